@@ -34,6 +34,11 @@ option(
 option(WITH_LOGGING_TIMING_DATA
        "Build with logging all Add and Erase Segment calls." OFF)
 
+# Turn this option on to store each track of note data in a sorted array
+# instead of a std::map.
+option(WITH_FLAT_NOTE_DATA
+       "Build with note data stored in sorted arrays." OFF)
+
 if(NOT MSVC)
   # Change this number to utilize a different number of jobs for building
   # FFMPEG.
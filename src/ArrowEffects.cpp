@@ -12,7 +12,9 @@
 #include "GameState.h"
 #include "Style.h"
 #include "ThemeMetric.h"
+#include "GameplayBenchmark.h"
 
+#include <algorithm>
 #include <cfloat>
 #include <cmath>
 #include <cstddef>
@@ -84,8 +86,9 @@ static ThemeMetric<float>	TINY_PERCENT_BASE( "ArrowEffects", "TinyPercentBase" )
 static ThemeMetric<float>	TINY_PERCENT_GATE( "ArrowEffects", "TinyPercentGate" );
 
 static const PlayerOptions* curr_options= nullptr;
-
-float ArrowGetPercentVisible(float fYPosWithoutReverse, int iCol, float fYOffset);
+// Bumped by Update and SetCurrentOptions, so that the Y offset frame worked
+// out for a draw isn't used after anything it depends on could change.
+static unsigned g_iYOffsetFrameGeneration= 0;
 
 static float GetNoteFieldHeight()
 {
@@ -152,46 +155,165 @@ static float SelectTanType(float angle, bool is_cosec)
 	    return RageFastTan(angle);
 }
 
-static float CalculateTornadoOffsetFromMagnitude(int dimension, int col_id,
+/* The position effects below add their offset to each of a batch of notes.
+ * Everything that only depends on the options and the column is worked out
+ * before the loop, so that the loop is only the math that depends on each
+ * note's Y offset. */
+static void AddTornadoOffsets(int dimension, int col_id,
 	float magnitude, float effect_offset, float period,
 	const Style::ColumnInfo* pCols, float field_zoom,
-	PerPlayerData& data, float y_offset, bool is_tan)
+	PerPlayerData& data, bool is_tan, const float* y_offsets, int count,
+	float* out)
 {
 	float const real_pixel_offset= pCols[col_id].fXOffset * field_zoom;
+	float const min_pixel_offset= data.m_MinTornado[dimension][col_id] * field_zoom;
+	float const max_pixel_offset= data.m_MaxTornado[dimension][col_id] * field_zoom;
 	float const position_between= SCALE(real_pixel_offset,
-		data.m_MinTornado[dimension][col_id] * field_zoom,
-		data.m_MaxTornado[dimension][col_id] * field_zoom,
+		min_pixel_offset, max_pixel_offset,
 		tornado_position_scale_to_low[dimension],
 		tornado_position_scale_to_high[dimension]);
-	float rads= std::acos(position_between);
-	float frequency= tornado_offset_frequency[dimension];
-	rads+= (y_offset + effect_offset) * ((period * frequency) + frequency) / SCREEN_HEIGHT;
-	float processed_rads = is_tan ? SelectTanType(rads, curr_options->m_bCosecant) : RageFastCos(rads);
+	float const base_rads= std::acos(position_between);
+	float const frequency= tornado_offset_frequency[dimension];
+	float const rads_scale= (period * frequency) + frequency;
+	float const screen_height= SCREEN_HEIGHT;
+	float const scale_from_low= tornado_offset_scale_from_low[dimension];
+	float const scale_from_high= tornado_offset_scale_from_high[dimension];
+	bool const is_cosec= curr_options->m_bCosecant;
+	for(int i= 0; i < count; ++i)
+	{
+		float rads= base_rads;
+		rads+= (y_offsets[i] + effect_offset) * rads_scale / screen_height;
+		float processed_rads = is_tan ? SelectTanType(rads, is_cosec) : RageFastCos(rads);
+
+		float const adjusted_pixel_offset= SCALE(processed_rads,
+			scale_from_low, scale_from_high,
+			min_pixel_offset, max_pixel_offset);
+		out[i]+= (adjusted_pixel_offset - real_pixel_offset) * magnitude;
+	}
+}
 
-	float const adjusted_pixel_offset= SCALE(processed_rads,
-		tornado_offset_scale_from_low[dimension],
-		tornado_offset_scale_from_high[dimension],
-		data.m_MinTornado[dimension][col_id] * field_zoom,
-		data.m_MaxTornado[dimension][col_id] * field_zoom);
-	return (adjusted_pixel_offset - real_pixel_offset) * magnitude;
+static void AddDrunkOffsets(float magnitude, float speed, int col, float offset,
+	float col_frequency, float period, float offset_frequency,
+	float arrow_magnitude, bool is_tan, const float* y_offsets, int count,
+	float* out)
+{
+	float const time= ArrowEffects::GetTime();
+	float const base_angle= time * (1+speed) + col*( (offset*col_frequency) + col_frequency);
+	float const angle_scale= (period*offset_frequency) + offset_frequency;
+	float const screen_height= SCREEN_HEIGHT;
+	bool const is_cosec= curr_options->m_bCosecant;
+	for(int i= 0; i < count; ++i)
+	{
+		float const angle= base_angle + y_offsets[i] * angle_scale / screen_height;
+		float const wave= is_tan ? SelectTanType(angle, is_cosec) : RageFastCos(angle);
+		out[i]+= magnitude * ( wave * ARROW_SIZE*arrow_magnitude );
+	}
 }
 
-static float CalculateDrunkAngle(float speed, int col, float offset,
-	float col_frequency, float y_offset, float period, float offset_frequency)
+static void AddBumpyOffsets(float magnitude, float offset, float period,
+	bool is_tan, const float* y_offsets, int count, float* out)
 {
-	float time = ArrowEffects::GetTime();
-	return time * (1+speed) + col*( (offset*col_frequency) + col_frequency)
-		+ y_offset * ( (period*offset_frequency) + offset_frequency) / SCREEN_HEIGHT;
+	float const angle_offset= 100.0f*offset;
+	float const angle_period= (period*16.0f)+16.0f;
+	bool const is_cosec= curr_options->m_bCosecant;
+	for(int i= 0; i < count; ++i)
+	{
+		float const angle= (y_offsets[i]+angle_offset)/angle_period;
+		float const wave= is_tan ? SelectTanType(angle, is_cosec) : RageFastSin(angle);
+		out[i]+= magnitude * 40*wave;
+	}
 }
 
-static float CalculateBumpyAngle(float y_offset, float offset, float period)
+static void AddBeatOffsets(float beat_factor, float magnitude, float period,
+	float offset_height, float pi_height, const float* y_offsets, int count,
+	float* out)
 {
-	return (y_offset+(100.0f*offset))/((period*16.0f)+16.0f);
+	float const shift_period= (period*offset_height)+offset_height;
+	float const shift_phase= PI/pi_height;
+	for(int i= 0; i < count; ++i)
+	{
+		const float fShift = beat_factor*RageFastSin( y_offsets[i] / shift_period + shift_phase );
+		out[i]+= magnitude * fShift;
+	}
 }
 
-static float CalculateDigitalAngle(float y_offset, float offset, float period)
+static void AddZigzagOffsets(float magnitude, float offset, float period,
+	const float* y_offsets, int count, float* out)
 {
-	return PI * (y_offset + (1.0f * offset ) ) / (ARROW_SIZE + (period * ARROW_SIZE) );
+	float const angle_scale= PI * (1/(period+1));
+	float const angle_offset= 100.0f*offset;
+	float const amplitude= magnitude*ARROW_SIZE/2;
+	for(int i= 0; i < count; ++i)
+	{
+		float fResult = RageTriangle( angle_scale * ((y_offsets[i]+angle_offset)/ARROW_SIZE) );
+		out[i]+= amplitude * fResult;
+	}
+}
+
+static void AddSawtoothOffsets(float magnitude, float period,
+	const float* y_offsets, int count, float* out)
+{
+	float const amplitude= magnitude*ARROW_SIZE;
+	float const frequency= 0.5f / (period+1);
+	for(int i= 0; i < count; ++i)
+	{
+		float const phase= (frequency * y_offsets[i]) / ARROW_SIZE;
+		out[i]+= amplitude * (phase - std::floor(phase));
+	}
+}
+
+static void AddParabolaOffsets(float magnitude, const float* y_offsets,
+	int count, float* out)
+{
+	for(int i= 0; i < count; ++i)
+		out[i]+= magnitude * (y_offsets[i]/ARROW_SIZE) * (y_offsets[i]/ARROW_SIZE);
+}
+
+static void AddAttenuateOffsets(float magnitude, float x_offset,
+	const float* y_offsets, int count, float* out)
+{
+	float const column_scale= x_offset/ARROW_SIZE;
+	for(int i= 0; i < count; ++i)
+		out[i]+= magnitude * (y_offsets[i]/ARROW_SIZE) * (y_offsets[i]/ARROW_SIZE) * column_scale;
+}
+
+static void AddDigitalOffsets(float magnitude, float steps, float offset,
+	float period, bool is_tan, const float* y_offsets, int count, float* out)
+{
+	float const amplitude= magnitude * ARROW_SIZE * 0.5f;
+	float const num_steps= steps+1;
+	float const angle_period= ARROW_SIZE + (period * ARROW_SIZE);
+	bool const is_cosec= curr_options->m_bCosecant;
+	for(int i= 0; i < count; ++i)
+	{
+		float const angle= PI * (y_offsets[i] + (1.0f * offset ) ) / angle_period;
+		float const wave= is_tan ? SelectTanType(angle, is_cosec) : RageFastSin(angle);
+		out[i]+= amplitude * std::round(num_steps * wave) / num_steps;
+	}
+}
+
+static void AddSquareOffsets(float magnitude, float offset, float period,
+	const float* y_offsets, int count, float* out)
+{
+	float const angle_period= ARROW_SIZE+(period*ARROW_SIZE);
+	float const amplitude= magnitude * ARROW_SIZE * 0.5f;
+	for(int i= 0; i < count; ++i)
+	{
+		float fResult = RageSquare( (PI * (y_offsets[i]+(1.0f*offset))) / angle_period );
+		out[i]+= amplitude * fResult;
+	}
+}
+
+static void AddBounceOffsets(float magnitude, float offset, float period,
+	const float* y_offsets, int count, float* out)
+{
+	float const bounce_period= 60 + (period*60);
+	float const amplitude= magnitude * ARROW_SIZE * 0.5f;
+	for(int i= 0; i < count; ++i)
+	{
+		float fBounceAmt = std::abs( RageFastSin( (y_offsets[i] + (1.0f * offset)) / bounce_period ) );
+		out[i]+= amplitude * fBounceAmt;
+	}
 }
 
 static void UpdateBeat(int dimension, PerPlayerData &data, const SongPosition &position, float beat_offset, float beat_mult)
@@ -315,6 +437,8 @@ void ArrowEffects::Init(PlayerNumber pn)
 
 void ArrowEffects::Update()
 {
+	GameplayBenchmark::StageTimer timer( BenchmarkStage_ArrowEffects );
+
 	static float fLastTime = 0;
 	float fTime = RageTimer::GetTimeSinceStartFast();
 
@@ -427,17 +551,19 @@ void ArrowEffects::Update()
 		UpdateBeat(dim_z, data, position, effects[PlayerOptions::EFFECT_BEAT_Z_OFFSET], effects[PlayerOptions::EFFECT_BEAT_Z_MULT]);
 	}
 	fLastTime = fTime;
+	++g_iYOffsetFrameGeneration;
 }
 
 void ArrowEffects::SetCurrentOptions(const PlayerOptions* options)
 {
 	curr_options= options;
+	++g_iYOffsetFrameGeneration;
 }
 
-static float GetDisplayedBeat( const PlayerState* pPlayerState, float beat )
+// Returns the index of the segment of data that beat is in, or -1.
+static int FindDisplayedBeatSegment( const std::vector<CacheDisplayedBeat> &data, float beat )
 {
 	// do a binary search here
-	const std::vector<CacheDisplayedBeat> &data = pPlayerState->m_CacheDisplayedBeat;
 	int max = data.size() - 1;
 	int l = 0, r = max;
 	while( l <= r )
@@ -445,7 +571,7 @@ static float GetDisplayedBeat( const PlayerState* pPlayerState, float beat )
 		int m = ( l + r ) / 2;
 		if( ( m == 0 || data[m].beat <= beat ) && ( m == max || beat < data[m + 1].beat ) )
 		{
-			return data[m].displayedBeat + data[m].velocity * (beat - data[m].beat);
+			return m;
 		}
 		else if( data[m].beat <= beat )
 		{
@@ -456,157 +582,374 @@ static float GetDisplayedBeat( const PlayerState* pPlayerState, float beat )
 			r = m - 1;
 		}
 	}
-	return beat;
+	return -1;
 }
 
-/* For visibility testing: if bAbsolute is false, random modifiers must return
- * the minimum possible scroll speed. */
-float ArrowEffects::GetYOffset( const PlayerState* pPlayerState, int iCol, float fNoteBeat, float &fPeakYOffsetOut, bool &bIsPastPeakOut, bool bAbsolute )
+static float GetDisplayedBeatInSegment( const std::vector<CacheDisplayedBeat> &data, int m, float beat )
 {
-	// Default values that are returned if boomerang is off.
-	fPeakYOffsetOut = FLT_MAX;
-	bIsPastPeakOut = true;
+	if( m == -1 )
+		return beat;
+	return data[m].displayedBeat + data[m].velocity * (beat - data[m].beat);
+}
 
-	float fYOffset = 0;
-	const SongPosition &position = pPlayerState->GetDisplayedPosition();
+static float GetDisplayedBeat( const PlayerState* pPlayerState, float beat )
+{
+	const std::vector<CacheDisplayedBeat> &data = pPlayerState->m_CacheDisplayedBeat;
+	return GetDisplayedBeatInSegment( data, FindDisplayedBeatSegment(data, beat), beat );
+}
 
-	float fSongBeat = position.m_fSongBeatVisible;
+namespace
+{
+	/* Everything GetYOffset needs that's the same for every note the player
+	 * has in a frame, so that a batch of notes only works it out once. */
+	struct YOffsetFrame
+	{
+		const PlayerState *m_pPlayerState;
+		const TimingData *m_pTiming;
+		float m_fSongBeat;
+
+		bool m_bBeatSpacing;	// m_fTimeSpacing != 1
+		bool m_bConstantSpacing;	// in the step editor
+		float m_fDisplayedSongBeat;
+		float m_fDisplayedSpeedPercent;
+
+		bool m_bTimeSpacing;	// m_fTimeSpacing != 0
+		float m_fSongSeconds;
+		float m_fBPS;
+
+		float m_fTimeSpacing;
+		float m_fArrowSpacing;
+		float m_fScrollSpeed;
+
+		bool m_bBoost, m_bBrake, m_bWave, m_bParabolaY, m_bBoomerang;
+		bool m_bRandomSpeed, m_bExpand, m_bTanExpand;
+		float m_fBoost, m_fBrake, m_fWave, m_fParabolaY;
+		float m_fEffectHeight;
+		float m_fBoostMinClamp, m_fBoostMaxClamp;
+		float m_fBrakeMinClamp, m_fBrakeMaxClamp;
+		float m_fWaveMagnitude, m_fWaveHeight;
+		float m_fScreenHeight;
+		float m_fPeakAtYOffset;
+		float m_fPeakYOffset;
+		unsigned m_iStageSeed;
+		float m_fRandomSpeed;
+		float m_fExpandSpeed;
+		float m_fTanExpandSpeed;
+	};
+}
 
+static void PrepareYOffsetFrame( const PlayerState* pPlayerState, bool bAbsolute, YOffsetFrame &frame )
+{
+	const SongPosition &position = pPlayerState->GetDisplayedPosition();
 	Steps *pCurSteps = GAMESTATE->m_pCurSteps[pPlayerState->m_PlayerNumber];
 
-	/* Usually, fTimeSpacing is 0 or 1, in which case we use entirely beat spacing or
-	 * entirely time spacing (respectively). Occasionally, we tween between them. */
-	if( curr_options->m_fTimeSpacing != 1.0f )
-	{
-		if( GAMESTATE->m_bInStepEditor ) {
-			// Use constant spacing in step editor
-			fYOffset = fNoteBeat - fSongBeat;
-		} else {
-			fYOffset = GetDisplayedBeat(pPlayerState, fNoteBeat) - GetDisplayedBeat(pPlayerState, fSongBeat);
-			fYOffset *= pCurSteps->GetTimingData()->GetDisplayedSpeedPercent(
-								     position.m_fSongBeatVisible,
-								     position.m_fMusicSecondsVisible );
-		}
-		fYOffset *= 1 - curr_options->m_fTimeSpacing;
+	frame = YOffsetFrame();
+	frame.m_pPlayerState = pPlayerState;
+	frame.m_fSongBeat = position.m_fSongBeatVisible;
+	frame.m_fTimeSpacing = curr_options->m_fTimeSpacing;
+
+	frame.m_bBeatSpacing = curr_options->m_fTimeSpacing != 1.0f;
+	frame.m_bConstantSpacing = GAMESTATE->m_bInStepEditor;
+	if( frame.m_bBeatSpacing && !frame.m_bConstantSpacing )
+	{
+		frame.m_pTiming = pCurSteps->GetTimingData();
+		frame.m_fDisplayedSongBeat = GetDisplayedBeat( pPlayerState, frame.m_fSongBeat );
+		frame.m_fDisplayedSpeedPercent = frame.m_pTiming->GetDisplayedSpeedPercent(
+			position.m_fSongBeatVisible, position.m_fMusicSecondsVisible );
 	}
 
-	if( curr_options->m_fTimeSpacing != 0.0f )
+	frame.m_bTimeSpacing = curr_options->m_fTimeSpacing != 0.0f;
+	if( frame.m_bTimeSpacing )
 	{
-		float fSongSeconds = pPlayerState->m_Position.m_fMusicSecondsVisible;
-		float fNoteSeconds = pCurSteps->GetTimingData()->GetElapsedTimeFromBeat(fNoteBeat);
-		float fSecondsUntilStep = fNoteSeconds - fSongSeconds;
+		frame.m_pTiming = pCurSteps->GetTimingData();
+		frame.m_fSongSeconds = pPlayerState->m_Position.m_fMusicSecondsVisible;
 		float fBPM = curr_options->m_fScrollBPM;
-		float fBPS = fBPM/60.f / GAMESTATE->m_SongOptions.GetCurrent().m_fMusicRate;
-		float fYOffsetTimeSpacing = fSecondsUntilStep * fBPS;
-		fYOffset += fYOffsetTimeSpacing * curr_options->m_fTimeSpacing;
+		frame.m_fBPS = fBPM/60.f / GAMESTATE->m_SongOptions.GetCurrent().m_fMusicRate;
 	}
 
 	// TODO: If we allow noteskins to have metricable row spacing
 	// (per issue 24), edit this to reflect that. -aj
-	fYOffset *= ARROW_SPACING;
+	frame.m_fArrowSpacing = ARROW_SPACING;
 
 	// Factor in scroll speed
-	float fScrollSpeed = curr_options->m_fScrollSpeed;
+	frame.m_fScrollSpeed = curr_options->m_fScrollSpeed;
 	if(curr_options->m_fMaxScrollBPM != 0)
 	{
-		fScrollSpeed= curr_options->m_fMaxScrollBPM /
+		frame.m_fScrollSpeed= curr_options->m_fMaxScrollBPM /
 			(pPlayerState->m_fReadBPM * GAMESTATE->m_SongOptions.GetCurrent().m_fMusicRate);
 	}
 
-	// don't mess with the arrows after they've crossed 0
-	if( fYOffset < 0 )
-	{
-		return fYOffset * fScrollSpeed;
-	}
-
 	const float* fAccels = curr_options->m_fAccels;
 	const float* fEffects = curr_options->m_fEffects;
 
 	// TODO: Don't index by PlayerNumber.
 	PerPlayerData &data = g_EffectData[pPlayerState->m_PlayerNumber];
 
-	float fYAdjust = 0;	// fill this in depending on PlayerOptions
+	frame.m_fBoost = fAccels[PlayerOptions::ACCEL_BOOST];
+	frame.m_fBrake = fAccels[PlayerOptions::ACCEL_BRAKE];
+	frame.m_fWave = fAccels[PlayerOptions::ACCEL_WAVE];
+	frame.m_fParabolaY = fEffects[PlayerOptions::EFFECT_PARABOLA_Y];
+	frame.m_bBoost = frame.m_fBoost != 0;
+	frame.m_bBrake = frame.m_fBrake != 0;
+	frame.m_bWave = frame.m_fWave != 0;
+	frame.m_bParabolaY = frame.m_fParabolaY != 0;
+	frame.m_bBoomerang = fAccels[PlayerOptions::ACCEL_BOOMERANG] != 0;
+	frame.m_bRandomSpeed = curr_options->m_fRandomSpeed > 0 && !bAbsolute;
+	frame.m_bExpand = fAccels[PlayerOptions::ACCEL_EXPAND] != 0;
+	frame.m_bTanExpand = fAccels[PlayerOptions::ACCEL_TAN_EXPAND] != 0;
 
-	if( fAccels[PlayerOptions::ACCEL_BOOST] != 0 )
+	if( frame.m_bBoost || frame.m_bBrake )
+		frame.m_fEffectHeight = GetNoteFieldHeight();
+	if( frame.m_bBoost )
 	{
-		float fEffectHeight = GetNoteFieldHeight();
-		float fNewYOffset = fYOffset * 1.5f / ((fYOffset+fEffectHeight/1.2f)/fEffectHeight);
-		float fAccelYAdjust =	fAccels[PlayerOptions::ACCEL_BOOST] * (fNewYOffset - fYOffset);
-		// TRICKY: Clamp this value, or else BOOST+BOOMERANG will draw a ton of arrows on the screen.
-		CLAMP( fAccelYAdjust, BOOST_MOD_MIN_CLAMP, BOOST_MOD_MAX_CLAMP );
-		fYAdjust += fAccelYAdjust;
+		frame.m_fBoostMinClamp = BOOST_MOD_MIN_CLAMP;
+		frame.m_fBoostMaxClamp = BOOST_MOD_MAX_CLAMP;
 	}
-	if( fAccels[PlayerOptions::ACCEL_BRAKE] != 0 )
+	if( frame.m_bBrake )
 	{
-		float fEffectHeight = GetNoteFieldHeight();
-		float fScale = SCALE( fYOffset, 0.f, fEffectHeight, 0, 1.f );
-		float fNewYOffset = fYOffset * fScale;
-		float fBrakeYAdjust = fAccels[PlayerOptions::ACCEL_BRAKE] * (fNewYOffset - fYOffset);
-		// TRICKY: Clamp this value the same way as BOOST so that in BOOST+BRAKE, BRAKE doesn't overpower BOOST
-		CLAMP( fBrakeYAdjust, BRAKE_MOD_MIN_CLAMP, BRAKE_MOD_MAX_CLAMP );
-		fYAdjust += fBrakeYAdjust;
+		frame.m_fBrakeMinClamp = BRAKE_MOD_MIN_CLAMP;
+		frame.m_fBrakeMaxClamp = BRAKE_MOD_MAX_CLAMP;
 	}
-	if( fAccels[PlayerOptions::ACCEL_WAVE] != 0 )
-		fYAdjust +=	fAccels[PlayerOptions::ACCEL_WAVE] * WAVE_MOD_MAGNITUDE *RageFastSin( fYOffset/((fAccels[PlayerOptions::ACCEL_WAVE_PERIOD]*WAVE_MOD_HEIGHT)+WAVE_MOD_HEIGHT) );
-
-	if( fEffects[PlayerOptions::EFFECT_PARABOLA_Y] != 0 )
-		fYAdjust += fEffects[PlayerOptions::EFFECT_PARABOLA_Y] * (fYOffset/ARROW_SIZE) * (fYOffset/ARROW_SIZE);
-
-	fYOffset += fYAdjust;
-
-	// Factor in boomerang
-	if( fAccels[PlayerOptions::ACCEL_BOOMERANG] != 0 )
+	if( frame.m_bWave )
 	{
-		float fPeakAtYOffset = SCREEN_HEIGHT * BOOMERANG_PEAK_PERCENTAGE;	// zero point of boomerang function
-		fPeakYOffsetOut = (-1*fPeakAtYOffset*fPeakAtYOffset/SCREEN_HEIGHT) + 1.5f*fPeakAtYOffset;
-		bIsPastPeakOut = fYOffset < fPeakAtYOffset;
-
-		fYOffset = (-1*fYOffset*fYOffset/SCREEN_HEIGHT) + 1.5f*fYOffset;
+		frame.m_fWaveMagnitude = WAVE_MOD_MAGNITUDE;
+		frame.m_fWaveHeight = (fAccels[PlayerOptions::ACCEL_WAVE_PERIOD]*WAVE_MOD_HEIGHT)+WAVE_MOD_HEIGHT;
 	}
-
-	if( curr_options->m_fRandomSpeed > 0 && !bAbsolute )
+	frame.m_fScreenHeight = SCREEN_HEIGHT;
+	if( frame.m_bBoomerang )
 	{
-		// Generate a deterministically "random" speed for each arrow.
-		unsigned seed = GAMESTATE->m_iStageSeed + ( BeatToNoteRow( fNoteBeat ) << 8 ) + (iCol * 100);
-
-		for( int i = 0; i < 3; ++i )
-			seed = ((seed * 1664525u) + 1013904223u) & 0xFFFFFFFF;
-		float fRandom = seed / 4294967296.0f;
-
-		/* Random speed always increases speed: a random speed of 10 indicates
-		 * [1,11]. This keeps it consistent with other mods: 0 means no effect. */
-		fScrollSpeed *=
-				SCALE( fRandom,
-						0.0f, 1.0f,
-						1.0f, curr_options->m_fRandomSpeed + 1.0f );
+		float fPeakAtYOffset = frame.m_fScreenHeight * BOOMERANG_PEAK_PERCENTAGE;	// zero point of boomerang function
+		frame.m_fPeakAtYOffset = fPeakAtYOffset;
+		frame.m_fPeakYOffset = (-1*fPeakAtYOffset*fPeakAtYOffset/frame.m_fScreenHeight) + 1.5f*fPeakAtYOffset;
+	}
+	if( frame.m_bRandomSpeed )
+	{
+		frame.m_iStageSeed = GAMESTATE->m_iStageSeed;
+		frame.m_fRandomSpeed = curr_options->m_fRandomSpeed;
 	}
 
-	if( fAccels[PlayerOptions::ACCEL_EXPAND] != 0 )
+	if( frame.m_bExpand )
 	{
 		float fExpandMultiplier = SCALE( RageFastCos(data.m_fExpandSeconds*EXPAND_MULTIPLIER_FREQUENCY*(fAccels[PlayerOptions::ACCEL_EXPAND_PERIOD]+1)),
 						EXPAND_MULTIPLIER_SCALE_FROM_LOW, EXPAND_MULTIPLIER_SCALE_FROM_HIGH,
 						EXPAND_MULTIPLIER_SCALE_TO_LOW, EXPAND_MULTIPLIER_SCALE_TO_HIGH );
-		fScrollSpeed *=	SCALE( fAccels[PlayerOptions::ACCEL_EXPAND],
+		frame.m_fExpandSpeed = SCALE( fAccels[PlayerOptions::ACCEL_EXPAND],
 				      EXPAND_SPEED_SCALE_FROM_LOW, EXPAND_SPEED_SCALE_FROM_HIGH,
 				      EXPAND_SPEED_SCALE_TO_LOW, fExpandMultiplier );
 	}
 
-	if( fAccels[PlayerOptions::ACCEL_TAN_EXPAND] != 0 )
+	if( frame.m_bTanExpand )
 	{
 		float fTanExpandMultiplier = SCALE( SelectTanType(data.m_fTanExpandSeconds*EXPAND_MULTIPLIER_FREQUENCY*(fAccels[PlayerOptions::ACCEL_TAN_EXPAND_PERIOD]+1), curr_options->m_bCosecant),
 						EXPAND_MULTIPLIER_SCALE_FROM_LOW, EXPAND_MULTIPLIER_SCALE_FROM_HIGH,
 						EXPAND_MULTIPLIER_SCALE_TO_LOW, EXPAND_MULTIPLIER_SCALE_TO_HIGH );
-		fScrollSpeed *=	SCALE( fAccels[PlayerOptions::ACCEL_TAN_EXPAND],
+		frame.m_fTanExpandSpeed = SCALE( fAccels[PlayerOptions::ACCEL_TAN_EXPAND],
 				      EXPAND_SPEED_SCALE_FROM_LOW, EXPAND_SPEED_SCALE_FROM_HIGH,
 				      EXPAND_SPEED_SCALE_TO_LOW, fTanExpandMultiplier );
 	}
+}
 
-	fYOffset *= fScrollSpeed;
-	fPeakYOffsetOut *= fScrollSpeed;
+namespace
+{
+	struct CachedYOffsetFrame
+	{
+		bool m_bValid = false;
+		unsigned m_iGeneration;
+		const PlayerState *m_pPlayerState;
+		const PlayerOptions *m_pOptions;
+		float m_fSongBeatVisible;
+		float m_fDisplayedSecondsVisible;
+		float m_fMusicSecondsVisible;
+		YOffsetFrame m_Frame;
+	};
+	// One for each value of bAbsolute.
+	CachedYOffsetFrame g_CachedYOffsetFrame[2];
+}
+
+/* Every note drawn, and every IsOnScreen test, needs the frame; only work it
+ * out again when the player, their options or the song position change. */
+static const YOffsetFrame &GetYOffsetFrame( const PlayerState* pPlayerState, bool bAbsolute )
+{
+	const SongPosition &position = pPlayerState->GetDisplayedPosition();
+	CachedYOffsetFrame &cache = g_CachedYOffsetFrame[bAbsolute? 1:0];
+	if( !cache.m_bValid ||
+		cache.m_iGeneration != g_iYOffsetFrameGeneration ||
+		cache.m_pPlayerState != pPlayerState ||
+		cache.m_pOptions != curr_options ||
+		cache.m_fSongBeatVisible != position.m_fSongBeatVisible ||
+		cache.m_fDisplayedSecondsVisible != position.m_fMusicSecondsVisible ||
+		cache.m_fMusicSecondsVisible != pPlayerState->m_Position.m_fMusicSecondsVisible )
+	{
+		PrepareYOffsetFrame( pPlayerState, bAbsolute, cache.m_Frame );
+		cache.m_bValid = true;
+		cache.m_iGeneration = g_iYOffsetFrameGeneration;
+		cache.m_pPlayerState = pPlayerState;
+		cache.m_pOptions = curr_options;
+		cache.m_fSongBeatVisible = position.m_fSongBeatVisible;
+		cache.m_fDisplayedSecondsVisible = position.m_fMusicSecondsVisible;
+		cache.m_fMusicSecondsVisible = pPlayerState->m_Position.m_fMusicSecondsVisible;
+	}
+	return cache.m_Frame;
+}
+
+/* Work out the Y offsets of iCount notes in one column.  The first pass finds
+ * how far away each note is; that's the part that has to look things up in
+ * the timing data.  The second applies the scroll speed and the accels, where
+ * everything but the offset is the same for every note. */
+static void CalculateYOffsets( const YOffsetFrame &frame, int iCol, const float *pNoteBeats, int iCount,
+	float *pYOffsetsOut, float *pPeakYOffsetsOut, bool *pIsPastPeakOut )
+{
+	const PlayerState* pPlayerState = frame.m_pPlayerState;
+	const std::vector<CacheDisplayedBeat> &displayed = pPlayerState->m_CacheDisplayedBeat;
+	int iSegment = -1;
+
+	for( int i = 0; i < iCount; ++i )
+	{
+		const float fNoteBeat = pNoteBeats[i];
+		float fYOffset = 0;
+
+		/* Usually, fTimeSpacing is 0 or 1, in which case we use entirely beat spacing or
+		 * entirely time spacing (respectively). Occasionally, we tween between them. */
+		if( frame.m_bBeatSpacing )
+		{
+			if( frame.m_bConstantSpacing ) {
+				// Use constant spacing in step editor
+				fYOffset = fNoteBeat - frame.m_fSongBeat;
+			} else {
+				// Notes usually come in order, so carry on from the last
+				// note's segment rather than searching again.
+				if( i > 0 && iSegment != -1 && fNoteBeat >= pNoteBeats[i-1] )
+				{
+					while( iSegment < int(displayed.size()) - 1 && displayed[iSegment + 1].beat <= fNoteBeat )
+						++iSegment;
+				}
+				else
+				{
+					iSegment = FindDisplayedBeatSegment( displayed, fNoteBeat );
+				}
+				fYOffset = GetDisplayedBeatInSegment(displayed, iSegment, fNoteBeat) - frame.m_fDisplayedSongBeat;
+				fYOffset *= frame.m_fDisplayedSpeedPercent;
+			}
+			fYOffset *= 1 - frame.m_fTimeSpacing;
+		}
+
+		if( frame.m_bTimeSpacing )
+		{
+			float fNoteSeconds = frame.m_pTiming->GetElapsedTimeFromBeat(fNoteBeat);
+			float fSecondsUntilStep = fNoteSeconds - frame.m_fSongSeconds;
+			float fYOffsetTimeSpacing = fSecondsUntilStep * frame.m_fBPS;
+			fYOffset += fYOffsetTimeSpacing * frame.m_fTimeSpacing;
+		}
+
+		pYOffsetsOut[i] = fYOffset * frame.m_fArrowSpacing;
+	}
+
+	for( int i = 0; i < iCount; ++i )
+	{
+		float fYOffset = pYOffsetsOut[i];
+		// Default values that are returned if boomerang is off.
+		float fPeakYOffset = FLT_MAX;
+		bool bIsPastPeak = true;
+		float fScrollSpeed = frame.m_fScrollSpeed;
+
+		// don't mess with the arrows after they've crossed 0
+		if( fYOffset < 0 )
+		{
+			pYOffsetsOut[i] = fYOffset * fScrollSpeed;
+			if( pPeakYOffsetsOut )
+				pPeakYOffsetsOut[i] = fPeakYOffset;
+			if( pIsPastPeakOut )
+				pIsPastPeakOut[i] = bIsPastPeak;
+			continue;
+		}
+
+		float fYAdjust = 0;	// fill this in depending on PlayerOptions
+
+		if( frame.m_bBoost )
+		{
+			float fEffectHeight = frame.m_fEffectHeight;
+			float fNewYOffset = fYOffset * 1.5f / ((fYOffset+fEffectHeight/1.2f)/fEffectHeight);
+			float fAccelYAdjust =	frame.m_fBoost * (fNewYOffset - fYOffset);
+			// TRICKY: Clamp this value, or else BOOST+BOOMERANG will draw a ton of arrows on the screen.
+			CLAMP( fAccelYAdjust, frame.m_fBoostMinClamp, frame.m_fBoostMaxClamp );
+			fYAdjust += fAccelYAdjust;
+		}
+		if( frame.m_bBrake )
+		{
+			float fEffectHeight = frame.m_fEffectHeight;
+			float fScale = SCALE( fYOffset, 0.f, fEffectHeight, 0, 1.f );
+			float fNewYOffset = fYOffset * fScale;
+			float fBrakeYAdjust = frame.m_fBrake * (fNewYOffset - fYOffset);
+			// TRICKY: Clamp this value the same way as BOOST so that in BOOST+BRAKE, BRAKE doesn't overpower BOOST
+			CLAMP( fBrakeYAdjust, frame.m_fBrakeMinClamp, frame.m_fBrakeMaxClamp );
+			fYAdjust += fBrakeYAdjust;
+		}
+		if( frame.m_bWave )
+			fYAdjust +=	frame.m_fWave * frame.m_fWaveMagnitude *RageFastSin( fYOffset/frame.m_fWaveHeight );
+
+		if( frame.m_bParabolaY )
+			fYAdjust += frame.m_fParabolaY * (fYOffset/ARROW_SIZE) * (fYOffset/ARROW_SIZE);
 
+		fYOffset += fYAdjust;
+
+		// Factor in boomerang
+		if( frame.m_bBoomerang )
+		{
+			fPeakYOffset = frame.m_fPeakYOffset;
+			bIsPastPeak = fYOffset < frame.m_fPeakAtYOffset;
+
+			fYOffset = (-1*fYOffset*fYOffset/frame.m_fScreenHeight) + 1.5f*fYOffset;
+		}
+
+		if( frame.m_bRandomSpeed )
+		{
+			// Generate a deterministically "random" speed for each arrow.
+			unsigned seed = frame.m_iStageSeed + ( BeatToNoteRow( pNoteBeats[i] ) << 8 ) + (iCol * 100);
+
+			for( int j = 0; j < 3; ++j )
+				seed = ((seed * 1664525u) + 1013904223u) & 0xFFFFFFFF;
+			float fRandom = seed / 4294967296.0f;
+
+			/* Random speed always increases speed: a random speed of 10 indicates
+			 * [1,11]. This keeps it consistent with other mods: 0 means no effect. */
+			fScrollSpeed *=
+					SCALE( fRandom,
+							0.0f, 1.0f,
+							1.0f, frame.m_fRandomSpeed + 1.0f );
+		}
+
+		if( frame.m_bExpand )
+			fScrollSpeed *= frame.m_fExpandSpeed;
+
+		if( frame.m_bTanExpand )
+			fScrollSpeed *= frame.m_fTanExpandSpeed;
+
+		pYOffsetsOut[i] = fYOffset * fScrollSpeed;
+		if( pPeakYOffsetsOut )
+			pPeakYOffsetsOut[i] = fPeakYOffset * fScrollSpeed;
+		if( pIsPastPeakOut )
+			pIsPastPeakOut[i] = bIsPastPeak;
+	}
+}
+
+/* For visibility testing: if bAbsolute is false, random modifiers must return
+ * the minimum possible scroll speed. */
+float ArrowEffects::GetYOffset( const PlayerState* pPlayerState, int iCol, float fNoteBeat, float &fPeakYOffsetOut, bool &bIsPastPeakOut, bool bAbsolute )
+{
+	const YOffsetFrame &frame = GetYOffsetFrame( pPlayerState, bAbsolute );
+	float fYOffset;
+	CalculateYOffsets( frame, iCol, &fNoteBeat, 1, &fYOffset, &fPeakYOffsetOut, &bIsPastPeakOut );
 	return fYOffset;
 }
 
+void ArrowEffects::GetYOffsets( const PlayerState* pPlayerState, int iCol, const float *pNoteBeats, int iCount, float *pYOffsetsOut, bool *pIsPastPeakOut, bool bAbsolute )
+{
+	if( iCount <= 0 )
+		return;
+	const YOffsetFrame &frame = GetYOffsetFrame( pPlayerState, bAbsolute );
+	CalculateYOffsets( frame, iCol, pNoteBeats, iCount, pYOffsetsOut, nullptr, pIsPastPeakOut );
+}
+
 static void ArrowGetReverseShiftAndScale(int iCol, float fYReverseOffsetPixels, float &fShiftOut, float &fScaleOut)
 {
 	// XXX: Hack: we need to scale the reverse shift by the zoom.
@@ -627,15 +970,30 @@ static void ArrowGetReverseShiftAndScale(int iCol, float fYReverseOffsetPixels,
 
 float ArrowEffects::GetYPos( const PlayerState* pPlayerState, int iCol, float fYOffset, float fYReverseOffsetPixels, bool WithReverse)
 {
-	float f = fYOffset;
+	float fYPos;
+	GetYPositions( pPlayerState, iCol, &fYOffset, 1, fYReverseOffsetPixels, &fYPos, WithReverse );
+	return fYPos;
+}
+
+void ArrowEffects::GetYPositions( const PlayerState* pPlayerState, int iCol, const float *pYOffsets, int iCount, float fYReverseOffsetPixels, float *pYPosOut, bool WithReverse )
+{
+	if( iCount <= 0 )
+		return;
+
+	float *f = pYPosOut;
+	for( int i = 0; i < iCount; ++i )
+		f[i] = pYOffsets[i];
 
 	if( WithReverse )
 	{
 		float fShift, fScale;
 		ArrowGetReverseShiftAndScale(iCol, fYReverseOffsetPixels, fShift, fScale);
 
-		f *= fScale;
-		f += fShift;
+		for( int i = 0; i < iCount; ++i )
+		{
+			f[i] *= fScale;
+			f[i] += fShift;
+		}
 	}
 
 	// TODO: Don't index by PlayerNumber.
@@ -647,56 +1005,89 @@ float ArrowEffects::GetYPos( const PlayerState* pPlayerState, int iCol, float fY
 	// checking whether tipsy is on. -Kyz
 	// TODO: Don't index by PlayerNumber.
 	PerPlayerData& data= g_EffectData[curr_options->m_pn];
-	f+= fEffects[PlayerOptions::EFFECT_TIPSY] * data.m_tipsy_result[iCol];
-	f+= fEffects[PlayerOptions::EFFECT_TAN_TIPSY] * data.m_tan_tipsy_result[iCol];
-
-	if( fEffects[PlayerOptions::EFFECT_ATTENUATE_Y] != 0 )
+	const float fTipsy = fEffects[PlayerOptions::EFFECT_TIPSY] * data.m_tipsy_result[iCol];
+	const float fTanTipsy = fEffects[PlayerOptions::EFFECT_TAN_TIPSY] * data.m_tan_tipsy_result[iCol];
+	for( int i = 0; i < iCount; ++i )
 	{
-		const float fXOffset = pCols[iCol].fXOffset;
-		f += fEffects[PlayerOptions::EFFECT_ATTENUATE_Y] * (fYOffset/ARROW_SIZE) * (fYOffset/ARROW_SIZE) * (fXOffset/ARROW_SIZE);
+		f[i]+= fTipsy;
+		f[i]+= fTanTipsy;
 	}
 
+	if( fEffects[PlayerOptions::EFFECT_ATTENUATE_Y] != 0 )
+		AddAttenuateOffsets(fEffects[PlayerOptions::EFFECT_ATTENUATE_Y],
+			pCols[iCol].fXOffset, pYOffsets, iCount, f);
 
 	if( fEffects[PlayerOptions::EFFECT_BEAT_Y] != 0 )
-	{
-		const float fShift = data.m_fBeatFactor[dim_y]*RageFastSin( fYOffset / ((fEffects[PlayerOptions::EFFECT_BEAT_Y_PERIOD]*BEAT_Y_OFFSET_HEIGHT)+BEAT_Y_OFFSET_HEIGHT) + PI/BEAT_Y_PI_HEIGHT );
-		f += fEffects[PlayerOptions::EFFECT_BEAT_Y] * fShift;
-	}
+		AddBeatOffsets(data.m_fBeatFactor[dim_y], fEffects[PlayerOptions::EFFECT_BEAT_Y],
+			fEffects[PlayerOptions::EFFECT_BEAT_Y_PERIOD], BEAT_Y_OFFSET_HEIGHT, BEAT_Y_PI_HEIGHT,
+			pYOffsets, iCount, f);
 
 	// In beware's DDR Extreme-focused fork of StepMania 3.9, this value is
 	// floored, making arrows show on integer Y coordinates. Supposedly it makes
 	// the arrows look better, but testing needs to be done.
 	// todo: make this a noteskin metric instead of a theme metric? -aj
-	return QUANTIZE_ARROW_Y ? std::floor(f) : f;
+	if( QUANTIZE_ARROW_Y )
+	{
+		for( int i = 0; i < iCount; ++i )
+			f[i] = std::floor(f[i]);
+	}
 }
 
 float ArrowEffects::GetYOffsetFromYPos(int iCol, float YPos, float fYReverseOffsetPixels)
 {
-	float f = YPos;
+	float fYOffset;
+	GetYOffsetsFromYPos( iCol, &YPos, 1, fYReverseOffsetPixels, &fYOffset );
+	return fYOffset;
+}
+
+void ArrowEffects::GetYOffsetsFromYPos( int iCol, const float *pYPos, int iCount, float fYReverseOffsetPixels, float *pYOffsetsOut )
+{
+	if( iCount <= 0 )
+		return;
 
+	float *f = pYOffsetsOut;
 	const float* fEffects = curr_options->m_fEffects;
 	// Doing the math with a precalculated result of 0 should be faster than
 	// checking whether tipsy is on. -Kyz
 	// TODO: Don't index by PlayerNumber.
 	PerPlayerData& data= g_EffectData[curr_options->m_pn];
-	f+= fEffects[PlayerOptions::EFFECT_TIPSY] * data.m_tipsy_offset_result[iCol];
-	f+= fEffects[PlayerOptions::EFFECT_TAN_TIPSY] * data.m_tan_tipsy_offset_result[iCol];
+	const float fTipsy = fEffects[PlayerOptions::EFFECT_TIPSY] * data.m_tipsy_offset_result[iCol];
+	const float fTanTipsy = fEffects[PlayerOptions::EFFECT_TAN_TIPSY] * data.m_tan_tipsy_offset_result[iCol];
+	for( int i = 0; i < iCount; ++i )
+	{
+		f[i] = pYPos[i];
+		f[i]+= fTipsy;
+		f[i]+= fTanTipsy;
+	}
 
-	f+= fEffects[PlayerOptions::EFFECT_PARABOLA_Y] * (YPos/ARROW_SIZE) * (YPos/ARROW_SIZE);
+	AddParabolaOffsets(fEffects[PlayerOptions::EFFECT_PARABOLA_Y], pYPos, iCount, f);
 
 	float fShift, fScale;
 	ArrowGetReverseShiftAndScale(iCol, fYReverseOffsetPixels, fShift, fScale);
 
-	f -= fShift;
-	if( fScale )
-		f /= fScale;
-
-	return f;
+	for( int i = 0; i < iCount; ++i )
+	{
+		f[i] -= fShift;
+		if( fScale )
+			f[i] /= fScale;
+	}
 }
 
 float ArrowEffects::GetXPos( const PlayerState* pPlayerState, int iColNum, float fYOffset )
 {
-	float fPixelOffsetFromCenter = 0; // fill this in below
+	float fXPos;
+	GetXPositions( pPlayerState, iColNum, &fYOffset, 1, &fXPos );
+	return fXPos;
+}
+
+void ArrowEffects::GetXPositions( const PlayerState* pPlayerState, int iColNum, const float *pYOffsets, int iCount, float *pXPosOut )
+{
+	if( iCount <= 0 )
+		return;
+
+	float *fPixelOffsetFromCenter = pXPosOut; // fill this in below
+	for( int i = 0; i < iCount; ++i )
+		fPixelOffsetFromCenter[i] = 0;
 
 	const Style* pStyle = GAMESTATE->GetCurrentStyle(pPlayerState->m_PlayerNumber);
 	const float* fEffects = curr_options->m_fEffects;
@@ -707,48 +1098,47 @@ float ArrowEffects::GetXPos( const PlayerState* pPlayerState, int iColNum, float
 
 	if( fEffects[PlayerOptions::EFFECT_TORNADO] != 0 )
 	{
-		fPixelOffsetFromCenter += CalculateTornadoOffsetFromMagnitude(dim_x,
-			iColNum, fEffects[PlayerOptions::EFFECT_TORNADO],
+		AddTornadoOffsets(dim_x, iColNum, fEffects[PlayerOptions::EFFECT_TORNADO],
 			fEffects[PlayerOptions::EFFECT_TORNADO_OFFSET],
 			fEffects[PlayerOptions::EFFECT_TORNADO_PERIOD],
-			pCols, pPlayerState->m_NotefieldZoom, data, fYOffset, false);
+			pCols, pPlayerState->m_NotefieldZoom, data, false,
+			pYOffsets, iCount, fPixelOffsetFromCenter);
 	}
 
 	if( fEffects[PlayerOptions::EFFECT_TAN_TORNADO] != 0 )
 	{
-		fPixelOffsetFromCenter += CalculateTornadoOffsetFromMagnitude(dim_x,
-			iColNum, fEffects[PlayerOptions::EFFECT_TAN_TORNADO],
+		AddTornadoOffsets(dim_x, iColNum, fEffects[PlayerOptions::EFFECT_TAN_TORNADO],
 			fEffects[PlayerOptions::EFFECT_TAN_TORNADO_OFFSET],
 			fEffects[PlayerOptions::EFFECT_TAN_TORNADO_PERIOD],
-			pCols, pPlayerState->m_NotefieldZoom, data, fYOffset, true);
+			pCols, pPlayerState->m_NotefieldZoom, data, true,
+			pYOffsets, iCount, fPixelOffsetFromCenter);
 	}
 
 	if( fEffects[PlayerOptions::EFFECT_BUMPY_X] != 0 )
-		fPixelOffsetFromCenter += fEffects[PlayerOptions::EFFECT_BUMPY_X] *
-			40*RageFastSin( CalculateBumpyAngle(fYOffset,
+		AddBumpyOffsets(fEffects[PlayerOptions::EFFECT_BUMPY_X],
 			fEffects[PlayerOptions::EFFECT_BUMPY_X_OFFSET],
-			fEffects[PlayerOptions::EFFECT_BUMPY_X_PERIOD]) );
+			fEffects[PlayerOptions::EFFECT_BUMPY_X_PERIOD], false,
+			pYOffsets, iCount, fPixelOffsetFromCenter);
 
 	if( fEffects[PlayerOptions::EFFECT_TAN_BUMPY_X] != 0 )
-		fPixelOffsetFromCenter += fEffects[PlayerOptions::EFFECT_TAN_BUMPY_X] *
-			40*SelectTanType( CalculateBumpyAngle(fYOffset,
+		AddBumpyOffsets(fEffects[PlayerOptions::EFFECT_TAN_BUMPY_X],
 			fEffects[PlayerOptions::EFFECT_TAN_BUMPY_X_OFFSET],
-			fEffects[PlayerOptions::EFFECT_TAN_BUMPY_X_PERIOD]), curr_options->m_bCosecant );
+			fEffects[PlayerOptions::EFFECT_TAN_BUMPY_X_PERIOD], true,
+			pYOffsets, iCount, fPixelOffsetFromCenter);
 
 	if( fEffects[PlayerOptions::EFFECT_DRUNK] != 0 )
-		fPixelOffsetFromCenter += fEffects[PlayerOptions::EFFECT_DRUNK] *
-			( RageFastCos( CalculateDrunkAngle(fEffects[PlayerOptions::EFFECT_DRUNK_SPEED], iColNum,
-					fEffects[PlayerOptions::EFFECT_DRUNK_OFFSET], DRUNK_COLUMN_FREQUENCY,
-					fYOffset, fEffects[PlayerOptions::EFFECT_DRUNK_PERIOD],
-					DRUNK_OFFSET_FREQUENCY) ) * ARROW_SIZE*DRUNK_ARROW_MAGNITUDE );
+		AddDrunkOffsets(fEffects[PlayerOptions::EFFECT_DRUNK],
+			fEffects[PlayerOptions::EFFECT_DRUNK_SPEED], iColNum,
+			fEffects[PlayerOptions::EFFECT_DRUNK_OFFSET], DRUNK_COLUMN_FREQUENCY,
+			fEffects[PlayerOptions::EFFECT_DRUNK_PERIOD], DRUNK_OFFSET_FREQUENCY,
+			DRUNK_ARROW_MAGNITUDE, false, pYOffsets, iCount, fPixelOffsetFromCenter);
 
 	if( fEffects[PlayerOptions::EFFECT_TAN_DRUNK] != 0 )
-		fPixelOffsetFromCenter += fEffects[PlayerOptions::EFFECT_TAN_DRUNK] *
-			( SelectTanType( CalculateDrunkAngle(fEffects[PlayerOptions::EFFECT_TAN_DRUNK_SPEED],
-					iColNum, fEffects[PlayerOptions::EFFECT_TAN_DRUNK_OFFSET],
-					DRUNK_COLUMN_FREQUENCY, fYOffset,
-					fEffects[PlayerOptions::EFFECT_TAN_DRUNK_PERIOD], DRUNK_OFFSET_FREQUENCY)
-					, curr_options->m_bCosecant) * ARROW_SIZE*DRUNK_ARROW_MAGNITUDE );
+		AddDrunkOffsets(fEffects[PlayerOptions::EFFECT_TAN_DRUNK],
+			fEffects[PlayerOptions::EFFECT_TAN_DRUNK_SPEED], iColNum,
+			fEffects[PlayerOptions::EFFECT_TAN_DRUNK_OFFSET], DRUNK_COLUMN_FREQUENCY,
+			fEffects[PlayerOptions::EFFECT_TAN_DRUNK_PERIOD], DRUNK_OFFSET_FREQUENCY,
+			DRUNK_ARROW_MAGNITUDE, true, pYOffsets, iCount, fPixelOffsetFromCenter);
 
 	if( fEffects[PlayerOptions::EFFECT_FLIP] != 0 )
 	{
@@ -758,74 +1148,72 @@ float ArrowEffects::GetXPos( const PlayerState* pPlayerState, int iColNum, float
 		const float fOldPixelOffset = pCols[iColNum].fXOffset * pPlayerState->m_NotefieldZoom;
 		const float fNewPixelOffset = pCols[iNewCol].fXOffset * pPlayerState->m_NotefieldZoom;
 		const float fDistance = fNewPixelOffset - fOldPixelOffset;
-		fPixelOffsetFromCenter += fDistance * fEffects[PlayerOptions::EFFECT_FLIP];
+		const float fFlip = fDistance * fEffects[PlayerOptions::EFFECT_FLIP];
+		for( int i = 0; i < iCount; ++i )
+			fPixelOffsetFromCenter[i] += fFlip;
 	}
 	if( fEffects[PlayerOptions::EFFECT_INVERT] != 0 )
-		fPixelOffsetFromCenter += data.m_fInvertDistance[iColNum] * fEffects[PlayerOptions::EFFECT_INVERT];
-
-	if( fEffects[PlayerOptions::EFFECT_BEAT] != 0 )
 	{
-		const float fShift = data.m_fBeatFactor[dim_x]*RageFastSin( fYOffset / ((fEffects[PlayerOptions::EFFECT_BEAT_PERIOD]*BEAT_OFFSET_HEIGHT)+BEAT_OFFSET_HEIGHT) + PI/BEAT_PI_HEIGHT );
-		fPixelOffsetFromCenter += fEffects[PlayerOptions::EFFECT_BEAT] * fShift;
+		const float fInvert = data.m_fInvertDistance[iColNum] * fEffects[PlayerOptions::EFFECT_INVERT];
+		for( int i = 0; i < iCount; ++i )
+			fPixelOffsetFromCenter[i] += fInvert;
 	}
 
-	if( fEffects[PlayerOptions::EFFECT_ZIGZAG] != 0 )
-	{
-		float fResult = RageTriangle( (PI * (1/(fEffects[PlayerOptions::EFFECT_ZIGZAG_PERIOD]+1)) *
-		((fYOffset+(100.0f*(fEffects[PlayerOptions::EFFECT_ZIGZAG_OFFSET])))/ARROW_SIZE) ) );
+	if( fEffects[PlayerOptions::EFFECT_BEAT] != 0 )
+		AddBeatOffsets(data.m_fBeatFactor[dim_x], fEffects[PlayerOptions::EFFECT_BEAT],
+			fEffects[PlayerOptions::EFFECT_BEAT_PERIOD], BEAT_OFFSET_HEIGHT, BEAT_PI_HEIGHT,
+			pYOffsets, iCount, fPixelOffsetFromCenter);
 
-		fPixelOffsetFromCenter += (fEffects[PlayerOptions::EFFECT_ZIGZAG]*ARROW_SIZE/2) * fResult;
-	}
+	if( fEffects[PlayerOptions::EFFECT_ZIGZAG] != 0 )
+		AddZigzagOffsets(fEffects[PlayerOptions::EFFECT_ZIGZAG],
+			fEffects[PlayerOptions::EFFECT_ZIGZAG_OFFSET],
+			fEffects[PlayerOptions::EFFECT_ZIGZAG_PERIOD],
+			pYOffsets, iCount, fPixelOffsetFromCenter);
 
 	if( fEffects[PlayerOptions::EFFECT_SAWTOOTH] != 0 )
-		fPixelOffsetFromCenter += (fEffects[PlayerOptions::EFFECT_SAWTOOTH]*ARROW_SIZE) *
-			((0.5f / (fEffects[PlayerOptions::EFFECT_SAWTOOTH_PERIOD]+1) * fYOffset) / ARROW_SIZE -
-			std::floor((0.5f / (fEffects[PlayerOptions::EFFECT_SAWTOOTH_PERIOD]+1) * fYOffset) / ARROW_SIZE) );
+		AddSawtoothOffsets(fEffects[PlayerOptions::EFFECT_SAWTOOTH],
+			fEffects[PlayerOptions::EFFECT_SAWTOOTH_PERIOD],
+			pYOffsets, iCount, fPixelOffsetFromCenter);
 
 	if( fEffects[PlayerOptions::EFFECT_PARABOLA_X] != 0 )
-		fPixelOffsetFromCenter += fEffects[PlayerOptions::EFFECT_PARABOLA_X] * (fYOffset/ARROW_SIZE) * (fYOffset/ARROW_SIZE);
+		AddParabolaOffsets(fEffects[PlayerOptions::EFFECT_PARABOLA_X],
+			pYOffsets, iCount, fPixelOffsetFromCenter);
 
 	if( fEffects[PlayerOptions::EFFECT_ATTENUATE_X] != 0 )
-	{
-		const float fXOffset = pCols[iColNum].fXOffset;
-		fPixelOffsetFromCenter += fEffects[PlayerOptions::EFFECT_ATTENUATE_X] * (fYOffset/ARROW_SIZE) * (fYOffset/ARROW_SIZE) * (fXOffset/ARROW_SIZE);
-	}
+		AddAttenuateOffsets(fEffects[PlayerOptions::EFFECT_ATTENUATE_X],
+			pCols[iColNum].fXOffset, pYOffsets, iCount, fPixelOffsetFromCenter);
 
 	if( fEffects[PlayerOptions::EFFECT_DIGITAL] != 0 )
-		fPixelOffsetFromCenter += (fEffects[PlayerOptions::EFFECT_DIGITAL] * ARROW_SIZE * 0.5f) *
-			std::round((fEffects[PlayerOptions::EFFECT_DIGITAL_STEPS]+1) * RageFastSin(
-				CalculateDigitalAngle(fYOffset,
-				fEffects[PlayerOptions::EFFECT_DIGITAL_OFFSET],
-				fEffects[PlayerOptions::EFFECT_DIGITAL_PERIOD]) ) )/(fEffects[PlayerOptions::EFFECT_DIGITAL_STEPS]+1);
+		AddDigitalOffsets(fEffects[PlayerOptions::EFFECT_DIGITAL],
+			fEffects[PlayerOptions::EFFECT_DIGITAL_STEPS],
+			fEffects[PlayerOptions::EFFECT_DIGITAL_OFFSET],
+			fEffects[PlayerOptions::EFFECT_DIGITAL_PERIOD], false,
+			pYOffsets, iCount, fPixelOffsetFromCenter);
 
 	if( fEffects[PlayerOptions::EFFECT_TAN_DIGITAL] != 0 )
-		fPixelOffsetFromCenter += (fEffects[PlayerOptions::EFFECT_TAN_DIGITAL] * ARROW_SIZE * 0.5f) *
-			std::round((fEffects[PlayerOptions::EFFECT_TAN_DIGITAL_STEPS]+1) * SelectTanType(
-				CalculateDigitalAngle(fYOffset,
-				fEffects[PlayerOptions::EFFECT_TAN_DIGITAL_OFFSET],
-				fEffects[PlayerOptions::EFFECT_TAN_DIGITAL_PERIOD]), curr_options->m_bCosecant ) )/(fEffects[PlayerOptions::EFFECT_TAN_DIGITAL_STEPS]+1);
-
+		AddDigitalOffsets(fEffects[PlayerOptions::EFFECT_TAN_DIGITAL],
+			fEffects[PlayerOptions::EFFECT_TAN_DIGITAL_STEPS],
+			fEffects[PlayerOptions::EFFECT_TAN_DIGITAL_OFFSET],
+			fEffects[PlayerOptions::EFFECT_TAN_DIGITAL_PERIOD], true,
+			pYOffsets, iCount, fPixelOffsetFromCenter);
 
 	if( fEffects[PlayerOptions::EFFECT_SQUARE] != 0 )
-	{
-		float fResult = RageSquare( (PI * (fYOffset+(1.0f*(fEffects[PlayerOptions::EFFECT_SQUARE_OFFSET]))) /
-			(ARROW_SIZE+(fEffects[PlayerOptions::EFFECT_SQUARE_PERIOD]*ARROW_SIZE))) );
-
-		fPixelOffsetFromCenter += (fEffects[PlayerOptions::EFFECT_SQUARE] * ARROW_SIZE * 0.5f) * fResult;
-	}
+		AddSquareOffsets(fEffects[PlayerOptions::EFFECT_SQUARE],
+			fEffects[PlayerOptions::EFFECT_SQUARE_OFFSET],
+			fEffects[PlayerOptions::EFFECT_SQUARE_PERIOD],
+			pYOffsets, iCount, fPixelOffsetFromCenter);
 
 	if( fEffects[PlayerOptions::EFFECT_BOUNCE] != 0 )
-	{
-		float fBounceAmt = std::abs( RageFastSin( ( (fYOffset + (1.0f * (fEffects[PlayerOptions::EFFECT_BOUNCE_OFFSET]) ) ) /
-			( 60 + (fEffects[PlayerOptions::EFFECT_BOUNCE_PERIOD]*60) ) ) ) );
-
-		fPixelOffsetFromCenter += fEffects[PlayerOptions::EFFECT_BOUNCE] * ARROW_SIZE * 0.5f * fBounceAmt;
-	}
+		AddBounceOffsets(fEffects[PlayerOptions::EFFECT_BOUNCE],
+			fEffects[PlayerOptions::EFFECT_BOUNCE_OFFSET],
+			fEffects[PlayerOptions::EFFECT_BOUNCE_PERIOD],
+			pYOffsets, iCount, fPixelOffsetFromCenter);
 
 	if( fEffects[PlayerOptions::EFFECT_XMODE] != 0 )
 	{
 		// based off of code by v1toko for StepNXA, except it should work on
 		// any gametype now.
+		bool bMirrored = false;
 		switch( pStyle->m_StyleType )
 		{
 			case StyleType_OnePlayerTwoSides:
@@ -834,40 +1222,53 @@ float ArrowEffects::GetXPos( const PlayerState* pPlayerState, int iColNum, float
 					// find the middle, and split based on iColNum
 					// it's unknown if this will work for routine.
 					const int iMiddleColumn = std::floor(pStyle->m_iColsPerPlayer/2.0f);
-					if( iColNum > iMiddleColumn-1 )
-						fPixelOffsetFromCenter += fEffects[PlayerOptions::EFFECT_XMODE]*-(fYOffset);
-					else
-						fPixelOffsetFromCenter += fEffects[PlayerOptions::EFFECT_XMODE]*fYOffset;
+					bMirrored = iColNum > iMiddleColumn-1;
 				}
 				break;
 			case StyleType_OnePlayerOneSide:
 			case StyleType_TwoPlayersTwoSides:
 				{
 					// the code was the same for both of these cases in StepNXA.
-					if( pPlayerState->m_PlayerNumber == PLAYER_2 )
-						fPixelOffsetFromCenter += fEffects[PlayerOptions::EFFECT_XMODE]*-(fYOffset);
-					else
-						fPixelOffsetFromCenter += fEffects[PlayerOptions::EFFECT_XMODE]*fYOffset;
+					bMirrored = pPlayerState->m_PlayerNumber == PLAYER_2;
 				}
 				break;
 			DEFAULT_FAIL(pStyle->m_StyleType);
 		}
+		const float fXMode = fEffects[PlayerOptions::EFFECT_XMODE];
+		if( bMirrored )
+		{
+			for( int i = 0; i < iCount; ++i )
+				fPixelOffsetFromCenter[i] += fXMode*-(pYOffsets[i]);
+		}
+		else
+		{
+			for( int i = 0; i < iCount; ++i )
+				fPixelOffsetFromCenter[i] += fXMode*pYOffsets[i];
+		}
 	}
 
-	fPixelOffsetFromCenter += pCols[iColNum].fXOffset * pPlayerState->m_NotefieldZoom;
+	const float fColumnOffset = pCols[iColNum].fXOffset * pPlayerState->m_NotefieldZoom;
+	for( int i = 0; i < iCount; ++i )
+		fPixelOffsetFromCenter[i] += fColumnOffset;
 
 	if( fEffects[PlayerOptions::EFFECT_TINY] != 0 )
 	{
 		// Allow Tiny to pull tracks together, but not to push them apart.
 		float fTinyPercent = fEffects[PlayerOptions::EFFECT_TINY];
 		fTinyPercent = std::min( std::pow(TINY_PERCENT_BASE, fTinyPercent), (float)TINY_PERCENT_GATE );
-		fPixelOffsetFromCenter *= fTinyPercent;
+		for( int i = 0; i < iCount; ++i )
+			fPixelOffsetFromCenter[i] *= fTinyPercent;
 	}
-
-	return fPixelOffsetFromCenter;
 }
 
 float ArrowEffects::GetRotationX(const PlayerState* pPlayerState, float fYOffset, bool bIsHoldCap, int iCol)
+{
+	float fRotation;
+	GetRotationsX( pPlayerState, &fYOffset, 1, bIsHoldCap, iCol, &fRotation );
+	return fRotation;
+}
+
+void ArrowEffects::GetRotationsX( const PlayerState* pPlayerState, const float *pYOffsets, int iCount, bool bIsHoldCap, int iCol, float *pRotationsOut )
 {
 	const float* fEffects = curr_options->m_fEffects;
 	float fRotation = 0;
@@ -875,14 +1276,24 @@ float ArrowEffects::GetRotationX(const PlayerState* pPlayerState, float fYOffset
 	curr_options->m_fConfusionX[iCol] != 0
 	)
 		fRotation += ReceptorGetRotationX( pPlayerState, iCol );
+	for( int i = 0; i < iCount; ++i )
+		pRotationsOut[i] = fRotation;
 	if( fEffects[PlayerOptions::EFFECT_ROLL] != 0 && !bIsHoldCap )
 	{
-		fRotation += fEffects[PlayerOptions::EFFECT_ROLL] * fYOffset/2;
+		const float fRoll = fEffects[PlayerOptions::EFFECT_ROLL];
+		for( int i = 0; i < iCount; ++i )
+			pRotationsOut[i] += fRoll * pYOffsets[i]/2;
 	}
-	return fRotation;
 }
 
 float ArrowEffects::GetRotationY(const PlayerState* pPlayerState, float fYOffset, int iCol)
+{
+	float fRotation;
+	GetRotationsY( pPlayerState, &fYOffset, 1, iCol, &fRotation );
+	return fRotation;
+}
+
+void ArrowEffects::GetRotationsY( const PlayerState* pPlayerState, const float *pYOffsets, int iCount, int iCol, float *pRotationsOut )
 {
 	const float* fEffects = curr_options->m_fEffects;
 	float fRotation = 0;
@@ -890,14 +1301,24 @@ float ArrowEffects::GetRotationY(const PlayerState* pPlayerState, float fYOffset
 	curr_options->m_fConfusionY[iCol] != 0
 	)
 		fRotation += ReceptorGetRotationY( pPlayerState, iCol );
+	for( int i = 0; i < iCount; ++i )
+		pRotationsOut[i] = fRotation;
 	if( fEffects[PlayerOptions::EFFECT_TWIRL] != 0 )
 	{
-		fRotation += fEffects[PlayerOptions::EFFECT_TWIRL] * fYOffset/2;
+		const float fTwirl = fEffects[PlayerOptions::EFFECT_TWIRL];
+		for( int i = 0; i < iCount; ++i )
+			pRotationsOut[i] += fTwirl * pYOffsets[i]/2;
 	}
-	return fRotation;
 }
 
 float ArrowEffects::GetRotationZ( const PlayerState* pPlayerState, float fNoteBeat, bool bIsHoldHead, int iCol )
+{
+	float fRotation;
+	GetRotationsZ( pPlayerState, &fNoteBeat, 1, bIsHoldHead, iCol, &fRotation );
+	return fRotation;
+}
+
+void ArrowEffects::GetRotationsZ( const PlayerState* pPlayerState, const float *pNoteBeats, int iCount, bool bIsHoldHead, int iCol, float *pRotationsOut )
 {
 	const float* fEffects = curr_options->m_fEffects;
 	float fRotation = 0;
@@ -905,18 +1326,23 @@ float ArrowEffects::GetRotationZ( const PlayerState* pPlayerState, float fNoteBe
 	curr_options->m_fConfusionZ[iCol] != 0
 	)
 		fRotation += ReceptorGetRotationZ( pPlayerState, iCol );
+	for( int i = 0; i < iCount; ++i )
+		pRotationsOut[i] = fRotation;
 
 	// As usual, enable dizzy hold heads at your own risk. -Wolfman2000
 	if( fEffects[PlayerOptions::EFFECT_DIZZY] != 0 && ( curr_options->m_bDizzyHolds || !bIsHoldHead ) )
 	{
 		const float fSongBeat = pPlayerState->m_Position.m_fSongBeatVisible;
-		float fDizzyRotation = fNoteBeat - fSongBeat;
-		fDizzyRotation *= fEffects[PlayerOptions::EFFECT_DIZZY];
-		fDizzyRotation = std::fmod( fDizzyRotation, 2*PI );
-		fDizzyRotation *= 180/PI;
-		fRotation += fDizzyRotation;
+		const float fDizzy = fEffects[PlayerOptions::EFFECT_DIZZY];
+		for( int i = 0; i < iCount; ++i )
+		{
+			float fDizzyRotation = pNoteBeats[i] - fSongBeat;
+			fDizzyRotation *= fDizzy;
+			fDizzyRotation = std::fmod( fDizzyRotation, 2*PI );
+			fDizzyRotation *= 180/PI;
+			pRotationsOut[i] += fDizzyRotation;
+		}
 	}
-	return fRotation;
 }
 
 float ArrowEffects::ReceptorGetRotationZ( const PlayerState* pPlayerState, int iCol )
@@ -1074,91 +1500,153 @@ static float GetSuddenStartLine()
 		GetCenterLine() * curr_options->m_fAppearances[PlayerOptions::APPEARANCE_SUDDEN_OFFSET];
 }
 
-// used by ArrowGetAlpha and ArrowGetGlow below
-float ArrowGetPercentVisible(float fYPosWithoutReverse, int iCol, float fYOffset)
+// used by GetAlphasAndGlows below
+static void ArrowGetPercentVisible(const float *pYPosWithoutReverse, int iCol, const float *pYOffsets, int iCount, float *pPercentVisibleOut)
 {
-	const float fDistFromCenterLine = fYPosWithoutReverse - GetCenterLine();
-
-	float fYPos;
-	if( curr_options->m_bStealthType )
-		fYPos = fYOffset;
-	else
-		fYPos = fYPosWithoutReverse;
-
-
-	if( fYPos < 0 && curr_options->m_bStealthPastReceptors == false)	// past Gray Arrows
-		return 1;	// totally visible
+	const float fCenterLine = GetCenterLine();
+	const bool bStealthType = curr_options->m_bStealthType;
+	const bool bStealthPastReceptors = curr_options->m_bStealthPastReceptors;
 
 	const float* fAppearances = curr_options->m_fAppearances;
+	const float fHidden = fAppearances[PlayerOptions::APPEARANCE_HIDDEN];
+	const float fSudden = fAppearances[PlayerOptions::APPEARANCE_SUDDEN];
+	const float fStealth = fAppearances[PlayerOptions::APPEARANCE_STEALTH];
+	const float fColumnStealth = curr_options->m_fStealth[iCol];
+	const float fBlink = fAppearances[PlayerOptions::APPEARANCE_BLINK];
+	const float fRandomVanish = fAppearances[PlayerOptions::APPEARANCE_RANDOMVANISH];
 
-	float fVisibleAdjust = 0;
-
-	if( fAppearances[PlayerOptions::APPEARANCE_HIDDEN] != 0 )
+	float fHiddenStartLine = 0, fHiddenEndLine = 0;
+	if( fHidden != 0 )
 	{
-		float fHiddenVisibleAdjust = SCALE( fYPos, GetHiddenStartLine(), GetHiddenEndLine(), 0, -1 );
-		CLAMP( fHiddenVisibleAdjust, -1, 0 );
-		fVisibleAdjust += fAppearances[PlayerOptions::APPEARANCE_HIDDEN] * fHiddenVisibleAdjust;
+		fHiddenStartLine = GetHiddenStartLine();
+		fHiddenEndLine = GetHiddenEndLine();
 	}
-	if( fAppearances[PlayerOptions::APPEARANCE_SUDDEN] != 0 )
+	float fSuddenStartLine = 0, fSuddenEndLine = 0;
+	if( fSudden != 0 )
 	{
-		float fSuddenVisibleAdjust = SCALE( fYPos, GetSuddenStartLine(), GetSuddenEndLine(), -1, 0 );
-		CLAMP( fSuddenVisibleAdjust, -1, 0 );
-		fVisibleAdjust += fAppearances[PlayerOptions::APPEARANCE_SUDDEN] * fSuddenVisibleAdjust;
-	}
-
-	if( fAppearances[PlayerOptions::APPEARANCE_STEALTH] != 0 )
-		fVisibleAdjust -= fAppearances[PlayerOptions::APPEARANCE_STEALTH];
-	if( curr_options->m_fStealth[iCol] != 0 ){
-		fVisibleAdjust -= curr_options->m_fStealth[iCol];
+		fSuddenStartLine = GetSuddenStartLine();
+		fSuddenEndLine = GetSuddenEndLine();
 	}
-	if( fAppearances[PlayerOptions::APPEARANCE_BLINK] != 0 )
+	float fBlinkAdjust = 0;
+	if( fBlink != 0 )
 	{
 		float f = RageFastSin(ArrowEffects::GetTime()*10);
 		f = Quantize( f, BLINK_MOD_FREQUENCY );
-		fVisibleAdjust += SCALE( f, 0, 1, -1, 0 );
+		fBlinkAdjust = SCALE( f, 0, 1, -1, 0 );
 	}
-	if( fAppearances[PlayerOptions::APPEARANCE_RANDOMVANISH] != 0 )
+
+	for( int i = 0; i < iCount; ++i )
 	{
-		const float fRealFadeDist = 80;
-		fVisibleAdjust += SCALE( std::abs(fDistFromCenterLine), fRealFadeDist, 2*fRealFadeDist, -1, 0 )
-			* fAppearances[PlayerOptions::APPEARANCE_RANDOMVANISH];
-	}
+		const float fYPosWithoutReverse = pYPosWithoutReverse[i];
+		const float fDistFromCenterLine = fYPosWithoutReverse - fCenterLine;
 
-	return clamp(1 + fVisibleAdjust, 0.0f, 1.0f);
-}
+		float fYPos;
+		if( bStealthType )
+			fYPos = pYOffsets[i];
+		else
+			fYPos = fYPosWithoutReverse;
 
-float ArrowEffects::GetAlpha( const PlayerState* pPlayerState, int iCol, float fYOffset, float fPercentFadeToFail, float fYReverseOffsetPixels, float fDrawDistanceBeforeTargetsPixels, float fFadeInPercentOfDrawFar)
-{
-	// Get the YPos without reverse (that is, factor in EFFECT_TIPSY).
-	float fYPosWithoutReverse = ArrowEffects::GetYPos(pPlayerState, iCol, fYOffset, fYReverseOffsetPixels, false );
+		if( fYPos < 0 && bStealthPastReceptors == false)	// past Gray Arrows
+		{
+			pPercentVisibleOut[i] = 1;	// totally visible
+			continue;
+		}
 
-	float fPercentVisible = ArrowGetPercentVisible(fYPosWithoutReverse, iCol, fYOffset);
+		float fVisibleAdjust = 0;
 
-	if( fPercentFadeToFail != -1 )
-		fPercentVisible = 1 - fPercentFadeToFail;
+		if( fHidden != 0 )
+		{
+			float fHiddenVisibleAdjust = SCALE( fYPos, fHiddenStartLine, fHiddenEndLine, 0, -1 );
+			CLAMP( fHiddenVisibleAdjust, -1, 0 );
+			fVisibleAdjust += fHidden * fHiddenVisibleAdjust;
+		}
+		if( fSudden != 0 )
+		{
+			float fSuddenVisibleAdjust = SCALE( fYPos, fSuddenStartLine, fSuddenEndLine, -1, 0 );
+			CLAMP( fSuddenVisibleAdjust, -1, 0 );
+			fVisibleAdjust += fSudden * fSuddenVisibleAdjust;
+		}
 
+		if( fStealth != 0 )
+			fVisibleAdjust -= fStealth;
+		if( fColumnStealth != 0 ){
+			fVisibleAdjust -= fColumnStealth;
+		}
+		if( fBlink != 0 )
+			fVisibleAdjust += fBlinkAdjust;
+		if( fRandomVanish != 0 )
+		{
+			const float fRealFadeDist = 80;
+			fVisibleAdjust += SCALE( std::abs(fDistFromCenterLine), fRealFadeDist, 2*fRealFadeDist, -1, 0 )
+				* fRandomVanish;
+		}
 
-	float fFullAlphaY = fDrawDistanceBeforeTargetsPixels*(1-fFadeInPercentOfDrawFar);
-	if( fYPosWithoutReverse > fFullAlphaY )
-	{
-		float f = SCALE( fYPosWithoutReverse, fFullAlphaY, fDrawDistanceBeforeTargetsPixels, 1.0f, 0.0f );
-		return f;
+		pPercentVisibleOut[i] = clamp(1 + fVisibleAdjust, 0.0f, 1.0f);
 	}
-	return (fPercentVisible>0.5f) ? 1.0f : 0.0f;
+}
+
+float ArrowEffects::GetAlpha( const PlayerState* pPlayerState, int iCol, float fYOffset, float fPercentFadeToFail, float fYReverseOffsetPixels, float fDrawDistanceBeforeTargetsPixels, float fFadeInPercentOfDrawFar)
+{
+	float fAlpha;
+	GetAlphasAndGlows( pPlayerState, iCol, &fYOffset, 1, fPercentFadeToFail, fYReverseOffsetPixels, fDrawDistanceBeforeTargetsPixels, fFadeInPercentOfDrawFar, &fAlpha, nullptr );
+	return fAlpha;
 }
 
 float ArrowEffects::GetGlow( const PlayerState* pPlayerState, int iCol, float fYOffset, float fPercentFadeToFail, float fYReverseOffsetPixels, float fDrawDistanceBeforeTargetsPixels, float fFadeInPercentOfDrawFar)
 {
-	// Get the YPos without reverse (that is, factor in EFFECT_TIPSY).
-	float fYPosWithoutReverse = ArrowEffects::GetYPos(pPlayerState, iCol, fYOffset, fYReverseOffsetPixels, false );
+	float fGlow;
+	GetAlphasAndGlows( pPlayerState, iCol, &fYOffset, 1, fPercentFadeToFail, fYReverseOffsetPixels, fDrawDistanceBeforeTargetsPixels, fFadeInPercentOfDrawFar, nullptr, &fGlow );
+	return fGlow;
+}
 
-	float fPercentVisible = ArrowGetPercentVisible(fYPosWithoutReverse, iCol, fYOffset);
+void ArrowEffects::GetAlphasAndGlows( const PlayerState* pPlayerState, int iCol, const float *pYOffsets, int iCount, float fPercentFadeToFail, float fYReverseOffsetPixels, float fDrawDistanceBeforeTargetsPixels, float fFadeInPercentOfDrawFar, float *pAlphasOut, float *pGlowsOut )
+{
+	const float fFullAlphaY = fDrawDistanceBeforeTargetsPixels*(1-fFadeInPercentOfDrawFar);
+
+	// Work through the notes a chunk at a time, so that the positions and
+	// visibilities in between can live on the stack.
+	enum { CHUNK_SIZE = 64 };
+	float fYPosWithoutReverse[CHUNK_SIZE];
+	float fPercentVisible[CHUNK_SIZE];
+	for( int iStart = 0; iStart < iCount; iStart += CHUNK_SIZE )
+	{
+		const int iChunk = std::min( iCount - iStart, int(CHUNK_SIZE) );
+		const float *pChunkYOffsets = pYOffsets + iStart;
+
+		// Get the YPos without reverse (that is, factor in EFFECT_TIPSY).
+		GetYPositions( pPlayerState, iCol, pChunkYOffsets, iChunk, fYReverseOffsetPixels, fYPosWithoutReverse, false );
+
+		if( fPercentFadeToFail != -1 )
+		{
+			for( int i = 0; i < iChunk; ++i )
+				fPercentVisible[i] = 1 - fPercentFadeToFail;
+		}
+		else
+		{
+			ArrowGetPercentVisible( fYPosWithoutReverse, iCol, pChunkYOffsets, iChunk, fPercentVisible );
+		}
 
-	if( fPercentFadeToFail != -1 )
-		fPercentVisible = 1 - fPercentFadeToFail;
+		if( pAlphasOut != nullptr )
+		{
+			for( int i = 0; i < iChunk; ++i )
+			{
+				float &fAlpha = pAlphasOut[iStart + i];
+				if( fYPosWithoutReverse[i] > fFullAlphaY )
+					fAlpha = SCALE( fYPosWithoutReverse[i], fFullAlphaY, fDrawDistanceBeforeTargetsPixels, 1.0f, 0.0f );
+				else
+					fAlpha = (fPercentVisible[i]>0.5f) ? 1.0f : 0.0f;
+			}
+		}
 
-	const float fDistFromHalf = std::abs( fPercentVisible - 0.5f );
-	return SCALE( fDistFromHalf, 0, 0.5f, 1.3f, 0 );
+		if( pGlowsOut != nullptr )
+		{
+			for( int i = 0; i < iChunk; ++i )
+			{
+				const float fDistFromHalf = std::abs( fPercentVisible[i] - 0.5f );
+				pGlowsOut[iStart + i] = SCALE( fDistFromHalf, 0, 0.5f, 1.3f, 0 );
+			}
+		}
+	}
 }
 
 float ArrowEffects::GetBrightness( const PlayerState* pPlayerState, float fNoteBeat )
@@ -1177,7 +1665,20 @@ float ArrowEffects::GetBrightness( const PlayerState* pPlayerState, float fNoteB
 
 float ArrowEffects::GetZPos( const PlayerState* pPlayerState, int iCol, float fYOffset)
 {
-	float fZPos=0;
+	float fZPos;
+	GetZPositions( pPlayerState, iCol, &fYOffset, 1, &fZPos );
+	return fZPos;
+}
+
+void ArrowEffects::GetZPositions( const PlayerState* pPlayerState, int iCol, const float *pYOffsets, int iCount, float *pZPosOut )
+{
+	if( iCount <= 0 )
+		return;
+
+	float *fZPos = pZPosOut;
+	for( int i = 0; i < iCount; ++i )
+		fZPos[i] = 0;
+
 	const float* fEffects = curr_options->m_fEffects;
 	const Style* pStyle = GAMESTATE->GetCurrentStyle(pPlayerState->m_PlayerNumber);
 
@@ -1187,115 +1688,103 @@ float ArrowEffects::GetZPos( const PlayerState* pPlayerState, int iCol, float fY
 
 	if( fEffects[PlayerOptions::EFFECT_TORNADO_Z] != 0 )
 	{
-		fZPos += CalculateTornadoOffsetFromMagnitude(dim_z, iCol,
-			fEffects[PlayerOptions::EFFECT_TORNADO_Z],
+		AddTornadoOffsets(dim_z, iCol, fEffects[PlayerOptions::EFFECT_TORNADO_Z],
 			fEffects[PlayerOptions::EFFECT_TORNADO_Z_OFFSET],
 			fEffects[PlayerOptions::EFFECT_TORNADO_Z_PERIOD],
-			pCols, pPlayerState->m_NotefieldZoom, data, fYOffset, false);
+			pCols, pPlayerState->m_NotefieldZoom, data, false,
+			pYOffsets, iCount, fZPos);
 	}
 
 	if( fEffects[PlayerOptions::EFFECT_TAN_TORNADO_Z] != 0 )
 	{
-		fZPos += CalculateTornadoOffsetFromMagnitude(dim_z, iCol,
-			fEffects[PlayerOptions::EFFECT_TAN_TORNADO_Z],
+		AddTornadoOffsets(dim_z, iCol, fEffects[PlayerOptions::EFFECT_TAN_TORNADO_Z],
 			fEffects[PlayerOptions::EFFECT_TAN_TORNADO_Z_OFFSET],
 			fEffects[PlayerOptions::EFFECT_TAN_TORNADO_Z_PERIOD],
-			pCols, pPlayerState->m_NotefieldZoom, data, fYOffset, true);
+			pCols, pPlayerState->m_NotefieldZoom, data, true,
+			pYOffsets, iCount, fZPos);
 	}
 
 	if( fEffects[PlayerOptions::EFFECT_BUMPY] != 0 )
-		fZPos += fEffects[PlayerOptions::EFFECT_BUMPY] * 40*RageFastSin(
-			CalculateBumpyAngle(fYOffset,
+		AddBumpyOffsets(fEffects[PlayerOptions::EFFECT_BUMPY],
 			fEffects[PlayerOptions::EFFECT_BUMPY_OFFSET],
-			fEffects[PlayerOptions::EFFECT_BUMPY_PERIOD]) );
+			fEffects[PlayerOptions::EFFECT_BUMPY_PERIOD], false,
+			pYOffsets, iCount, fZPos);
 
 	if( curr_options->m_fBumpy[iCol] != 0 )
-		fZPos += curr_options->m_fBumpy[iCol] * 40*RageFastSin(
-			CalculateBumpyAngle(fYOffset,
+		AddBumpyOffsets(curr_options->m_fBumpy[iCol],
 			fEffects[PlayerOptions::EFFECT_BUMPY_OFFSET],
-			fEffects[PlayerOptions::EFFECT_BUMPY_PERIOD]) );
+			fEffects[PlayerOptions::EFFECT_BUMPY_PERIOD], false,
+			pYOffsets, iCount, fZPos);
 
 	if( fEffects[PlayerOptions::EFFECT_TAN_BUMPY] != 0 )
-		fZPos += fEffects[PlayerOptions::EFFECT_TAN_BUMPY] * 40*SelectTanType(
-			CalculateBumpyAngle(fYOffset,
+		AddBumpyOffsets(fEffects[PlayerOptions::EFFECT_TAN_BUMPY],
 			fEffects[PlayerOptions::EFFECT_TAN_BUMPY_OFFSET],
-			fEffects[PlayerOptions::EFFECT_TAN_BUMPY_PERIOD]), curr_options->m_bCosecant );
+			fEffects[PlayerOptions::EFFECT_TAN_BUMPY_PERIOD], true,
+			pYOffsets, iCount, fZPos);
 
 	if( fEffects[PlayerOptions::EFFECT_ZIGZAG_Z] != 0 )
-	{
-		float fResult = RageTriangle( (PI * (1/(fEffects[PlayerOptions::EFFECT_ZIGZAG_Z_PERIOD]+1)) *
-			((fYOffset+(100.0f*(fEffects[PlayerOptions::EFFECT_ZIGZAG_Z_OFFSET])))/ARROW_SIZE) ) );
-
-		fZPos += (fEffects[PlayerOptions::EFFECT_ZIGZAG_Z]*ARROW_SIZE/2) * fResult;
-	}
+		AddZigzagOffsets(fEffects[PlayerOptions::EFFECT_ZIGZAG_Z],
+			fEffects[PlayerOptions::EFFECT_ZIGZAG_Z_OFFSET],
+			fEffects[PlayerOptions::EFFECT_ZIGZAG_Z_PERIOD],
+			pYOffsets, iCount, fZPos);
 
 	if( fEffects[PlayerOptions::EFFECT_SAWTOOTH_Z] != 0 )
-		fZPos += (fEffects[PlayerOptions::EFFECT_SAWTOOTH_Z]*ARROW_SIZE) *
-			((0.5f/(fEffects[PlayerOptions::EFFECT_SAWTOOTH_Z_PERIOD]+1)*fYOffset)/ARROW_SIZE -
-				std::floor((0.5f/(fEffects[PlayerOptions::EFFECT_SAWTOOTH_Z_PERIOD]+1)*fYOffset)/ARROW_SIZE));
+		AddSawtoothOffsets(fEffects[PlayerOptions::EFFECT_SAWTOOTH_Z],
+			fEffects[PlayerOptions::EFFECT_SAWTOOTH_Z_PERIOD],
+			pYOffsets, iCount, fZPos);
 
 	if( fEffects[PlayerOptions::EFFECT_PARABOLA_Z] != 0 )
-		fZPos += fEffects[PlayerOptions::EFFECT_PARABOLA_Z] * (fYOffset/ARROW_SIZE) * (fYOffset/ARROW_SIZE);
+		AddParabolaOffsets(fEffects[PlayerOptions::EFFECT_PARABOLA_Z],
+			pYOffsets, iCount, fZPos);
 
 	if( fEffects[PlayerOptions::EFFECT_ATTENUATE_Z] != 0 )
-	{
-		const float fXOffset = pCols[iCol].fXOffset;
-		fZPos += fEffects[PlayerOptions::EFFECT_ATTENUATE_Z] * (fYOffset/ARROW_SIZE) * (fYOffset/ARROW_SIZE) * (fXOffset/ARROW_SIZE);
-	}
+		AddAttenuateOffsets(fEffects[PlayerOptions::EFFECT_ATTENUATE_Z],
+			pCols[iCol].fXOffset, pYOffsets, iCount, fZPos);
 
 	if( fEffects[PlayerOptions::EFFECT_DRUNK_Z] != 0 )
-		fZPos += fEffects[PlayerOptions::EFFECT_DRUNK_Z] *
-			( RageFastCos( CalculateDrunkAngle(fEffects[PlayerOptions::EFFECT_DRUNK_Z_SPEED], iCol,
-					fEffects[PlayerOptions::EFFECT_DRUNK_Z_OFFSET], DRUNK_Z_COLUMN_FREQUENCY,
-					fYOffset, fEffects[PlayerOptions::EFFECT_DRUNK_Z_PERIOD],
-					DRUNK_Z_OFFSET_FREQUENCY) ) * ARROW_SIZE*DRUNK_Z_ARROW_MAGNITUDE );
+		AddDrunkOffsets(fEffects[PlayerOptions::EFFECT_DRUNK_Z],
+			fEffects[PlayerOptions::EFFECT_DRUNK_Z_SPEED], iCol,
+			fEffects[PlayerOptions::EFFECT_DRUNK_Z_OFFSET], DRUNK_Z_COLUMN_FREQUENCY,
+			fEffects[PlayerOptions::EFFECT_DRUNK_Z_PERIOD], DRUNK_Z_OFFSET_FREQUENCY,
+			DRUNK_Z_ARROW_MAGNITUDE, false, pYOffsets, iCount, fZPos);
 
 	if( fEffects[PlayerOptions::EFFECT_TAN_DRUNK_Z] != 0 )
-		fZPos += fEffects[PlayerOptions::EFFECT_TAN_DRUNK_Z] *
-			( SelectTanType( CalculateDrunkAngle(fEffects[PlayerOptions::EFFECT_TAN_DRUNK_Z_SPEED],
-					iCol, fEffects[PlayerOptions::EFFECT_TAN_DRUNK_Z_OFFSET],
-					DRUNK_Z_COLUMN_FREQUENCY, fYOffset,
-					fEffects[PlayerOptions::EFFECT_TAN_DRUNK_Z_PERIOD],
-					DRUNK_Z_OFFSET_FREQUENCY)
-					, curr_options->m_bCosecant) * ARROW_SIZE*DRUNK_Z_ARROW_MAGNITUDE );
+		AddDrunkOffsets(fEffects[PlayerOptions::EFFECT_TAN_DRUNK_Z],
+			fEffects[PlayerOptions::EFFECT_TAN_DRUNK_Z_SPEED], iCol,
+			fEffects[PlayerOptions::EFFECT_TAN_DRUNK_Z_OFFSET], DRUNK_Z_COLUMN_FREQUENCY,
+			fEffects[PlayerOptions::EFFECT_TAN_DRUNK_Z_PERIOD], DRUNK_Z_OFFSET_FREQUENCY,
+			DRUNK_Z_ARROW_MAGNITUDE, true, pYOffsets, iCount, fZPos);
 
 	if( fEffects[PlayerOptions::EFFECT_BEAT_Z] != 0 )
-	{
-		const float fShift = data.m_fBeatFactor[dim_z]*RageFastSin( fYOffset / ((fEffects[PlayerOptions::EFFECT_BEAT_Z_PERIOD]*BEAT_Z_OFFSET_HEIGHT)+BEAT_Z_OFFSET_HEIGHT) + PI/BEAT_Z_PI_HEIGHT );
-		fZPos += fEffects[PlayerOptions::EFFECT_BEAT_Z] * fShift;
-	}
+		AddBeatOffsets(data.m_fBeatFactor[dim_z], fEffects[PlayerOptions::EFFECT_BEAT_Z],
+			fEffects[PlayerOptions::EFFECT_BEAT_Z_PERIOD], BEAT_Z_OFFSET_HEIGHT, BEAT_Z_PI_HEIGHT,
+			pYOffsets, iCount, fZPos);
 
 	if( fEffects[PlayerOptions::EFFECT_DIGITAL_Z] != 0 )
-		fZPos += (fEffects[PlayerOptions::EFFECT_DIGITAL_Z] * ARROW_SIZE * 0.5f) *
-			std::round((fEffects[PlayerOptions::EFFECT_DIGITAL_Z_STEPS]+1) * RageFastSin(
-				CalculateDigitalAngle(fYOffset,
-				fEffects[PlayerOptions::EFFECT_DIGITAL_Z_OFFSET],
-				fEffects[PlayerOptions::EFFECT_DIGITAL_Z_PERIOD]) ) ) /(fEffects[PlayerOptions::EFFECT_DIGITAL_Z_STEPS]+1);
+		AddDigitalOffsets(fEffects[PlayerOptions::EFFECT_DIGITAL_Z],
+			fEffects[PlayerOptions::EFFECT_DIGITAL_Z_STEPS],
+			fEffects[PlayerOptions::EFFECT_DIGITAL_Z_OFFSET],
+			fEffects[PlayerOptions::EFFECT_DIGITAL_Z_PERIOD], false,
+			pYOffsets, iCount, fZPos);
 
 	if( fEffects[PlayerOptions::EFFECT_TAN_DIGITAL_Z] != 0 )
-		fZPos += (fEffects[PlayerOptions::EFFECT_TAN_DIGITAL_Z] * ARROW_SIZE * 0.5f) *
-			std::round((fEffects[PlayerOptions::EFFECT_TAN_DIGITAL_Z_STEPS]+1) * SelectTanType(
-				CalculateDigitalAngle(fYOffset,
-				fEffects[PlayerOptions::EFFECT_TAN_DIGITAL_Z_OFFSET],
-				fEffects[PlayerOptions::EFFECT_TAN_DIGITAL_Z_PERIOD]), curr_options->m_bCosecant ) ) /(fEffects[PlayerOptions::EFFECT_TAN_DIGITAL_Z_STEPS]+1);
-
+		AddDigitalOffsets(fEffects[PlayerOptions::EFFECT_TAN_DIGITAL_Z],
+			fEffects[PlayerOptions::EFFECT_TAN_DIGITAL_Z_STEPS],
+			fEffects[PlayerOptions::EFFECT_TAN_DIGITAL_Z_OFFSET],
+			fEffects[PlayerOptions::EFFECT_TAN_DIGITAL_Z_PERIOD], true,
+			pYOffsets, iCount, fZPos);
 
 	if( fEffects[PlayerOptions::EFFECT_SQUARE_Z] != 0 )
-	{
-		float fResult = RageSquare( (PI * (fYOffset+(1.0f*(fEffects[PlayerOptions::EFFECT_SQUARE_Z_OFFSET]))) /
-			(ARROW_SIZE+(fEffects[PlayerOptions::EFFECT_SQUARE_Z_PERIOD]*ARROW_SIZE))) );
-		fZPos += (fEffects[PlayerOptions::EFFECT_SQUARE_Z] * ARROW_SIZE * 0.5f) * fResult;
-	}
+		AddSquareOffsets(fEffects[PlayerOptions::EFFECT_SQUARE_Z],
+			fEffects[PlayerOptions::EFFECT_SQUARE_Z_OFFSET],
+			fEffects[PlayerOptions::EFFECT_SQUARE_Z_PERIOD],
+			pYOffsets, iCount, fZPos);
 
 	if( fEffects[PlayerOptions::EFFECT_BOUNCE_Z] != 0 )
-	{
-		float fBounceAmt = std::abs( RageFastSin( ( (fYOffset + (1.0f * (fEffects[PlayerOptions::EFFECT_BOUNCE_Z_OFFSET]) ) ) /
-			( 60 + (fEffects[PlayerOptions::EFFECT_BOUNCE_Z_PERIOD]*60) ) ) ) );
-
-		fZPos += fEffects[PlayerOptions::EFFECT_BOUNCE_Z] * ARROW_SIZE * 0.5f * fBounceAmt;
-	}
-
-	return fZPos;
+		AddBounceOffsets(fEffects[PlayerOptions::EFFECT_BOUNCE_Z],
+			fEffects[PlayerOptions::EFFECT_BOUNCE_Z_OFFSET],
+			fEffects[PlayerOptions::EFFECT_BOUNCE_Z_PERIOD],
+			pYOffsets, iCount, fZPos);
 }
 
 bool ArrowEffects::NeedZBuffer()
@@ -1336,6 +1825,13 @@ bool ArrowEffects::NeedZBuffer()
 }
 
 float ArrowEffects::GetZoom( const PlayerState* pPlayerState, float fYOffset, int iCol )
+{
+	float fZoom;
+	GetZooms( pPlayerState, &fYOffset, 1, iCol, &fZoom );
+	return fZoom;
+}
+
+void ArrowEffects::GetZooms( const PlayerState* pPlayerState, const float *pYOffsets, int iCount, int iCol, float *pZoomsOut )
 {
 	float fZoom = 1.0f;
 	// Design change:  Instead of having a flag in the style that toggles a
@@ -1344,37 +1840,67 @@ float ArrowEffects::GetZoom( const PlayerState* pPlayerState, float fYOffset, in
 	// PlayerState. -Kyz
 	fZoom*= pPlayerState->m_NotefieldZoom;
 
-	fZoom = GetZoomVariable( fYOffset, iCol, fZoom);
+	GetZoomVariables( pYOffsets, iCount, iCol, fZoom, pZoomsOut );
 
 	float fTinyPercent = curr_options->m_fEffects[PlayerOptions::EFFECT_TINY];
 	if( fTinyPercent != 0 )
 	{
 		fTinyPercent = std::pow( 0.5f, fTinyPercent );
-		fZoom *= fTinyPercent;
+		for( int i = 0; i < iCount; ++i )
+			pZoomsOut[i] *= fTinyPercent;
 	}
 	if( curr_options->m_fTiny[iCol] != 0 )
 	{
 		fTinyPercent = std::pow( 0.5f, curr_options->m_fTiny[iCol] );
-		fZoom *= fTinyPercent;
+		for( int i = 0; i < iCount; ++i )
+			pZoomsOut[i] *= fTinyPercent;
 	}
-	return fZoom;
 }
 
 float ArrowEffects::GetZoomVariable( float fYOffset, int iCol, float fCurZoom )
 {
-	float fZoom = fCurZoom;
+	float fZoom;
+	GetZoomVariables( &fYOffset, 1, iCol, fCurZoom, &fZoom );
+	return fZoom;
+}
+
+void ArrowEffects::GetZoomVariables( const float *pYOffsets, int iCount, int iCol, float fCurZoom, float *pZoomsOut )
+{
+	float *fZoom = pZoomsOut;
+	for( int i = 0; i < iCount; ++i )
+		fZoom[i] = fCurZoom;
 	if( curr_options->m_fEffects[PlayerOptions::EFFECT_PULSE_INNER] != 0 || curr_options->m_fEffects[PlayerOptions::EFFECT_PULSE_OUTER] != 0 )
 	{
-		float sine = RageFastSin(((fYOffset+(100.0f*(curr_options->m_fEffects[PlayerOptions::EFFECT_PULSE_OFFSET])))/(0.4f*(ARROW_SIZE+(curr_options->m_fEffects[PlayerOptions::EFFECT_PULSE_PERIOD]*ARROW_SIZE)))));
+		const float fPulseOffset = 100.0f*(curr_options->m_fEffects[PlayerOptions::EFFECT_PULSE_OFFSET]);
+		const float fPulsePeriod = 0.4f*(ARROW_SIZE+(curr_options->m_fEffects[PlayerOptions::EFFECT_PULSE_PERIOD]*ARROW_SIZE));
+		const float fPulseOuter = curr_options->m_fEffects[PlayerOptions::EFFECT_PULSE_OUTER]*0.5f;
+		const float fPulseInner = GetPulseInner();
+		for( int i = 0; i < iCount; ++i )
+		{
+			float sine = RageFastSin(((pYOffsets[i]+fPulseOffset)/fPulsePeriod));
 
-		fZoom *= (sine*(curr_options->m_fEffects[PlayerOptions::EFFECT_PULSE_OUTER]*0.5f))+GetPulseInner();
+			fZoom[i] *= (sine*fPulseOuter)+fPulseInner;
+		}
+	}
+	if( curr_options->m_fEffects[PlayerOptions::EFFECT_SHRINK_TO_MULT] !=0 )
+	{
+		const float fShrinkMult = curr_options->m_fEffects[PlayerOptions::EFFECT_SHRINK_TO_MULT]/100.0f;
+		for( int i = 0; i < iCount; ++i )
+		{
+			if( pYOffsets[i] >= 0 )
+				fZoom[i] *= 1/(1+(pYOffsets[i]*fShrinkMult));
+		}
 	}
-	if( curr_options->m_fEffects[PlayerOptions::EFFECT_SHRINK_TO_MULT] !=0 && fYOffset >= 0 )
-		fZoom *= 1/(1+(fYOffset*(curr_options->m_fEffects[PlayerOptions::EFFECT_SHRINK_TO_MULT]/100.0f)));
 
-	if( curr_options->m_fEffects[PlayerOptions::EFFECT_SHRINK_TO_LINEAR] !=0 && fYOffset >= 0 )
-		fZoom += fYOffset*(0.5f*curr_options->m_fEffects[PlayerOptions::EFFECT_SHRINK_TO_LINEAR]/ARROW_SIZE);
-	return fZoom;
+	if( curr_options->m_fEffects[PlayerOptions::EFFECT_SHRINK_TO_LINEAR] !=0 )
+	{
+		const float fShrinkLinear = 0.5f*curr_options->m_fEffects[PlayerOptions::EFFECT_SHRINK_TO_LINEAR]/ARROW_SIZE;
+		for( int i = 0; i < iCount; ++i )
+		{
+			if( pYOffsets[i] >= 0 )
+				fZoom[i] += pYOffsets[i]*fShrinkLinear;
+		}
+	}
 }
 
 float ArrowEffects::GetPulseInner()
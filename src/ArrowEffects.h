@@ -29,6 +29,17 @@ public:
 		bool bThrowAway;
 		return GetYOffset( pPlayerState, iCol, fNoteBeat, fThrowAway, bThrowAway, bAbsolute );
 	}
+	/**
+	 * @brief Work out the Y offsets of a batch of notes in one column.
+	 *
+	 * This gives the same results as calling GetYOffset for each of them, but
+	 * the scroll speed and accels are applied in one loop over the batch.
+	 * Notes in increasing beat order are cheapest.  Both share what's the same
+	 * for every note in a frame, until Update or SetCurrentOptions is called
+	 * or the song position changes.  The other batched functions below take
+	 * the offsets this gives.
+	 * @param pIsPastPeakOut if not nullptr, gets bIsPastPeakYOffset for each note. */
+	static void GetYOffsets( const PlayerState* pPlayerState, int iCol, const float *pNoteBeats, int iCount, float *pYOffsetsOut, bool *pIsPastPeakOut=nullptr, bool bAbsolute=false );
 
 	static void GetXYZPos(const PlayerState* player_state, int col, float y_offset, float y_reverse_offset, RageVector3& ret, bool with_reverse= true)
 	{
@@ -48,20 +59,33 @@ public:
 	 * @param WithReverse a flag to see if the Reverse mod is on.
 	 * @return the actual display position. */
 	static float GetYPos(const PlayerState* pPlayerState, int iCol, float fYOffset, float fYReverseOffsetPixels, bool WithReverse = true );
+	/**
+	 * @brief GetYPos for a batch of notes in one column.
+	 *
+	 * Like the other batched functions, this gives the same results as
+	 * calling the single-note function for each of them.  The options are
+	 * read once, and each effect is applied in its own loop over the batch
+	 * with its constants worked out before it.  The output array must not
+	 * overlap the input. */
+	static void GetYPositions( const PlayerState* pPlayerState, int iCol, const float *pYOffsets, int iCount, float fYReverseOffsetPixels, float *pYPosOut, bool WithReverse = true );
 
 	// Inverse of ArrowGetYPos (YPos -> fYOffset).
 	static float GetYOffsetFromYPos(int iCol, float YPos, float fYReverseOffsetPixels);
+	static void GetYOffsetsFromYPos( int iCol, const float *pYPos, int iCount, float fYReverseOffsetPixels, float *pYOffsetsOut );
 
 	// fRotation is Z rotation of an arrow.  This will depend on the column of 
 	// the arrow and possibly the Arrow effect and the fYOffset (in the case of 
 	// EFFECT_DIZZY).
 	static float GetRotationZ(	const PlayerState* pPlayerState, float fNoteBeat, bool bIsHoldHead, int iCol );
+	static void GetRotationsZ( const PlayerState* pPlayerState, const float *pNoteBeats, int iCount, bool bIsHoldHead, int iCol, float *pRotationsOut );
 	static float ReceptorGetRotationZ(	const PlayerState* pPlayerState, int iCol );
 
 	// Due to the handling logic for holds on Twirl, we need to use an offset instead.
 	// It's more intuitive for Roll to be based off offset, so use an offset there too.
 	static float GetRotationX(const PlayerState* pPlayerState, float fYOffset, bool bIsHoldCap, int iCol);
 	static float GetRotationY(const PlayerState* pPlayerState, float fYOffset, int iCol);
+	static void GetRotationsX( const PlayerState* pPlayerState, const float *pYOffsets, int iCount, bool bIsHoldCap, int iCol, float *pRotationsOut );
+	static void GetRotationsY( const PlayerState* pPlayerState, const float *pYOffsets, int iCount, int iCol, float *pRotationsOut );
 	
 	static float ReceptorGetRotationX(	const PlayerState* pPlayerState, int iCol);
 	static float ReceptorGetRotationY(	const PlayerState* pPlayerState, int iCol);
@@ -74,6 +98,7 @@ public:
 	// This depends on the column of the arrow and possibly the Arrow effect and
 	// fYPos (in the case of EFFECT_DRUNK).
 	static float GetXPos( const PlayerState* pPlayerState, int iCol, float fYOffset );
+	static void GetXPositions( const PlayerState* pPlayerState, int iCol, const float *pYOffsets, int iCount, float *pXPosOut );
 
 	/**
 	 * @brief Retrieve the Z position.
@@ -84,6 +109,7 @@ public:
 	 * @param fYPos the Y position of the arrow.
 	 * @return the Z position. */
 	static float GetZPos( const PlayerState* pPlayerState, int iCol, float fYPos);
+	static void GetZPositions( const PlayerState* pPlayerState, int iCol, const float *pYOffsets, int iCount, float *pZPosOut );
 
 	// Enable this if any ZPos effects are enabled.
 	static bool NeedZBuffer();
@@ -96,6 +122,10 @@ public:
 	// AppearanceType.
 	static float GetGlow(const PlayerState* pPlayerState, int iCol, float fYPos, float fPercentFadeToFail, float fYReverseOffsetPixels, float fDrawDistanceBeforeTargetsPixels, float fFadeInPercentOfDrawFar );
 
+	// GetAlpha and GetGlow for a batch of notes.  Either output may be
+	// nullptr if it isn't wanted.
+	static void GetAlphasAndGlows( const PlayerState* pPlayerState, int iCol, const float *pYOffsets, int iCount, float fPercentFadeToFail, float fYReverseOffsetPixels, float fDrawDistanceBeforeTargetsPixels, float fFadeInPercentOfDrawFar, float *pAlphasOut, float *pGlowsOut );
+
 	/**
 	 * @brief Retrieve the current brightness.
 	 *
@@ -108,6 +138,8 @@ public:
 	// This is the zoom of the individual tracks, not of the whole Player.
 	static float GetZoom( const PlayerState* pPlayerState, float fYOffset, int iCol );
 	static float GetZoomVariable( float fYOffset, int iCol, float fCurZoom );
+	static void GetZooms( const PlayerState* pPlayerState, const float *pYOffsets, int iCount, int iCol, float *pZoomsOut );
+	static void GetZoomVariables( const float *pYOffsets, int iCount, int iCol, float fCurZoom, float *pZoomsOut );
 	static float GetPulseInner();
 
 	static float GetFrameWidthScale( const PlayerState* pPlayerState, float fYOffset, float fOverlappedTime );
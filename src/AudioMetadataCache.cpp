@@ -0,0 +1,333 @@
+#include "global.h"
+
+#include "AudioMetadataCache.h"
+#include "IniFile.h"
+#include "RageFile.h"
+#include "RageFileManager.h"
+#include "RageLog.h"
+#include "RageThreads.h"
+#include "RageUtil.h"
+#include "SongDirManifest.h"
+#include "SpecialFiles.h"
+
+#include <atomic>
+#include <cstdint>
+
+#define AUDIO_CACHE_FILE (SpecialFiles::CACHE_DIR + "audio.cache")
+#define FRAME_INDEX_DIR (SpecialFiles::CACHE_DIR + "FrameIndex/")
+
+/* "SMFI"; everything in a frame index file is little-endian. */
+static const std::uint32_t FRAME_INDEX_MAGIC = 0x49464D53;
+/* Bump this whenever the layout changes. */
+static const std::uint32_t FRAME_INDEX_VERSION = 2;
+
+/* This is used from song loading threads and from sound readers. */
+static RageMutex g_AudioCacheMutex( "AudioMetadataCache" );
+static IniFile g_AudioCache;
+static bool g_bAudioCacheRead = false;
+static bool g_bAudioCacheChanged = false;
+
+static void ReadIfNeeded()
+{
+	if( g_bAudioCacheRead )
+		return;
+	g_bAudioCacheRead = true;
+	g_AudioCache.ReadFile( AUDIO_CACHE_FILE );	// don't care if this fails
+}
+
+/* Get the entry of a file that hasn't changed since it was stored, throwing
+ * out the entry if it has.  g_AudioCacheMutex must be held. */
+static const XNode *GetEntry( const RString &sPath, std::int64_t iStamp )
+{
+	ReadIfNeeded();
+	RString sCachedStamp;
+	if( !g_AudioCache.GetValue(sPath, "Stamp", sCachedStamp) )
+		return nullptr;
+	if( StringToLLong(sCachedStamp) != iStamp )
+	{
+		g_AudioCache.DeleteKey( sPath );
+		g_bAudioCacheChanged = true;
+		return nullptr;
+	}
+	return g_AudioCache.GetChild( sPath );
+}
+
+/* Get ready to store into the entry of a file, starting it over if the file
+ * has changed.  g_AudioCacheMutex must be held. */
+static void StartEntry( const RString &sPath, std::int64_t iStamp )
+{
+	ReadIfNeeded();
+	RString sCachedStamp;
+	if( !g_AudioCache.GetValue(sPath, "Stamp", sCachedStamp) || StringToLLong(sCachedStamp) != iStamp )
+	{
+		g_AudioCache.DeleteKey( sPath );
+		g_AudioCache.SetValue( sPath, "Stamp", ssprintf("%lld", (long long) iStamp) );
+	}
+	g_bAudioCacheChanged = true;
+}
+
+bool AudioMetadataCache::GetInfo( const RString &sPath, Info &out )
+{
+	if( sPath.empty() )
+		return false;
+	const std::int64_t iStamp = SongDirManifest::GetStamp( sPath );
+	if( iStamp == -1 )
+		return false;
+
+	LockMut( g_AudioCacheMutex );
+	const XNode *pEntry = GetEntry( sPath, iStamp );
+	if( pEntry == nullptr )
+		return false;
+	Info info;
+	if( !pEntry->GetAttrValue("LengthMilliseconds", info.m_iLengthMilliseconds) ||
+		!pEntry->GetAttrValue("SampleRate", info.m_iSampleRate) ||
+		!pEntry->GetAttrValue("Channels", info.m_iChannels) )
+		return false;
+	out = info;
+	return true;
+}
+
+void AudioMetadataCache::SetInfo( const RString &sPath, const Info &info )
+{
+	if( sPath.empty() )
+		return;
+	const std::int64_t iStamp = SongDirManifest::GetStamp( sPath );
+	if( iStamp == -1 )
+		return;
+
+	LockMut( g_AudioCacheMutex );
+	StartEntry( sPath, iStamp );
+	g_AudioCache.SetValue( sPath, "LengthMilliseconds", info.m_iLengthMilliseconds );
+	g_AudioCache.SetValue( sPath, "SampleRate", info.m_iSampleRate );
+	g_AudioCache.SetValue( sPath, "Channels", info.m_iChannels );
+}
+
+/* Frame index files are named after a hash of the path, and hold the path
+ * itself in case two paths have the same hash:
+ *
+ * magic, version, stamp (64 bits, low half first), path length, path, entry
+ * count, (frame, byte)... */
+static RString GetFrameIndexPath( const RString &sPath )
+{
+	return FRAME_INDEX_DIR + ssprintf( "%08x.idx", GetHashForString(sPath) );
+}
+
+static bool ReadU32( RageFile &f, std::uint32_t &iOut )
+{
+	if( f.Read(&iOut, sizeof(iOut)) != sizeof(iOut) )
+		return false;
+	iOut = Swap32LE( iOut );
+	return true;
+}
+
+static void AppendU32( RString &sOut, std::uint32_t i )
+{
+	i = Swap32LE( i );
+	sOut.append( reinterpret_cast<const char *>(&i), sizeof(i) );
+}
+
+static bool ReadStamp( RageFile &f, std::int64_t &iOut )
+{
+	std::uint32_t iLow, iHigh;
+	if( !ReadU32(f, iLow) || !ReadU32(f, iHigh) )
+		return false;
+	iOut = std::int64_t( (std::uint64_t(iHigh) << 32) | iLow );
+	return true;
+}
+
+static void AppendStamp( RString &sOut, std::int64_t iStamp )
+{
+	AppendU32( sOut, std::uint32_t(std::uint64_t(iStamp)) );
+	AppendU32( sOut, std::uint32_t(std::uint64_t(iStamp) >> 32) );
+}
+
+/* Read the header of a frame index file, up to the entry count.  Returns
+ * false if it isn't one this version wrote. */
+static bool ReadFrameIndexHeader( RageFile &f, RString &sPathOut, std::int64_t &iStampOut )
+{
+	std::uint32_t iMagic, iVersion, iPathSize;
+	if( !ReadU32(f, iMagic) || iMagic != FRAME_INDEX_MAGIC ||
+		!ReadU32(f, iVersion) || iVersion != FRAME_INDEX_VERSION ||
+		!ReadStamp(f, iStampOut) ||
+		!ReadU32(f, iPathSize) || iPathSize > std::uint32_t(f.GetFileSize()) )
+		return false;
+	if( f.Read(sPathOut, iPathSize) != int(iPathSize) )
+		return false;
+	return true;
+}
+
+bool AudioMetadataCache::GetSeekTable( const RString &sPath, SeekTable &out )
+{
+	if( sPath.empty() )
+		return false;
+	const std::int64_t iStamp = SongDirManifest::GetStamp( sPath );
+	if( iStamp == -1 )
+		return false;
+
+	RageFile f;
+	if( !f.Open(GetFrameIndexPath(sPath), RageFile::READ) )
+		return false;
+
+	RString sCachedPath;
+	std::int64_t iCachedStamp;
+	if( !ReadFrameIndexHeader(f, sCachedPath, iCachedStamp) || sCachedPath != sPath )
+		return false;
+	if( iCachedStamp != iStamp )
+	{
+		// The file has changed since; a new index will take this one's place.
+		f.Close();
+		FILEMAN->Remove( GetFrameIndexPath(sPath) );
+		return false;
+	}
+
+	std::uint32_t iCount;
+	if( !ReadU32(f, iCount) || iCount == 0 || iCount > std::uint32_t(f.GetFileSize()) / 8 )
+		return false;
+	out.clear();
+	out.reserve( iCount );
+	for( std::uint32_t i = 0; i < iCount; ++i )
+	{
+		std::uint32_t iFrame, iByte;
+		if( !ReadU32(f, iFrame) || !ReadU32(f, iByte) )
+			return false;
+		if( !out.empty() && int(iFrame) <= out.back().first )
+			return false;
+		out.emplace_back( int(iFrame), int(iByte) );
+	}
+	return true;
+}
+
+void AudioMetadataCache::SetSeekTable( const RString &sPath, const SeekTable &table )
+{
+	if( sPath.empty() || table.empty() )
+		return;
+	const std::int64_t iStamp = SongDirManifest::GetStamp( sPath );
+	if( iStamp == -1 )
+		return;
+
+	RString sData;
+	sData.reserve( 6*sizeof(std::uint32_t) + sPath.size() + table.size()*2*sizeof(std::uint32_t) );
+	AppendU32( sData, FRAME_INDEX_MAGIC );
+	AppendU32( sData, FRAME_INDEX_VERSION );
+	AppendStamp( sData, iStamp );
+	AppendU32( sData, sPath.size() );
+	sData += sPath;
+	AppendU32( sData, table.size() );
+	for( std::pair<int,int> const &entry : table )
+	{
+		AppendU32( sData, std::uint32_t(entry.first) );
+		AppendU32( sData, std::uint32_t(entry.second) );
+	}
+
+	/* Two readers of the same MP3 can write its index at once, so each writes
+	 * a file of its own and moves it into place.  Nobody ever reads half of
+	 * one. */
+	static std::atomic<unsigned> s_iNextTempFile( 0 );
+	const RString sIndexPath = GetFrameIndexPath( sPath );
+	const RString sTempPath = sIndexPath + ssprintf( ".%u.tmp", s_iNextTempFile++ );
+	bool bWritten;
+	{
+		RageFile f;
+		bWritten = f.Open( sTempPath, RageFile::WRITE ) && f.Write( sData ) != -1 && f.Flush() != -1;
+		if( !bWritten )
+			LOG->Warn( "Couldn't write the frame index %s: %s", sTempPath.c_str(), f.GetError().c_str() );
+	}
+	if( bWritten && FILEMAN->Move(sTempPath, sIndexPath) )
+		return;
+	if( bWritten )
+		LOG->Warn( "Couldn't move the frame index %s into place", sTempPath.c_str() );
+	FILEMAN->Remove( sTempPath );
+}
+
+void AudioMetadataCache::PruneFrameIndexes()
+{
+	std::vector<RString> asFiles;
+	GetDirListing( FRAME_INDEX_DIR + "*.idx", asFiles, false, true );
+	int iRemoved = 0;
+	for( RString const &sFile : asFiles )
+	{
+		RString sPath;
+		std::int64_t iStamp = -1;
+		bool bValid;
+		{
+			RageFile f;
+			bValid = f.Open( sFile, RageFile::READ ) && ReadFrameIndexHeader( f, sPath, iStamp );
+		}
+		if( bValid && GetFrameIndexPath(sPath) == sFile && SongDirManifest::GetStamp(sPath) == iStamp )
+			continue;
+		if( FILEMAN->Remove(sFile) )
+			++iRemoved;
+	}
+
+	/* Indexes that were still being written when the game quit. */
+	asFiles.clear();
+	GetDirListing( FRAME_INDEX_DIR + "*.tmp", asFiles, false, true );
+	for( RString const &sFile : asFiles )
+	{
+		if( FILEMAN->Remove(sFile) )
+			++iRemoved;
+	}
+
+	if( iRemoved )
+		LOG->Trace( "Removed %i stale frame indexes", iRemoved );
+}
+
+void AudioMetadataCache::WriteToDisk()
+{
+	LockMut( g_AudioCacheMutex );
+	if( !g_bAudioCacheChanged )
+		return;
+
+	/* Drop the entries of files that are gone or have changed, so the cache
+	 * doesn't keep every song that was ever loaded. */
+	std::vector<RString> asStale;
+	FOREACH_CONST_Child( &g_AudioCache, pKey )
+	{
+		RString sCachedStamp;
+		if( !pKey->GetAttrValue("Stamp", sCachedStamp) ||
+			StringToLLong(sCachedStamp) != SongDirManifest::GetStamp(pKey->GetName()) )
+			asStale.push_back( pKey->GetName() );
+	}
+	for( RString const &sPath : asStale )
+		g_AudioCache.DeleteKey( sPath );
+
+	/* Write the whole cache before it replaces the old one, so a crash
+	 * doesn't leave half of it behind. */
+	const RString sTempPath = AUDIO_CACHE_FILE + ".tmp";
+	if( !g_AudioCache.WriteFile(sTempPath) )
+	{
+		LOG->Warn( "Couldn't write the audio cache: %s", g_AudioCache.GetError().c_str() );
+		FILEMAN->Remove( sTempPath );
+	}
+	else if( !FILEMAN->Move(sTempPath, AUDIO_CACHE_FILE) )
+	{
+		LOG->Warn( "Couldn't move the audio cache into place" );
+		FILEMAN->Remove( sTempPath );
+	}
+	g_bAudioCacheChanged = false;
+}
+
+/*
+ * (c) 2026 Stepmania team
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, and/or sell copies of the Software, and to permit persons to
+ * whom the Software is furnished to do so, provided that the above
+ * copyright notice(s) and this permission notice appear in all copies of
+ * the Software and that both the above copyright notice(s) and this
+ * permission notice appear in supporting documentation.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT OF
+ * THIRD PARTY RIGHTS. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR HOLDERS
+ * INCLUDED IN THIS NOTICE BE LIABLE FOR ANY CLAIM, OR ANY SPECIAL INDIRECT
+ * OR CONSEQUENTIAL DAMAGES, OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS
+ * OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
@@ -0,0 +1,81 @@
+#ifndef AUDIO_METADATA_CACHE_H
+#define AUDIO_METADATA_CACHE_H
+
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Remembers what was learned about music files between runs.
+ *
+ * Finding the length of a VBR MP3 without a Xing tag means reading the header
+ * of every frame in the file, and seeking in one accurately means decoding up
+ * to the seek point.  Lengths and formats are kept in Cache/audio.cache.  MP3
+ * frame indexes are larger, so each is kept in a file of its own in
+ * Cache/FrameIndex/, only read when the MP3 is seeked in.  Everything is
+ * stored with the file's stamp (its modification time and size), and is
+ * only used while the stamp still matches. */
+namespace AudioMetadataCache
+{
+	struct Info
+	{
+		int m_iLengthMilliseconds = -1;
+		int m_iSampleRate = 0;
+		int m_iChannels = 0;
+	};
+	/**
+	 * @brief Look up the length and format of a sound file.
+	 * @return false if it isn't known, or the file has changed since. */
+	bool GetInfo( const RString &sPath, Info &out );
+	/** @brief Store the length and format of a sound file. */
+	void SetInfo( const RString &sPath, const Info &info );
+
+	/** @brief Pairs of the first sample frame of an MP3 frame and the byte
+	 * it starts at, sorted by frame. */
+	typedef std::vector<std::pair<int,int>> SeekTable;
+	/**
+	 * @brief Look up the frame index of an MP3.
+	 * @return false if there isn't one, or the file has changed since. */
+	bool GetSeekTable( const RString &sPath, SeekTable &out );
+	/** @brief Write the frame index of an MP3 to its file. */
+	void SetSeekTable( const RString &sPath, const SeekTable &table );
+	/**
+	 * @brief Delete the frame index files of MP3s that have changed or are
+	 * gone, and any that this version can't read.
+	 *
+	 * This looks at the stamp of every MP3 with an index, so it's only done
+	 * at shutdown. */
+	void PruneFrameIndexes();
+
+	/**
+	 * @brief Write the cache to disk, if anything has been added to it.
+	 *
+	 * The entries of files that are gone or have changed are dropped first. */
+	void WriteToDisk();
+}
+
+#endif
+
+/*
+ * (c) 2026 Stepmania team
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, and/or sell copies of the Software, and to permit persons to
+ * whom the Software is furnished to do so, provided that the above
+ * copyright notice(s) and this permission notice appear in all copies of
+ * the Software and that both the above copyright notice(s) and this
+ * permission notice appear in supporting documentation.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT OF
+ * THIRD PARTY RIGHTS. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR HOLDERS
+ * INCLUDED IN THIS NOTICE BE LIABLE FOR ANY CLAIM, OR ANY SPECIAL INDIRECT
+ * OR CONSEQUENTIAL DAMAGES, OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS
+ * OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
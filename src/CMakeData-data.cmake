@@ -50,11 +50,16 @@ source_group("Data Structures\\\\Courses and Trails"
              ${SM_DATA_COURSE_HPP})
 
 list(APPEND SM_DATA_NOTEDATA_SRC
+            "ChartStats.cpp"
+            "CompiledNoteData.cpp"
             "NoteData.cpp"
             "NoteDataUtil.cpp"
             "NoteDataWithScoring.cpp")
 
 list(APPEND SM_DATA_NOTEDATA_HPP
+            "ChartStats.h"
+            "CompiledNoteData.h"
+            "FlatMap.h"
             "NoteData.h"
             "NoteDataUtil.h"
             "NoteDataWithScoring.h")
@@ -107,12 +112,14 @@ source_group("Data Structures\\\\Notes Writers"
              ${SM_DATA_NOTEWRITE_HPP})
 
 list(APPEND SM_DATA_SCORE_SRC
+            "JudgmentLatency.cpp"
             "ScoreKeeper.cpp"
             "ScoreKeeperNormal.cpp"
             "ScoreKeeperRave.cpp"
             "ScoreKeeperShared.cpp")
 
 list(APPEND SM_DATA_SCORE_HPP
+            "JudgmentLatency.h"
             "ScoreKeeper.h"
             "ScoreKeeperNormal.h"
             "ScoreKeeperRave.h"
@@ -124,15 +131,25 @@ source_group("Data Structures\\\\Score Keepers"
              ${SM_DATA_SCORE_HPP})
 
 list(APPEND SM_DATA_SONG_SRC
+            "AudioMetadataCache.cpp"
+            "ChartHashCache.cpp"
+            "LoadProfiler.cpp"
             "Song.cpp"
+            "SongCacheBinary.cpp"
             "SongCacheIndex.cpp"
+            "SongDirManifest.cpp"
             "SongOptions.cpp"
             "SongPosition.cpp"
             "SongUtil.cpp")
 
 list(APPEND SM_DATA_SONG_HPP
+            "AudioMetadataCache.h"
+            "ChartHashCache.h"
+            "LoadProfiler.h"
             "Song.h"
+            "SongCacheBinary.h"
             "SongCacheIndex.h"
+            "SongDirManifest.h"
             "SongOptions.h"
             "SongPosition.h"
             "SongUtil.h")
@@ -1,5 +1,6 @@
 list(APPEND SMDATA_GLOBAL_FILES_SRC
             "GameLoop.cpp"
+            "GameplayBenchmark.cpp"
             "global.cpp"
             "SpecialFiles.cpp"
             "StepMania.cpp" # TODO: Refactor into separate main project.
@@ -8,6 +9,7 @@ list(APPEND SMDATA_GLOBAL_FILES_SRC
 list(APPEND SMDATA_GLOBAL_FILES_HPP
             "${SM_GENERATED_SRC_DIR}/config.hpp"
             "GameLoop.h"
+            "GameplayBenchmark.h"
             "global.h"
             "ProductInfo.h" # TODO: Have this be auto-generated.
             "SpecialFiles.h"
@@ -156,6 +156,7 @@ source_group("Rage\\\\File"
 
 list(APPEND SMDATA_RAGE_SOUND_SRC
             "RageSound.cpp"
+            "RageSoundKernels.cpp"
             "RageSoundManager.cpp"
             "RageSoundMixBuffer.cpp"
             "RageSoundPosMap.cpp"
@@ -179,6 +180,7 @@ list(APPEND SMDATA_RAGE_SOUND_SRC
 
 list(APPEND SMDATA_RAGE_SOUND_HPP
             "RageSound.h"
+            "RageSoundKernels.h"
             "RageSoundManager.h"
             "RageSoundMixBuffer.h"
             "RageSoundPosMap.h"
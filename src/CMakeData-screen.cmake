@@ -1,5 +1,6 @@
 list(APPEND SMDATA_SCREEN_GAMEPLAY_SRC
             "ScreenGameplay.cpp"
+            "ScreenGameplayBenchmark.cpp"
             "ScreenGameplayLesson.cpp"
             "ScreenGameplayNormal.cpp"
             "ScreenGameplayShared.cpp"
@@ -7,6 +8,7 @@ list(APPEND SMDATA_SCREEN_GAMEPLAY_SRC
 
 list(APPEND SMDATA_SCREEN_GAMEPLAY_HPP
             "ScreenGameplay.h"
+            "ScreenGameplayBenchmark.h"
             "ScreenGameplayNormal.h"
             "ScreenGameplayShared.h"
             "ScreenGameplaySyncMachine.h")
@@ -0,0 +1,150 @@
+#include "global.h"
+
+#include "ChartHashCache.h"
+#include "IniFile.h"
+#include "RageLog.h"
+#include "RageThreads.h"
+#include "RageUtil.h"
+#include "SongDirManifest.h"
+#include "SpecialFiles.h"
+#include "Steps.h"
+
+#define HASH_CACHE_FILE (SpecialFiles::CACHE_DIR + "hashes.cache")
+
+/* Hashes are requested from song loading threads and from Lua. */
+static RageMutex g_HashCacheMutex( "ChartHashCache" );
+static IniFile g_HashCache;
+static bool g_bHashCacheRead = false;
+static bool g_bHashCacheChanged = false;
+
+static void ReadIfNeeded()
+{
+	if( g_bHashCacheRead )
+		return;
+	g_bHashCacheRead = true;
+	g_HashCache.ReadFile( HASH_CACHE_FILE );	// don't care if this fails
+}
+
+bool ChartHashCache::Get( const RString &sFile, const RString &sName, RString &sOut )
+{
+	if( sFile.empty() )
+		return false;
+	const std::int64_t iStamp = SongDirManifest::GetStamp( sFile );
+	if( iStamp == -1 )
+		return false;
+
+	LockMut( g_HashCacheMutex );
+	ReadIfNeeded();
+	RString sCachedStamp;
+	if( !g_HashCache.GetValue(sFile, "Stamp", sCachedStamp) )
+		return false;
+	if( StringToLLong(sCachedStamp) != iStamp )
+	{
+		// The file has changed, so none of its hashes are any good.
+		g_HashCache.DeleteKey( sFile );
+		g_bHashCacheChanged = true;
+		return false;
+	}
+	return g_HashCache.GetValue( sFile, sName, sOut );
+}
+
+/* The cache is an ini file, so a name can't hold anything that would end it
+ * or make its line a section or a comment, and a hash can't span lines or
+ * end with the backslash that continues one. */
+static bool IsStorable( const RString &sName, const RString &sHash )
+{
+	if( sName.empty() )
+		return false;
+	for( char c : sName )
+	{
+		if( !isalnum(static_cast<unsigned char>(c)) && c != '.' && c != '_' && c != '-' )
+			return false;
+	}
+	return sHash.find_first_of( "\r\n" ) == RString::npos && sHash.Right(1) != "\\";
+}
+
+void ChartHashCache::Set( const RString &sFile, const RString &sName, const RString &sHash )
+{
+	if( sFile.empty() )
+		return;
+	if( !IsStorable(sName, sHash) )
+	{
+		LOG->Warn( "Not caching the hash \"%s\" of %s: the name or hash has characters the cache can't hold.",
+			sName.c_str(), sFile.c_str() );
+		return;
+	}
+	const std::int64_t iStamp = SongDirManifest::GetStamp( sFile );
+	if( iStamp == -1 )
+		return;
+
+	LockMut( g_HashCacheMutex );
+	ReadIfNeeded();
+	RString sCachedStamp;
+	if( !g_HashCache.GetValue(sFile, "Stamp", sCachedStamp) || StringToLLong(sCachedStamp) != iStamp )
+	{
+		g_HashCache.DeleteKey( sFile );
+		g_HashCache.SetValue( sFile, "Stamp", ssprintf("%lld", (long long) iStamp) );
+	}
+	g_HashCache.SetValue( sFile, sName, sHash );
+	g_bHashCacheChanged = true;
+}
+
+RString ChartHashCache::GetStepsHashName( const Steps &steps, const RString &sName )
+{
+	/* The metadata alone isn't enough: two edits of a chart can share all
+	 * of it, and a hash stored for one mustn't be returned for the other. */
+	const RString sChart = ssprintf( "%s\n%s\n%d\n%s\n%s\n%s\n%08x", steps.m_StepsTypeStr.c_str(),
+		DifficultyToString(steps.GetDifficulty()).c_str(), steps.GetMeter(),
+		steps.GetDescription().c_str(), steps.GetChartName().c_str(), steps.GetCredit().c_str(),
+		steps.GetHash() );
+	return ssprintf( "Steps%08x.%s", GetHashForString(sChart), sName.c_str() );
+}
+
+void ChartHashCache::WriteToDisk()
+{
+	LockMut( g_HashCacheMutex );
+	if( !g_bHashCacheChanged )
+		return;
+
+	/* Drop the hashes of files that are gone or have changed, so the cache
+	 * doesn't keep every chart that was ever loaded. */
+	std::vector<RString> asStale;
+	FOREACH_CONST_Child( &g_HashCache, pKey )
+	{
+		RString sCachedStamp;
+		if( !pKey->GetAttrValue("Stamp", sCachedStamp) ||
+			StringToLLong(sCachedStamp) != SongDirManifest::GetStamp(pKey->GetName()) )
+			asStale.push_back( pKey->GetName() );
+	}
+	for( RString const &sFile : asStale )
+		g_HashCache.DeleteKey( sFile );
+
+	if( !g_HashCache.WriteFile(HASH_CACHE_FILE) )
+		LOG->Warn( "Couldn't write the hash cache: %s", g_HashCache.GetError().c_str() );
+	g_bHashCacheChanged = false;
+}
+
+/*
+ * (c) 2026 Stepmania team
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, and/or sell copies of the Software, and to permit persons to
+ * whom the Software is furnished to do so, provided that the above
+ * copyright notice(s) and this permission notice appear in all copies of
+ * the Software and that both the above copyright notice(s) and this
+ * permission notice appear in supporting documentation.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT OF
+ * THIRD PARTY RIGHTS. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR HOLDERS
+ * INCLUDED IN THIS NOTICE BE LIABLE FOR ANY CLAIM, OR ANY SPECIAL INDIRECT
+ * OR CONSEQUENTIAL DAMAGES, OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS
+ * OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
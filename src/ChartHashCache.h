@@ -0,0 +1,74 @@
+#ifndef CHART_HASH_CACHE_H
+#define CHART_HASH_CACHE_H
+
+class Steps;
+
+/**
+ * @brief Remembers hashes computed from simfiles between runs.
+ *
+ * Song::GetFileHash and Steps::GetChartKey are expensive: the first reads
+ * and hashes a whole simfile, the second decompresses a chart's note data.
+ * Themes compute their own chart hashes (for GrooveStats, for example) from
+ * the same data.  Their results are kept in Cache/hashes.cache, grouped by
+ * the file they were computed from along with that file's stamp (its
+ * modification time and size).  A hash is only returned while the
+ * file's stamp still matches. */
+namespace ChartHashCache
+{
+	/**
+	 * @brief Look up a hash computed from a file.
+	 * @param sFile the file the hash was computed from.
+	 * @param sName the name the hash was stored under.
+	 * @param sOut the hash.
+	 * @return false if there's no hash, or the file has changed since. */
+	bool Get( const RString &sFile, const RString &sName, RString &sOut );
+	/**
+	 * @brief Store a hash computed from a file.
+	 *
+	 * Names may only hold letters, digits, '.', '_' and '-', and hashes may
+	 * not hold line breaks; anything else isn't stored. */
+	void Set( const RString &sFile, const RString &sName, const RString &sHash );
+
+	/**
+	 * @brief Get the name a hash of one chart is stored under.
+	 *
+	 * Several charts come from one simfile, so the name is made from the
+	 * chart's type, difficulty, meter, description and credit, along with
+	 * the hash of its note data (Steps::GetHash).
+	 * @param steps the chart.
+	 * @param sName what the hash is, such as "ChartKey". */
+	RString GetStepsHashName( const Steps &steps, const RString &sName );
+
+	/**
+	 * @brief Write the cache to disk, if anything has been added to it.
+	 *
+	 * The hashes of files that are gone or have changed are dropped first. */
+	void WriteToDisk();
+}
+
+#endif
+
+/*
+ * (c) 2026 Stepmania team
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, and/or sell copies of the Software, and to permit persons to
+ * whom the Software is furnished to do so, provided that the above
+ * copyright notice(s) and this permission notice appear in all copies of
+ * the Software and that both the above copyright notice(s) and this
+ * permission notice appear in supporting documentation.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT OF
+ * THIRD PARTY RIGHTS. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR HOLDERS
+ * INCLUDED IN THIS NOTICE BE LIABLE FOR ANY CLAIM, OR ANY SPECIAL INDIRECT
+ * OR CONSEQUENTIAL DAMAGES, OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS
+ * OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
@@ -0,0 +1,94 @@
+#include "global.h"
+
+#include "ChartStats.h"
+#include "LuaManager.h"
+
+ChartStats::ChartStats(): m_iQuads(0), m_fPeakNPS(0)
+{
+	m_Radar.Zero();
+}
+
+void ChartStats::Zero()
+{
+	m_Radar.Zero();
+	m_iQuads = 0;
+	m_vNotesPerMeasure.clear();
+	m_fPeakNPS = 0;
+	m_vStreams.clear();
+}
+
+void GetStreamBreakdown( const std::vector<int> &vNotesPerMeasure, int iMinNotes, std::vector<StreamRun> &out )
+{
+	out.clear();
+	for( unsigned i = 0; i < vNotesPerMeasure.size(); ++i )
+	{
+		const bool bStream = vNotesPerMeasure[i] >= iMinNotes;
+		if( out.empty() || out.back().m_bStream != bStream )
+			out.push_back( StreamRun{ int(i), 0, bStream } );
+		++out.back().m_iMeasures;
+	}
+}
+
+void PushStreamBreakdown( lua_State *L, const std::vector<StreamRun> &vRuns )
+{
+	lua_createtable( L, vRuns.size(), 0 );
+	for( unsigned i = 0; i < vRuns.size(); ++i )
+	{
+		lua_createtable( L, 0, 3 );
+		LuaHelpers::Push( L, vRuns[i].m_iFirstMeasure );
+		lua_setfield( L, -2, "FirstMeasure" );
+		LuaHelpers::Push( L, vRuns[i].m_iMeasures );
+		lua_setfield( L, -2, "Measures" );
+		LuaHelpers::Push( L, vRuns[i].m_bStream );
+		lua_setfield( L, -2, "Stream" );
+		lua_rawseti( L, -2, i+1 );
+	}
+}
+
+void ChartStats::PushSelf( lua_State *L ) const
+{
+	lua_newtable( L );
+	static const RadarCategory COUNTS[] = {
+		RadarCategory_Notes, RadarCategory_TapsAndHolds, RadarCategory_Jumps,
+		RadarCategory_Holds, RadarCategory_Mines, RadarCategory_Hands,
+		RadarCategory_Rolls, RadarCategory_Lifts, RadarCategory_Fakes,
+	};
+	for( RadarCategory rc : COUNTS )
+	{
+		LuaHelpers::Push( L, int(m_Radar[rc]) );
+		lua_setfield( L, -2, RadarCategoryToString(rc).c_str() );
+	}
+	LuaHelpers::Push( L, m_iQuads );
+	lua_setfield( L, -2, "Quads" );
+	LuaHelpers::CreateTableFromArray( m_vNotesPerMeasure, L );
+	lua_setfield( L, -2, "NotesPerMeasure" );
+	LuaHelpers::Push( L, m_fPeakNPS );
+	lua_setfield( L, -2, "PeakNPS" );
+	PushStreamBreakdown( L, m_vStreams );
+	lua_setfield( L, -2, "Streams" );
+}
+
+/*
+ * (c) 2026 Stepmania team
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, and/or sell copies of the Software, and to permit persons to
+ * whom the Software is furnished to do so, provided that the above
+ * copyright notice(s) and this permission notice appear in all copies of
+ * the Software and that both the above copyright notice(s) and this
+ * permission notice appear in supporting documentation.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT OF
+ * THIRD PARTY RIGHTS. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR HOLDERS
+ * INCLUDED IN THIS NOTICE BE LIABLE FOR ANY CLAIM, OR ANY SPECIAL INDIRECT
+ * OR CONSEQUENTIAL DAMAGES, OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS
+ * OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
@@ -0,0 +1,77 @@
+#ifndef CHART_STATS_H
+#define CHART_STATS_H
+
+#include "RadarValues.h"
+
+#include <vector>
+
+struct lua_State;
+
+/** @brief A run of measures that are all stream or all break. */
+struct StreamRun
+{
+	int m_iFirstMeasure;
+	int m_iMeasures;
+	bool m_bStream;
+};
+
+/** @brief A measure with this many note rows is stream: unbroken 16ths. */
+const int DEFAULT_STREAM_NOTES_PER_MEASURE = 16;
+
+/**
+ * @brief Statistics about a chart, all worked out in one pass over its notes
+ * by NoteDataUtil::CalculateChartStats.
+ *
+ * Measures are four beats long, the way simfiles write them.  Time
+ * signatures are ignored, like ITG themes do when they count measures. */
+struct ChartStats
+{
+	RadarValues m_Radar;
+	/** @brief Rows with four or more notes, counting holds still held, like hands. */
+	int m_iQuads;
+	/** @brief The number of rows with notes in each measure.  A jump counts once. */
+	std::vector<int> m_vNotesPerMeasure;
+	/** @brief The most note rows per second in any measure, at normal speed. */
+	float m_fPeakNPS;
+	/** @brief The runs of stream and break, with DEFAULT_STREAM_NOTES_PER_MEASURE. */
+	std::vector<StreamRun> m_vStreams;
+
+	ChartStats();
+	void Zero();
+
+	// Lua
+	void PushSelf( lua_State *L ) const;
+};
+
+/**
+ * @brief Split the measures into runs of stream and break.
+ * @param iMinNotes how many note rows a measure needs to be stream. */
+void GetStreamBreakdown( const std::vector<int> &vNotesPerMeasure, int iMinNotes, std::vector<StreamRun> &out );
+void PushStreamBreakdown( lua_State *L, const std::vector<StreamRun> &vRuns );
+
+#endif
+
+/*
+ * (c) 2026 Stepmania team
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, and/or sell copies of the Software, and to permit persons to
+ * whom the Software is furnished to do so, provided that the above
+ * copyright notice(s) and this permission notice appear in all copies of
+ * the Software and that both the above copyright notice(s) and this
+ * permission notice appear in supporting documentation.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT OF
+ * THIRD PARTY RIGHTS. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR HOLDERS
+ * INCLUDED IN THIS NOTICE BE LIABLE FOR ANY CLAIM, OR ANY SPECIAL INDIRECT
+ * OR CONSEQUENTIAL DAMAGES, OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS
+ * OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
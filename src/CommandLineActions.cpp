@@ -15,6 +15,7 @@
 #include "arch/LoadingWindow/LoadingWindow.h"
 #include "Preference.h"
 #include "JsonUtil.h"
+#include "GameplayBenchmark.h"
 #include "ScreenInstallOverlay.h"
 #include "ver.h"
 
@@ -72,6 +73,9 @@ void CommandLineActions::Handle(LoadingWindow* pLW)
 		args.argv.push_back(g_argv[i]);
 	ToProcess.push_back(args);
 
+	// Before the sound and display start, so the benchmark can pick the null ones.
+	GameplayBenchmark::Init();
+
 	bool bExitAfter = false;
 	if( GetCommandlineArgument("ExportLuaInformation") )
 	{
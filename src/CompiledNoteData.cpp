@@ -0,0 +1,264 @@
+#include "global.h"
+
+#include "CompiledNoteData.h"
+#include "GameState.h"
+#include "NoteData.h"
+#include "PrefsManager.h"
+#include "TimingData.h"
+
+#include <algorithm>
+#include <utility>
+
+void CompiledNoteData::Clear()
+{
+	m_vRow.clear();
+	m_vSeconds.clear();
+	m_vTrack.clear();
+	m_vFlags.clear();
+	m_vpTapNote.clear();
+	m_vColumns.clear();
+}
+
+float CompiledNoteData::GetOffset( const TimingData &td )
+{
+	// GetElapsedTimeFromBeat, less GetElapsedTimeFromBeatNoOffset.
+	return -td.m_fBeat0OffsetInSeconds
+		- GAMESTATE->m_SongOptions.GetCurrent().m_fMusicRate * PREFSMAN->m_fGlobalOffsetSeconds;
+}
+
+void CompiledNoteData::CompileRows( NoteData &nd, const TimingData &td, int iStartRow, int iEndRow )
+{
+	// Work out the time and judgability once for each row, not each note.
+	int iLastRow = -1;
+	float fSeconds = 0;
+	bool bJudgable = false;
+
+	for( NoteData::all_tracks_iterator iter = nd.GetTapNoteRangeAllTracks(iStartRow, iEndRow); !iter.IsAtEnd(); ++iter )
+	{
+		const int iRow = iter.Row();
+		const int iTrack = iter.Track();
+		TapNote &tn = *iter;
+		if( iRow != iLastRow )
+		{
+			iLastRow = iRow;
+			fSeconds = td.GetElapsedTimeFromBeatNoOffset( NoteRowToBeat(iRow) ) + td.m_fBeat0OffsetInSeconds;
+			bJudgable = td.IsJudgableAtRow( iRow );
+		}
+
+		std::uint8_t iFlags = 0;
+		if( bJudgable )
+			iFlags |= NOTE_JUDGABLE;
+		if( tn.type != TapNoteType_Empty && tn.type != TapNoteType_AutoKeysound )
+			iFlags |= NOTE_STEPPABLE;
+		if( tn.type == TapNoteType_Tap || tn.type == TapNoteType_HoldHead )
+			iFlags |= NOTE_TAP_OR_HOLD_HEAD;
+
+		m_vRow.push_back( iRow );
+		m_vSeconds.push_back( fSeconds );
+		m_vTrack.push_back( iTrack );
+		m_vFlags.push_back( iFlags );
+		m_vpTapNote.push_back( &tn );
+	}
+}
+
+void CompiledNoteData::BuildColumns( int iNumTracks )
+{
+	m_vColumns.resize( iNumTracks );
+	for( Column &col : m_vColumns )
+	{
+		col.m_vRow.clear();
+		col.m_vIndex.clear();
+	}
+	for( std::size_t i = 0; i < size(); ++i )
+	{
+		Column &col = m_vColumns[m_vTrack[i]];
+		col.m_vRow.push_back( m_vRow[i] );
+		col.m_vIndex.push_back( i );
+	}
+}
+
+bool CompiledNoteData::RelinkNotes( NoteData &nd )
+{
+	// Each column lists its notes in the order the track holds them.
+	for( int t = 0; t < nd.GetNumTracks(); ++t )
+	{
+		const Column &col = m_vColumns[t];
+		std::size_t i = 0;
+		for( NoteData::iterator it = nd.begin(t); it != nd.end(t) && it->first < MAX_NOTE_ROW; ++it, ++i )
+		{
+			if( i == col.m_vRow.size() || it->first != col.m_vRow[i] )
+				return false;
+			m_vpTapNote[col.m_vIndex[i]] = &it->second;
+		}
+		if( i != col.m_vRow.size() )
+			return false;
+	}
+	return true;
+}
+
+void CompiledNoteData::Compile( NoteData &nd, const TimingData &td )
+{
+	Clear();
+	CompileRows( nd, td, 0, MAX_NOTE_ROW );
+	BuildColumns( nd.GetNumTracks() );
+}
+
+std::vector<std::pair<int,int>> CompiledNoteData::GetCursorNotes( std::initializer_list<std::size_t*> cursors ) const
+{
+	std::vector<std::pair<int,int>> vResumeAt;
+	for( std::size_t *pCursor : cursors )
+	{
+		if( *pCursor < size() )
+			vResumeAt.emplace_back( m_vRow[*pCursor], m_vTrack[*pCursor] );
+		else if( !m_vRow.empty() )
+			vResumeAt.emplace_back( m_vRow.back()+1, 0 );
+		else
+			vResumeAt.emplace_back( 0, 0 );
+	}
+	return vResumeAt;
+}
+
+void CompiledNoteData::MoveCursors( const std::vector<std::pair<int,int>> &vResumeAt, std::initializer_list<std::size_t*> cursors ) const
+{
+	auto resume = vResumeAt.begin();
+	for( std::size_t *pCursor : cursors )
+	{
+		*pCursor = LowerBound( resume->first, resume->second );
+		++resume;
+	}
+}
+
+void CompiledNoteData::Recompile( NoteData &nd, const TimingData &td, std::initializer_list<std::size_t*> cursors )
+{
+	const std::vector<std::pair<int,int>> vResumeAt = GetCursorNotes( cursors );
+	Compile( nd, td );
+	MoveCursors( vResumeAt, cursors );
+}
+
+/* Replace [iBegin,iEnd) of v with what was appended past iOldSize. */
+template<typename T>
+static void SpliceAppended( std::vector<T> &v, std::size_t iBegin, std::size_t iEnd, std::size_t iOldSize )
+{
+	v.erase( v.begin()+iBegin, v.begin()+iEnd );
+	std::rotate( v.begin()+iBegin, v.begin()+(iOldSize-(iEnd-iBegin)), v.end() );
+}
+
+void CompiledNoteData::RecompileRange( NoteData &nd, const TimingData &td, int iStartRow, int iEndRow,
+	std::initializer_list<std::size_t*> cursors )
+{
+	const std::vector<std::pair<int,int>> vResumeAt = GetCursorNotes( cursors );
+
+	// Compile the range onto the end, then move it over the old notes.
+	// The notes outside the range keep their times and flags, so only the
+	// range has to look at the timing data.
+	const std::size_t iBegin = LowerBound( iStartRow );
+	const std::size_t iEnd = LowerBound( iEndRow );
+	const std::size_t iOldSize = size();
+	CompileRows( nd, td, iStartRow, iEndRow );
+	SpliceAppended( m_vRow, iBegin, iEnd, iOldSize );
+	SpliceAppended( m_vSeconds, iBegin, iEnd, iOldSize );
+	SpliceAppended( m_vTrack, iBegin, iEnd, iOldSize );
+	SpliceAppended( m_vFlags, iBegin, iEnd, iOldSize );
+	SpliceAppended( m_vpTapNote, iBegin, iEnd, iOldSize );
+	BuildColumns( nd.GetNumTracks() );
+	// Changing the range can have moved the other notes on its tracks.  If
+	// notes past the range were added or removed, compile them all.
+	if( !RelinkNotes(nd) )
+		Compile( nd, td );
+
+	MoveCursors( vResumeAt, cursors );
+}
+
+void CompiledNoteData::WidenRangeOverHolds( const NoteData &nd, int &iStartRow, int &iEndRow )
+{
+	for( int t=0; t<nd.GetNumTracks(); t++ )
+	{
+		int iHeadRow;
+		if( nd.IsHoldNoteAtRow(t, iStartRow, &iHeadRow) )
+			iStartRow = std::min( iStartRow, iHeadRow );
+		if( nd.IsHoldNoteAtRow(t, iEndRow, &iHeadRow) )
+			iEndRow = std::max( iEndRow, iHeadRow + nd.GetTapNote(t, iHeadRow).iDuration + 1 );
+	}
+}
+
+std::size_t CompiledNoteData::LowerBound( int iRow ) const
+{
+	return std::lower_bound( m_vRow.begin(), m_vRow.end(), iRow ) - m_vRow.begin();
+}
+
+std::size_t CompiledNoteData::LowerBound( int iRow, int iTrack ) const
+{
+	std::size_t i = LowerBound( iRow );
+	while( i < size() && m_vRow[i] == iRow && m_vTrack[i] < iTrack )
+		++i;
+	return i;
+}
+
+std::size_t CompiledNoteData::Find( int iTrack, int iRow ) const
+{
+	if( iTrack < 0 || iTrack >= int(m_vColumns.size()) )
+		return size();
+	const Column &col = m_vColumns[iTrack];
+	auto it = std::lower_bound( col.m_vRow.begin(), col.m_vRow.end(), iRow );
+	if( it == col.m_vRow.end() || *it != iRow )
+		return size();
+	return col.m_vIndex[it - col.m_vRow.begin()];
+}
+
+int CompiledNoteData::GetClosestNoteDirectional( int iTrack, int iStartRow, int iEndRow, bool bAllowGraded, bool bForward ) const
+{
+	if( iTrack < 0 || iTrack >= int(m_vColumns.size()) || iStartRow > iEndRow )
+		return -1;
+
+	const Column &col = m_vColumns[iTrack];
+	const std::size_t iBegin = std::lower_bound( col.m_vRow.begin(), col.m_vRow.end(), iStartRow ) - col.m_vRow.begin();
+	const std::size_t iEnd = std::lower_bound( col.m_vRow.begin(), col.m_vRow.end(), iEndRow ) - col.m_vRow.begin();
+
+	auto IsClosest = [&]( std::size_t i )
+	{
+		const unsigned iNote = col.m_vIndex[i];
+		const int iNeeded = NOTE_JUDGABLE | NOTE_STEPPABLE;
+		if( (m_vFlags[iNote] & iNeeded) != iNeeded )
+			return false;
+		return bAllowGraded || m_vpTapNote[iNote]->result.tns == TNS_None;
+	};
+
+	if( bForward )
+	{
+		for( std::size_t i = iBegin; i < iEnd; ++i )
+			if( IsClosest(i) )
+				return col.m_vRow[i];
+	}
+	else
+	{
+		for( std::size_t i = iEnd; i > iBegin; --i )
+			if( IsClosest(i-1) )
+				return col.m_vRow[i-1];
+	}
+	return -1;
+}
+
+/*
+ * (c) 2026 Stepmania team
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, and/or sell copies of the Software, and to permit persons to
+ * whom the Software is furnished to do so, provided that the above
+ * copyright notice(s) and this permission notice appear in all copies of
+ * the Software and that both the above copyright notice(s) and this
+ * permission notice appear in supporting documentation.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT OF
+ * THIRD PARTY RIGHTS. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR HOLDERS
+ * INCLUDED IN THIS NOTICE BE LIABLE FOR ANY CLAIM, OR ANY SPECIAL INDIRECT
+ * OR CONSEQUENTIAL DAMAGES, OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS
+ * OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
@@ -0,0 +1,149 @@
+#ifndef COMPILED_NOTE_DATA_H
+#define COMPILED_NOTE_DATA_H
+
+#include "NoteTypes.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <utility>
+#include <vector>
+
+class NoteData;
+class TimingData;
+
+/**
+ * @brief The notes of a NoteData laid out for judging them.
+ *
+ * Every note is put in one list, sorted by row and then track, with what
+ * judging asks about it most kept in separate arrays: its row, its time in
+ * the song, and flags worked out from the note and the timing data when it's
+ * compiled.  Judging can then walk the notes with a plain index instead of
+ * searching the NoteData and the timing segments over and over.  Times are
+ * kept without the song's and the global offset, which autosync and the sync
+ * keys change during a song; see GetOffset.  Each column
+ * also has its own sorted list of rows for finding the closest note to a
+ * step.
+ *
+ * It points at the notes in the NoteData, so it has to be compiled again
+ * whenever notes are added to or removed from it.  That can move notes that
+ * weren't changed, too: with WITH_FLAT_NOTE_DATA, each track's notes are
+ * kept in one array. */
+class CompiledNoteData
+{
+public:
+	enum
+	{
+		/** @brief The note isn't in a warp or fake segment. */
+		NOTE_JUDGABLE = 1 << 0,
+		/** @brief The note can be stepped on: it isn't empty or an autokeysound. */
+		NOTE_STEPPABLE = 1 << 1,
+		/** @brief The note is a tap or a hold head. */
+		NOTE_TAP_OR_HOLD_HEAD = 1 << 2,
+	};
+
+	/** @brief Compile the notes of nd, timed with td. */
+	void Compile( NoteData &nd, const TimingData &td );
+	/**
+	 * @brief Compile nd again after it has changed.
+	 *
+	 * Each cursor is an index into the notes.  It's moved to the first note
+	 * at or after the note it was on, or to the end if it was at the end. */
+	void Recompile( NoteData &nd, const TimingData &td, std::initializer_list<std::size_t*> cursors );
+	/**
+	 * @brief Compile the notes in [iStartRow,iEndRow) of nd again after they've changed.
+	 *
+	 * Notes outside the range are pointed at again, since they may have moved
+	 * in memory.  If any of them were added or removed, or moved to another
+	 * row or track, everything is compiled again, as with Compile; their
+	 * types must not have changed.  Cursors are moved as with Recompile. */
+	void RecompileRange( NoteData &nd, const TimingData &td, int iStartRow, int iEndRow,
+		std::initializer_list<std::size_t*> cursors );
+	void Clear();
+
+	/**
+	 * @brief Widen [iStartRow,iEndRow) to take in the holds that cross its
+	 * edges, which a transform of the range can change, or add notes under.
+	 *
+	 * Do this before and after transforming the range, and recompile what
+	 * it comes to. */
+	static void WidenRangeOverHolds( const NoteData &nd, int &iStartRow, int &iEndRow );
+
+	/**
+	 * @brief Return what to add to GetSeconds for the song's and the global
+	 * offset as they are now. */
+	static float GetOffset( const TimingData &td );
+
+	std::size_t size() const				{ return m_vRow.size(); }
+	int GetRow( std::size_t i ) const			{ return m_vRow[i]; }
+	int GetTrack( std::size_t i ) const			{ return m_vTrack[i]; }
+	/** @brief Return the time of a note in the song, given GetOffset(). */
+	float GetSeconds( std::size_t i, float fOffset ) const	{ return m_vSeconds[i] + fOffset; }
+	bool HasFlag( std::size_t i, int iFlag ) const		{ return (m_vFlags[i] & iFlag) != 0; }
+	TapNote &GetTapNote( std::size_t i ) const		{ return *m_vpTapNote[i]; }
+
+	/** @brief Return the index of the first note at or after iRow. */
+	std::size_t LowerBound( int iRow ) const;
+	/** @brief Return the index of the note at iRow in iTrack, or size() if there isn't one. */
+	std::size_t Find( int iTrack, int iRow ) const;
+
+	/**
+	 * @brief Find the first (or, going backward, the last) note in
+	 * [iStartRow,iEndRow) of a column that can be stepped on.
+	 * @param bAllowGraded whether notes that already have a score count.
+	 * @return its row, or -1 if there isn't one. */
+	int GetClosestNoteDirectional( int iTrack, int iStartRow, int iEndRow, bool bAllowGraded, bool bForward ) const;
+
+private:
+	std::size_t LowerBound( int iRow, int iTrack ) const;
+	/** @brief Append the notes of nd in [iStartRow,iEndRow) to the lists, leaving the columns alone. */
+	void CompileRows( NoteData &nd, const TimingData &td, int iStartRow, int iEndRow );
+	void BuildColumns( int iNumTracks );
+	/**
+	 * @brief Point at the notes of nd again, after they may have moved in memory.
+	 * @return false if nd doesn't have the same rows on each track. */
+	bool RelinkNotes( NoteData &nd );
+	std::vector<std::pair<int,int>> GetCursorNotes( std::initializer_list<std::size_t*> cursors ) const;
+	void MoveCursors( const std::vector<std::pair<int,int>> &vNotes, std::initializer_list<std::size_t*> cursors ) const;
+
+	std::vector<int> m_vRow;
+	std::vector<float> m_vSeconds;
+	std::vector<std::uint8_t> m_vTrack;
+	std::vector<std::uint8_t> m_vFlags;
+	std::vector<TapNote*> m_vpTapNote;
+
+	struct Column
+	{
+		std::vector<int> m_vRow;
+		/** @brief The index of each of the column's notes in the list of all notes. */
+		std::vector<unsigned> m_vIndex;
+	};
+	std::vector<Column> m_vColumns;
+};
+
+#endif
+
+/*
+ * (c) 2026 Stepmania team
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, and/or sell copies of the Software, and to permit persons to
+ * whom the Software is furnished to do so, provided that the above
+ * copyright notice(s) and this permission notice appear in all copies of
+ * the Software and that both the above copyright notice(s) and this
+ * permission notice appear in supporting documentation.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT OF
+ * THIRD PARTY RIGHTS. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR HOLDERS
+ * INCLUDED IN THIS NOTICE BE LIABLE FOR ANY CLAIM, OR ANY SPECIAL INDIRECT
+ * OR CONSEQUENTIAL DAMAGES, OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS
+ * OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
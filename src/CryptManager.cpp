@@ -411,6 +411,35 @@ RString CryptManager::GetSHA1ForString( RString sData )
 	return RString( (const char *) digest, sizeof(digest) );
 }
 
+struct SHA1Hash::State
+{
+	hash_state hash;
+	int iHash;
+};
+
+SHA1Hash::SHA1Hash(): m_pState( new State )
+{
+	m_pState->iHash = register_hash( &sha1_desc );
+	hash_descriptor[m_pState->iHash].init( &m_pState->hash );
+}
+
+SHA1Hash::~SHA1Hash()
+{
+	delete m_pState;
+}
+
+void SHA1Hash::Update( const void *pData, std::size_t iSize )
+{
+	hash_descriptor[m_pState->iHash].process( &m_pState->hash, (const unsigned char *) pData, iSize );
+}
+
+RString SHA1Hash::Finish()
+{
+	unsigned char digest[20];
+	hash_descriptor[m_pState->iHash].done( &m_pState->hash, digest );
+	return RString( (const char *) digest, sizeof(digest) );
+}
+
 RString CryptManager::GetSHA1ForFile( RString fn )
 {
 	RageFile file;
@@ -1,6 +1,8 @@
 #ifndef CryptManager_H
 #define CryptManager_H
 
+#include <cstddef>
+
 class RageFileBasic;
 struct lua_State;
 
@@ -37,6 +39,24 @@ public:
 	void PushSelf( lua_State *L );
 };
 
+/** @brief Computes a SHA-1 hash of data that's fed to it a piece at a time. */
+class SHA1Hash
+{
+public:
+	SHA1Hash();
+	~SHA1Hash();
+	void Update( const void *pData, std::size_t iSize );
+	/** @brief Finish hashing and return the digest, in binary. */
+	RString Finish();
+
+private:
+	SHA1Hash( const SHA1Hash & ) = delete;
+	SHA1Hash &operator=( const SHA1Hash & ) = delete;
+
+	struct State;
+	State *m_pState;
+};
+
 extern CryptManager*	CRYPTMAN;	// global and accessible from anywhere in our program
 
 #endif
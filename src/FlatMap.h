@@ -0,0 +1,174 @@
+#ifndef FLAT_MAP_H
+#define FLAT_MAP_H
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief A sorted map kept in one contiguous array.
+ *
+ * It has the parts of the std::map interface NoteData needs.  Lookups are a
+ * binary search and walking it in order never leaves the array, which is
+ * much kinder to the cache than following tree nodes.  Inserting or erasing
+ * in the middle moves everything after it, and unlike std::map, it
+ * invalidates every iterator and reference past that point.  Inserting past
+ * the last key, which is what loading does, is just an append. */
+template<typename Key, typename T>
+class FlatMap
+{
+public:
+	typedef Key key_type;
+	typedef T mapped_type;
+	typedef std::pair<Key, T> value_type;
+	typedef std::vector<value_type> container_type;
+	typedef typename container_type::size_type size_type;
+	typedef typename container_type::iterator iterator;
+	typedef typename container_type::const_iterator const_iterator;
+	typedef typename container_type::reverse_iterator reverse_iterator;
+	typedef typename container_type::const_reverse_iterator const_reverse_iterator;
+
+	iterator begin()				{ return m_Values.begin(); }
+	const_iterator begin() const			{ return m_Values.begin(); }
+	iterator end()					{ return m_Values.end(); }
+	const_iterator end() const			{ return m_Values.end(); }
+	reverse_iterator rbegin()			{ return m_Values.rbegin(); }
+	const_reverse_iterator rbegin() const		{ return m_Values.rbegin(); }
+	reverse_iterator rend()				{ return m_Values.rend(); }
+	const_reverse_iterator rend() const		{ return m_Values.rend(); }
+
+	bool empty() const				{ return m_Values.empty(); }
+	size_type size() const				{ return m_Values.size(); }
+	void clear()					{ m_Values.clear(); }
+	void reserve( size_type iSize )			{ m_Values.reserve( iSize ); }
+	void swap( FlatMap &other )			{ m_Values.swap( other.m_Values ); }
+
+	iterator lower_bound( const Key &key )
+	{
+		return std::lower_bound( m_Values.begin(), m_Values.end(), key, KeyLess() );
+	}
+	const_iterator lower_bound( const Key &key ) const
+	{
+		return std::lower_bound( m_Values.begin(), m_Values.end(), key, KeyLess() );
+	}
+	iterator upper_bound( const Key &key )
+	{
+		return std::upper_bound( m_Values.begin(), m_Values.end(), key, KeyLess() );
+	}
+	const_iterator upper_bound( const Key &key ) const
+	{
+		return std::upper_bound( m_Values.begin(), m_Values.end(), key, KeyLess() );
+	}
+	iterator find( const Key &key )
+	{
+		iterator it = lower_bound( key );
+		return it != end() && !(key < it->first)? it:end();
+	}
+	const_iterator find( const Key &key ) const
+	{
+		const_iterator it = lower_bound( key );
+		return it != end() && !(key < it->first)? it:end();
+	}
+
+	T &operator[]( const Key &key )
+	{
+		// Appending is the common case, so check for it before searching.
+		if( m_Values.empty() || m_Values.back().first < key )
+		{
+			m_Values.emplace_back( key, T() );
+			return m_Values.back().second;
+		}
+		iterator it = lower_bound( key );
+		if( it == end() || key < it->first )
+			it = m_Values.emplace( it, key, T() );
+		return it->second;
+	}
+
+	/** @brief Insert v if its key isn't there yet.  Like std::map, hint is
+	 * only a guess at where it goes; end() makes appending cheap. */
+	iterator insert( const_iterator hint, const value_type &v )
+	{
+		if( hint == end() && (m_Values.empty() || m_Values.back().first < v.first) )
+		{
+			m_Values.push_back( v );
+			return m_Values.end() - 1;
+		}
+		iterator it = lower_bound( v.first );
+		if( it == end() || v.first < it->first )
+			it = m_Values.insert( it, v );
+		return it;
+	}
+
+	/** @brief Insert the elements of [first,last) whose keys aren't there
+	 * yet, like std::map.  It's one merge however many there are, instead
+	 * of moving the tail of the array for each of them. */
+	template<typename InputIt>
+	void insert( InputIt first, InputIt last )
+	{
+		const size_type iOldSize = m_Values.size();
+		m_Values.insert( m_Values.end(), first, last );
+		if( m_Values.size() == iOldSize )
+			return;
+		iterator middle = m_Values.begin() + iOldSize;
+		std::stable_sort( middle, m_Values.end(), KeyLess() );
+		std::inplace_merge( m_Values.begin(), middle, m_Values.end(), KeyLess() );
+		// Equal keys stay in order, so this keeps what was there first.
+		m_Values.erase( std::unique( m_Values.begin(), m_Values.end(), KeyEqual() ), m_Values.end() );
+	}
+
+	/** @brief Erase an element, returning the one after it. */
+	iterator erase( const_iterator it )		{ return m_Values.erase( it ); }
+	iterator erase( const_iterator first, const_iterator last ) { return m_Values.erase( first, last ); }
+	size_type erase( const Key &key )
+	{
+		iterator it = find( key );
+		if( it == end() )
+			return 0;
+		m_Values.erase( it );
+		return 1;
+	}
+
+	bool operator==( const FlatMap &other ) const	{ return m_Values == other.m_Values; }
+	bool operator!=( const FlatMap &other ) const	{ return m_Values != other.m_Values; }
+
+private:
+	struct KeyLess
+	{
+		bool operator()( const value_type &v, const Key &key ) const	{ return v.first < key; }
+		bool operator()( const Key &key, const value_type &v ) const	{ return key < v.first; }
+		bool operator()( const value_type &a, const value_type &b ) const	{ return a.first < b.first; }
+	};
+	struct KeyEqual
+	{
+		bool operator()( const value_type &a, const value_type &b ) const	{ return !(a.first < b.first) && !(b.first < a.first); }
+	};
+
+	container_type m_Values;
+};
+
+#endif
+
+/*
+ * (c) 2026 Stepmania team
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, and/or sell copies of the Software, and to permit persons to
+ * whom the Software is furnished to do so, provided that the above
+ * copyright notice(s) and this permission notice appear in all copies of
+ * the Software and that both the above copyright notice(s) and this
+ * permission notice appear in supporting documentation.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT OF
+ * THIRD PARTY RIGHTS. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR HOLDERS
+ * INCLUDED IN THIS NOTICE BE LIABLE FOR ANY CLAIM, OR ANY SPECIAL INDIRECT
+ * OR CONSEQUENTIAL DAMAGES, OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS
+ * OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
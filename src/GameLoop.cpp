@@ -1,5 +1,6 @@
 #include "global.h"
 #include "GameLoop.h"
+#include "GameplayBenchmark.h"
 #include "RageLog.h"
 #include "RageTextureManager.h"
 #include "RageSoundManager.h"
@@ -283,6 +284,10 @@ void GameLoop::UpdateAllButDraw(bool bRunningFromVBLANK)
 	if (g_fConstantUpdateDeltaSeconds > 0)
 		fDeltaTime = g_fConstantUpdateDeltaSeconds;
 
+	// The benchmark goes through the same frames however long they take.
+	if( GameplayBenchmark::IsRunning() )
+		fDeltaTime = GameplayBenchmark::GetFrameSeconds();
+
 	CheckGameLoopTimerSkips(fDeltaTime);
 
 	fDeltaTime *= g_fUpdateRate;
@@ -296,6 +301,7 @@ void GameLoop::UpdateAllButDraw(bool bRunningFromVBLANK)
 	SOUND->Update(fDeltaTime);
 	TEXTUREMAN->Update(fDeltaTime);
 	GAMESTATE->Update(fDeltaTime);
+	SONGMAN->Update();
 	SCREENMAN->Update(fDeltaTime);
 	MEMCARDMAN->Update();
 
@@ -343,6 +349,8 @@ void GameLoop::RunGameLoop()
 		}
 
 		SCREENMAN->Draw();
+
+		GameplayBenchmark::EndFrame();
 	}
 
 	// If we ended mid-game, finish up.
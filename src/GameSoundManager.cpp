@@ -107,48 +107,69 @@ struct MusicToPlay
 	{
 		HasTiming = false;
 	}
+	bool IsSameRequest( const MusicToPlay &other ) const
+	{
+		return m_sFile.EqualsNoCase( other.m_sFile ) &&
+			m_sTimingFile.EqualsNoCase( other.m_sTimingFile ) &&
+			HasTiming == other.HasTiming &&
+			m_TimingData == other.m_TimingData &&
+			m_LightsData == other.m_LightsData &&
+			bForceLoop == other.bForceLoop &&
+			fStartSecond == other.fStartSecond &&
+			fLengthSeconds == other.fLengthSeconds &&
+			fFadeInLengthSeconds == other.fFadeInLengthSeconds &&
+			fFadeOutLengthSeconds == other.fFadeOutLengthSeconds &&
+			bAlignBeat == other.bAlignBeat &&
+			bApplyMusicRate == other.bApplyMusicRate;
+	}
 };
 std::vector<MusicToPlay> g_MusicsToPlay;
 static GameSoundManager::PlayMusicParams g_FallbackMusicParams;
 
-static void StartMusic( MusicToPlay &ToPlay )
+/* Music is loaded, seeked and buffered on a thread of its own, so the music
+ * thread never waits on a file.  Only the newest request matters: each request
+ * or stop makes whatever is still loading stale, and a stale load is thrown
+ * away at its next step.  Lock g_Mutex before touching these. */
+static RageThread MusicLoadThread;
+static int g_iMusicLoadGeneration = 0;
+static bool g_bMusicLoadRequested = false;
+static bool g_bLoadingMusic = false;
+/* The newest request.  It's still pending until it starts playing or goes stale. */
+static MusicToPlay g_MusicToLoad;
+static bool g_bMusicPending = false;
+
+struct LoadedMusic
 {
-	LockMutex L( *g_Mutex );
-	if( g_Playing->m_Music->IsPlaying() && g_Playing->m_Music->GetLoadedFilePath().EqualsNoCase(ToPlay.m_sFile) )
-		return;
-
-	/* We're changing or stopping the music.  If we were dimming, reset. */
-	g_FadeState = FADE_NONE;
-
-	if( ToPlay.m_sFile.empty() )
-	{
-		/* StopPlaying() can take a while, so don't hold the lock while we stop the sound.
-		 * Be sure to leave the rest of g_Playing in place. */
-		RageSound *pOldSound = g_Playing->m_Music;
-		g_Playing->m_Music = new RageSound;
-		L.Unlock();
-
-		delete pOldSound;
-		return;
-	}
+	MusicToPlay m_ToPlay;
+	RageSound *m_pSound;
+	LoadedMusic( const MusicToPlay &ToPlay, RageSound *pSound ): m_ToPlay(ToPlay), m_pSound(pSound) { }
+	~LoadedMusic() { delete m_pSound; }
+};
+/* Music that's ready to start, waiting for the music thread. */
+static LoadedMusic *g_pLoadedMusic = nullptr;
 
-	/* Unlock, load the sound here, and relock.  Loading may take a while if we're
-	 * reading from CD and we have to seek far, which can throw off the timing below. */
-	MusicPlaying *NewMusic;
-	{
-		g_Mutex->Unlock();
-		RageSound *pSound = new RageSound;
-		RageSoundLoadParams params;
-		params.m_bSupportRateChanging = ToPlay.bApplyMusicRate;
-		pSound->Load( ToPlay.m_sFile, false, &params );
-		g_Mutex->Lock();
+/* How much of the music to decode before handing it over. */
+static const float MUSIC_PREBUFFER_SECONDS = 1.0f;
 
-		NewMusic = new MusicPlaying( pSound );
-	}
+static bool IsMusicLoadStale( int iGeneration )
+{
+	LockMut( *g_Mutex );
+	return iGeneration != g_iMusicLoadGeneration;
+}
 
-	NewMusic->m_Timing = g_Playing->m_Timing;
-	NewMusic->m_Lights = g_Playing->m_Lights;
+/* Make anything that's loading, or loaded but not started, stale.  g_Mutex
+ * must be held.  Delete the returned music once it isn't; that can take a while. */
+static LoadedMusic *CancelMusicLoad()
+{
+	++g_iMusicLoadGeneration;
+	g_bMusicPending = false;
+	LoadedMusic *pLoaded = g_pLoadedMusic;
+	g_pLoadedMusic = nullptr;
+	return pLoaded;
+}
 
+static void LoadTimingFile( MusicToPlay &ToPlay )
+{
 	/* See if we can find timing data, if it's not already loaded. */
 	if( !ToPlay.HasTiming && IsAFile(ToPlay.m_sTimingFile) )
 	{
@@ -177,6 +198,138 @@ static void StartMusic( MusicToPlay &ToPlay )
 				pStepsCabinetLights->GetNoteData( ToPlay.m_LightsData );
 		}
 	}
+}
+
+/* Open, seek and buffer music on the loading thread.  Returns nullptr if the
+ * request went stale on the way. */
+static RageSound *LoadMusic( MusicToPlay &ToPlay, int iGeneration )
+{
+	RageSound *pSound = new RageSound;
+	RageSoundLoadParams params;
+	params.m_bSupportRateChanging = ToPlay.bApplyMusicRate;
+	pSound->Load( ToPlay.m_sFile, false, &params );
+
+	if( !IsMusicLoadStale(iGeneration) )
+		LoadTimingFile( ToPlay );
+
+	if( !IsMusicLoadStale(iGeneration) )
+	{
+		RageSoundParams p;
+		p.m_StartSecond = ToPlay.fStartSecond;
+		pSound->SetParams( p );
+		pSound->PrepareToPlay( MUSIC_PREBUFFER_SECONDS );
+	}
+
+	if( IsMusicLoadStale(iGeneration) )
+	{
+		delete pSound;
+		return nullptr;
+	}
+	return pSound;
+}
+
+int MusicLoadThread_start( void *p )
+{
+	g_Mutex->Lock();
+	while( !g_Shutdown )
+	{
+		if( !g_bMusicLoadRequested )
+		{
+			g_Mutex->Wait();
+			continue;
+		}
+
+		MusicToPlay ToPlay = g_MusicToLoad;
+		const int iGeneration = g_iMusicLoadGeneration;
+		g_bMusicLoadRequested = false;
+		g_bLoadingMusic = true;
+		g_Mutex->Unlock();
+
+		RageSound *pSound = LoadMusic( ToPlay, iGeneration );
+
+		g_Mutex->Lock();
+		if( pSound != nullptr && iGeneration == g_iMusicLoadGeneration )
+		{
+			/* Any music loaded before this was made stale by this request. */
+			ASSERT( g_pLoadedMusic == nullptr );
+			g_pLoadedMusic = new LoadedMusic( ToPlay, pSound );
+			pSound = nullptr;
+		}
+		g_bLoadingMusic = false;
+		g_Mutex->Broadcast();
+
+		if( pSound != nullptr )
+		{
+			g_Mutex->Unlock();
+			delete pSound;
+			g_Mutex->Lock();
+		}
+	}
+	g_Mutex->Unlock();
+
+	return 0;
+}
+
+/* Hand music to the loading thread, or stop it.  This never waits on a file. */
+static void RequestMusic( const MusicToPlay &ToPlay )
+{
+	RageSound *pOldSound = nullptr;
+	LoadedMusic *pStale = nullptr;
+	{
+		LockMutex L( *g_Mutex );
+		if( g_Playing->m_Music->IsPlaying() && g_Playing->m_Music->GetLoadedFilePath().EqualsNoCase(ToPlay.m_sFile) )
+		{
+			/* Keep playing it, and forget about anything asked for since. */
+			pStale = CancelMusicLoad();
+		}
+		else if( !ToPlay.m_sFile.empty() && g_bMusicPending && g_MusicToLoad.IsSameRequest(ToPlay) )
+		{
+			/* It's already on its way. */
+		}
+		else
+		{
+			/* We're changing or stopping the music.  If we were dimming, reset. */
+			g_FadeState = FADE_NONE;
+			pStale = CancelMusicLoad();
+
+			if( ToPlay.m_sFile.empty() )
+			{
+				/* StopPlaying() can take a while, so don't hold the lock while we stop the sound.
+				 * Be sure to leave the rest of g_Playing in place. */
+				pOldSound = g_Playing->m_Music;
+				g_Playing->m_Music = new RageSound;
+			}
+			else
+			{
+				/* The music keeps playing until the new music is ready. */
+				g_MusicToLoad = ToPlay;
+				g_bMusicPending = true;
+				g_bMusicLoadRequested = true;
+				g_Mutex->Broadcast();
+			}
+		}
+	}
+
+	delete pOldSound;
+	delete pStale;
+}
+
+/* Start the music the loading thread has finished with. */
+static void StartLoadedMusic()
+{
+	LockMutex L( *g_Mutex );
+	LoadedMusic *pLoaded = g_pLoadedMusic;
+	if( pLoaded == nullptr )
+		return;
+	g_pLoadedMusic = nullptr;
+	g_bMusicPending = false;
+
+	MusicToPlay &ToPlay = pLoaded->m_ToPlay;
+	MusicPlaying *NewMusic = new MusicPlaying( pLoaded->m_pSound );
+	pLoaded->m_pSound = nullptr;
+
+	NewMusic->m_Timing = g_Playing->m_Timing;
+	NewMusic->m_Lights = g_Playing->m_Lights;
 
 	if( ToPlay.HasTiming )
 	{
@@ -255,7 +408,7 @@ static void StartMusic( MusicToPlay &ToPlay )
 		when = GAMESTATE->m_Position.m_LastBeatUpdate + fDistance;
 	}
 
-	/* Important: don't hold the mutex while we load and seek the actual sound. */
+	/* Important: don't hold the mutex while we start the actual sound. */
 	L.Unlock();
 	{
 		NewMusic->m_bHasTiming = ToPlay.HasTiming;
@@ -280,6 +433,7 @@ static void StartMusic( MusicToPlay &ToPlay )
 	LockMut( *g_Mutex );
 	delete g_Playing;
 	g_Playing = NewMusic;
+	delete pLoaded;
 }
 
 static void DoPlayOnce( RString sPath )
@@ -341,7 +495,8 @@ static bool SoundWaiting()
 	return !g_SoundsToPlayOnce.empty() ||
 		!g_SoundsToPlayOnceFromDir.empty() ||
 		!g_SoundsToPlayOnceFromAnnouncer.empty() ||
-		!g_MusicsToPlay.empty();
+		!g_MusicsToPlay.empty() ||
+		g_pLoadedMusic != nullptr;
 }
 
 
@@ -384,7 +539,7 @@ static void StartQueuedSounds()
 		 * to be replaced immediately, though.  So, if we have more music in the queue,
 		 * then forcibly stop the current sound. */
 		if( i+1 == aMusicsToPlay.size() )
-			StartMusic( aMusicsToPlay[i] );
+			RequestMusic( aMusicsToPlay[i] );
 		else
 		{
 			CHECKPOINT_M( ssprintf("Removing old sound at index %d", i));
@@ -397,6 +552,8 @@ static void StartQueuedSounds()
 			delete pOldSound;
 		}
 	}
+
+	StartLoadedMusic();
 }
 
 void GameSoundManager::Flush()
@@ -431,8 +588,16 @@ int MusicThread_start( void *p )
 
 		if( bFlushing )
 		{
+			/* Wait for music that's been asked for to load, and start it, too. */
 			g_Mutex->Lock();
-			g_Mutex->Signal();
+			while( (g_bMusicLoadRequested || g_bLoadingMusic) && !g_Shutdown )
+				g_Mutex->Wait();
+			g_Mutex->Unlock();
+			StartLoadedMusic();
+
+			/* The loading thread waits on g_Mutex, too, so wake everyone. */
+			g_Mutex->Lock();
+			g_Mutex->Broadcast();
 			g_bFlushing = false;
 			g_Mutex->Unlock();
 		}
@@ -454,6 +619,8 @@ GameSoundManager::GameSoundManager()
 	g_Shutdown = false;
 	MusicThread.SetName( "Music thread" );
 	MusicThread.Create( MusicThread_start, this );
+	MusicLoadThread.SetName( "Music loading thread" );
+	MusicLoadThread.Create( MusicLoadThread_start, this );
 
 	// Register with Lua.
 	{
@@ -477,8 +644,11 @@ GameSoundManager::~GameSoundManager()
 	g_Mutex->Broadcast();
 	g_Mutex->Unlock();
 	MusicThread.Wait();
+	MusicLoadThread.Wait();
 	LOG->Trace("Music start thread shut down.");
 
+	SAFE_DELETE( g_pLoadedMusic );
+
 	SAFE_DELETE( g_Playing );
 	SAFE_DELETE( g_Mutex );
 }
@@ -113,8 +113,16 @@ static ThemeMetric<bool> ARE_STAGE_SONG_MODS_FORCED	("GameState","AreStageSongMo
 static Preference<Premium> g_Premium( "Premium", Premium_DoubleFor1Credit );
 Preference<bool> GameState::m_bAutoJoin( "AutoJoin", false );
 
+/** @brief The TimingData that is used for processing certain functions.
+ *
+ * Radar calculation sets this, and songs may be loaded on several threads at
+ * once, so each thread gets its own.  It always points at the TimingData of
+ * the Steps being processed, and whatever sets it clears it or puts back
+ * what was there, so it owns nothing and there's nothing to free when a
+ * thread ends. */
+static thread_local TimingData *g_pProcessedTiming = nullptr;
+
 GameState::GameState() :
-	processedTiming(nullptr),
 	m_pCurGame(				Message_CurrentGameChanged ),
 	m_pCurStyle(			Message_CurrentStyleChanged ),
 	m_PlayMode(				Message_PlayModeChanged ),
@@ -203,7 +211,6 @@ GameState::~GameState()
 
 	SAFE_DELETE( m_Environment );
 	SAFE_DELETE( g_pImpl );
-	SAFE_DELETE( processedTiming );
 }
 
 PlayerNumber GameState::GetMasterPlayerNumber() const
@@ -218,12 +225,12 @@ void GameState::SetMasterPlayerNumber(const PlayerNumber p)
 
 TimingData * GameState::GetProcessedTimingData() const
 {
-	return this->processedTiming;
+	return g_pProcessedTiming;
 }
 
 void GameState::SetProcessedTimingData(TimingData * t)
 {
-	this->processedTiming = t;
+	g_pProcessedTiming = t;
 }
 
 void GameState::ApplyGameCommand( const RString &sCommand, PlayerNumber pn )
@@ -0,0 +1,397 @@
+#include "global.h"
+
+#include "GameplayBenchmark.h"
+#include "EnumHelper.h"
+#include "GameManager.h"
+#include "GameState.h"
+#include "JsonUtil.h"
+#include "Preference.h"
+#include "RageLog.h"
+#include "RageThreads.h"
+#include "RageUtil.h"
+#include "ScreenManager.h"
+#include "Song.h"
+#include "SongManager.h"
+#include "Steps.h"
+#include "arch/ArchHooks/ArchHooks.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+static const char *BenchmarkStageNames[] = {
+	"Player",
+	"NoteField",
+	"ArrowEffects",
+	"Lua",
+};
+XToString( BenchmarkStage );
+
+#define BENCHMARK_FILE "/Logs/Benchmark.json"
+#define BENCHMARK_SCREEN "ScreenGameplayBenchmark"
+static const float FRAME_SECONDS = 1.0f / 60;
+
+/* What the benchmark needs the preferences to be while it runs.  They're
+ * put back before the preferences are saved. */
+static const char *const PREFERENCE_OVERRIDES[][2] = {
+	{ "SoundDrivers", "Null" },
+	{ "MovieDrivers", "Null" },
+	// Loading groups in the background would take time from the frames.
+	{ "SongLoadForegroundGroups", "0" },
+};
+
+namespace
+{
+	struct Frame
+	{
+		float m_fSeconds;
+		float m_fStageSeconds[NUM_BenchmarkStage];
+	};
+
+	struct ChartFrames
+	{
+		GameplayBenchmark::Chart m_Chart;
+		std::vector<Frame> m_vFrames;
+	};
+
+	enum ChartState
+	{
+		ChartState_Idle,
+		ChartState_Loading,
+		ChartState_Playing
+	};
+
+	/* The frames' times for a stage or for the whole frame, in
+	 * milliseconds. */
+	struct Summary
+	{
+		float m_fMean = 0, m_fMedian = 0, m_fP99 = 0, m_fMax = 0;
+
+		Summary( std::vector<float> vSeconds )
+		{
+			if( vSeconds.empty() )
+				return;
+			std::sort( vSeconds.begin(), vSeconds.end() );
+			float fTotal = 0;
+			for( float f : vSeconds )
+				fTotal += f;
+			m_fMean = fTotal / vSeconds.size() * 1000;
+			m_fMedian = vSeconds[(vSeconds.size() - 1) / 2] * 1000;
+			// The smallest frame with at least 99% of them at or below it.
+			const std::size_t iP99Rank = std::max<std::size_t>( 1, (vSeconds.size() * 99 + 99) / 100 );
+			m_fP99 = vSeconds[iP99Rank - 1] * 1000;
+			m_fMax = vSeconds.back() * 1000;
+		}
+		void Serialize( Json::Value &root ) const
+		{
+			root["MeanMilliseconds"] = m_fMean;
+			root["MedianMilliseconds"] = m_fMedian;
+			root["P99Milliseconds"] = m_fP99;
+			root["MaxMilliseconds"] = m_fMax;
+		}
+	};
+
+	/* Every frame's time for the whole frame, then for each stage. */
+	struct FrameSeconds
+	{
+		std::vector<float> m_vFrame;
+		std::vector<float> m_vStage[NUM_BenchmarkStage];
+
+		void Add( const std::vector<Frame> &vFrames )
+		{
+			for( Frame const &frame : vFrames )
+			{
+				m_vFrame.push_back( frame.m_fSeconds );
+				FOREACH_ENUM( BenchmarkStage, bs )
+					m_vStage[bs].push_back( frame.m_fStageSeconds[bs] );
+			}
+		}
+		void Log( const RString &sName ) const
+		{
+			const Summary frame( m_vFrame );
+			LOG->Info( "%s: %i frames, mean %.3fms, median %.3fms, p99 %.3fms, max %.3fms",
+				sName.c_str(), int(m_vFrame.size()), frame.m_fMean, frame.m_fMedian, frame.m_fP99, frame.m_fMax );
+			FOREACH_ENUM( BenchmarkStage, bs )
+			{
+				const Summary stage( m_vStage[bs] );
+				LOG->Info( "  %-12s mean %.3fms, median %.3fms, p99 %.3fms, max %.3fms",
+					BenchmarkStageToString(bs).c_str(), stage.m_fMean, stage.m_fMedian, stage.m_fP99, stage.m_fMax );
+			}
+		}
+		void Serialize( Json::Value &root ) const
+		{
+			root["Frames"] = int(m_vFrame.size());
+			Summary( m_vFrame ).Serialize( root["Frame"] );
+			FOREACH_ENUM( BenchmarkStage, bs )
+				Summary( m_vStage[bs] ).Serialize( root["Stages"][BenchmarkStageToString(bs)] );
+		}
+	};
+}
+
+static bool g_bRunning = false;
+static RString g_sChartList;
+static std::vector<std::pair<IPreference*, RString>> g_vOverriddenPreferences;
+
+/* The stage timers only run on the thread the game loop is on, so none of
+ * this needs a lock. */
+static std::uint64_t g_iGameThreadID = 0;
+static GameplayBenchmark::StageTimer *g_pCurrentStage = nullptr;
+static float g_fStageSeconds[NUM_BenchmarkStage];
+static RageTimer g_FrameTimer( RageZeroTimer );
+
+static std::vector<ChartFrames> g_vCharts;
+static std::size_t g_iCurrentChart = 0;
+static ChartState g_ChartState = ChartState_Idle;
+
+void GameplayBenchmark::Init()
+{
+	g_bRunning = GetCommandlineArgument( "benchmark", &g_sChartList );
+	if( !g_bRunning )
+		return;
+
+	for( auto const &pref : PREFERENCE_OVERRIDES )
+	{
+		IPreference *pPref = IPreference::GetPreferenceByName( pref[0] );
+		if( pPref == nullptr )
+			continue;
+		g_vOverriddenPreferences.emplace_back( pPref, pPref->ToString() );
+		pPref->FromString( pref[1] );
+	}
+	g_iGameThreadID = RageThread::GetCurrentThreadID();
+	LOG->Info( "Running the gameplay benchmark with the charts in \"%s\"", g_sChartList.c_str() );
+}
+
+bool GameplayBenchmark::IsRunning()
+{
+	return g_bRunning;
+}
+
+float GameplayBenchmark::GetFrameSeconds()
+{
+	return FRAME_SECONDS;
+}
+
+/* Add the charts on one line of the list. */
+static void AddCharts( const RString &sLine )
+{
+	std::vector<RString> vsParts;
+	split( sLine, "|", vsParts, false );
+	for( RString &s : vsParts )
+		Trim( s );
+
+	Song *pSong = SONGMAN->FindSong( vsParts[0] );
+	if( pSong == nullptr )
+	{
+		LOG->Warn( "Benchmark: there's no song \"%s\"", vsParts[0].c_str() );
+		return;
+	}
+
+	Difficulty dc = Difficulty_Invalid;
+	if( vsParts.size() > 1 && !vsParts[1].empty() )
+	{
+		dc = StringToDifficulty( vsParts[1] );
+		if( dc == Difficulty_Invalid )
+		{
+			LOG->Warn( "Benchmark: \"%s\" isn't a difficulty", vsParts[1].c_str() );
+			return;
+		}
+	}
+
+	bool bAdded = false;
+	for( Steps *pSteps : pSong->GetAllSteps() )
+	{
+		if( pSteps->IsAutogen() || (dc != Difficulty_Invalid && pSteps->GetDifficulty() != dc) )
+			continue;
+		const Style *pStyle = GAMEMAN->GetFirstCompatibleStyle( GAMESTATE->GetCurrentGame(), 1, pSteps->m_StepsType );
+		if( pStyle == nullptr )
+			continue;
+
+		ChartFrames chart;
+		chart.m_Chart.m_pSong = pSong;
+		chart.m_Chart.m_pSteps = pSteps;
+		chart.m_Chart.m_pStyle = pStyle;
+		if( vsParts.size() > 2 )
+			chart.m_Chart.m_sModifiers = vsParts[2];
+		g_vCharts.push_back( chart );
+		bAdded = true;
+	}
+	if( !bAdded )
+		LOG->Warn( "Benchmark: \"%s\" has no charts to play", sLine.c_str() );
+}
+
+void GameplayBenchmark::Start()
+{
+	ASSERT( g_bRunning );
+	g_vCharts.clear();
+	g_iCurrentChart = 0;
+
+	std::vector<RString> vsLines;
+	if( !GetFileContents(g_sChartList, vsLines) )
+		LOG->Warn( "Benchmark: couldn't read the chart list \"%s\"", g_sChartList.c_str() );
+	for( RString sLine : vsLines )
+	{
+		Trim( sLine );
+		if( sLine.empty() || sLine[0] == '#' )
+			continue;
+		AddCharts( sLine );
+	}
+
+	if( g_vCharts.empty() )
+	{
+		LOG->Warn( "Benchmark: there are no charts to play" );
+		ArchHooks::SetUserQuit();
+		return;
+	}
+	SCREENMAN->SetNewScreen( BENCHMARK_SCREEN );
+}
+
+const GameplayBenchmark::Chart *GameplayBenchmark::GetChart()
+{
+	if( g_iCurrentChart >= g_vCharts.size() )
+		return nullptr;
+	return &g_vCharts[g_iCurrentChart].m_Chart;
+}
+
+void GameplayBenchmark::BeginChart()
+{
+	ASSERT( g_iCurrentChart < g_vCharts.size() );
+	g_vCharts[g_iCurrentChart].m_vFrames.clear();
+	g_ChartState = ChartState_Loading;
+}
+
+void GameplayBenchmark::EndChart()
+{
+	if( g_ChartState == ChartState_Idle )
+		return;
+	g_ChartState = ChartState_Idle;
+	++g_iCurrentChart;
+
+	if( g_iCurrentChart < g_vCharts.size() )
+		SCREENMAN->SetNewScreen( BENCHMARK_SCREEN );
+	else
+		ArchHooks::SetUserQuit();
+}
+
+void GameplayBenchmark::EndFrame()
+{
+	if( !g_bRunning )
+		return;
+
+	const float fSeconds = g_FrameTimer.IsZero()? 0:g_FrameTimer.GetDeltaTime();
+	g_FrameTimer.Touch();
+
+	if( g_ChartState == ChartState_Playing )
+	{
+		Frame frame;
+		frame.m_fSeconds = fSeconds;
+		std::copy( g_fStageSeconds, g_fStageSeconds+NUM_BenchmarkStage, frame.m_fStageSeconds );
+		g_vCharts[g_iCurrentChart].m_vFrames.push_back( frame );
+	}
+	else if( g_ChartState == ChartState_Loading )
+	{
+		g_ChartState = ChartState_Playing;
+	}
+	std::fill( g_fStageSeconds, g_fStageSeconds+NUM_BenchmarkStage, 0.0f );
+}
+
+void GameplayBenchmark::End()
+{
+	if( !g_bRunning )
+		return;
+
+	for( auto const &pref : g_vOverriddenPreferences )
+		pref.first->FromString( pref.second );
+	g_vOverriddenPreferences.clear();
+
+	Json::Value root;
+	root["SecondsPerFrame"] = FRAME_SECONDS;
+	Json::Value &charts = root["Charts"];
+	charts = Json::Value( Json::arrayValue );
+
+	FrameSeconds all;
+	for( ChartFrames const &chart : g_vCharts )
+	{
+		if( chart.m_vFrames.empty() )
+			continue;
+		const Chart &c = chart.m_Chart;
+		const RString sName = ssprintf( "%s %s %s", c.m_pSong->GetSongDir().c_str(),
+			GAMEMAN->GetStepsTypeInfo(c.m_pSteps->m_StepsType).szName,
+			DifficultyToString(c.m_pSteps->GetDifficulty()).c_str() );
+
+		FrameSeconds seconds;
+		seconds.Add( chart.m_vFrames );
+		seconds.Log( sName );
+		all.Add( chart.m_vFrames );
+
+		Json::Value &entry = charts.append( Json::Value() );
+		entry["Song"] = c.m_pSong->GetSongDir();
+		entry["StepsType"] = GAMEMAN->GetStepsTypeInfo(c.m_pSteps->m_StepsType).szName;
+		entry["Difficulty"] = DifficultyToString( c.m_pSteps->GetDifficulty() );
+		entry["Description"] = c.m_pSteps->GetDescription();
+		entry["Modifiers"] = c.m_sModifiers;
+		seconds.Serialize( entry );
+	}
+
+	if( all.m_vFrame.empty() )
+	{
+		LOG->Warn( "Benchmark: no charts were played" );
+		return;
+	}
+	all.Log( "All charts" );
+	all.Serialize( root["All"] );
+
+	if( !JsonUtil::WriteFile(root, BENCHMARK_FILE, false) )
+		LOG->Warn( "Couldn't write the benchmark to %s.", BENCHMARK_FILE );
+}
+
+GameplayBenchmark::StageTimer::StageTimer( BenchmarkStage stage ):
+	m_Stage(stage), m_bRunning(g_bRunning), m_Timer(RageZeroTimer),
+	m_pParent(nullptr), m_fChildSeconds(0)
+{
+	if( !m_bRunning )
+		return;
+	if( RageThread::GetCurrentThreadID() != g_iGameThreadID )
+	{
+		m_bRunning = false;
+		return;
+	}
+	m_pParent = g_pCurrentStage;
+	g_pCurrentStage = this;
+	m_Timer.Touch();
+}
+
+GameplayBenchmark::StageTimer::~StageTimer()
+{
+	if( !m_bRunning )
+		return;
+	const float fSeconds = m_Timer.Ago();
+	g_pCurrentStage = m_pParent;
+	if( m_pParent != nullptr )
+		m_pParent->m_fChildSeconds += fSeconds;
+	g_fStageSeconds[m_Stage] += std::max( 0.0f, fSeconds - m_fChildSeconds );
+}
+
+/*
+ * (c) 2026 Stepmania team
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, and/or sell copies of the Software, and to permit persons to
+ * whom the Software is furnished to do so, provided that the above
+ * copyright notice(s) and this permission notice appear in all copies of
+ * the Software and that both the above copyright notice(s) and this
+ * permission notice appear in supporting documentation.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT OF
+ * THIRD PARTY RIGHTS. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR HOLDERS
+ * INCLUDED IN THIS NOTICE BE LIABLE FOR ANY CLAIM, OR ANY SPECIAL INDIRECT
+ * OR CONSEQUENTIAL DAMAGES, OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS
+ * OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
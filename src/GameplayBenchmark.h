@@ -0,0 +1,120 @@
+#ifndef GAMEPLAY_BENCHMARK_H
+#define GAMEPLAY_BENCHMARK_H
+
+#include "RageTimer.h"
+
+class Song;
+class Steps;
+class Style;
+
+/** @brief The parts of a gameplay frame that GameplayBenchmark times. */
+enum BenchmarkStage
+{
+	BenchmarkStage_Player,		/**< Updating and drawing the Player, other than its NoteField. */
+	BenchmarkStage_NoteField,	/**< Updating and drawing the NoteField. */
+	BenchmarkStage_ArrowEffects,	/**< ArrowEffects::Update and placing each drawn note for the mods. */
+	BenchmarkStage_Lua,		/**< Running Lua functions and commands. */
+	NUM_BenchmarkStage,
+	BenchmarkStage_Invalid
+};
+const RString& BenchmarkStageToString( BenchmarkStage bs );
+
+/**
+ * @brief Plays a list of charts on autoplay as fast as it can, timing every frame.
+ *
+ * It runs when the game is started with --benchmark=<chart list>, where the
+ * list is a file in the game's directories with one chart on each line:
+ *
+ *     Group/Song Dir|Difficulty|Modifiers
+ *
+ * The difficulty and modifiers can be left off; without a difficulty, every
+ * chart of the song that one player can play in the current game is played.
+ * Lines starting with # are skipped.
+ *
+ * Nothing is shown or heard: only the null display and sound drivers are
+ * started, so it runs without a window or a GPU.  Every frame moves the game
+ * on by the same 1/60 second however long it took, so each run goes through
+ * the same frames.  Within each frame, the time spent in each stage is added
+ * up; like LoadProfiler, a stage is only charged for the time not spent in the
+ * stages inside it.  Once the last chart ends, the game quits, and the
+ * timings are logged and written to /Logs/Benchmark.json. */
+namespace GameplayBenchmark
+{
+	/**
+	 * @brief Get ready to run, if --benchmark was given.
+	 *
+	 * This is called before the sound and display are started, so that they
+	 * can be started as the null ones. */
+	void Init();
+	/** @brief Was --benchmark given? */
+	bool IsRunning();
+	/** @brief How far each frame moves the game on, in seconds. */
+	float GetFrameSeconds();
+
+	/** @brief Find the charts in the list and go to the first of them.
+	 * If there aren't any, quit. */
+	void Start();
+	/** @brief Report, and put back the preferences the benchmark changed. */
+	void End();
+
+	struct Chart
+	{
+		Song *m_pSong;
+		Steps *m_pSteps;
+		const Style *m_pStyle;
+		RString m_sModifiers;
+	};
+	/** @brief The chart to play next, or nullptr once they've all been played. */
+	const Chart *GetChart();
+	/** @brief Start timing the current chart.  The frame this is called in
+	 * is loading the chart, so it isn't counted. */
+	void BeginChart();
+	/** @brief Stop timing the current chart and move on to the next one. */
+	void EndChart();
+	/** @brief Count the time since the last frame ended towards the chart. */
+	void EndFrame();
+
+	/** @brief Charges the time until it's destroyed to a stage of this frame. */
+	class StageTimer
+	{
+	public:
+		StageTimer( BenchmarkStage stage );
+		~StageTimer();
+	private:
+		StageTimer( const StageTimer & ) = delete;
+		StageTimer &operator=( const StageTimer & ) = delete;
+
+		BenchmarkStage m_Stage;
+		bool m_bRunning;
+		RageTimer m_Timer;
+		StageTimer *m_pParent;
+		float m_fChildSeconds;
+	};
+}
+
+#endif
+
+/*
+ * (c) 2026 Stepmania team
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, and/or sell copies of the Software, and to permit persons to
+ * whom the Software is furnished to do so, provided that the above
+ * copyright notice(s) and this permission notice appear in all copies of
+ * the Software and that both the above copyright notice(s) and this
+ * permission notice appear in supporting documentation.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT OF
+ * THIRD PARTY RIGHTS. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR HOLDERS
+ * INCLUDED IN THIS NOTICE BE LIABLE FOR ANY CLAIM, OR ANY SPECIAL INDIRECT
+ * OR CONSEQUENTIAL DAMAGES, OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS
+ * OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
@@ -1,6 +1,7 @@
 #include "global.h"
 
 #include "ImageCache.h"
+#include "LoadProfiler.h"
 #include "RageDisplay.h"
 #include "RageUtil.h"
 #include "RageLog.h"
@@ -16,6 +17,7 @@
 #include "RageSurfaceUtils_Palettize.h"
 #include "RageSurfaceUtils_Dither.h"
 #include "RageSurfaceUtils_Zoom.h"
+#include "RageThreads.h"
 #include "SpecialFiles.h"
 #include "Banner.h"
 
@@ -25,6 +27,8 @@
 #include <cmath>
 #include <cstddef>
 #include <cstdint>
+#include <set>
+#include <vector>
 
 static Preference<bool> g_bPalettedImageCache( "PalettedImageCache", false );
 
@@ -57,6 +61,14 @@ ImageCache *IMAGECACHE; // global and accessible from anywhere in our program
 
 static std::map<RString, RageSurface*> g_ImagePathToImage;
 static int g_iDemandRefcount = 0;
+/* Songs may be loaded on several threads at once, and they all cache their
+ * images through here.  This protects g_ImagePathToImage, g_CachingImages and
+ * ImageData.  It's only held while they're looked at, never while reading or
+ * writing images, so threads don't wait for each other's disk access. */
+static RageMutex g_ImageCacheMutex( "ImageCache" );
+/* Images a thread is writing the cache file of, so no other thread writes
+ * the same file at the same time. */
+static std::set<RString> g_CachingImages;
 
 RString ImageCache::GetImageCachePath( RString sImageDir ,RString sImagePath )
 {
@@ -68,20 +80,25 @@ RString ImageCache::GetImageCachePath( RString sImageDir ,RString sImagePath )
  * by CacheImage or LoadImage on startup. */
 void ImageCache::Demand( RString sImageDir )
 {
-	++g_iDemandRefcount;
-	if( g_iDemandRefcount > 1 )
-		return;
-
-	if( PREFSMAN->m_ImageCache != IMGCACHE_LOW_RES_LOAD_ON_DEMAND )
-		return;
-
-	FOREACH_CONST_Child( &ImageData, p )
+	std::vector<RString> vsImagePaths;
 	{
-		RString sImagePath = p->GetName();
+		LockMut( g_ImageCacheMutex );
+		++g_iDemandRefcount;
+		if( g_iDemandRefcount > 1 )
+			return;
+
+		if( PREFSMAN->m_ImageCache != IMGCACHE_LOW_RES_LOAD_ON_DEMAND )
+			return;
 
-		if( g_ImagePathToImage.find(sImagePath) != g_ImagePathToImage.end() )
-			continue; /* already loaded */
+		FOREACH_CONST_Child( &ImageData, p )
+		{
+			if( g_ImagePathToImage.find(p->GetName()) == g_ImagePathToImage.end() )
+				vsImagePaths.push_back( p->GetName() );
+		}
+	}
 
+	for( const RString &sImagePath : vsImagePaths )
+	{
 		const RString sCachePath = GetImageCachePath(sImageDir,sImagePath);
 		RageSurface *pImage = RageSurfaceUtils::LoadSurface( sCachePath );
 		if( pImage == nullptr )
@@ -89,13 +106,16 @@ void ImageCache::Demand( RString sImageDir )
 			continue; /* doesn't exist */
 		}
 
-		g_ImagePathToImage[sImagePath] = pImage;
+		LockMut( g_ImageCacheMutex );
+		if( !g_ImagePathToImage.emplace(sImagePath, pImage).second )
+			delete pImage; /* another thread loaded it first */
 	}
 }
 
 /* Release images loaded on demand. */
 void ImageCache::Undemand( RString sImageDir )
 {
+	LockMut( g_ImageCacheMutex );
 	--g_iDemandRefcount;
 	if( g_iDemandRefcount != 0 )
 		return;
@@ -112,6 +132,7 @@ void ImageCache::Undemand( RString sImageDir )
  * not be updated if the original file changes, for efficiency. */
 void ImageCache::LoadImage( RString sImageDir, RString sImagePath )
 {
+	LoadProfiler::StageTimer timer( LoadStage_CacheImages );
 	if( sImagePath == "" )
 		return; // nothing to do
 	if( PREFSMAN->m_ImageCache != IMGCACHE_LOW_RES_PRELOAD &&
@@ -123,8 +144,11 @@ void ImageCache::LoadImage( RString sImageDir, RString sImagePath )
 
 	for( int tries = 0; tries < 2; ++tries )
 	{
-		if( g_ImagePathToImage.find(sImagePath) != g_ImagePathToImage.end() )
-			return; /* already loaded */
+		{
+			LockMut( g_ImageCacheMutex );
+			if( g_ImagePathToImage.find(sImagePath) != g_ImagePathToImage.end() )
+				return; /* already loaded */
+		}
 
 		CHECKPOINT_M( ssprintf( "ImageCache::LoadImage: %s", sCachePath.c_str() ) );
 		RageSurface *pImage = RageSurfaceUtils::LoadSurface( sCachePath );
@@ -148,12 +172,15 @@ void ImageCache::LoadImage( RString sImageDir, RString sImagePath )
 			}
 		}
 
-		g_ImagePathToImage[sImagePath] = pImage;
+		LockMut( g_ImageCacheMutex );
+		if( !g_ImagePathToImage.emplace(sImagePath, pImage).second )
+			delete pImage; /* another thread loaded it first */
 	}
 }
 
 void ImageCache::OutputStats() const
 {
+	LockMut( g_ImageCacheMutex );
 	int iTotalSize = 0;
 	for (auto const &it : g_ImagePathToImage)
 	{
@@ -166,6 +193,7 @@ void ImageCache::OutputStats() const
 
 void ImageCache::UnloadAllImages()
 {
+	LockMut( g_ImageCacheMutex );
 	for (auto &it: g_ImagePathToImage)
 	{
 		delete it.second;
@@ -313,6 +341,7 @@ RageTextureID ImageCache::LoadCachedImage( RString sImageDir, RString sImagePath
 		ID = Sprite::SongBannerTexture(ID);
 
 	/* It's not in a texture.  Do we have it loaded? */
+	LockMut( g_ImageCacheMutex );
 	if( g_ImagePathToImage.find(sImagePath) == g_ImagePathToImage.end() )
 	{
 		/* Oops, the image is missing.  Warn and continue. */
@@ -364,6 +393,7 @@ static inline int closest( int num, int n1, int n2 )
  * load the cache file, too.  (This is done at startup.) */
 void ImageCache::CacheImage( RString sImageDir, RString sImagePath )
 {
+	LoadProfiler::StageTimer timer( LoadStage_CacheImages );
 	if( PREFSMAN->m_ImageCache != IMGCACHE_LOW_RES_PRELOAD &&
 	    PREFSMAN->m_ImageCache != IMGCACHE_LOW_RES_LOAD_ON_DEMAND )
 		return;
@@ -382,6 +412,7 @@ void ImageCache::CacheImage( RString sImageDir, RString sImagePath )
 		{
 			unsigned CurFullHash;
 			const unsigned FullHash = GetHashForFile( sImagePath );
+			LockMut( g_ImageCacheMutex );
 			if( ImageData.GetValue( sImagePath, "FullHash", CurFullHash ) && CurFullHash == FullHash )
 				bCacheUpToDate = true;
 		}
@@ -403,11 +434,19 @@ void ImageCache::CacheImage( RString sImageDir, RString sImagePath )
 
 void ImageCache::CacheImageInternal( RString sImageDir, RString sImagePath )
 {
+	{
+		LockMut( g_ImageCacheMutex );
+		if( !g_CachingImages.insert(sImagePath).second )
+			return; /* another thread is caching it */
+	}
+
 	RString sError;
 	RageSurface *pImage = RageSurfaceUtils::LoadFile( sImagePath, sError );
 	if( pImage == nullptr )
 	{
 		LOG->UserLog( "Cache file", sImagePath, "couldn't be loaded: %s", sError.c_str() );
+		LockMut( g_ImageCacheMutex );
+		g_CachingImages.erase( sImagePath );
 		return;
 	}
 
@@ -466,6 +505,10 @@ void ImageCache::CacheImageInternal( RString sImageDir, RString sImagePath )
 
 	const RString sCachePath = GetImageCachePath(sImageDir,sImagePath);
 	RageSurfaceUtils::SaveSurface( pImage, sCachePath );
+	const unsigned iFullHash = GetHashForFile( sImagePath );
+
+	LockMut( g_ImageCacheMutex );
+	g_CachingImages.erase( sImagePath );
 
 	/* If an old image is loaded, free it. */
 	if( g_ImagePathToImage.find(sImagePath) != g_ImagePathToImage.end() )
@@ -487,13 +530,14 @@ void ImageCache::CacheImageInternal( RString sImageDir, RString sImagePath )
 	ImageData.SetValue( sImagePath, "Path", sCachePath );
 	ImageData.SetValue( sImagePath, "Width", iSourceWidth );
 	ImageData.SetValue( sImagePath, "Height", iSourceHeight );
-	ImageData.SetValue( sImagePath, "FullHash", GetHashForFile( sImagePath ) );
+	ImageData.SetValue( sImagePath, "FullHash", iFullHash );
 	if (!delay_save_cache)
 		WriteToDisk();
 }
 
 void ImageCache::WriteToDisk()
 {
+	LockMut( g_ImageCacheMutex );
 	ImageData.WriteFile(IMAGE_CACHE_INDEX);
 }
 
@@ -0,0 +1,221 @@
+#include "global.h"
+
+#include "JudgmentLatency.h"
+#include "EnumHelper.h"
+#include "JsonUtil.h"
+#include "LuaManager.h"
+#include "RageLog.h"
+#include "RageUtil.h"
+
+#include <atomic>
+#include <cstdint>
+#include <limits>
+
+static const char *LatencyStageNames[] = {
+	"Step",
+	"Judgment",
+};
+XToString( LatencyStage );
+
+#define LATENCY_FILE "/Logs/JudgmentLatency.json"
+static const unsigned MICROSECONDS_PER_BUCKET = 100;
+/* 100ms of 0.1ms buckets.  Anything slower goes in one more bucket at the end. */
+static const unsigned NUM_BUCKETS = 1000;
+
+namespace
+{
+	struct Histogram
+	{
+		std::atomic<std::uint32_t> m_iBuckets[NUM_BUCKETS+1];
+		std::atomic<std::uint32_t> m_iMinMicroseconds;
+		std::atomic<std::uint32_t> m_iMaxMicroseconds;
+
+		Histogram() { Reset(); }
+		void Reset()
+		{
+			for( std::atomic<std::uint32_t> &i : m_iBuckets )
+				i.store( 0, std::memory_order_relaxed );
+			m_iMinMicroseconds.store( std::numeric_limits<std::uint32_t>::max(), std::memory_order_relaxed );
+			m_iMaxMicroseconds.store( 0, std::memory_order_relaxed );
+		}
+
+		void Record( std::uint32_t iMicroseconds )
+		{
+			const unsigned iBucket = std::min( iMicroseconds / MICROSECONDS_PER_BUCKET, NUM_BUCKETS );
+			m_iBuckets[iBucket].fetch_add( 1, std::memory_order_relaxed );
+
+			std::uint32_t iMin = m_iMinMicroseconds.load( std::memory_order_relaxed );
+			while( iMicroseconds < iMin && !m_iMinMicroseconds.compare_exchange_weak(iMin, iMicroseconds, std::memory_order_relaxed) )
+				;
+			std::uint32_t iMax = m_iMaxMicroseconds.load( std::memory_order_relaxed );
+			while( iMicroseconds > iMax && !m_iMaxMicroseconds.compare_exchange_weak(iMax, iMicroseconds, std::memory_order_relaxed) )
+				;
+		}
+	};
+
+	Histogram g_Histograms[NUM_LatencyStage];
+
+	/* Copy the buckets out, so a summary adds up even if more is recorded
+	 * while it's worked out. */
+	unsigned CopyBuckets( LatencyStage ls, std::uint32_t iBuckets[NUM_BUCKETS+1] )
+	{
+		unsigned iCount = 0;
+		for( unsigned i = 0; i <= NUM_BUCKETS; ++i )
+		{
+			iBuckets[i] = g_Histograms[ls].m_iBuckets[i].load( std::memory_order_relaxed );
+			iCount += iBuckets[i];
+		}
+		return iCount;
+	}
+
+	/* The middle of the bucket the iRank'th (from 1) sample is in, kept
+	 * within what was actually recorded. */
+	float GetSecondsAtRank( const std::uint32_t iBuckets[NUM_BUCKETS+1], unsigned iRank, float fMin, float fMax )
+	{
+		unsigned iSeen = 0;
+		for( unsigned i = 0; i < NUM_BUCKETS; ++i )
+		{
+			iSeen += iBuckets[i];
+			if( iSeen >= iRank )
+			{
+				const float fSeconds = (i + 0.5f) * MICROSECONDS_PER_BUCKET / 1000000.0f;
+				return clamp( fSeconds, fMin, fMax );
+			}
+		}
+		return fMax;
+	}
+}
+
+void JudgmentLatency::Record( LatencyStage ls, float fSeconds )
+{
+	ASSERT( ls < NUM_LatencyStage );
+	const float fMicroseconds = std::max( 0.0f, fSeconds * 1000000.0f );
+	const std::uint32_t iMicroseconds = fMicroseconds >= float(std::numeric_limits<std::uint32_t>::max())?
+		std::numeric_limits<std::uint32_t>::max() : std::uint32_t(fMicroseconds);
+	g_Histograms[ls].Record( iMicroseconds );
+}
+
+void JudgmentLatency::Reset()
+{
+	for( Histogram &h : g_Histograms )
+		h.Reset();
+}
+
+JudgmentLatency::Summary JudgmentLatency::GetSummary( LatencyStage ls )
+{
+	ASSERT( ls < NUM_LatencyStage );
+	std::uint32_t iBuckets[NUM_BUCKETS+1];
+	Summary ret;
+	ret.m_iCount = CopyBuckets( ls, iBuckets );
+	if( ret.m_iCount == 0 )
+		return ret;
+
+	ret.m_fMin = g_Histograms[ls].m_iMinMicroseconds.load( std::memory_order_relaxed ) / 1000000.0f;
+	ret.m_fMax = g_Histograms[ls].m_iMaxMicroseconds.load( std::memory_order_relaxed ) / 1000000.0f;
+	ret.m_fMedian = GetSecondsAtRank( iBuckets, (ret.m_iCount + 1) / 2, ret.m_fMin, ret.m_fMax );
+	// The smallest rank with at least 99% of the samples at or below it.
+	const unsigned iP99Rank = std::max( 1u, unsigned((std::uint64_t(ret.m_iCount) * 99 + 99) / 100) );
+	ret.m_fP99 = GetSecondsAtRank( iBuckets, iP99Rank, ret.m_fMin, ret.m_fMax );
+	return ret;
+}
+
+bool JudgmentLatency::Write()
+{
+	Json::Value root;
+	root["MillisecondsPerBucket"] = MICROSECONDS_PER_BUCKET / 1000.0;
+	FOREACH_ENUM( LatencyStage, ls )
+	{
+		const Summary summary = GetSummary( ls );
+		Json::Value &stage = root[LatencyStageToString(ls)];
+		stage["Count"] = summary.m_iCount;
+		stage["MinMilliseconds"] = summary.m_fMin * 1000;
+		stage["MedianMilliseconds"] = summary.m_fMedian * 1000;
+		stage["P99Milliseconds"] = summary.m_fP99 * 1000;
+		stage["MaxMilliseconds"] = summary.m_fMax * 1000;
+
+		// Only the buckets that have anything in them, as [bucket, count].
+		std::uint32_t iBuckets[NUM_BUCKETS+1];
+		CopyBuckets( ls, iBuckets );
+		Json::Value &buckets = stage["Buckets"];
+		buckets = Json::Value( Json::arrayValue );
+		for( unsigned i = 0; i <= NUM_BUCKETS; ++i )
+		{
+			if( iBuckets[i] == 0 )
+				continue;
+			Json::Value &entry = buckets.append( Json::Value(Json::arrayValue) );
+			entry.append( i );
+			entry.append( iBuckets[i] );
+		}
+	}
+
+	if( !JsonUtil::WriteFile(root, LATENCY_FILE, false) )
+	{
+		LOG->Warn( "Couldn't write the judgment latency to %s.", LATENCY_FILE );
+		return false;
+	}
+	return true;
+}
+
+void JudgmentLatency::PushSummaries( lua_State *L )
+{
+	lua_createtable( L, 0, NUM_LatencyStage );
+	FOREACH_ENUM( LatencyStage, ls )
+	{
+		const Summary summary = GetSummary( ls );
+		lua_createtable( L, 0, 5 );
+		LuaHelpers::Push( L, int(summary.m_iCount) );
+		lua_setfield( L, -2, "Count" );
+		LuaHelpers::Push( L, summary.m_fMin * 1000 );
+		lua_setfield( L, -2, "Min" );
+		LuaHelpers::Push( L, summary.m_fMedian * 1000 );
+		lua_setfield( L, -2, "Median" );
+		LuaHelpers::Push( L, summary.m_fP99 * 1000 );
+		lua_setfield( L, -2, "P99" );
+		LuaHelpers::Push( L, summary.m_fMax * 1000 );
+		lua_setfield( L, -2, "Max" );
+		lua_setfield( L, -2, LatencyStageToString(ls).c_str() );
+	}
+}
+
+int LuaFunc_GetJudgmentLatency( lua_State *L );
+int LuaFunc_GetJudgmentLatency( lua_State *L )
+{
+	JudgmentLatency::PushSummaries( L );
+	return 1;
+}
+LUAFUNC_REGISTER_COMMON( GetJudgmentLatency );
+
+LuaFunction( WriteJudgmentLatency, JudgmentLatency::Write() );
+
+int LuaFunc_ResetJudgmentLatency( lua_State *L );
+int LuaFunc_ResetJudgmentLatency( lua_State *L )
+{
+	JudgmentLatency::Reset();
+	return 0;
+}
+LUAFUNC_REGISTER_COMMON( ResetJudgmentLatency );
+
+/*
+ * (c) 2026 Stepmania team
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, and/or sell copies of the Software, and to permit persons to
+ * whom the Software is furnished to do so, provided that the above
+ * copyright notice(s) and this permission notice appear in all copies of
+ * the Software and that both the above copyright notice(s) and this
+ * permission notice appear in supporting documentation.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT OF
+ * THIRD PARTY RIGHTS. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR HOLDERS
+ * INCLUDED IN THIS NOTICE BE LIABLE FOR ANY CLAIM, OR ANY SPECIAL INDIRECT
+ * OR CONSEQUENTIAL DAMAGES, OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS
+ * OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
@@ -0,0 +1,72 @@
+#ifndef JUDGMENT_LATENCY_H
+#define JUDGMENT_LATENCY_H
+
+struct lua_State;
+
+/** @brief The points after an input arrives that JudgmentLatency times. */
+enum LatencyStage
+{
+	LatencyStage_Step,	/**< Player::Step scoring the note the input hit. */
+	LatencyStage_Judgment,	/**< Player::SetJudgment sending the judgment for its row. */
+	NUM_LatencyStage,
+	LatencyStage_Invalid
+};
+const RString& LatencyStageToString( LatencyStage ls );
+
+/**
+ * @brief Measures how long it takes from an input arriving to its judgment.
+ *
+ * The time from the input's timestamp to each stage is counted in a
+ * histogram of 0.1ms buckets up to 100ms, with one more for anything later.
+ * Recording only increments atomic counters, so it never blocks the input
+ * or game threads and can be left on. */
+namespace JudgmentLatency
+{
+	/** @brief Count an input that took fSeconds to reach a stage. */
+	void Record( LatencyStage ls, float fSeconds );
+	/** @brief Forget everything recorded so far. */
+	void Reset();
+
+	struct Summary
+	{
+		unsigned m_iCount = 0;
+		/** @brief These are in seconds, and 0 if nothing was recorded. */
+		float m_fMin = 0, m_fMedian = 0, m_fP99 = 0, m_fMax = 0;
+	};
+	/** @brief Summarize a stage.  The median and 99th percentile are
+	 * accurate to a bucket. */
+	Summary GetSummary( LatencyStage ls );
+
+	/** @brief Write the summaries and the histograms to /Logs/JudgmentLatency.json. */
+	bool Write();
+
+	/** @brief Push a table of the summary of each stage, in milliseconds. */
+	void PushSummaries( lua_State *L );
+}
+
+#endif
+
+/*
+ * (c) 2026 Stepmania team
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, and/or sell copies of the Software, and to permit persons to
+ * whom the Software is furnished to do so, provided that the above
+ * copyright notice(s) and this permission notice appear in all copies of
+ * the Software and that both the above copyright notice(s) and this
+ * permission notice appear in supporting documentation.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT OF
+ * THIRD PARTY RIGHTS. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR HOLDERS
+ * INCLUDED IN THIS NOTICE BE LIABLE FOR ANY CLAIM, OR ANY SPECIAL INDIRECT
+ * OR CONSEQUENTIAL DAMAGES, OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS
+ * OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
@@ -0,0 +1,266 @@
+#include "global.h"
+
+#include "LoadProfiler.h"
+#include "EnumHelper.h"
+#include "JsonUtil.h"
+#include "Preference.h"
+#include "RageLog.h"
+#include "RageThreads.h"
+#include "RageUtil.h"
+
+#include <algorithm>
+#include <map>
+#include <vector>
+
+static const char *LoadStageNames[] = {
+	"ListDirectories",
+	"ReadCache",
+	"ParseSimfile",
+	"TidyUp",
+	"RadarValues",
+	"CacheImages",
+	"WriteCache",
+};
+XToString( LoadStage );
+
+static Preference<bool> g_bProfileSongLoading( "ProfileSongLoading", false );
+
+#define PROFILE_FILE "/Logs/LoadProfile.json"
+/* How many of the slowest groups and songs to log.  The JSON report has all
+ * of them. */
+static const unsigned NUM_SLOWEST_TO_LOG = 10;
+
+namespace
+{
+	struct StageTotals
+	{
+		float m_fSeconds[NUM_LoadStage];
+		int m_iCount[NUM_LoadStage];
+
+		StageTotals()
+		{
+			std::fill( m_fSeconds, m_fSeconds+NUM_LoadStage, 0.0f );
+			std::fill( m_iCount, m_iCount+NUM_LoadStage, 0 );
+		}
+		void Add( LoadStage ls, float fSeconds, int iCount )
+		{
+			m_fSeconds[ls] += fSeconds;
+			m_iCount[ls] += iCount;
+		}
+		void Add( const StageTotals &other )
+		{
+			FOREACH_ENUM( LoadStage, ls )
+				Add( ls, other.m_fSeconds[ls], other.m_iCount[ls] );
+		}
+		void Serialize( Json::Value &root ) const
+		{
+			FOREACH_ENUM( LoadStage, ls )
+			{
+				Json::Value &stage = root[LoadStageToString(ls)];
+				stage["Seconds"] = m_fSeconds[ls];
+				stage["Count"] = m_iCount[ls];
+			}
+		}
+	};
+
+	struct GroupTotals
+	{
+		RString m_sGroup;
+		int m_iSongs = 0;
+		float m_fSeconds = 0;
+		StageTotals m_Stages;
+	};
+}
+
+struct LoadProfiler::SongTimer::Stats
+{
+	RString m_sGroup;
+	RString m_sSongDir;
+	float m_fSeconds = 0;
+	StageTotals m_Stages;
+};
+
+/* Begin and End are only called while no songs are loading, so the worker
+ * threads only ever read g_bRunning. */
+static bool g_bRunning = false;
+static RageTimer g_StartTime;
+static RageMutex g_Lock( "LoadProfiler" );
+static StageTotals g_Stages;
+static std::map<RString, GroupTotals> g_Groups;
+static std::vector<LoadProfiler::SongTimer::Stats> g_Songs;
+
+static thread_local LoadProfiler::StageTimer *g_pCurrentStage = nullptr;
+static thread_local LoadProfiler::SongTimer::Stats *g_pCurrentSong = nullptr;
+
+void LoadProfiler::Begin()
+{
+	g_bRunning = g_bProfileSongLoading;
+	if( !g_bRunning )
+		return;
+
+	g_Stages = StageTotals();
+	g_Groups.clear();
+	g_Songs.clear();
+	g_StartTime.Touch();
+}
+
+void LoadProfiler::End()
+{
+	if( !g_bRunning )
+		return;
+	g_bRunning = false;
+	const float fTotalSeconds = g_StartTime.Ago();
+
+	std::vector<GroupTotals> vGroups;
+	for( auto const &group : g_Groups )
+		vGroups.push_back( group.second );
+	std::sort( vGroups.begin(), vGroups.end(),
+		[]( const GroupTotals &a, const GroupTotals &b ) { return a.m_fSeconds > b.m_fSeconds; } );
+	std::sort( g_Songs.begin(), g_Songs.end(),
+		[]( const SongTimer::Stats &a, const SongTimer::Stats &b ) { return a.m_fSeconds > b.m_fSeconds; } );
+
+	LOG->Info( "Song loading profile: %.3f seconds, %i songs in %i groups",
+		fTotalSeconds, int(g_Songs.size()), int(vGroups.size()) );
+	FOREACH_ENUM( LoadStage, ls )
+	{
+		LOG->Info( "  %-16s %9.3f seconds, %7i times", LoadStageToString(ls).c_str(),
+			g_Stages.m_fSeconds[ls], g_Stages.m_iCount[ls] );
+	}
+	LOG->Info( "Slowest groups:" );
+	for( unsigned i = 0; i < vGroups.size() && i < NUM_SLOWEST_TO_LOG; ++i )
+	{
+		LOG->Info( "  %9.3f seconds, %5i songs: %s", vGroups[i].m_fSeconds,
+			vGroups[i].m_iSongs, vGroups[i].m_sGroup.c_str() );
+	}
+	LOG->Info( "Slowest songs:" );
+	for( unsigned i = 0; i < g_Songs.size() && i < NUM_SLOWEST_TO_LOG; ++i )
+		LOG->Info( "  %9.3f seconds: %s", g_Songs[i].m_fSeconds, g_Songs[i].m_sSongDir.c_str() );
+
+	Json::Value root;
+	root["Seconds"] = fTotalSeconds;
+	g_Stages.Serialize( root["Stages"] );
+
+	Json::Value &groups = root["Groups"];
+	groups = Json::Value( Json::arrayValue );
+	for( GroupTotals const &group : vGroups )
+	{
+		Json::Value &entry = groups.append( Json::Value() );
+		entry["Name"] = group.m_sGroup;
+		entry["Songs"] = group.m_iSongs;
+		entry["Seconds"] = group.m_fSeconds;
+		group.m_Stages.Serialize( entry["Stages"] );
+	}
+
+	Json::Value &songs = root["Songs"];
+	songs = Json::Value( Json::arrayValue );
+	for( SongTimer::Stats const &song : g_Songs )
+	{
+		Json::Value &entry = songs.append( Json::Value() );
+		entry["Dir"] = song.m_sSongDir;
+		entry["Group"] = song.m_sGroup;
+		entry["Seconds"] = song.m_fSeconds;
+		song.m_Stages.Serialize( entry["Stages"] );
+	}
+
+	if( !JsonUtil::WriteFile(root, PROFILE_FILE, false) )
+		LOG->Warn( "Couldn't write the song loading profile to %s.", PROFILE_FILE );
+
+	g_Groups.clear();
+	g_Songs.clear();
+}
+
+LoadProfiler::StageTimer::StageTimer( LoadStage stage ):
+	m_Stage(stage), m_bRunning(g_bRunning), m_Timer(RageZeroTimer),
+	m_pParent(nullptr), m_fChildSeconds(0)
+{
+	if( !m_bRunning )
+		return;
+	m_pParent = g_pCurrentStage;
+	g_pCurrentStage = this;
+	m_Timer.Touch();
+}
+
+LoadProfiler::StageTimer::~StageTimer()
+{
+	if( !m_bRunning )
+		return;
+	const float fSeconds = m_Timer.Ago();
+	g_pCurrentStage = m_pParent;
+	if( m_pParent != nullptr )
+		m_pParent->m_fChildSeconds += fSeconds;
+
+	const float fOwnSeconds = std::max( 0.0f, fSeconds - m_fChildSeconds );
+	if( g_pCurrentSong != nullptr )
+	{
+		g_pCurrentSong->m_Stages.Add( m_Stage, fOwnSeconds, 1 );
+		return;
+	}
+
+	LockMut( g_Lock );
+	if( g_bRunning )
+		g_Stages.Add( m_Stage, fOwnSeconds, 1 );
+}
+
+LoadProfiler::SongTimer::SongTimer( const RString &sGroup, const RString &sSongDir ):
+	m_pStats(nullptr), m_pParentStats(nullptr), m_Timer(RageZeroTimer)
+{
+	if( !g_bRunning )
+		return;
+	m_pStats = new Stats;
+	m_pStats->m_sGroup = sGroup;
+	m_pStats->m_sSongDir = sSongDir;
+	m_pParentStats = g_pCurrentSong;
+	g_pCurrentSong = m_pStats;
+	m_Timer.Touch();
+}
+
+LoadProfiler::SongTimer::~SongTimer()
+{
+	if( m_pStats == nullptr )
+		return;
+	m_pStats->m_fSeconds = m_Timer.Ago();
+	g_pCurrentSong = m_pParentStats;
+
+	{
+		LockMut( g_Lock );
+		if( g_bRunning )
+		{
+			g_Stages.Add( m_pStats->m_Stages );
+			GroupTotals &group = g_Groups[m_pStats->m_sGroup];
+			group.m_sGroup = m_pStats->m_sGroup;
+			group.m_fSeconds += m_pStats->m_fSeconds;
+			group.m_Stages.Add( m_pStats->m_Stages );
+			if( !m_pStats->m_sSongDir.empty() )
+			{
+				++group.m_iSongs;
+				g_Songs.push_back( *m_pStats );
+			}
+		}
+	}
+	delete m_pStats;
+}
+
+/*
+ * (c) 2026 Stepmania team
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, and/or sell copies of the Software, and to permit persons to
+ * whom the Software is furnished to do so, provided that the above
+ * copyright notice(s) and this permission notice appear in all copies of
+ * the Software and that both the above copyright notice(s) and this
+ * permission notice appear in supporting documentation.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT OF
+ * THIRD PARTY RIGHTS. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR HOLDERS
+ * INCLUDED IN THIS NOTICE BE LIABLE FOR ANY CLAIM, OR ANY SPECIAL INDIRECT
+ * OR CONSEQUENTIAL DAMAGES, OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS
+ * OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
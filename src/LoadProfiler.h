@@ -0,0 +1,102 @@
+#ifndef LOAD_PROFILER_H
+#define LOAD_PROFILER_H
+
+#include "RageTimer.h"
+
+/** @brief The stages of song loading that LoadProfiler keeps track of. */
+enum LoadStage
+{
+	LoadStage_ListDirectories,	/**< Listing and hashing song and group directories. */
+	LoadStage_ReadCache,		/**< Loading a song from its cache entry. */
+	LoadStage_ParseSimfile,		/**< Loading a song and its edits from its simfiles. */
+	LoadStage_TidyUp,		/**< Song::TidyUpData. */
+	LoadStage_RadarValues,		/**< Calculating radar values and the song's last second. */
+	LoadStage_CacheImages,		/**< Caching banners and other images. */
+	LoadStage_WriteCache,		/**< Writing a song's cache entry. */
+	NUM_LoadStage,
+	LoadStage_Invalid
+};
+const RString& LoadStageToString( LoadStage ls );
+
+/**
+ * @brief Measures where the time goes while songs are loaded.
+ *
+ * While the profiler is running, the time spent in each stage is added up,
+ * along with the number of times each stage ran, for every song and group.
+ * Stages can run inside each other; each is only charged for the time not
+ * spent in the stages inside it.  It only runs if the ProfileSongLoading
+ * preference is set. */
+namespace LoadProfiler
+{
+	/** @brief Start a new profile, if profiling is turned on. */
+	void Begin();
+	/**
+	 * @brief Stop profiling and report.
+	 *
+	 * This logs the time spent in each stage, the slowest groups and the
+	 * slowest songs, and writes the whole profile to /Logs/LoadProfile.json. */
+	void End();
+
+	/** @brief Charges the time until it's destroyed to a stage. */
+	class StageTimer
+	{
+	public:
+		StageTimer( LoadStage stage );
+		~StageTimer();
+	private:
+		StageTimer( const StageTimer & ) = delete;
+		StageTimer &operator=( const StageTimer & ) = delete;
+
+		LoadStage m_Stage;
+		bool m_bRunning;
+		RageTimer m_Timer;
+		StageTimer *m_pParent;
+		float m_fChildSeconds;
+	};
+
+	/**
+	 * @brief Charges the stages run on this thread until it's destroyed to a
+	 * song, or to a group if there's no song. */
+	class SongTimer
+	{
+	public:
+		SongTimer( const RString &sGroup, const RString &sSongDir );
+		~SongTimer();
+
+		struct Stats;
+	private:
+		SongTimer( const SongTimer & ) = delete;
+		SongTimer &operator=( const SongTimer & ) = delete;
+
+		Stats *m_pStats;
+		Stats *m_pParentStats;
+		RageTimer m_Timer;
+	};
+}
+
+#endif
+
+/*
+ * (c) 2026 Stepmania team
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, and/or sell copies of the Software, and to permit persons to
+ * whom the Software is furnished to do so, provided that the above
+ * copyright notice(s) and this permission notice appear in all copies of
+ * the Software and that both the above copyright notice(s) and this
+ * permission notice appear in supporting documentation.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT OF
+ * THIRD PARTY RIGHTS. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR HOLDERS
+ * INCLUDED IN THIS NOTICE BE LIABLE FOR ANY CLAIM, OR ANY SPECIAL INDIRECT
+ * OR CONSEQUENTIAL DAMAGES, OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS
+ * OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
@@ -12,6 +12,7 @@
 #include "RageTypes.h"
 #include "MessageManager.h"
 #include "ver.h"
+#include "GameplayBenchmark.h"
 
 #include <cassert>
 #include <cmath>
@@ -832,6 +833,8 @@ void LuaHelpers::ReportScriptErrorFmt(const char *fmt, ...)
 
 bool LuaHelpers::RunScriptOnStack( Lua *L, RString &Error, int Args, int ReturnValues, bool ReportError )
 {
+	GameplayBenchmark::StageTimer timer( BenchmarkStage_Lua );
+
 	lua_pushcfunction( L, GetLuaStack );
 
 	// move the error function above the function and params
@@ -87,6 +87,7 @@ static const char *MessageIDNames[] = {
 	"MiddleClick",
 	"MouseWheelUp",
 	"MouseWheelDown",
+	"SongGroupsLoaded",
 };
 XToString( MessageID );
 
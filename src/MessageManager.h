@@ -87,6 +87,7 @@ enum MessageID
 	Message_MiddleClick,
 	Message_MouseWheelUp,
 	Message_MouseWheelDown,
+	Message_SongGroupsLoaded,
 	NUM_MessageID,	// leave this at the end
 	MessageID_Invalid
 };
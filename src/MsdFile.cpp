@@ -18,9 +18,11 @@
 #include "RageLog.h"
 #include "RageUtil.h"
 
+#include <cstring>
+
 void MsdFile::AddParam( const char *buf, int len )
 {
-	values.back().params.push_back( RString(buf, len) );
+	values.back().params.push_back( std::string_view(buf, len) );
 }
 
 void MsdFile::AddValue() /* (no extra charge) */
@@ -29,14 +31,62 @@ void MsdFile::AddValue() /* (no extra charge) */
 	values.back().params.reserve( 32 );
 }
 
+/* Parameters are views.  One that's a plain run of the buffer points straight
+ * into it; only one that had a comment or an escape taken out of its middle
+ * is copied, into m_sProcessed.  Nothing gets longer when it's processed, so
+ * m_sProcessed is big enough for all of them once it's the size of the
+ * buffer, and never moves after that. */
 void MsdFile::ReadBuf( const char *buf, int len, bool bUnescape )
 {
+	values.clear();
 	values.reserve( 64 );
+	m_sProcessed.clear();
 
 	bool ReadingValue=false;
 	int i = 0;
-	char *cProcessed = new char[len];
+	/* The current parameter is pParam[0, iProcessedLen).  pProcessed is set
+	 * once it's being copied into m_sProcessed; until then, each character
+	 * added to it is the next one in the buffer. */
+	const char *pParam = buf;
+	char *pProcessed = nullptr;
 	int iProcessedLen = -1;
+	int iProcessedUsed = 0;
+
+	auto BeginParam = [&]( int iStart )
+	{
+		pParam = buf + iStart;
+		pProcessed = nullptr;
+		iProcessedLen = 0;
+	};
+	auto AppendChar = [&]( char c )
+	{
+		if( pProcessed != nullptr )
+			pProcessed[iProcessedLen] = c;
+		++iProcessedLen;
+	};
+	// Text was dropped from the buffer; the parameter continues at iNext.
+	auto SkipTo = [&]( int iNext )
+	{
+		if( pProcessed != nullptr )
+			return;
+		if( iProcessedLen == 0 )
+		{
+			pParam = buf + iNext;
+			return;
+		}
+		if( m_sProcessed.empty() )
+			m_sProcessed.resize( len );
+		pProcessed = &m_sProcessed[iProcessedUsed];
+		memcpy( pProcessed, pParam, iProcessedLen );
+		pParam = pProcessed;
+	};
+	auto EndParam = [&]()
+	{
+		AddParam( pParam, iProcessedLen );
+		if( pProcessed != nullptr )
+			iProcessedUsed += iProcessedLen;
+	};
+
 	while( i < len )
 	{
 		if( i+1 < len && buf[i] == '/' && buf[i+1] == '/' )
@@ -47,6 +97,8 @@ void MsdFile::ReadBuf( const char *buf, int len, bool bUnescape )
 				i++;
 			} while( i < len && buf[i] != '\n' );
 
+			if( ReadingValue )
+				SkipTo( i );
 			continue;
 		}
 
@@ -58,9 +110,9 @@ void MsdFile::ReadBuf( const char *buf, int len, bool bUnescape )
 			// Make sure this # is the first non-whitespace character on the line.
 			bool FirstChar = true;
 			int j = iProcessedLen;
-			while( j > 0 && cProcessed[j - 1] != '\r' && cProcessed[j - 1] != '\n' )
+			while( j > 0 && pParam[j - 1] != '\r' && pParam[j - 1] != '\n' )
 			{
-				if( cProcessed[j - 1] == ' ' || cProcessed[j - 1] == '\t' )
+				if( pParam[j - 1] == ' ' || pParam[j - 1] == '\t' )
 				{
 					--j;
 					continue;
@@ -73,18 +125,18 @@ void MsdFile::ReadBuf( const char *buf, int len, bool bUnescape )
 			if( !FirstChar )
 			{
 				/* We're not the first char on a line.  Treat it as if it were a normal character. */
-				cProcessed[iProcessedLen++] = buf[i++];
+				AppendChar( buf[i++] );
 				continue;
 			}
 
 			/* Skip newlines and whitespace before adding the value. */
 			iProcessedLen = j;
 			while( iProcessedLen > 0 &&
-			       ( cProcessed[iProcessedLen - 1] == '\r' || cProcessed[iProcessedLen - 1] == '\n' ||
-			         cProcessed[iProcessedLen - 1] == ' ' || cProcessed[iProcessedLen - 1] == '\t' ) )
+			       ( pParam[iProcessedLen - 1] == '\r' || pParam[iProcessedLen - 1] == '\n' ||
+			         pParam[iProcessedLen - 1] == ' ' || pParam[iProcessedLen - 1] == '\t' ) )
 				--iProcessedLen;
 
-			AddParam( cProcessed, iProcessedLen );
+			EndParam();
 			iProcessedLen = 0;
 			ReadingValue=false;
 		}
@@ -107,13 +159,13 @@ void MsdFile::ReadBuf( const char *buf, int len, bool bUnescape )
 
 		/* : and ; end the current param, if any. */
 		if( iProcessedLen != -1 && (buf[i] == ':' || buf[i] == ';') )
-			AddParam( cProcessed, iProcessedLen );
+			EndParam();
 
 		/* # and : begin new params. */
 		if( buf[i] == '#' || buf[i] == ':' )
 		{
 			++i;
-			iProcessedLen = 0;
+			BeginParam( i );
 			continue;
 		}
 
@@ -133,29 +185,28 @@ void MsdFile::ReadBuf( const char *buf, int len, bool bUnescape )
 			if(bUnescape)
 			{
 				++i;
+				SkipTo( i );
 			}
-			// Otherwise, add the '\\' to cProcessed here, so that
+			// Otherwise, add the '\\' to the parameter here, so that
 			// whatever character is coming next stays escaped in
 			// the resulting value/parameter string 
 			// (and most importantly, it doesn't get parsed as a control character)
 			// on the next iteration
 			else 
 			{
-				cProcessed[iProcessedLen++] = buf[i++];	
+				AppendChar( buf[i++] );
 			}
 		}
 		
 		if( i < len )
 		{
-			cProcessed[iProcessedLen++] = buf[i++];
+			AppendChar( buf[i++] );
 		}
 	}
 
 	/* Add any unterminated value at the very end. */
 	if( ReadingValue )
-		AddParam( cProcessed, iProcessedLen );
-
-	delete [] cProcessed;
+		EndParam();
 }
 
 // returns true if successful, false otherwise
@@ -171,25 +222,27 @@ bool MsdFile::ReadFile( RString sNewPath, bool bUnescape )
 		return false;
 	}
 
-	// allocate a string to hold the file
-	RString FileString;
-	FileString.reserve( f.GetFileSize() );
+	// allocate a string to hold the file; the parameters will point into it
+	values.clear();
+	m_sBuffer = RString();
+	m_sBuffer.reserve( f.GetFileSize() );
 
-	int iBytesRead = f.Read( FileString );
+	int iBytesRead = f.Read( m_sBuffer );
 	if( iBytesRead == -1 )
 	{
 		error = f.GetError();
 		return false;
 	}
 
-	ReadBuf( FileString.c_str(), iBytesRead, bUnescape );
+	ReadBuf( m_sBuffer.c_str(), iBytesRead, bUnescape );
 
 	return true;
 }
 
 void MsdFile::ReadFromString( const RString &sString, bool bUnescape )
 {
-	ReadBuf( sString.c_str(), sString.size(), bUnescape );
+	m_sBuffer = sString;
+	ReadBuf( m_sBuffer.c_str(), m_sBuffer.size(), bUnescape );
 }
 
 RString MsdFile::GetParam(unsigned val, unsigned par) const
@@ -197,7 +250,15 @@ RString MsdFile::GetParam(unsigned val, unsigned par) const
 	if( val >= GetNumValues() || par >= GetNumParams(val) )
 		return RString();
 
-	return values[val].params[par];
+	return values[val][par];
+}
+
+std::string_view MsdFile::GetParamView( unsigned val, unsigned par ) const
+{
+	if( val >= GetNumValues() )
+		return std::string_view();
+
+	return values[val].GetView( par );
 }
 
 /*
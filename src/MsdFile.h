@@ -1,10 +1,15 @@
 #ifndef MSDFILE_H
 #define MSDFILE_H
 
+#include <string_view>
 #include <vector>
 
 
-/** @brief The class that reads the various .SSC, .SM, .SMA, .DWI, and .MSD files. */
+/**
+ * @brief The class that reads the various .SSC, .SM, .SMA, .DWI, and .MSD files.
+ *
+ * The MsdFile keeps the text it read, and its parameters point into it, so
+ * they're only valid for as long as the MsdFile is. */
 class MsdFile
 {
 public:
@@ -14,8 +19,8 @@ public:
 	 * Note that &#35;param:param:param:param; is one whole value. */
 	struct value_t
 	{
-		/** @brief The list of parameters. */
-		std::vector<RString> params;
+		/** @brief The list of parameters, pointing into the MsdFile. */
+		std::vector<std::string_view> params;
 		/** @brief Set up the parameters with default values. */
 		value_t(): params() {}
 
@@ -24,10 +29,18 @@ public:
 		 * @param i the index.
 		 * @return the proper parameter.
 		 */
-		RString operator[]( unsigned i ) const { if( i >= params.size() ) return RString(); return params[i]; }
+		RString operator[]( unsigned i ) const { if( i >= params.size() ) return RString(); return RString( params[i].data(), params[i].size() ); }
+		/**
+		 * @brief Access the proper parameter without copying it.
+		 * @param i the index.
+		 * @return the proper parameter.
+		 */
+		std::string_view GetView( unsigned i ) const { if( i >= params.size() ) return std::string_view(); return params[i]; }
 	};
 
 	MsdFile(): values(), error("") {}
+	MsdFile( const MsdFile & ) = delete;
+	MsdFile &operator=( const MsdFile & ) = delete;
 
 	/** @brief Remove the MSDFile. */
 	virtual ~MsdFile() { }
@@ -75,6 +88,13 @@ public:
 	 * @return the parameter in question.
 	 */
 	RString GetParam( unsigned val, unsigned par ) const;
+	/**
+	 * @brief Retrieve the specified parameter without copying it.
+	 * @param val the current value index.
+	 * @param par the current parameter index.
+	 * @return the parameter in question.
+	 */
+	std::string_view GetParamView( unsigned val, unsigned par ) const;
 
 
 private:
@@ -87,7 +107,7 @@ private:
 	void ReadBuf( const char *buf, int len, bool bUnescape );
 	/**
 	 * @brief Add a new parameter.
-	 * @param buf the new parameter.
+	 * @param buf the new parameter, which must outlive the MsdFile.
 	 * @param len the length of the new parameter.
 	 */
 	void AddParam( const char *buf, int len );
@@ -98,6 +118,10 @@ private:
 
 	/** @brief The list of values. */
 	std::vector<value_t> values;
+	/** @brief The text that was read. */
+	RString m_sBuffer;
+	/** @brief Parameters that couldn't point into m_sBuffer. */
+	RString m_sProcessed;
 	/** @brief The error string. */
 	RString error;
 };
@@ -286,6 +286,35 @@ void MusicWheel::ReloadSongList()
 	SCREENMAN->PostMessageToTopScreen( SM_SongChanged, 0 );
 }
 
+void MusicWheel::SongsAdded()
+{
+	Song *pOldSong = nullptr;
+	Course *pOldCourse = nullptr;
+	RString sOldSection;
+	if( !m_CurWheelItemData.empty() )
+	{
+		pOldSong = GetSelectedSong();
+		pOldCourse = GetSelectedCourse();
+		sOldSection = GetSelectedSection();
+	}
+
+	FOREACH_ENUM( SortOrder, so ) {
+		m_WheelItemDatasStatus[so]=INVALID;
+	}
+	readyWheelItemsData(GAMESTATE->m_SortOrder);
+	SetOpenSection(m_sExpandedSectionName);
+
+	// Items may have been added ahead of the selection, so find it again
+	// instead of keeping its index like ReloadSongList does.
+	if( !SelectSong(pOldSong) && !SelectCourse(pOldCourse) )
+		SelectSection(sOldSection);
+	RebuildWheelItems();
+
+	// Only refresh the song preview if the selection changed.
+	if( m_CurWheelItemData.empty() || GetSelectedSong() != pOldSong || GetSelectedCourse() != pOldCourse )
+		SCREENMAN->PostMessageToTopScreen( SM_SongChanged, 0 );
+}
+
 /* If a song or course is set in GAMESTATE and available, select it.  Otherwise, choose the
  * first available song or course.  Return true if an item was set, false if no items are
  * available. */
@@ -54,6 +54,8 @@ public:
 	const MusicWheelItemData *GetCurWheelItemData( int i ) { return (const MusicWheelItemData *) m_CurWheelItemData[i]; }
 
 	virtual void ReloadSongList();
+	/** @brief Rebuild the wheel after songs were added, keeping the selection. */
+	void SongsAdded();
 
 	void GetCurrentSections(std::vector<RString> &sections);
 	// Lua
@@ -13,6 +13,7 @@
 #include "RageUtil_AutoPtr.h"
 
 #include <cstddef>
+#include <utility>
 #include <vector>
 
 
@@ -34,7 +35,7 @@ bool NoteData::IsComposite() const
 {
 	for( int track = 0; track < GetNumTracks(); ++track )
 	{
-		for (const std::pair<const int, TapNote>& tn : m_TapNotes[track])
+		for (auto const &tn : m_TapNotes[track])
 			if( tn.second.pn != PLAYER_INVALID )
 				return true;
 	}
@@ -335,15 +336,7 @@ void NoteData::AddHoldNote( int iTrack, int iStartRow, int iEndRow, TapNote tn )
 	tn.iDuration = iEndRow - iStartRow;
 
 	// Remove everything in the range.
-	while( lBegin != lEnd )
-	{
-		iterator next = lBegin;
-		++next;
-
-		RemoveTapNote( iTrack, lBegin );
-
-		lBegin = next;
-	}
+	m_TapNotes[iTrack].erase( lBegin, lEnd );
 
 	/* Additionally, if there's a tap note lying at the end of our range,
 	 * remove it too. */
@@ -935,6 +928,76 @@ void NoteData::LoadTransformed( const NoteData& in, int iNewNumTracks, const int
 	}
 }
 
+void NoteData::RemapTracks( const int iOriginalTrackToTakeFrom[], int rowBegin, int rowEnd )
+{
+	if( rowBegin <= 0 && rowEnd >= MAX_NOTE_ROW )
+	{
+		// A track taken from more than once has to be copied until its last use.
+		std::vector<int> viUses( GetNumTracks(), 0 );
+		for( int t=0; t<GetNumTracks(); t++ )
+		{
+			const int iOriginalTrack = iOriginalTrackToTakeFrom[t];
+			ASSERT_M( iOriginalTrack < GetNumTracks(), ssprintf("from OriginalTrack %i >= %i (#tracks)", iOriginalTrack, GetNumTracks()) );
+			if( iOriginalTrack != -1 )
+				++viUses[iOriginalTrack];
+		}
+
+		std::vector<TrackMap> vOriginal( GetNumTracks() );
+		for( int t=0; t<GetNumTracks(); t++ )
+			vOriginal[t].swap( m_TapNotes[t] );
+		for( int t=0; t<GetNumTracks(); t++ )
+		{
+			const int iOriginalTrack = iOriginalTrackToTakeFrom[t];
+			if( iOriginalTrack == -1 )
+				continue;
+			if( --viUses[iOriginalTrack] == 0 )
+				m_TapNotes[t].swap( vOriginal[iOriginalTrack] );
+			else
+				m_TapNotes[t] = vOriginal[iOriginalTrack];
+		}
+		return;
+	}
+
+	/* Do what LoadTransformed and then CopyRange of the range back would,
+	 * without copying the rest of the chart: take the range, and the holds
+	 * crossing into it, out of every track before putting any of it back.
+	 * Clearing the range cuts the holds crossing its edges, and the holds put
+	 * back are clipped to it and merged by AddHoldNote, so nothing moved can
+	 * overlap a note outside the range. */
+	std::vector<std::vector<std::pair<int,TapNote>>> vRange( GetNumTracks() );
+	for( int t=0; t<GetNumTracks(); t++ )
+	{
+		const_iterator begin, end;
+		GetTapNoteRangeInclusive( t, rowBegin, rowEnd, begin, end );
+		vRange[t].assign( begin, end );
+	}
+	ClearRange( rowBegin, rowEnd );
+	for( int t=0; t<GetNumTracks(); t++ )
+	{
+		const int iOriginalTrack = iOriginalTrackToTakeFrom[t];
+		ASSERT_M( iOriginalTrack < GetNumTracks(), ssprintf("from OriginalTrack %i >= %i (#tracks)", iOriginalTrack, GetNumTracks()) );
+		if( iOriginalTrack == -1 )
+			continue;
+		for( const std::pair<int,TapNote> &note : vRange[iOriginalTrack] )
+		{
+			const TapNote &tn = note.second;
+			if( tn.type == TapNoteType_Empty )
+				continue;
+
+			if( tn.type == TapNoteType_HoldHead )
+			{
+				const int iStartRow = clamp( note.first, rowBegin, rowEnd );
+				const int iEndRow = clamp( note.first + tn.iDuration, rowBegin, rowEnd );
+				AddHoldNote( t, iStartRow, iEndRow, tn );
+			}
+			else if( note.first >= rowBegin && note.first <= rowEnd )
+			{
+				SetTapNote( t, note.first, tn );
+			}
+		}
+	}
+}
+
 void NoteData::MoveTapNoteTrack( int dest, int src )
 {
 	if(dest == src) return;
@@ -962,10 +1025,20 @@ void NoteData::SetTapNote( int track, int row, const TapNote& t )
 	}
 	else
 	{
-		m_TapNotes[track][row] = t;
+		// t may be a note in this track, which inserting can move.
+		const TapNote tn = t;
+		m_TapNotes[track][row] = tn;
 	}
 }
 
+void NoteData::AppendTapNote( int track, int row, const TapNote& tn )
+{
+	DEBUG_ASSERT( track>=0 && track<GetNumTracks() );
+	TrackMap &trackMap = m_TapNotes[track];
+	DEBUG_ASSERT( trackMap.empty() || trackMap.rbegin()->first < row );
+	trackMap.insert( trackMap.end(), TrackMap::value_type(row, tn) );
+}
+
 void NoteData::GetTracksHeldAtRow( int row, std::set<int>& addTo )
 {
 	for( int t=0; t<GetNumTracks(); ++t )
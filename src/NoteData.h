@@ -2,6 +2,9 @@
 #define NOTE_DATA_H
 
 #include "NoteTypes.h"
+#if defined(WITH_FLAT_NOTE_DATA)
+#include "FlatMap.h"
+#endif
 
 #include <map>
 #include <set>
@@ -30,11 +33,20 @@
 class NoteData
 {
 public:
+	/* With WITH_FLAT_NOTE_DATA, each track is a sorted array instead of a
+	 * tree.  Changing a track then invalidates iterators into it past the
+	 * change, so code that changes a track while walking it has to use the
+	 * iterator RemoveTapNote returns, and not keep iterators or references
+	 * across SetTapNote. */
+#if defined(WITH_FLAT_NOTE_DATA)
+	typedef FlatMap<int,TapNote> TrackMap;
+#else
 	typedef std::map<int,TapNote> TrackMap;
-	typedef std::map<int,TapNote>::iterator iterator;
-	typedef std::map<int,TapNote>::const_iterator const_iterator;
-	typedef std::map<int,TapNote>::reverse_iterator reverse_iterator;
-	typedef std::map<int,TapNote>::const_reverse_iterator const_reverse_iterator;
+#endif
+	typedef TrackMap::iterator iterator;
+	typedef TrackMap::const_iterator const_iterator;
+	typedef TrackMap::reverse_iterator reverse_iterator;
+	typedef TrackMap::const_reverse_iterator const_reverse_iterator;
 
 	NoteData(): m_TapNotes() {}
 
@@ -192,7 +204,8 @@ public:
 
 	inline iterator FindTapNote( unsigned iTrack, int iRow )	{ return m_TapNotes[iTrack].find( iRow ); }
 	inline const_iterator FindTapNote( unsigned iTrack, int iRow ) const { return m_TapNotes[iTrack].find( iRow ); }
-	void RemoveTapNote( unsigned iTrack, iterator it )		{ m_TapNotes[iTrack].erase( it ); }
+	// Returns the iterator after the removed note.
+	iterator RemoveTapNote( unsigned iTrack, iterator it )		{ return m_TapNotes[iTrack].erase( it ); }
 
 	/**
 	 * @brief Return an iterator range for [rowBegin,rowEnd).
@@ -261,6 +274,12 @@ public:
 
 	void MoveTapNoteTrack( int dest, int src );
 	void SetTapNote( int track, int row, const TapNote& tn );
+	/**
+	 * @brief Add a note after every note already in the track.
+	 *
+	 * This skips the search SetTapNote does, so loading notes in order
+	 * doesn't have to look through the track for each one. */
+	void AppendTapNote( int track, int row, const TapNote& tn );
 	/**
 	 * @brief Add a hold note, merging other overlapping holds and destroying
 	 * tap notes underneath.
@@ -377,6 +396,14 @@ public:
 	void LoadTransformed(const NoteData& original,
 						 int iNewNumTracks,
 						 const int iOriginalTrackToTakeFrom[] );	// -1 for iOriginalTracksToTakeFrom means no track
+	/**
+	 * @brief Move the notes starting in [rowBegin,rowEnd) between tracks in place.
+	 *
+	 * Track t gets the notes iOriginalTrackToTakeFrom[t] had in the range,
+	 * just as LoadTransformed followed by CopyRange of the range would give:
+	 * holds crossing the edges of the range are cut there.  Over the whole
+	 * chart, the tracks are just moved, not copied. */
+	void RemapTracks( const int iOriginalTrackToTakeFrom[], int rowBegin = 0, int rowEnd = MAX_NOTE_ROW );
 
 	// XML
 	XNode* CreateNode() const;
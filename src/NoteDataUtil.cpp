@@ -1,5 +1,6 @@
 #include "global.h"
 #include "NoteDataUtil.h"
+#include "ChartStats.h"
 #include "NoteData.h"
 #include "RageUtil.h"
 #include "RageLog.h"
@@ -13,6 +14,7 @@
 #include <cmath>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <utility>
 #include <vector>
 
@@ -59,48 +61,98 @@ NoteType NoteDataUtil::GetSmallestNoteTypeInRange( const NoteData &n, int iStart
 	return NoteType_Invalid;	// well-formed notes created in the editor should never get here
 }
 
+/* The whitespace trimmed from each line.  Stray NULs are trimmed as well,
+ * as they always have been. */
+static inline bool IsSMNoteDataSpace( char c )
+{
+	return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\0';
+}
+
+/* The row of the hold head that a '3' after every note in the track would
+ * end, or -1.  That's the last note in the track if it's a hold head without
+ * a tail, skipping autokeysounds, the same way NoteData::IsHoldNoteAtRow
+ * looks. */
+static int FindOpenHoldHead( const NoteData &nd, int iTrack )
+{
+	for( NoteData::const_reverse_iterator it = nd.rbegin(iTrack); it != nd.rend(iTrack); ++it )
+	{
+		if( it->second.type == TapNoteType_AutoKeysound )
+			continue;
+		if( it->second.type == TapNoteType_HoldHead && it->second.iDuration == MAX_NOTE_ROW )
+			return it->first;
+		break;
+	}
+	return -1;
+}
+
 static void LoadFromSMNoteDataStringWithPlayer( NoteData& out, const RString &sSMNoteData, int start,
 						int len, PlayerNumber pn, int iNumTracks )
 {
-	/* Don't allocate memory for the entire string, nor per measure. Instead, use the in-place
-	 * partial string split twice. By maintaining begin and end pointers to each measure line
-	 * we can perform this without copying the string at all. */
-	int size = -1;
-	const int end = start + len;
+	/* Measures are split on ',' and lines on '\n' with memchr, which the C
+	 * library vectorizes, and nothing is copied: each line is kept as a pair
+	 * of pointers into the string.  Rows come out in order, so notes are
+	 * appended to their tracks without searching them, and the hold head a
+	 * '3' ends is remembered instead of searched for. */
+	const char *pMeasure = sSMNoteData.data() + start;
+	const char *const pEnd = pMeasure + len;
+
+	/* Set the hold note to have infinite length. We'll clamp
+	 * it when we hit the tail. */
+	TapNote holdHead = TAP_ORIGINAL_HOLD_HEAD;
+	holdHead.iDuration = MAX_NOTE_ROW;
+	TapNote rollHead = TAP_ORIGINAL_ROLL_HEAD;
+	rollHead.iDuration = MAX_NOTE_ROW;
+
+	/* The note for each character.  '0', '3', and invalid data are null.
+	 * We don't want to assert on invalid data, since there might simply be
+	 * invalid data in an .SM, and we don't want to die due to invalid data. */
+	const TapNote *apNotes[256] = {};
+	apNotes[uint8_t('1')] = &TAP_ORIGINAL_TAP;
+	apNotes[uint8_t('2')] = &holdHead;
+	apNotes[uint8_t('4')] = &rollHead;
+	// apNotes[uint8_t('N')] = &mineHead; // upcoming code for minefields -aj
+	// Don't be loose with the definition.  Use only 'M' since
+	// that's what we've been writing to disk.  -Chris
+	apNotes[uint8_t('M')] = &TAP_ORIGINAL_MINE;
+	// apNotes[uint8_t('A')] = &TAP_ORIGINAL_ATTACK;
+	apNotes[uint8_t('K')] = &TAP_ORIGINAL_AUTO_KEYSOUND;
+	apNotes[uint8_t('L')] = &TAP_ORIGINAL_LIFT;
+	apNotes[uint8_t('F')] = &TAP_ORIGINAL_FAKE;
+	// apNotes[uint8_t('I')] = &TAP_ORIGINAL_ITEM;
+
+	// Most lines are empty rows; those are skipped with one comparison.
+	const RString sEmptyRow( iNumTracks, '0' );
+	std::vector<int> vLastRow( iNumTracks, -1 );
+	std::vector<int> vOpenHeadRow( iNumTracks, -1 );
 	std::vector<std::pair<const char*, const char*> > aMeasureLines;
-	for( unsigned m = 0; true; ++m )
+
+	for( unsigned m = 0; pMeasure < pEnd; ++pMeasure )
 	{
+		const char *pMeasureEnd = static_cast<const char *>( memchr(pMeasure, ',', pEnd - pMeasure) );
+		if( pMeasureEnd == nullptr )
+			pMeasureEnd = pEnd;
 		/* XXX Ignoring empty seems wrong for measures. It means that ",,," is treated as
 		 * "," where I would expect most people would want 2 empty measures. ",\n,\n,"
 		 * would do as I would expect. */
-		split( sSMNoteData, ",", start, size, end, true ); // Ignore empty is important.
-		if( start == end )
-		{
-			break;
-		}
-		// Partial string split.
-		int measureLineStart = start, measureLineSize = -1;
-		const int measureEnd = start + size;
+		if( pMeasureEnd == pMeasure )
+			continue;
 
 		aMeasureLines.clear();
-		for(;;)
+		for( const char *pLine = pMeasure; pLine < pMeasureEnd; )
 		{
-			// Ignore empty is clearly important here.
-			split( sSMNoteData, "\n", measureLineStart, measureLineSize, measureEnd, true );
-			if( measureLineStart == measureEnd )
-			{
-				break;
-			}
-			//RString &line = sSMNoteData.substr( measureLineStart, measureLineSize );
-			const char *beginLine = sSMNoteData.data() + measureLineStart;
-			const char *endLine = beginLine + measureLineSize;
+			const char *pLineEnd = static_cast<const char *>( memchr(pLine, '\n', pMeasureEnd - pLine) );
+			if( pLineEnd == nullptr )
+				pLineEnd = pMeasureEnd;
 
-			while( beginLine < endLine && strchr("\r\n\t ", *beginLine) )
+			const char *beginLine = pLine;
+			const char *endLine = pLineEnd;
+			while( beginLine < endLine && IsSMNoteDataSpace(*beginLine) )
 				++beginLine;
-			while( endLine > beginLine && strchr("\r\n\t ", *(endLine - 1)) )
+			while( endLine > beginLine && IsSMNoteDataSpace(*(endLine - 1)) )
 				--endLine;
 			if( beginLine < endLine ) // nonempty
 				aMeasureLines.push_back( std::pair<const char*, const char*>(beginLine, endLine) );
+			pLine = pLineEnd + 1;
 		}
 
 		for( unsigned l=0; l<aMeasureLines.size(); l++ )
@@ -109,107 +161,25 @@ static void LoadFromSMNoteDataStringWithPlayer( NoteData& out, const RString &sS
 			const char *const beginLine = p;
 			const char *const endLine = aMeasureLines[l].second;
 
+			if( endLine - beginLine == iNumTracks && memcmp(beginLine, sEmptyRow.data(), iNumTracks) == 0 )
+				continue;
+
 			const float fPercentIntoMeasure = l/(float)aMeasureLines.size();
 			const float fBeat = (m + fPercentIntoMeasure) * BEATS_PER_MEASURE;
 			const int iIndex = BeatToNoteRow( fBeat );
 
-			int iTrack = 0;
-			while( iTrack < iNumTracks && p < endLine )
+			for( int iTrack = 0; iTrack < iNumTracks && p < endLine; iTrack++ )
 			{
-				TapNote tn;
-				char ch = *p;
-
-				switch( ch )
-				{
-				case '0': tn = TAP_EMPTY;				break;
-				case '1': tn = TAP_ORIGINAL_TAP;			break;
-				case '2':
-				case '4':
-				// case 'N': // minefield
-					tn = ch == '2' ? TAP_ORIGINAL_HOLD_HEAD : TAP_ORIGINAL_ROLL_HEAD;
-					/*
-					// upcoming code for minefields -aj
-					switch(ch)
-					{
-					case '2': tn = TAP_ORIGINAL_HOLD_HEAD; break;
-					case '4': tn = TAP_ORIGINAL_ROLL_HEAD; break;
-					case 'N': tn = TAP_ORIGINAL_MINE_HEAD; break;
-					}
-					*/
-
-					/* Set the hold note to have infinite length. We'll clamp
-					 * it when we hit the tail. */
-					tn.iDuration = MAX_NOTE_ROW;
-					break;
-				case '3':
-				{
-					// This is the end of a hold. Search for the beginning.
-					int iHeadRow;
-					if( !out.IsHoldNoteAtRow( iTrack, iIndex, &iHeadRow ) )
-					{
-						int n = std::intptr_t(endLine) - std::intptr_t(beginLine);
-						LOG->Warn( "Unmatched 3 in \"%.*s\"", n, beginLine );
-					}
-					else
-					{
-						out.FindTapNote( iTrack, iHeadRow )->second.iDuration = iIndex - iHeadRow;
-					}
-
-					// This won't write tn, but keep parsing normally anyway.
-					break;
-				}
-				//				case 'm':
-				// Don't be loose with the definition.  Use only 'M' since
-				// that's what we've been writing to disk.  -Chris
-				case 'M': tn = TAP_ORIGINAL_MINE;			break;
-				// case 'A': tn = TAP_ORIGINAL_ATTACK;			break;
-				case 'K': tn = TAP_ORIGINAL_AUTO_KEYSOUND;		break;
-				case 'L': tn = TAP_ORIGINAL_LIFT;			break;
-				case 'F': tn = TAP_ORIGINAL_FAKE;			break;
-				// case 'I': tn = TAP_ORIGINAL_ITEM;			break;
-				default:
-					/* Invalid data. We don't want to assert, since there might
-					 * simply be invalid data in an .SM, and we don't want to die
-					 * due to invalid data. We should probably check for this when
-					 * we load SM data for the first time ... */
-					// FAIL_M("Invalid data in SM");
-					tn = TAP_EMPTY;
-					break;
-				}
-
-				p++;
-				// We won't scan past the end of the line so these are safe to do.
-#if 0
-				// look for optional attack info (e.g. "{tipsy,50% drunk:15.2}")
-				if( *p == '{' )
-				{
-					p++;
-
-					char szModifiers[256] = "";
-					float fDurationSeconds = 0;
-					if( sscanf( p, "%255[^:]:%f}", szModifiers, &fDurationSeconds ) == 2 )	// not fatal if this fails due to malformed data
-					{
-						tn.type = TapNoteType_Attack;
-						tn.sAttackModifiers = szModifiers;
-		 				tn.fAttackDurationSeconds = fDurationSeconds;
-					}
-
-					// skip past the '}'
-					while( p < endLine )
-					{
-						if( *(p++) == '}' )
-							break;
-					}
-				}
-#endif
+				const char ch = *p++;
+				const TapNote *pNote = apNotes[uint8_t(ch)];
 
 				// look for optional keysound index (e.g. "[123]")
-				if( *p == '[' )
+				int iKeysoundIndex = -1;
+				if( p < endLine && *p == '[' )
 				{
 					p++;
-					int iKeysoundIndex = 0;
-					if( 1 == sscanf( p, "%d]", &iKeysoundIndex ) )	// not fatal if this fails due to malformed data
-		 				tn.iKeysoundIndex = iKeysoundIndex;
+					if( 1 != sscanf( p, "%d]", &iKeysoundIndex ) )	// not fatal if this fails due to malformed data
+						iKeysoundIndex = -1;
 
 					// skip past the ']'
 					while( p < endLine )
@@ -219,54 +189,78 @@ static void LoadFromSMNoteDataStringWithPlayer( NoteData& out, const RString &sS
 					}
 				}
 
-#if 0
-				// look for optional item name (e.g. "<potion>"),
-				// where the name in the <> is a Lua function defined elsewhere
-				// (Data/ItemTypes.lua, perhaps?) -aj
-				if( *p == '<' )
-				{
-					p++;
+				/* A measure with more lines than rows puts some of them on the
+				 * same row (or the first row of the next measure), and a later
+				 * one replaces an earlier one.  Those take the slow way. */
+				const bool bInOrder = iIndex > vLastRow[iTrack];
 
-					// skip past the '>'
-					while( p < endLine )
+				if( ch == '3' )
+				{
+					// This is the end of a hold. Search for the beginning.
+					int iHeadRow = vOpenHeadRow[iTrack];
+					if( !bInOrder && !out.IsHoldNoteAtRow(iTrack, iIndex, &iHeadRow) )
+						iHeadRow = -1;
+					if( iHeadRow == -1 )
 					{
-						if( *(p++) == '>' )
-							break;
+						int n = std::intptr_t(endLine) - std::intptr_t(beginLine);
+						LOG->Warn( "Unmatched 3 in \"%.*s\"", n, beginLine );
+					}
+					else
+					{
+						out.FindTapNote( iTrack, iHeadRow )->second.iDuration = iIndex - iHeadRow;
+						vOpenHeadRow[iTrack] = bInOrder? -1:FindOpenHoldHead( out, iTrack );
+						// Another 3 on this row would end the same hold again.
+						vLastRow[iTrack] = std::max( vLastRow[iTrack], iIndex );
 					}
+					continue;
 				}
-#endif
 
 				/* Optimization: if we pass TAP_EMPTY, NoteData will do a search
 				 * to remove anything in this position.  We know that there's nothing
 				 * there, so avoid the search. */
-				if( tn.type != TapNoteType_Empty && ch != '3' )
+				if( pNote == nullptr )
+					continue;
+
+				TapNote tn = *pNote;
+				tn.pn = pn;
+				if( iKeysoundIndex != -1 )
+					tn.iKeysoundIndex = iKeysoundIndex;
+				if( bInOrder )
+				{
+					out.AppendTapNote( iTrack, iIndex, tn );
+					vLastRow[iTrack] = iIndex;
+					if( tn.type == TapNoteType_HoldHead )
+						vOpenHeadRow[iTrack] = iIndex;
+					else if( tn.type != TapNoteType_AutoKeysound )
+						vOpenHeadRow[iTrack] = -1;
+				}
+				else
 				{
-					tn.pn = pn;
 					out.SetTapNote( iTrack, iIndex, tn );
+					vOpenHeadRow[iTrack] = FindOpenHoldHead( out, iTrack );
 				}
-
-				iTrack++;
 			}
 		}
+
+		++m;
+		pMeasure = pMeasureEnd;
 	}
 
 	// Make sure we don't have any hold notes that didn't find a tail.
 	for( int t=0; t<out.GetNumTracks(); t++ )
 	{
 		NoteData::iterator begin = out.begin( t );
-		NoteData::iterator lEnd = out.end( t );
-		while( begin != lEnd )
+		while( begin != out.end(t) )
 		{
-			NoteData::iterator next = Increment( begin );
 			const TapNote &tn = begin->second;
 			if( tn.type == TapNoteType_HoldHead && tn.iDuration == MAX_NOTE_ROW )
 			{
 				int iRow = begin->first;
 				LOG->UserLog( "", "", "While loading .sm/.ssc note data, there was an unmatched 2 at beat %f", NoteRowToBeat(iRow) );
-				out.RemoveTapNote( t, begin );
+				begin = out.RemoveTapNote( t, begin );
 			}
-
-			begin = next;
+			else
+				++begin;
 		}
 	}
 	out.RevalidateATIs(std::vector<int>(), false);
@@ -327,6 +321,9 @@ void NoteDataUtil::InsertHoldTails( NoteData &inout )
 {
 	for( int t=0; t < inout.GetNumTracks(); t++ )
 	{
+		// Adding the tails while walking the track would invalidate our
+		// iterators, so find them all first.
+		std::vector<std::pair<int, TapNote>> vTails;
 		NoteData::iterator begin = inout.begin(t), end = inout.end(t);
 
 		for( ; begin != end; ++begin )
@@ -339,12 +336,15 @@ void NoteDataUtil::InsertHoldTails( NoteData &inout )
 			TapNote tail = tn;
 			tail.type = TapNoteType_HoldTail;
 
-			/* If iDuration is 0, we'd end up overwriting the head with the tail
-			 * (and invalidating our iterator). Empty hold notes aren't valid. */
+			/* If iDuration is 0, we'd end up overwriting the head with the tail.
+			 * Empty hold notes aren't valid. */
 			ASSERT( tn.iDuration != 0 );
 
-			inout.SetTapNote( t, iRow + tn.iDuration, tail );
+			vTails.emplace_back( iRow + tn.iDuration, tail );
 		}
+
+		for( auto const &tail : vTails )
+			inout.SetTapNote( t, tail.first, tail.second );
 	}
 }
 
@@ -1002,6 +1002,7 @@ struct recent_note
 struct crv_state
 {
 	bool judgable;
+	int row;
 	// hold_ends tracks where currently active holds will end, which is used
 	// to count the number of hands. -Kyz
 	std::vector<int> hold_ends;
@@ -1011,28 +1012,50 @@ struct crv_state
 	int num_notes_on_curr_row;
 
 	crv_state()
-		:judgable(false), num_holds_on_curr_row(0), num_notes_on_curr_row(0)
+		:judgable(false), row(-1), num_holds_on_curr_row(0), num_notes_on_curr_row(0)
 	{}
 };
 
-static void DoRowEndRadarCalc(crv_state& state, RadarValues& out)
+static void DoRowEndRadarCalc(crv_state& state, ChartStats& stats)
 {
 	if(state.judgable)
 	{
-		if(state.num_notes_on_curr_row + (state.hold_ends.size() -
-				state.num_holds_on_curr_row) >= 3)
+		const std::size_t pressed= state.num_notes_on_curr_row +
+			(state.hold_ends.size() - state.num_holds_on_curr_row);
+		if(pressed >= 3)
+		{
+			++stats.m_Radar[RadarCategory_Hands];
+		}
+		if(pressed >= 4)
 		{
-			++out[RadarCategory_Hands];
+			++stats.m_iQuads;
+		}
+		if(state.num_notes_on_curr_row > 0)
+		{
+			const std::size_t measure= state.row / ROWS_PER_MEASURE;
+			if(measure >= stats.m_vNotesPerMeasure.size())
+			{
+				stats.m_vNotesPerMeasure.resize(measure + 1, 0);
+			}
+			++stats.m_vNotesPerMeasure[measure];
 		}
 	}
 }
 
 void NoteDataUtil::CalculateRadarValues( const NoteData &in, float fSongSeconds, RadarValues& out )
+{
+	ChartStats stats;
+	CalculateChartStats(in, fSongSeconds, stats);
+	out= stats.m_Radar;
+}
+
+void NoteDataUtil::CalculateChartStats( const NoteData &in, float fSongSeconds, ChartStats& stats )
 {
 	// Anybody editing this function should also examine
 	// NoteDataWithScoring::GetActualRadarValues to make sure it handles things
 	// the same way.
-	out.Zero();
+	stats.Zero();
+	RadarValues& out= stats.m_Radar;
 	int curr_row= -1;
 	// recent_notes is used to calculate the voltage.  Each element is the row
 	// and track number of a tap note.  When the pair at the beginning is too
@@ -1055,8 +1078,9 @@ void NoteDataUtil::CalculateRadarValues( const NoteData &in, float fSongSeconds,
 	{
 		if(curr_note.Row() != curr_row)
 		{
-			DoRowEndRadarCalc(state, out);
+			DoRowEndRadarCalc(state, stats);
 			curr_row= curr_note.Row();
+			state.row= curr_row;
 			state.num_notes_on_curr_row= 0;
 			state.num_holds_on_curr_row= 0;
 			state.judgable= timing->IsJudgableAtRow(curr_row);
@@ -1159,7 +1183,24 @@ void NoteDataUtil::CalculateRadarValues( const NoteData &in, float fSongSeconds,
 		}
 		++curr_note;
 	}
-	DoRowEndRadarCalc(state, out);
+	DoRowEndRadarCalc(state, stats);
+	GetStreamBreakdown(stats.m_vNotesPerMeasure, DEFAULT_STREAM_NOTES_PER_MEASURE,
+		stats.m_vStreams);
+	for(std::size_t m= 0; m < stats.m_vNotesPerMeasure.size(); ++m)
+	{
+		if(stats.m_vNotesPerMeasure[m] == 0)
+		{
+			continue;
+		}
+		const float seconds=
+			timing->GetElapsedTimeFromBeatNoOffset(float((m+1) * BEATS_PER_MEASURE)) -
+			timing->GetElapsedTimeFromBeatNoOffset(float(m * BEATS_PER_MEASURE));
+		if(seconds > 0.0f)
+		{
+			stats.m_fPeakNPS= std::max(stats.m_fPeakNPS,
+				stats.m_vNotesPerMeasure[m] / seconds);
+		}
+	}
 
 	// Walking the notes complete, now assign any values that remain. -Kyz
 	if(fSongSeconds > 0.0f)
@@ -1358,7 +1399,7 @@ void NoteDataUtil::RemoveAllButPlayer( NoteData &inout, PlayerNumber pn )
 		while( i != inout.end(track) )
 		{
 			if( i->second.pn != pn && i->second.pn != PLAYER_INVALID )
-				inout.RemoveTapNote( track, i++ );
+				i = inout.RemoveTapNote( track, i );
 			else
 				++i;
 		}
@@ -2213,30 +2254,28 @@ static void SuperShuffleTaps( NoteData &inout, int iStartIndex, int iEndIndex )
 
 void NoteDataUtil::Turn( NoteData &inout, StepsType st, TrackMapping tt, int iStartIndex, int iEndIndex )
 {
-	NoteData tempNoteData;
-
 	if( tt == hyper_shuffle )
 	{
 		// HyperShuffle doesn't require a column transformation beforehand, so there's no point
 		// in wasting time doing that.
-		tempNoteData.CopyAll(inout);
-		HyperShuffleNotes( tempNoteData, iStartIndex, iEndIndex );
+		HyperShuffleNotes( inout, iStartIndex, iEndIndex );
 	}
 	else
 	{
 		// Calculate how the columns should be rearranged, and then do it.
+		// Only the notes in the range move, so an attack doesn't turn the
+		// whole chart.  Holds crossing its edges are cut there.
 		int iTakeFromTrack[MAX_NOTE_TRACKS];	// New track "t" will take from old track iTakeFromTrack[t]
 		GetTrackMapping( st, tt, inout.GetNumTracks(), iTakeFromTrack );
 
-		tempNoteData.LoadTransformed( inout, inout.GetNumTracks(), iTakeFromTrack );
+		inout.RemapTracks( iTakeFromTrack, iStartIndex, iEndIndex );
 
 		// SuperShuffle doesn't affect holds, it instead relies on a regular shuffle to do them first.
 		// Then it SuperShuffles everything else.
 		if( tt == super_shuffle )
-			SuperShuffleTaps( tempNoteData, iStartIndex, iEndIndex );
+			SuperShuffleTaps( inout, iStartIndex, iEndIndex );
 	}
 
-	inout.CopyAll( tempNoteData );
 	inout.RevalidateATIs(std::vector<int>(), false);
 }
 
@@ -3026,18 +3065,94 @@ void NoteDataUtil::TransformNoteData(NoteData &nd, TimingData const& timing_data
 	}
 }
 
+/* The remove transforms that only look at one note at a time, in the order
+ * TransformNoteData applies them. */
+static const PlayerOptions::Transform g_PerNoteTransforms[] =
+{
+	PlayerOptions::TRANSFORM_LITTLE,
+	PlayerOptions::TRANSFORM_NOROLLS,
+	PlayerOptions::TRANSFORM_NOHOLDS,
+	PlayerOptions::TRANSFORM_NOMINES,
+	PlayerOptions::TRANSFORM_NOLIFTS,
+	PlayerOptions::TRANSFORM_NOFAKES,
+};
+
+/* Apply the transforms in abTransforms from g_PerNoteTransforms in one walk
+ * over each track, instead of one walk (and one map search per note) each.
+ * Since each of them looks at a note by itself, doing them all to one note
+ * before moving to the next gives the same result. */
+static void ApplyPerNoteTransforms( NoteData &nd, TimingData const& timing_data, const bool abTransforms[PlayerOptions::NUM_TRANSFORMS], int iStartIndex, int iEndIndex )
+{
+	const bool bLittle = abTransforms[PlayerOptions::TRANSFORM_LITTLE];
+	const bool bNoRolls = abTransforms[PlayerOptions::TRANSFORM_NOROLLS];
+	const bool bNoHolds = abTransforms[PlayerOptions::TRANSFORM_NOHOLDS];
+	const bool bNoMines = abTransforms[PlayerOptions::TRANSFORM_NOMINES];
+	const bool bNoLifts = abTransforms[PlayerOptions::TRANSFORM_NOLIFTS];
+	const bool bNoFakes = abTransforms[PlayerOptions::TRANSFORM_NOFAKES];
+	if( !bLittle && !bNoRolls && !bNoHolds && !bNoMines && !bNoLifts && !bNoFakes )
+		return;
+
+	for( int t=0; t<nd.GetNumTracks(); t++ )
+	{
+		// Like ChangeRollsToHolds and RemoveHoldNotes, this includes a hold
+		// from before the range that reaches into it, but only converts it.
+		// Removing from a flat track moves the notes after it, so check
+		// against the end of the range by row, not with an iterator.
+		NoteData::TrackMap::iterator iter, end;
+		nd.GetTapNoteRangeInclusive( t, iStartIndex, iEndIndex, iter, end );
+		while( iter != nd.end(t) && iter->first < iEndIndex )
+		{
+			const int iRow = iter->first;
+			TapNote &tn = iter->second;
+
+			if( tn.type == TapNoteType_HoldHead )
+			{
+				if( bNoRolls && tn.subType == TapNoteSubType_Roll )
+					tn.subType = TapNoteSubType_Hold;
+				if( bNoHolds && tn.subType == TapNoteSubType_Hold )
+					tn.type = TapNoteType_Tap;
+			}
+
+			bool bRemove = false;
+			if( iRow >= iStartIndex )
+			{
+				bRemove |= bLittle && iRow % ROWS_PER_BEAT != 0;
+				bRemove |= bNoMines && tn.type == TapNoteType_Mine;
+				bRemove |= bNoLifts && tn.type == TapNoteType_Lift;
+				bRemove |= bNoFakes && (tn.type == TapNoteType_Fake || !timing_data.IsJudgableAtRow(iRow));
+			}
+
+			if( bRemove )
+				iter = nd.RemoveTapNote( t, iter );
+			else
+				++iter;
+		}
+	}
+}
+
 void NoteDataUtil::TransformNoteData( NoteData &nd, TimingData const& timing_data, const PlayerOptions &po, StepsType st, int iStartIndex, int iEndIndex )
 {
 	// Apply remove transforms before others so that we don't go removing
 	// notes we just inserted.  Apply TRANSFORM_NOROLLS before TRANSFORM_NOHOLDS,
 	// since NOROLLS creates holds.
-	if( po.m_bTransforms[PlayerOptions::TRANSFORM_LITTLE] )		NoteDataUtil::Little( nd, iStartIndex, iEndIndex );
-	if( po.m_bTransforms[PlayerOptions::TRANSFORM_NOROLLS] )	NoteDataUtil::ChangeRollsToHolds( nd, iStartIndex, iEndIndex );
-	if( po.m_bTransforms[PlayerOptions::TRANSFORM_NOHOLDS] )	NoteDataUtil::RemoveHoldNotes( nd, iStartIndex, iEndIndex );
-	if( po.m_bTransforms[PlayerOptions::TRANSFORM_NOMINES] )	NoteDataUtil::RemoveMines( nd, iStartIndex, iEndIndex );
+	//
+	// The ones that only look at one note at a time are done together.
+	// NoJumps counts the notes on each row and the holds over it, so it has
+	// to see the notes NoLifts and NoFakes would remove after it; when it's
+	// on, they're done in a second walk after it.
+	bool abPerNote[PlayerOptions::NUM_TRANSFORMS] = { false };
+	bool abAfterJumps[PlayerOptions::NUM_TRANSFORMS] = { false };
+	for( PlayerOptions::Transform tr : g_PerNoteTransforms )
+		abPerNote[tr] = po.m_bTransforms[tr];
+	if( po.m_bTransforms[PlayerOptions::TRANSFORM_NOJUMPS] )
+	{
+		std::swap( abPerNote[PlayerOptions::TRANSFORM_NOLIFTS], abAfterJumps[PlayerOptions::TRANSFORM_NOLIFTS] );
+		std::swap( abPerNote[PlayerOptions::TRANSFORM_NOFAKES], abAfterJumps[PlayerOptions::TRANSFORM_NOFAKES] );
+	}
+
+	ApplyPerNoteTransforms( nd, timing_data, abPerNote, iStartIndex, iEndIndex );
 	if( po.m_bTransforms[PlayerOptions::TRANSFORM_NOJUMPS] )	NoteDataUtil::RemoveJumps( nd, iStartIndex, iEndIndex );
-	if( po.m_bTransforms[PlayerOptions::TRANSFORM_NOLIFTS] )	NoteDataUtil::RemoveLifts( nd, iStartIndex, iEndIndex );
-	if( po.m_bTransforms[PlayerOptions::TRANSFORM_NOFAKES] )	NoteDataUtil::RemoveFakes( nd, timing_data, iStartIndex, iEndIndex );
+	ApplyPerNoteTransforms( nd, timing_data, abAfterJumps, iStartIndex, iEndIndex );
 	if( po.m_bTransforms[PlayerOptions::TRANSFORM_NOHANDS] )	NoteDataUtil::RemoveHands( nd, iStartIndex, iEndIndex );
 	if( po.m_bTransforms[PlayerOptions::TRANSFORM_NOQUADS] )	NoteDataUtil::RemoveQuads( nd, iStartIndex, iEndIndex );
 	if( po.m_bTransforms[PlayerOptions::TRANSFORM_NOSTRETCH] )	NoteDataUtil::RemoveStretch( nd, st, iStartIndex, iEndIndex );
@@ -3197,16 +3312,15 @@ void NoteDataUtil::DeleteRows( NoteData &nd, int iStartIndex, int iRowsToDelete
 
 void NoteDataUtil::RemoveAllTapsOfType( NoteData& ndInOut, TapNoteType typeToRemove )
 {
-	/* Be very careful when deleting the tap notes. Erasing elements from maps using
-	 * iterators invalidates only the iterator that is being erased. To that end,
-	 * increment the iterator before deleting the elment of the map.
-	 */
+	/* Be very careful when deleting the tap notes. Erasing an element can
+	 * invalidate the iterators after it, so carry on from the iterator
+	 * RemoveTapNote returns. */
 	for( int t=0; t<ndInOut.GetNumTracks(); t++ )
 	{
 		for( NoteData::iterator iter = ndInOut.begin(t); iter != ndInOut.end(t); )
 		{
 			if( iter->second.type == typeToRemove )
-				ndInOut.RemoveTapNote( t, iter++ );
+				iter = ndInOut.RemoveTapNote( t, iter );
 			else
 				++iter;
 		}
@@ -3222,7 +3336,7 @@ void NoteDataUtil::RemoveAllTapsExceptForType( NoteData& ndInOut, TapNoteType ty
 		for( NoteData::iterator iter = ndInOut.begin(t); iter != ndInOut.end(t); )
 		{
 			if( iter->second.type != typeToKeep )
-				ndInOut.RemoveTapNote( t, iter++ );
+				iter = ndInOut.RemoveTapNote( t, iter );
 			else
 				++iter;
 		}
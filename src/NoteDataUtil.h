@@ -9,6 +9,7 @@
 
 class PlayerOptions;
 struct RadarValues;
+struct ChartStats;
 class NoteData;
 class Song;
 struct AttackArray;
@@ -58,6 +59,8 @@ namespace NoteDataUtil
 	void AutogenKickbox(const NoteData& in, NoteData& out, const TimingData& timing, StepsType out_type, int nonrandom_seed);
 
 	void CalculateRadarValues( const NoteData &in, float fSongSeconds, RadarValues& out );
+	/** @brief Work out the radar values and the rest of the ChartStats in one pass. */
+	void CalculateChartStats( const NoteData &in, float fSongSeconds, ChartStats& out );
 
 	/**
 	 * @brief Remove all of the Hold notes.
@@ -4,6 +4,7 @@
 
 #include "ActorUtil.h"
 #include "ArrowEffects.h"
+#include "GameplayBenchmark.h"
 #include "GameState.h"
 #include "GhostArrowRow.h"
 #include "LuaBinding.h"
@@ -23,6 +24,7 @@
 #include "calm/drawables/CalmDrawableFactory.h"
 #include "calm/RageAdapter.h"
 
+#include <algorithm>
 #include <cmath>
 #include <cstdint>
 #include <vector>
@@ -480,31 +482,140 @@ bool NoteDisplay::IsOnScreen( float fBeat, int iCol, int iDrawDistanceAfterTarge
 	return true;
 }
 
+void NoteDisplay::note_positions::resize(std::size_t size)
+{
+	beats.resize(size);
+	y_offsets.resize(size);
+	if(size > past_peaks_size)
+	{
+		past_peaks.reset(new bool[size]);
+		past_peaks_size= size;
+	}
+}
+
+void NoteDisplay::note_effects::resize(std::size_t size)
+{
+	x.resize(size);
+	y.resize(size);
+	z.resize(size);
+	rot_x.resize(size);
+	rot_y.resize(size);
+	rot_z.resize(size);
+	zoom.resize(size);
+	alpha.resize(size);
+	glow.resize(size);
+}
+
+static bool SplineModeUsesArrowEffects(const NCSplineHandler* handler)
+{
+	return handler->m_spline_mode == NCSM_Disabled ||
+		handler->m_spline_mode == NCSM_Offset;
+}
+
+static bool SplineModeUsesSpline(const NCSplineHandler* handler)
+{
+	return handler->m_spline_mode == NCSM_Offset ||
+		handler->m_spline_mode == NCSM_Position;
+}
+
+void NoteDisplay::GetTapEffects(const NoteFieldRenderArgs& field_args,
+	const NoteColumnRenderArgs& column_args, int num_taps)
+{
+	GameplayBenchmark::StageTimer timer( BenchmarkStage_ArrowEffects );
+
+	// Taps are never hold heads or caps, and they fade with the rest of the
+	// field unless they're in the selection, so they can all be asked about
+	// together.  Anything a spline mode leaves out is zero, as it would be
+	// in DrawActor.
+	const int col= column_args.column;
+	const float* beats= m_TapPositions.beats.data();
+	const float* y_offsets= m_TapPositions.y_offsets.data();
+	note_effects& effects= m_TapEffects;
+	effects.resize(num_taps);
+	ArrowEffects::GetAlphasAndGlows(m_pPlayerState, col, y_offsets, num_taps,
+		field_args.fail_fade, m_fYReverseOffsetPixels,
+		field_args.draw_pixels_before_targets, field_args.fade_before_targets,
+		effects.alpha.data(), effects.glow.data());
+	if(SplineModeUsesArrowEffects(column_args.pos_handler))
+	{
+		ArrowEffects::GetXPositions(m_pPlayerState, col, y_offsets, num_taps, effects.x.data());
+		ArrowEffects::GetYPositions(m_pPlayerState, col, y_offsets, num_taps, m_fYReverseOffsetPixels, effects.y.data());
+		ArrowEffects::GetZPositions(m_pPlayerState, col, y_offsets, num_taps, effects.z.data());
+		const float move_x= ArrowEffects::GetMoveX(col);
+		const float move_y= ArrowEffects::GetMoveY(col);
+		const float move_z= ArrowEffects::GetMoveZ(col);
+		for(int i= 0; i < num_taps; ++i)
+		{
+			effects.x[i]= move_x + effects.x[i];
+			effects.y[i]= move_y + effects.y[i];
+			effects.z[i]= move_z + effects.z[i];
+		}
+	}
+	else
+	{
+		std::fill(effects.x.begin(), effects.x.end(), 0.0f);
+		std::fill(effects.y.begin(), effects.y.end(), 0.0f);
+		std::fill(effects.z.begin(), effects.z.end(), 0.0f);
+	}
+	if(SplineModeUsesArrowEffects(column_args.rot_handler))
+	{
+		ArrowEffects::GetRotationsX(m_pPlayerState, y_offsets, num_taps, false, col, effects.rot_x.data());
+		ArrowEffects::GetRotationsY(m_pPlayerState, y_offsets, num_taps, col, effects.rot_y.data());
+		ArrowEffects::GetRotationsZ(m_pPlayerState, beats, num_taps, false, col, effects.rot_z.data());
+	}
+	else
+	{
+		std::fill(effects.rot_x.begin(), effects.rot_x.end(), 0.0f);
+		std::fill(effects.rot_y.begin(), effects.rot_y.end(), 0.0f);
+		std::fill(effects.rot_z.begin(), effects.rot_z.end(), 0.0f);
+	}
+	if(SplineModeUsesArrowEffects(column_args.zoom_handler))
+	{
+		ArrowEffects::GetZooms(m_pPlayerState, y_offsets, num_taps, col, effects.zoom.data());
+	}
+	else
+	{
+		std::fill(effects.zoom.begin(), effects.zoom.end(), 0.0f);
+	}
+}
+
 bool NoteDisplay::DrawHoldsInRange(const NoteFieldRenderArgs& field_args,
 	const NoteColumnRenderArgs& column_args,
 	const std::vector<NoteData::TrackMap::const_iterator>& tap_set)
 {
 	bool any_upcoming = false;
-	for(std::vector<NoteData::TrackMap::const_iterator>::const_iterator tapit=
-		tap_set.begin(); tapit != tap_set.end(); ++tapit)
+
+	// Work out where the heads and tails are all at once.
+	const int num_holds= tap_set.size();
+	note_positions& starts= m_HoldStartPositions;
+	note_positions& ends= m_HoldEndPositions;
+	starts.resize(num_holds);
+	ends.resize(num_holds);
+	for(int i= 0; i < num_holds; ++i)
+	{
+		int start_row= tap_set[i]->first;
+		starts.beats[i]= NoteRowToVisibleBeat(m_pPlayerState, start_row);
+		ends.beats[i]= NoteRowToVisibleBeat(m_pPlayerState, start_row + tap_set[i]->second.iDuration);
+	}
+	ArrowEffects::GetYOffsets(m_pPlayerState, column_args.column,
+		starts.beats.data(), num_holds, starts.y_offsets.data(), starts.past_peaks.get());
+	ArrowEffects::GetYOffsets(m_pPlayerState, column_args.column,
+		ends.beats.data(), num_holds, ends.y_offsets.data(), ends.past_peaks.get());
+
+	for(int i= 0; i < num_holds; ++i)
 	{
-		const TapNote& tn= (*tapit)->second;
+		const TapNote& tn= tap_set[i]->second;
 		const HoldNoteResult& result= tn.HoldResult;
-		int start_row= (*tapit)->first;
+		int start_row= tap_set[i]->first;
 		int end_row = start_row + tn.iDuration;
 
 		// TRICKY: If boomerang is on, then all notes in the range
 		// [first_row,last_row] aren't necessarily visible.
 		// Test every note to make sure it's on screen before drawing
-		float throw_away;
-		bool start_past_peak = false;
-		bool end_past_peak = false;
-		float start_y	= ArrowEffects::GetYOffset(m_pPlayerState, column_args.column,
-			NoteRowToVisibleBeat(m_pPlayerState, start_row), throw_away,
-			start_past_peak);
-		float end_y	= ArrowEffects::GetYOffset(m_pPlayerState, column_args.column,
-			NoteRowToVisibleBeat(m_pPlayerState, end_row), throw_away,
-			end_past_peak);
+		const bool start_past_peak = starts.past_peaks[i];
+		const bool end_past_peak = ends.past_peaks[i];
+		const float start_y= starts.y_offsets[i];
+		const float end_y= ends.y_offsets[i];
 		bool tail_visible = field_args.draw_pixels_after_targets <= end_y &&
 			end_y <= field_args.draw_pixels_before_targets;
 		bool head_visible = field_args.draw_pixels_after_targets <= start_y  &&
@@ -552,16 +663,31 @@ bool NoteDisplay::DrawTapsInRange(const NoteFieldRenderArgs& field_args,
 {
 	bool any_upcoming= false;
 
-	auto loop_body = [this, &field_args, &column_args, &any_upcoming](const NoteData::TrackMap::const_iterator& tapit)
+	// Work out where the notes are all at once, for both the test below and
+	// drawing them.
+	const int num_taps= tap_set.size();
+	m_TapPositions.resize(num_taps);
+	std::vector<float>& beats= m_TapPositions.beats;
+	std::vector<float>& y_offsets= m_TapPositions.y_offsets;
+	for(int i= 0; i < num_taps; ++i)
+	{
+		beats[i]= NoteRowToVisibleBeat(m_pPlayerState, tap_set[i]->first);
+	}
+	ArrowEffects::GetYOffsets(m_pPlayerState, column_args.column,
+		beats.data(), num_taps, y_offsets.data());
+	GetTapEffects(field_args, column_args, num_taps);
+
+	auto loop_body = [this, &field_args, &column_args, &any_upcoming, &tap_set, &beats, &y_offsets](int i)
 	{
-		int tap_row= tapit->first;
-		const TapNote& tn= tapit->second;
+		int tap_row= tap_set[i]->first;
+		const TapNote& tn= tap_set[i]->second;
 
 		// TRICKY: If boomerang is on, then all notes in the range
 		// [first_row,last_row] aren't necessarily visible.
 		// Test every note to make sure it's on screen before drawing.
-		if(!IsOnScreen(NoteRowToBeat(tap_row), column_args.column,
-				field_args.draw_pixels_after_targets, field_args.draw_pixels_before_targets))
+		// This is IsOnScreen, with the offset worked out above.
+		if(y_offsets[i] > field_args.draw_pixels_before_targets ||
+			y_offsets[i] < field_args.draw_pixels_after_targets)
 		{
 			return; // skip
 		}
@@ -616,12 +742,26 @@ bool NoteDisplay::DrawTapsInRange(const NoteFieldRenderArgs& field_args,
 				tap_row < *field_args.selection_end_marker;
 		}
 
+		// Notes in the selection glow instead of fading, so they ask
+		// ArrowEffects for themselves.
+		NoteArrowEffects effects;
+		const NoteArrowEffects* precomputed= nullptr;
+		if(!in_selection_range)
+		{
+			effects.pos= RageVector3(m_TapEffects.x[i], m_TapEffects.y[i], m_TapEffects.z[i]);
+			effects.rot= RageVector3(m_TapEffects.rot_x[i], m_TapEffects.rot_y[i], m_TapEffects.rot_z[i]);
+			effects.zoom= m_TapEffects.zoom[i];
+			effects.alpha= m_TapEffects.alpha[i];
+			effects.glow= m_TapEffects.glow[i];
+			precomputed= &effects;
+		}
+
 		bool is_addition = (tn.source == TapNoteSource_Addition);
-		DrawTap(tn, field_args, column_args,
-			NoteRowToVisibleBeat(m_pPlayerState, tap_row),
+		DrawTap(tn, field_args, column_args, beats[i], y_offsets[i],
 			hold_begins_on_this_beat, roll_begins_on_this_beat,
 			is_addition,
-			in_selection_range ? field_args.selection_glow : field_args.fail_fade);
+			in_selection_range ? field_args.selection_glow : field_args.fail_fade,
+			precomputed);
 
 		any_upcoming |= NoteRowToBeat(tap_row) >
 			m_pPlayerState->GetDisplayedPosition().m_fSongBeat;
@@ -646,12 +786,18 @@ bool NoteDisplay::DrawTapsInRange(const NoteFieldRenderArgs& field_args,
 	if (g_bRenderEarlierNotesOnTop.Get())
 	{
 		// draw notes from closest to furthest
-		std::for_each(tap_set.rbegin(), tap_set.rend(), loop_body);
+		for(int i= num_taps-1; i >= 0; --i)
+		{
+			loop_body(i);
+		}
 	}
 	else
 	{
 		// draw notes from furthest to closest
-		std::for_each(tap_set.begin(), tap_set.end(), loop_body);
+		for(int i= 0; i < num_taps; ++i)
+		{
+			loop_body(i);
+		}
 	}
 
 	return any_upcoming;
@@ -730,14 +876,6 @@ Sprite *NoteDisplay::GetHoldSprite( NoteColorSprite ncs[NUM_HoldType][NUM_Active
 	return pSpriteOut;
 }
 
-static float ArrowGetAlphaOrGlow( bool bGlow, const PlayerState* pPlayerState, int iCol, float fYOffset, float fPercentFadeToFail, float fYReverseOffsetPixels, float fDrawDistanceBeforeTargetsPixels, float fFadeInPercentOfDrawFar )
-{
-	if( bGlow )
-		return ArrowEffects::GetGlow(pPlayerState, iCol, fYOffset, fPercentFadeToFail, fYReverseOffsetPixels, fDrawDistanceBeforeTargetsPixels, fFadeInPercentOfDrawFar);
-	else
-		return ArrowEffects::GetAlpha(pPlayerState, iCol, fYOffset, fPercentFadeToFail, fYReverseOffsetPixels, fDrawDistanceBeforeTargetsPixels, fFadeInPercentOfDrawFar);
-}
-
 struct StripBuffer
 {
 	enum { size = 512 };
@@ -874,17 +1012,50 @@ if( DISPLAY2 ) {
 	static const RageVector3 pos_z_vec(0.0f, 0.0f, 1.0f);
 	static const RageVector3 pos_y_vec(0.0f, 1.0f, 0.0f);
 	StripBuffer queue;
+	// ArrowEffects is asked about each strip's verts all at once, before the
+	// strip is built.  A strip holds as many verts as fit in the queue, and
+	// the next one starts again from the last vert of the one before.
+	enum { max_strip_verts = StripBuffer::size / 3 };
+	float strip_ys[max_strip_verts];
+	float strip_y_offsets[max_strip_verts];
+	float strip_x_pos[max_strip_verts];
+	float strip_z_pos[max_strip_verts];
+	float strip_zooms[max_strip_verts];
+	float strip_rot_ys[max_strip_verts];
+	float strip_variable_zooms[max_strip_verts];
+	float strip_alphas[max_strip_verts];
+	int num_strip_verts = 0;
+	int strip_vert = 0;
 	for(float fY = y_start_pos; !last_vert_set; fY += part_args.y_step)
 	{
+		if(strip_vert == num_strip_verts)
+		{
+			num_strip_verts = 0;
+			strip_vert = 0;
+			for(float fStripY = fY; num_strip_verts < max_strip_verts; fStripY += part_args.y_step)
+			{
+				if(fStripY >= y_end_pos)
+				{
+					strip_ys[num_strip_verts++] = y_end_pos;
+					break;
+				}
+				strip_ys[num_strip_verts++] = fStripY;
+			}
+			GetHoldStripEffects(field_args, column_args, part_args, glow,
+				strip_ys, num_strip_verts, strip_y_offsets, strip_x_pos,
+				strip_z_pos, strip_zooms, strip_rot_ys, strip_variable_zooms,
+				strip_alphas);
+		}
+
 		if(fY >= y_end_pos)
 		{
 			fY = y_end_pos;
 			last_vert_set = true;
 		}
 
-		const float fYOffset= ArrowEffects::GetYOffsetFromYPos(column_args.column, fY, m_fYReverseOffsetPixels);
+		const float fYOffset= strip_y_offsets[strip_vert];
 
-		ae_zoom = ArrowEffects::GetZoom(m_pPlayerState, fYOffset, column_args.column);
+		ae_zoom = strip_zooms[strip_vert];
 
 		float cur_beat= part_args.top_beat;
 		if(part_args.top_beat != part_args.bottom_beat)
@@ -924,22 +1095,26 @@ if( DISPLAY2 ) {
 		// maintain the old behavior of how holds are drawn when they wave back
 		// and forth. -Kyz
 		RageVector3 render_forward(0.0f, 1.0f, 0.0f);
-		column_args.spae_pos_for_beat(m_pPlayerState, cur_beat,
-			fYOffset, m_fYReverseOffsetPixels, sp_pos, ae_pos);
 		// fX and fZ are sp_pos.x + ae_pos.x and sp_pos.z + ae_pos.z. -Kyz
-		// fY is the actual y position that should be used, not whatever spae
-		// fetched from ArrowEffects. -Kyz
+		// fY is the actual y position that should be used, not whatever
+		// ArrowEffects would give for it. -Kyz
 		switch(column_args.pos_handler->m_spline_mode)
 		{
 			case NCSM_Disabled:
+				ae_pos.x= strip_x_pos[strip_vert];
 				ae_pos.y= fY + ArrowEffects::GetMoveY(column_args.column);
+				ae_pos.z= strip_z_pos[strip_vert];
 				break;
 			case NCSM_Offset:
+				ae_pos.x= strip_x_pos[strip_vert];
 				ae_pos.y= fY + ArrowEffects::GetMoveY(column_args.column);
+				ae_pos.z= strip_z_pos[strip_vert];
+				column_args.pos_handler->EvalForBeat(column_args.song_beat, cur_beat, sp_pos);
 				column_args.pos_handler->EvalDerivForBeat(column_args.song_beat, cur_beat, sp_pos_forward);
 				RageVec3Normalize(&sp_pos_forward, &sp_pos_forward);
 				break;
 			case NCSM_Position:
+				column_args.pos_handler->EvalForBeat(column_args.song_beat, cur_beat, sp_pos);
 				ae_pos.y= 0.0f;
 				render_forward.y= 0.0f;
 				column_args.pos_handler->EvalDerivForBeat(column_args.song_beat, cur_beat, sp_pos_forward);
@@ -985,10 +1160,10 @@ if( DISPLAY2 ) {
 		{
 			case NCSM_Disabled:
 				// XXX: Actor rotations use degrees, Math uses radians. Convert here.
-				ae_rot.y= ArrowEffects::GetRotationY(m_pPlayerState, fYOffset, column_args.column) * -PI_180;
+				ae_rot.y= strip_rot_ys[strip_vert] * -PI_180;
 				break;
 			case NCSM_Offset:
-				ae_rot.y= ArrowEffects::GetRotationY(m_pPlayerState, fYOffset, column_args.column) * -PI_180;
+				ae_rot.y= strip_rot_ys[strip_vert] * -PI_180;
 				column_args.rot_handler->EvalForBeat(column_args.song_beat, cur_beat, sp_rot);
 				break;
 			case NCSM_Position:
@@ -1035,13 +1210,13 @@ if( DISPLAY2 ) {
 		// Hack: because some mods mess with the zoom, we need to compensate accordingly,
 		// or else hold ends don't look right.
 		const float fPulseInnerAdj	= ArrowEffects::GetPulseInner();
-		const float fVariableZoom	= ArrowEffects::GetZoomVariable(fYOffset, column_args.column, 1) / fPulseInnerAdj;
+		const float fVariableZoom	= strip_variable_zooms[strip_vert] / fPulseInnerAdj;
 
 		const float fDistFromTop	= (fY - y_start_pos) / ae_zoom;
 		float fTexCoordTop		= SCALE(fDistFromTop, 0, unzoomed_frame_height, rect.top, rect.bottom * fVariableZoom);
 		fTexCoordTop += add_to_tex_coord;
 
-		const float fAlpha		= ArrowGetAlphaOrGlow(glow, m_pPlayerState, column_args.column, fYOffset, part_args.percent_fade_to_fail, m_fYReverseOffsetPixels, field_args.draw_pixels_before_targets, field_args.fade_before_targets);
+		const float fAlpha		= strip_alphas[strip_vert];
 		const RageColor color= RageColor(
 			column_args.diffuse.r * color_scale,
 			column_args.diffuse.g * color_scale,
@@ -1082,7 +1257,40 @@ if( DISPLAY2 ) {
 			fY -= part_args.y_step;
 		}
 		first_vert_set= false;
+		++strip_vert;
+	}
+}
+
+void NoteDisplay::GetHoldStripEffects(const NoteFieldRenderArgs& field_args,
+	const NoteColumnRenderArgs& column_args,
+	const draw_hold_part_args& part_args, bool glow, const float* ys,
+	int num_verts, float* y_offsets, float* x_pos, float* z_pos, float* zooms,
+	float* rot_ys, float* variable_zooms, float* alphas)
+{
+	const int col= column_args.column;
+	ArrowEffects::GetYOffsetsFromYPos(col, ys, num_verts, m_fYReverseOffsetPixels, y_offsets);
+	ArrowEffects::GetZooms(m_pPlayerState, y_offsets, num_verts, col, zooms);
+	if(SplineModeUsesArrowEffects(column_args.pos_handler))
+	{
+		ArrowEffects::GetXPositions(m_pPlayerState, col, y_offsets, num_verts, x_pos);
+		ArrowEffects::GetZPositions(m_pPlayerState, col, y_offsets, num_verts, z_pos);
+		const float move_x= ArrowEffects::GetMoveX(col);
+		const float move_z= ArrowEffects::GetMoveZ(col);
+		for(int i= 0; i < num_verts; ++i)
+		{
+			x_pos[i]= move_x + x_pos[i];
+			z_pos[i]= move_z + z_pos[i];
+		}
+	}
+	if(SplineModeUsesArrowEffects(column_args.rot_handler))
+	{
+		ArrowEffects::GetRotationsY(m_pPlayerState, y_offsets, num_verts, col, rot_ys);
 	}
+	ArrowEffects::GetZoomVariables(y_offsets, num_verts, col, 1, variable_zooms);
+	ArrowEffects::GetAlphasAndGlows(m_pPlayerState, col, y_offsets, num_verts,
+		part_args.percent_fade_to_fail, m_fYReverseOffsetPixels,
+		field_args.draw_pixels_before_targets, field_args.fade_before_targets,
+		glow ? nullptr : alphas, glow ? alphas : nullptr);
 }
 
 void NoteDisplay::DrawHoldBodyInternal(std::vector<Sprite*>& sprite_top,
@@ -1303,7 +1511,7 @@ void NoteDisplay::DrawHold(const TapNote& tn,
 void NoteDisplay::DrawActor(const TapNote& tn, Actor* pActor, NotePart part,
 	const NoteFieldRenderArgs& field_args, const NoteColumnRenderArgs& column_args, float fYOffset, float fBeat,
 	bool bIsAddition, float fPercentFadeToFail, float fColorScale,
-	bool is_being_held)
+	bool is_being_held, const NoteArrowEffects* precomputed)
 {
 	if (tn.type == TapNoteType_AutoKeysound && !GAMESTATE->m_bInStepEditor) return;
 	if(fYOffset < field_args.draw_pixels_after_targets ||
@@ -1314,8 +1522,72 @@ void NoteDisplay::DrawActor(const TapNote& tn, Actor* pActor, NotePart part,
 	float spline_beat= fBeat;
 	if(is_being_held) { spline_beat= column_args.song_beat; }
 
-	const float fAlpha= ArrowEffects::GetAlpha(m_pPlayerState, column_args.column, fYOffset, fPercentFadeToFail, m_fYReverseOffsetPixels, field_args.draw_pixels_before_targets, field_args.fade_before_targets);
-	const float fGlow= ArrowEffects::GetGlow(m_pPlayerState, column_args.column, fYOffset, fPercentFadeToFail, m_fYReverseOffsetPixels, field_args.draw_pixels_before_targets, field_args.fade_before_targets);
+	bool bIsHoldHead = tn.type == TapNoteType_HoldHead;
+	bool bIsHoldCap = bIsHoldHead || tn.type == TapNoteType_HoldTail;
+
+	// same logical structure as in UpdateReceptorGhostStuff, I just haven't
+	// figured out a good way to combine them. -Kyz
+	float fAlpha;
+	float fGlow;
+	RageVector3 sp_pos;
+	RageVector3 sp_rot;
+	RageVector3 sp_zoom;
+	RageVector3 ae_pos;
+	RageVector3 ae_rot;
+	RageVector3 ae_zoom;
+	{
+		GameplayBenchmark::StageTimer timer( BenchmarkStage_ArrowEffects );
+
+		if(precomputed != nullptr)
+		{
+			fAlpha= precomputed->alpha;
+			fGlow= precomputed->glow;
+			ae_pos= precomputed->pos;
+			ae_rot= precomputed->rot;
+			ae_zoom.x= ae_zoom.y= ae_zoom.z= precomputed->zoom;
+			if(SplineModeUsesSpline(column_args.pos_handler))
+			{
+				column_args.pos_handler->EvalForBeat(column_args.song_beat, spline_beat, sp_pos);
+			}
+			if(SplineModeUsesSpline(column_args.rot_handler))
+			{
+				column_args.rot_handler->EvalForBeat(column_args.song_beat, spline_beat, sp_rot);
+			}
+			if(SplineModeUsesSpline(column_args.zoom_handler))
+			{
+				column_args.zoom_handler->EvalForBeat(column_args.song_beat, spline_beat, sp_zoom);
+			}
+		}
+		else
+		{
+			fAlpha= ArrowEffects::GetAlpha(m_pPlayerState, column_args.column, fYOffset, fPercentFadeToFail, m_fYReverseOffsetPixels, field_args.draw_pixels_before_targets, field_args.fade_before_targets);
+			fGlow= ArrowEffects::GetGlow(m_pPlayerState, column_args.column, fYOffset, fPercentFadeToFail, m_fYReverseOffsetPixels, field_args.draw_pixels_before_targets, field_args.fade_before_targets);
+			column_args.spae_pos_for_beat(m_pPlayerState, spline_beat,
+				fYOffset, m_fYReverseOffsetPixels, sp_pos, ae_pos);
+
+			switch(column_args.rot_handler->m_spline_mode)
+			{
+				case NCSM_Disabled:
+					ae_rot.x= ArrowEffects::GetRotationX(m_pPlayerState, fYOffset, bIsHoldCap, column_args.column);
+					ae_rot.y= ArrowEffects::GetRotationY(m_pPlayerState, fYOffset, column_args.column);
+					ae_rot.z= ArrowEffects::GetRotationZ(m_pPlayerState, fBeat, bIsHoldHead, column_args.column);
+					break;
+				case NCSM_Offset:
+					ae_rot.x= ArrowEffects::GetRotationX(m_pPlayerState, fYOffset, bIsHoldCap, column_args.column);
+					ae_rot.y= ArrowEffects::GetRotationY(m_pPlayerState, fYOffset, column_args.column);
+					ae_rot.z= ArrowEffects::GetRotationZ(m_pPlayerState, fBeat, bIsHoldHead, column_args.column);
+					column_args.rot_handler->EvalForBeat(column_args.song_beat, spline_beat, sp_rot);
+					break;
+				case NCSM_Position:
+					column_args.rot_handler->EvalForBeat(column_args.song_beat, spline_beat, sp_rot);
+					break;
+				default:
+					break;
+			}
+			column_args.spae_zoom_for_beat(m_pPlayerState, spline_beat, sp_zoom, ae_zoom, column_args.column, fYOffset);
+		}
+	}
+
 	const RageColor diffuse	= RageColor(
 		column_args.diffuse.r * fColorScale,
 		column_args.diffuse.g * fColorScale,
@@ -1332,9 +1604,6 @@ void NoteDisplay::DrawActor(const TapNote& tn, Actor* pActor, NotePart part,
 		column_args.glow.a * fGlow);
 	*/
 
-	bool bIsHoldHead = tn.type == TapNoteType_HoldHead;
-	bool bIsHoldCap = bIsHoldHead || tn.type == TapNoteType_HoldTail;
-
 	// So, thie call to GetBrightness does nothing because fColorScale is not
 	// used after this point.  If you read GetBrightness, it looks like it's
 	// meant to fade the note to black, so a note that is one beat past the
@@ -1344,37 +1613,6 @@ void NoteDisplay::DrawActor(const TapNote& tn, Actor* pActor, NotePart part,
 	if( tn.type != TapNoteType_HoldHead )
 	{ fColorScale *= ArrowEffects::GetBrightness(m_pPlayerState, fBeat); }
 
-	// same logical structure as in UpdateReceptorGhostStuff, I just haven't
-	// figured out a good way to combine them. -Kyz
-	RageVector3 sp_pos;
-	RageVector3 sp_rot;
-	RageVector3 sp_zoom;
-	RageVector3 ae_pos;
-	RageVector3 ae_rot;
-	RageVector3 ae_zoom;
-	column_args.spae_pos_for_beat(m_pPlayerState, spline_beat,
-		fYOffset, m_fYReverseOffsetPixels, sp_pos, ae_pos);
-
-	switch(column_args.rot_handler->m_spline_mode)
-	{
-		case NCSM_Disabled:
-			ae_rot.x= ArrowEffects::GetRotationX(m_pPlayerState, fYOffset, bIsHoldCap, column_args.column);
-			ae_rot.y= ArrowEffects::GetRotationY(m_pPlayerState, fYOffset, column_args.column);
-			ae_rot.z= ArrowEffects::GetRotationZ(m_pPlayerState, fBeat, bIsHoldHead, column_args.column);
-			break;
-		case NCSM_Offset:
-			ae_rot.x= ArrowEffects::GetRotationX(m_pPlayerState, fYOffset, bIsHoldCap, column_args.column);
-			ae_rot.y= ArrowEffects::GetRotationY(m_pPlayerState, fYOffset, column_args.column);
-			ae_rot.z= ArrowEffects::GetRotationZ(m_pPlayerState, fBeat, bIsHoldHead, column_args.column);
-			column_args.rot_handler->EvalForBeat(column_args.song_beat, spline_beat, sp_rot);
-			break;
-		case NCSM_Position:
-			column_args.rot_handler->EvalForBeat(column_args.song_beat, spline_beat, sp_rot);
-			break;
-		default:
-			break;
-	}
-	column_args.spae_zoom_for_beat(m_pPlayerState, spline_beat, sp_zoom, ae_zoom, column_args.column, fYOffset);
 	column_args.SetPRZForActor(pActor, sp_pos, ae_pos, sp_rot, ae_rot, sp_zoom, ae_zoom);
 	// [AJ] this two lines (and how they're handled) piss off many people:
 	pActor->SetDiffuse( diffuse );
@@ -1421,9 +1659,10 @@ void NoteDisplay::DrawActor(const TapNote& tn, Actor* pActor, NotePart part,
 
 void NoteDisplay::DrawTap(const TapNote& tn,
 	const NoteFieldRenderArgs& field_args,
-	const NoteColumnRenderArgs& column_args, float fBeat,
+	const NoteColumnRenderArgs& column_args, float fBeat, float fYOffset,
 	bool bOnSameRowAsHoldStart, bool bOnSameRowAsRollStart,
-	bool bIsAddition, float fPercentFadeToFail)
+	bool bIsAddition, float fPercentFadeToFail,
+	const NoteArrowEffects* precomputed)
 {
 	Actor* pActor = nullptr;
 	NotePart part = NotePart_Tap;
@@ -1495,9 +1734,8 @@ void NoteDisplay::DrawTap(const TapNote& tn,
 		pActor->HandleMessage( msg );
 	}
 
-	const float fYOffset = ArrowEffects::GetYOffset( m_pPlayerState, column_args.column, fBeat );
 	// this is the line that forces the (1,1,1,x) part of the noteskin diffuse -aj
-	DrawActor(tn, pActor, part, field_args, column_args, fYOffset, fBeat, bIsAddition, fPercentFadeToFail, 1.0f, false);
+	DrawActor(tn, pActor, part, field_args, column_args, fYOffset, fBeat, bIsAddition, fPercentFadeToFail, 1.0f, false, precomputed);
 
 	if( tn.type == TapNoteType_Attack )
 		pActor->PlayCommand( "UnsetAttack" );
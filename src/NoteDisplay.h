@@ -7,6 +7,7 @@
 #include "PlayerNumber.h"
 #include "GameInput.h"
 
+#include <memory>
 #include <vector>
 
 
@@ -175,6 +176,17 @@ struct NoteColumnRenderArgs
 	int column;
 };
 
+// What ArrowEffects gives for one note, when the NoteDisplay has already
+// worked it out for the whole column.
+struct NoteArrowEffects
+{
+	RageVector3 pos;
+	RageVector3 rot;
+	float zoom;
+	float alpha;
+	float glow;
+};
+
 /** @brief Draws TapNotes and HoldNotes. */
 class NoteDisplay
 {
@@ -199,6 +211,7 @@ public:
 	 * @param tn the TapNote in question.
 	 * @param iCol the column.
 	 * @param float fBeat the beat to draw them on.
+	 * @param fYOffset the ArrowEffects::GetYOffset of fBeat.
 	 * @param bOnSameRowAsHoldStart a flag to see if a hold is on the same beat.
 	 * @param bOnSameRowAsRollStart a flag to see if a roll is on the same beat.
 	 * @param bIsAddition a flag to see if this note was added via mods.
@@ -206,11 +219,14 @@ public:
 	 * @param fReverseOffsetPixels How are the notes adjusted on Reverse?
 	 * @param fDrawDistanceAfterTargetsPixels how much to draw after the receptors.
 	 * @param fDrawDistanceBeforeTargetsPixels how much ot draw before the receptors.
-	 * @param fFadeInPercentOfDrawFar when to start fading in. */
+	 * @param fFadeInPercentOfDrawFar when to start fading in.
+	 * @param precomputed what ArrowEffects gives for this note, if it was
+	 * already worked out for the whole column. */
 	void DrawTap(const TapNote& tn, const NoteFieldRenderArgs& field_args,
-		const NoteColumnRenderArgs& column_args, float fBeat,
+		const NoteColumnRenderArgs& column_args, float fBeat, float fYOffset,
 		bool bOnSameRowAsHoldStart,
-		bool bOnSameRowAsRollBeat, bool bIsAddition, float fPercentFadeToFail);
+		bool bOnSameRowAsRollBeat, bool bIsAddition, float fPercentFadeToFail,
+		const NoteArrowEffects* precomputed= nullptr);
 	void DrawHold(const TapNote& tn, const NoteFieldRenderArgs& field_args,
 		const NoteColumnRenderArgs& column_args, int iRow, bool bIsBeingHeld,
 		const HoldNoteResult &Result,
@@ -246,11 +262,16 @@ private:
 		const NoteFieldRenderArgs& field_args,
 		const NoteColumnRenderArgs& column_args, float fYOffset, float fBeat,
 		bool bIsAddition, float fPercentFadeToFail, float fColorScale,
-		bool is_being_held);
+		bool is_being_held, const NoteArrowEffects* precomputed= nullptr);
 	void DrawHoldPart(std::vector<Sprite*> &vpSpr,
 		const NoteFieldRenderArgs& field_args,
 		const NoteColumnRenderArgs& column_args,
 		const draw_hold_part_args& part_args, bool glow, int part_type);
+	void GetHoldStripEffects(const NoteFieldRenderArgs& field_args,
+		const NoteColumnRenderArgs& column_args,
+		const draw_hold_part_args& part_args, bool glow, const float* ys,
+		int num_verts, float* y_offsets, float* x_pos, float* z_pos,
+		float* zooms, float* rot_ys, float* variable_zooms, float* alphas);
 	void DrawHoldBodyInternal(std::vector<Sprite*>& sprite_top,
 		std::vector<Sprite*>& sprite_body, std::vector<Sprite*>& sprite_bottom,
 		const NoteFieldRenderArgs& field_args,
@@ -264,8 +285,41 @@ private:
 		float y_head, float y_tail, float percent_fade_to_fail,
 		float color_scale, float top_beat, float bottom_beat);
 
+	/* Where a column's notes are, worked out all at once before drawing
+	 * them.  It's kept between frames so that drawing doesn't allocate. */
+	struct note_positions
+	{
+		std::vector<float> beats;
+		std::vector<float> y_offsets;
+		std::unique_ptr<bool[]> past_peaks;
+		std::size_t past_peaks_size= 0;
+		void resize(std::size_t size);
+	};
+
+	/* What ArrowEffects says about each tap in a column, asked for all the
+	 * taps at once.  Kept between frames like note_positions. */
+	struct note_effects
+	{
+		std::vector<float> x;
+		std::vector<float> y;
+		std::vector<float> z;
+		std::vector<float> rot_x;
+		std::vector<float> rot_y;
+		std::vector<float> rot_z;
+		std::vector<float> zoom;
+		std::vector<float> alpha;
+		std::vector<float> glow;
+		void resize(std::size_t size);
+	};
+	void GetTapEffects(const NoteFieldRenderArgs& field_args,
+		const NoteColumnRenderArgs& column_args, int num_taps);
+
 	const PlayerState	*m_pPlayerState;	// to look up PlayerOptions
 	NoteMetricCache_t	*cache;
+	note_positions		m_TapPositions;
+	note_positions		m_HoldStartPositions;
+	note_positions		m_HoldEndPositions;
+	note_effects		m_TapEffects;
 
 	NoteColorActor		m_TapNote;
 	NoteColorActor		m_TapMine;
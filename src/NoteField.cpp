@@ -19,6 +19,7 @@
 #include "Course.h"
 #include "NoteData.h"
 #include "RageDisplay.h"
+#include "GameplayBenchmark.h"
 
 #include <cfloat>
 #include <cmath>
@@ -332,6 +333,7 @@ void NoteField::InitColumnRenderers()
 
 void NoteField::Update( float fDeltaTime )
 {
+	GameplayBenchmark::StageTimer timer( BenchmarkStage_NoteField );
 	if( m_bFirstUpdate )
 	{
 		m_pCurDisplay->m_ReceptorArrowRow.PlayCommand( "On" );
@@ -774,6 +776,8 @@ void NoteField::CalcPixelsBeforeAndAfterTargets()
 
 void NoteField::DrawPrimitives()
 {
+	GameplayBenchmark::StageTimer timer( BenchmarkStage_NoteField );
+
 	//LOG->Trace( "NoteField::DrawPrimitives()" );
 
 	// This should be filled in on the first update.
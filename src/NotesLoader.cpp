@@ -6,6 +6,7 @@
 #include "NotesLoaderDWI.h"
 #include "NotesLoaderBMS.h"
 #include "NotesLoaderKSF.h"
+#include "LoadProfiler.h"
 #include "RageUtil.h"
 
 #include <cstddef>
@@ -31,6 +32,7 @@ void NotesLoader::GetMainAndSubTitlesFromFullTitle( const RString &sFullTitle, R
 
 bool NotesLoader::LoadFromDir( const RString &sPath, Song &out, std::set<RString> &BlacklistedImages, bool load_autosave )
 {
+	LoadProfiler::StageTimer timer( LoadStage_ParseSimfile );
 	std::vector<RString> list;
 
 	BlacklistedImages.clear();
@@ -19,7 +19,9 @@
 
 Difficulty DwiCompatibleStringToDifficulty( const RString& sDC );
 
-static std::map<int,int> g_mapDanceNoteToNoteDataColumn;
+/* Rebuilt by ParseNoteData for every chart.  Songs may be loaded on several
+ * threads at once, so each thread keeps its own. */
+static thread_local std::map<int,int> g_mapDanceNoteToNoteDataColumn;
 
 /** @brief The different types of core DWI arrows and pads. */
 enum DanceNotes
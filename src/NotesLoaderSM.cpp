@@ -286,18 +286,22 @@ float SMLoader::RowToBeat( RString line, const int rowsPerBeat )
 }
 
 void SMLoader::LoadFromTokens(
-			     RString sStepsType,
-			     RString sDescription,
-			     RString sDifficulty,
-			     RString sMeter,
-			     RString sRadarValues,
-			     RString sNoteData,
+			     std::string_view sStepsType_,
+			     std::string_view sDescription_,
+			     std::string_view sDifficulty_,
+			     std::string_view sMeter_,
+			     std::string_view /* sRadarValues */,
+			     std::string_view sNoteData,
 			     Steps &out
 			     )
 {
 	// we're loading from disk, so this is by definition already saved:
 	out.SetSavedToDisk( true );
 
+	RString sStepsType( sStepsType_.data(), sStepsType_.size() );
+	RString sDescription( sDescription_.data(), sDescription_.size() );
+	RString sDifficulty( sDifficulty_.data(), sDifficulty_.size() );
+	RString sMeter( sMeter_.data(), sMeter_.size() );
 	Trim( sStepsType );
 	Trim( sDescription );
 	Trim( sDifficulty );
@@ -1104,7 +1108,7 @@ bool SMLoader::LoadNoteDataFromSimfile( const RString &path, Steps &out )
 				continue;
 			}
 
-			RString noteData = sParams[6];
+			std::string_view noteData = sParams.GetView(6);
 			Trim( noteData );
 			out.SetSMNoteData( noteData );
 			out.TidyUpData();
@@ -1160,12 +1164,12 @@ bool SMLoader::LoadFromSimfile( const RString &sPath, Song &out, bool bFromCache
 
 			Steps* pNewNotes = out.CreateSteps();
 			LoadFromTokens(
-				sParams[1],
-				sParams[2],
-				sParams[3],
-				sParams[4],
-				sParams[5],
-				sParams[6],
+				sParams.GetView(1),
+				sParams.GetView(2),
+				sParams.GetView(3),
+				sParams.GetView(4),
+				sParams.GetView(5),
+				sParams.GetView(6),
 				*pNewNotes);
 
 			pNewNotes->SetFilename(sPath);
@@ -1271,7 +1275,8 @@ bool SMLoader::LoadEditFromMsd( const MsdFile &msd, const RString &sEditFilePath
 
 			Steps* pNewNotes = pSong->CreateSteps();
 			LoadFromTokens(
-				sParams[1], sParams[2], sParams[3], sParams[4], sParams[5], sParams[6],
+				sParams.GetView(1), sParams.GetView(2), sParams.GetView(3),
+				sParams.GetView(4), sParams.GetView(5), sParams.GetView(6),
 				*pNewNotes);
 
 			pNewNotes->SetLoadedFromProfile( slot );
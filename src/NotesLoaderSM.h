@@ -6,6 +6,7 @@
 #include "Attack.h"
 #include "MsdFile.h" // we require the struct from here.
 
+#include <string_view>
 #include <vector>
 
 
@@ -188,14 +189,14 @@ protected:
 	 * @param difficulty The difficulty (in words) of the chart.
 	 * @param meter the difficulty (in numbers) of the chart.
 	 * @param radarValues the calculated radar values.
-	 * @param noteData the note data itself.
+	 * @param noteData the note data itself, which is only copied into out.
 	 * @param out the Steps getting the data. */
-	virtual void LoadFromTokens(RString sStepsType,
-				    RString sDescription,
-				    RString sDifficulty,
-				    RString sMeter,
-				    RString sRadarValues,
-				    RString sNoteData,
+	virtual void LoadFromTokens(std::string_view sStepsType,
+				    std::string_view sDescription,
+				    std::string_view sDifficulty,
+				    std::string_view sMeter,
+				    std::string_view sRadarValues,
+				    std::string_view sNoteData,
 				    Steps &out);
 
 	/**
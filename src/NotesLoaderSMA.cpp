@@ -453,12 +453,12 @@ bool SMALoader::LoadFromSimfile( const RString &sPath, Song &out, bool bFromCach
 			pNewNotes = new Steps(&out);
 
 			LoadFromTokens(
-					 sParams[1],
-					 sParams[2],
-					 sParams[3],
-					 sParams[4],
-					 sParams[5],
-					 sParams[6],
+					 sParams.GetView(1),
+					 sParams.GetView(2),
+					 sParams.GetView(3),
+					 sParams.GetView(4),
+					 sParams.GetView(5),
+					 sParams.GetView(6),
 					 *pNewNotes );
 			pNewNotes->SetFilename(sPath);
 			out.AddSteps( pNewNotes );
@@ -15,6 +15,7 @@
 #include "PrefsManager.h"
 
 #include <cstddef>
+#include <string_view>
 #include <vector>
 
 
@@ -383,6 +384,38 @@ void SetRadarValues(StepsTagInfo& info)
 	}
 	info.ssc_format= true;
 }
+void SetNotesPerMeasure(StepsTagInfo& info)
+{
+	// Only the cache has these; they're worked out with the radar values.
+	if(info.from_cache)
+	{
+		std::vector<std::uint8_t> v[NUM_PLAYERS];
+		FOREACH_PlayerNumber(pn)
+		{
+			std::vector<RString> values;
+			split((*info.params)[pn + 1], ",", values, true);
+			for(RString const& value : values)
+			{
+				v[pn].push_back(std::uint8_t(StringToInt(value)));
+			}
+		}
+		info.steps->SetCachedNotesPerMeasure(v);
+	}
+}
+void SetPeakNPS(StepsTagInfo& info)
+{
+	if(info.from_cache)
+	{
+		std::vector<RString> values;
+		split((*info.params)[1], ",", values, true);
+		float peak[NUM_PLAYERS];
+		FOREACH_PlayerNumber(pn)
+		{
+			peak[pn]= pn < values.size() ? StringToFloat(values[pn]) : 0.0f;
+		}
+		info.steps->SetCachedPeakNPS(peak);
+	}
+}
 void SetCredit(StepsTagInfo& info)
 {
 	info.steps->SetCredit((*info.params)[1]);
@@ -610,6 +643,8 @@ struct ssc_parser_helper_t
 		steps_tag_handlers["DIFFICULTY"]= &SetDifficulty;
 		steps_tag_handlers["METER"]= &SetMeter;
 		steps_tag_handlers["RADARVALUES"]= &SetRadarValues;
+		steps_tag_handlers["NOTESPERMEASURE"]= &SetNotesPerMeasure;
+		steps_tag_handlers["PEAKNPS"]= &SetPeakNPS;
 		steps_tag_handlers["CREDIT"]= &SetCredit;
 		steps_tag_handlers["MUSIC"]= &SetStepsMusic;
 		steps_tag_handlers["BPMS"]= &SetStepsBPMs;
@@ -865,13 +900,18 @@ bool SSCLoader::LoadNoteDataFromSimfile( const RString & cachePath, Steps &out )
 		const MsdFile::value_t &params = msd.GetValue(i);
 		RString valueName = params[0];
 		valueName.MakeUpper();
-		RString matcher = params[1]; // mainly for debugging.
-		Trim(matcher);
 
 		load_note_data_handler_map_t::iterator handler=
 			parser_helper.load_note_data_handlers.find(valueName);
 		if(handler != parser_helper.load_note_data_handlers.end())
 		{
+			std::string_view matcherView = params.GetView(1);
+			Trim(matcherView);
+			// The note data of every chart in the file goes through here, so
+			// only copy the small tags.
+			RString matcher; // mainly for debugging.
+			if(handler->second != LNDID_notes && handler->second != LNDID_notes2)
+			{ matcher.assign(matcherView.data(), matcherView.size()); }
 			if(tryingSteps)
 			{
 				switch(handler->second)
@@ -918,7 +958,7 @@ bool SSCLoader::LoadNoteDataFromSimfile( const RString & cachePath, Steps &out )
 						break;
 					case LNDID_notes:
 					case LNDID_notes2:
-						out.SetSMNoteData(matcher);
+						out.SetSMNoteData(matcherView);
 						out.TidyUpData();
 						return true;
 					default:
@@ -1024,7 +1064,7 @@ bool SSCLoader::LoadFromSimfile( const RString &sPath, Song &out, bool bFromCach
 					if(reused_steps_info.has_own_timing)
 					{ pNewNotes->m_Timing = stepsTiming; }
 					reused_steps_info.has_own_timing = false;
-					pNewNotes->SetSMNoteData(sParams[1]);
+					pNewNotes->SetSMNoteData(sParams.GetView(1));
 					pNewNotes->TidyUpData();
 					pNewNotes->SetFilename(sPath);
 					out.AddSteps(pNewNotes);
@@ -1157,18 +1197,18 @@ bool SSCLoader::LoadEditFromMsd(const MsdFile &msd,
 				{
 					if(reused_steps_info.has_own_timing)
 					{ pNewNotes->m_Timing = stepsTiming; }
-					pNewNotes->SetSMNoteData(sParams[1]);
+					pNewNotes->SetSMNoteData(sParams.GetView(1));
 					pNewNotes->TidyUpData();
 				}
 				else
 				{
 					pNewNotes = pSong->CreateSteps();
-					LoadFromTokens(sParams[1],
-						sParams[2],
-						sParams[3],
-						sParams[4],
-						sParams[5],
-						sParams[6],
+					LoadFromTokens(sParams.GetView(1),
+						sParams.GetView(2),
+						sParams.GetView(3),
+						sParams.GetView(4),
+						sParams.GetView(5),
+						sParams.GetView(6),
 						*pNewNotes);
 				}
 
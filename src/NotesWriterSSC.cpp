@@ -428,6 +428,19 @@ static RString GetSSCNoteData( const Song &song, const Steps &in, bool bSavingCa
 	}
 	if (bSavingCache)
 	{
+		// Each player's note rows per measure, so themes don't have to count
+		// them from the notes every time a chart is picked.
+		std::vector<RString> asNotesPerMeasure, asPeakNPS;
+		FOREACH_PlayerNumber( pn )
+		{
+			std::vector<RString> asCounts;
+			for( std::uint8_t iCount : in.GetNotesPerMeasure(pn) )
+				asCounts.push_back( ssprintf("%d", iCount) );
+			asNotesPerMeasure.push_back( join(",", asCounts) );
+			asPeakNPS.push_back( ssprintf("%.6f", in.GetPeakNPS(pn)) );
+		}
+		lines.push_back( ssprintf( "#NOTESPERMEASURE:%s;", join(":",asNotesPerMeasure).c_str() ) );
+		lines.push_back( ssprintf( "#PEAKNPS:%s;", join(",",asPeakNPS).c_str() ) );
 		lines.push_back(ssprintf("#STEPFILENAME:%s;", in.GetFilename().c_str()));
 	}
 	else
@@ -40,6 +40,8 @@
 #include "GameCommand.h"
 #include "LocalizedString.h"
 #include "AdjustSync.h"
+#include "JudgmentLatency.h"
+#include "GameplayBenchmark.h"
 
 #include "calm/CalmDisplay.h"
 
@@ -270,9 +272,9 @@ Player::Player( NoteData &nd, bool bVisibleParts ) : m_NoteData(nd)
 	m_pPrimaryScoreKeeper = nullptr;
 	m_pSecondaryScoreKeeper = nullptr;
 	m_pInventory = nullptr;
-	m_pIterNeedsTapJudging = nullptr;
+	m_iNextNoteNeedsTapJudging = 0;
+	m_iNextUncrossedNote = 0;
 	m_pIterNeedsHoldJudging = nullptr;
-	m_pIterUncrossedRows = nullptr;
 	m_pIterUnjudgedRows = nullptr;
 	m_pIterUnjudgedMineRows = nullptr;
 
@@ -306,9 +308,7 @@ Player::~Player()
 	for( unsigned i = 0; i < m_vpHoldJudgment.size(); ++i )
 		SAFE_DELETE( m_vpHoldJudgment[i] );
 	SAFE_DELETE( m_pJudgedRows );
-	SAFE_DELETE( m_pIterNeedsTapJudging );
 	SAFE_DELETE( m_pIterNeedsHoldJudging );
-	SAFE_DELETE( m_pIterUncrossedRows );
 	SAFE_DELETE( m_pIterUnjudgedRows );
 	SAFE_DELETE( m_pIterUnjudgedMineRows );
 
@@ -790,15 +790,14 @@ void Player::Load()
 	if( m_pPlayerStageStats )
 		SendComboMessages( m_pPlayerStageStats->m_iCurCombo, m_pPlayerStageStats->m_iCurMissCombo );
 
-	SAFE_DELETE( m_pIterNeedsTapJudging );
-	m_pIterNeedsTapJudging = new NoteData::all_tracks_iterator( m_NoteData.GetTapNoteRangeAllTracks(iNoteRow, MAX_NOTE_ROW) );
+	m_CompiledNotes.Compile( m_NoteData, *m_Timing );
+	m_iNextNoteNeedsTapJudging = m_CompiledNotes.LowerBound( iNoteRow );
+	m_iNextUncrossedNote = m_CompiledNotes.LowerBound( iNoteRow );
+	m_vPendingJudgmentInputs.clear();
 
 	SAFE_DELETE( m_pIterNeedsHoldJudging );
 	m_pIterNeedsHoldJudging = new NoteData::all_tracks_iterator( m_NoteData.GetTapNoteRangeAllTracks(iNoteRow, MAX_NOTE_ROW ) );
 
-	SAFE_DELETE( m_pIterUncrossedRows );
-	m_pIterUncrossedRows = new NoteData::all_tracks_iterator( m_NoteData.GetTapNoteRangeAllTracks(iNoteRow, MAX_NOTE_ROW ) );
-
 	SAFE_DELETE( m_pIterUnjudgedRows );
 	m_pIterUnjudgedRows = new NoteData::all_tracks_iterator( m_NoteData.GetTapNoteRangeAllTracks(iNoteRow, MAX_NOTE_ROW ) );
 
@@ -830,6 +829,7 @@ void Player::SendComboMessages( unsigned int iOldCombo, unsigned int iOldMissCom
 
 void Player::Update( float fDeltaTime )
 {
+	GameplayBenchmark::StageTimer timer( BenchmarkStage_Player );
 	const RageTimer now;
 	// Don't update if we haven't been loaded yet.
 	if( !m_bLoaded )
@@ -1048,22 +1048,22 @@ void Player::Update( float fDeltaTime )
 		// keep track for which tracks we have already seen an unjudged
 		// note.
 		std::vector<bool> seenTracks(m_NoteData.GetNumTracks(), false);
+		const float fTimeOffset = CompiledNoteData::GetOffset(*m_Timing);
 
-		for(auto iter = *m_pIterNeedsTapJudging; !iter.IsAtEnd() && iter.Row() <= lastCheckRow; ++iter)
+		for(std::size_t i = m_iNextNoteNeedsTapJudging; i < m_CompiledNotes.size() && m_CompiledNotes.GetRow(i) <= lastCheckRow; ++i)
 		{
-			TapNote &tn = *iter;
-			const int row = iter.Row();
-			const int track = iter.Track();
+			TapNote &tn = m_CompiledNotes.GetTapNote(i);
+			const int track = m_CompiledNotes.GetTrack(i);
 
 			// Skip over warp and fake segments
-			if (!m_Timing->IsJudgableAtRow(row))
+			if (!m_CompiledNotes.HasFlag(i, CompiledNoteData::NOTE_JUDGABLE))
 				continue;
 
 			// Held misses only apply to tap notes
-			if (tn.type != TapNoteType_Tap && tn.type != TapNoteType_HoldHead)
+			if (!m_CompiledNotes.HasFlag(i, CompiledNoteData::NOTE_TAP_OR_HOLD_HEAD))
 				continue;
 
-			const float notePosition = m_Timing->GetElapsedTimeFromBeat(NoteRowToBeat(row));
+			const float notePosition = m_CompiledNotes.GetSeconds(i, fTimeOffset);
 			const float offset = std::abs((notePosition - musicPosition) / rate);
 
 			// Skip if we are outside of the largest timing window
@@ -1597,6 +1597,9 @@ void Player::UpdateHoldNotes( int iSongRow, float fDeltaTime, std::vector<TrackR
 
 void Player::ApplyWaitingTransforms()
 {
+	// Only the rows the attacks cover need compiling again.
+	int iPatchStartRow = MAX_NOTE_ROW;
+	int iPatchEndRow = 0;
 	for( unsigned j=0; j<m_pPlayerState->m_ModsToApply.size(); j++ )
 	{
 		const Attack &mod = m_pPlayerState->m_ModsToApply[j];
@@ -1613,13 +1616,26 @@ void Player::ApplyWaitingTransforms()
 
 		// if re-adding noteskin changes, this is one place to edit -aj
 
-		NoteDataUtil::TransformNoteData(m_NoteData, *m_Timing, po, GAMESTATE->GetCurrentStyle(GetPlayerState()->m_PlayerNumber)->m_StepsType, BeatToNoteRow(fStartBeat), BeatToNoteRow(fEndBeat));
-	}
+		const int iStartRow = BeatToNoteRow(fStartBeat);
+		const int iEndRow = BeatToNoteRow(fEndBeat);
+		// Echo lays notes up to half a beat past the range; take them in, so
+		// the notes outside the patch are left as they were.
+		int iPatchStart = std::max( iStartRow - ROWS_PER_BEAT, 0 ), iPatchEnd = iEndRow + ROWS_PER_BEAT;
+		CompiledNoteData::WidenRangeOverHolds( m_NoteData, iPatchStart, iPatchEnd );
+		NoteDataUtil::TransformNoteData(m_NoteData, *m_Timing, po, GAMESTATE->GetCurrentStyle(GetPlayerState()->m_PlayerNumber)->m_StepsType, iStartRow, iEndRow);
+		CompiledNoteData::WidenRangeOverHolds( m_NoteData, iPatchStart, iPatchEnd );
+		iPatchStartRow = std::min( iPatchStartRow, iPatchStart );
+		iPatchEndRow = std::max( iPatchEndRow, iPatchEnd );
+	}
+	if( iPatchStartRow <= iPatchEndRow )
+		m_CompiledNotes.RecompileRange( m_NoteData, *m_Timing, iPatchStartRow, iPatchEndRow+1,
+			{ &m_iNextNoteNeedsTapJudging, &m_iNextUncrossedNote } );
 	m_pPlayerState->m_ModsToApply.clear();
 }
 
 void Player::DrawPrimitives()
 {
+	GameplayBenchmark::StageTimer timer( BenchmarkStage_Player );
 	// TODO: Remove use of PlayerNumber.
 	PlayerNumber pn = m_pPlayerState->m_PlayerNumber;
 
@@ -1867,36 +1883,8 @@ void Player::ChangeLifeRecord()
 
 int Player::GetClosestNoteDirectional( int col, int iStartRow, int iEndRow, bool bAllowGraded, bool bForward ) const
 {
-	NoteData::const_iterator begin, end;
-	m_NoteData.GetTapNoteRange( col, iStartRow, iEndRow, begin, end );
-
-	if( !bForward )
-		swap( begin, end );
-
-	while( begin != end )
-	{
-		if( !bForward )
-			--begin;
-
-		// Is this the row we want?
-		do {
-			const TapNote &tn = begin->second;
-			if (!m_Timing->IsJudgableAtRow( begin->first ))
-				break;
-			// unsure if autoKeysounds should be excluded. -Wolfman2000
-			if( tn.type == TapNoteType_Empty || tn.type == TapNoteType_AutoKeysound )
-				break;
-			if( !bAllowGraded && tn.result.tns != TNS_None )
-				break;
-
-			return begin->first;
-		} while(0);
-
-		if( bForward )
-			++begin;
-	}
-
-	return -1;
+	// unsure if autoKeysounds should be excluded. -Wolfman2000
+	return m_CompiledNotes.GetClosestNoteDirectional( col, iStartRow, iEndRow, bAllowGraded, bForward );
 }
 
 // Find the closest note to fBeat.
@@ -2248,7 +2236,9 @@ void Player::Step( int col, int row, const RageTimer &tm, bool bHeld, bool bRele
 		float fNoteOffset = 0.0f;
 		// we need this later if we are autosyncing
 		const float fStepBeat = NoteRowToBeat( iRowOfOverlappingNoteOrRow );
-		const float fStepSeconds = m_Timing->GetElapsedTimeFromBeat(fStepBeat);
+		const std::size_t iCompiledNote = m_CompiledNotes.Find( col, iRowOfOverlappingNoteOrRow );
+		const bool bCompiled = iCompiledNote < m_CompiledNotes.size();
+		const float fStepSeconds = bCompiled? m_CompiledNotes.GetSeconds(iCompiledNote, CompiledNoteData::GetOffset(*m_Timing)) : m_Timing->GetElapsedTimeFromBeat(fStepBeat);
 
 		if( row == -1 )
 		{
@@ -2275,9 +2265,16 @@ void Player::Step( int col, int row, const RageTimer &tm, bool bHeld, bool bRele
 
 		TapNote tnDummy = TAP_ORIGINAL_TAP;
 		TapNote *pTN = nullptr;
-		NoteData::iterator iter = m_NoteData.FindTapNote( col, iRowOfOverlappingNoteOrRow );
-		DEBUG_ASSERT( iter!= m_NoteData.end(col) );
-		pTN = &iter->second;
+		if( bCompiled )
+		{
+			pTN = &m_CompiledNotes.GetTapNote( iCompiledNote );
+		}
+		else
+		{
+			NoteData::iterator iter = m_NoteData.FindTapNote( col, iRowOfOverlappingNoteOrRow );
+			DEBUG_ASSERT( iter!= m_NoteData.end(col) );
+			pTN = &iter->second;
+		}
 
 		switch( m_pPlayerState->m_PlayerController )
 		{
@@ -2560,6 +2557,9 @@ void Player::Step( int col, int row, const RageTimer &tm, bool bHeld, bool bRele
 		}
 
 		m_LastTapNoteScore = score;
+		// Held steps are made up by the game for held buttons, not pressed.
+		if( m_pPlayerState->m_PlayerController == PC_HUMAN && !bHeld )
+			RecordStepLatency( iRowOfOverlappingNoteOrRow, pTN->type, tm );
 		if( GAMESTATE->GetCurrentGame()->m_bCountNotesSeparately )
 		{
 			if( pTN->type != TapNoteType_Mine )
@@ -2653,17 +2653,17 @@ void Player::UpdateTapNotesMissedOlderThan( float fMissIfOlderThanSeconds )
 		}
 	}
 
-	NoteData::all_tracks_iterator &iter = *m_pIterNeedsTapJudging;
+	std::size_t &i = m_iNextNoteNeedsTapJudging;
 
-	for( ; !iter.IsAtEnd() && iter.Row() < iMissIfOlderThanThisRow; ++iter )
+	for( ; i < m_CompiledNotes.size() && m_CompiledNotes.GetRow(i) < iMissIfOlderThanThisRow; ++i )
 	{
-		TapNote &tn = *iter;
+		TapNote &tn = m_CompiledNotes.GetTapNote(i);
 
 		if( !NeedsTapJudging(tn) )
 			continue;
 
 		// Ignore all notes in WarpSegments or FakeSegments.
-		if (!m_Timing->IsJudgableAtRow(iter.Row()))
+		if( !m_CompiledNotes.HasFlag(i, CompiledNoteData::NOTE_JUDGABLE) )
 			continue;
 
 		if( tn.type == TapNoteType_Mine )
@@ -2869,14 +2869,14 @@ void Player::CrossedRows( int iLastRowCrossed, const RageTimer &now )
 {
 	//LOG->Trace( "Player::CrossedRows   %d    %d", iFirstRowCrossed, iLastRowCrossed );
 
-	NoteData::all_tracks_iterator &iter = *m_pIterUncrossedRows;
+	std::size_t &i = m_iNextUncrossedNote;
 	int iLastSeenRow = -1;
-	for( ; !iter.IsAtEnd()  &&  iter.Row() <= iLastRowCrossed; ++iter )
+	for( ; i < m_CompiledNotes.size()  &&  m_CompiledNotes.GetRow(i) <= iLastRowCrossed; ++i )
 	{
 		// Apply InitialHoldLife.
-		TapNote &tn = *iter;
-		int iRow = iter.Row();
-		int iTrack = iter.Track();
+		TapNote &tn = m_CompiledNotes.GetTapNote(i);
+		int iRow = m_CompiledNotes.GetRow(i);
+		int iTrack = m_CompiledNotes.GetTrack(i);
 		switch( tn.type )
 		{
 			case TapNoteType_HoldHead:
@@ -2942,7 +2942,7 @@ void Player::CrossedRows( int iLastRowCrossed, const RageTimer &now )
 				tn.type != TapNoteType_Fake &&
 				tn.type != TapNoteType_AutoKeysound &&
 				tn.result.tns == TNS_None &&
-				this->m_Timing->IsJudgableAtRow(iRow) )
+				m_CompiledNotes.HasFlag(i, CompiledNoteData::NOTE_JUDGABLE) )
 			{
 				Step( iTrack, iRow, now, false, false );
 				if( m_pPlayerState->m_PlayerController == PC_AUTOPLAY )
@@ -2954,19 +2954,20 @@ void Player::CrossedRows( int iLastRowCrossed, const RageTimer &now )
 		}
 
 		// TODO: Can we remove the iLastSeenRow logic and the
-		// autokeysound for loop, since the iterator in this loop will
-		// already be iterating over all of the tracks?
+		// autokeysound for loop, since the loop over the notes will
+		// already be going over all of the tracks?
 		if( iRow != iLastSeenRow )
 		{
 			// crossed a new not-empty row
 			iLastSeenRow = iRow;
 
 			// handle autokeysounds here (if not in the editor).
+			// The notes on this row all come after this one.
 			if (!GAMESTATE->m_bInStepEditor)
 			{
-				for (int t = 0; t < m_NoteData.GetNumTracks(); ++t)
+				for (std::size_t j = i; j < m_CompiledNotes.size() && m_CompiledNotes.GetRow(j) == iRow; ++j)
 				{
-					const TapNote &tap = m_NoteData.GetTapNote(t, iRow);
+					const TapNote &tap = m_CompiledNotes.GetTapNote(j);
 					if (tap.type == TapNoteType_AutoKeysound)
 					{
 						PlayKeysound(tap, TNS_None);
@@ -3294,8 +3295,52 @@ void Player::SetMineJudgment( TapNoteScore tns , int iTrack )
 	}
 }
 
+void Player::RecordStepLatency( int iRow, TapNoteType type, const RageTimer &tm )
+{
+	JudgmentLatency::Record( LatencyStage_Step, tm.Ago() );
+
+	// Mines don't get a judgment message.
+	if( type == TapNoteType_Mine )
+		return;
+
+	// A row is judged once all of its notes are, so time the last input on it.
+	for( std::pair<int,RageTimer> &input : m_vPendingJudgmentInputs )
+	{
+		if( input.first == iRow )
+		{
+			input.second = tm;
+			return;
+		}
+	}
+	m_vPendingJudgmentInputs.emplace_back( iRow, tm );
+}
+
+void Player::RecordJudgmentLatency( int iRow )
+{
+	// Forget inputs on rows that were never judged, like attacks, so this
+	// doesn't grow.
+	static const float MAX_PENDING_SECONDS = 2.0f;
+	for( std::size_t i = 0; i < m_vPendingJudgmentInputs.size(); )
+	{
+		const std::pair<int,RageTimer> &input = m_vPendingJudgmentInputs[i];
+		const float fSeconds = input.second.Ago();
+		if( input.first == iRow )
+			JudgmentLatency::Record( LatencyStage_Judgment, fSeconds );
+		if( input.first == iRow || fSeconds > MAX_PENDING_SECONDS )
+		{
+			m_vPendingJudgmentInputs[i] = m_vPendingJudgmentInputs.back();
+			m_vPendingJudgmentInputs.pop_back();
+		}
+		else
+			++i;
+	}
+}
+
 void Player::SetJudgment( int iRow, int iTrack, const TapNote &tn, TapNoteScore tns, float fTapNoteOffset )
 {
+	if( !m_vPendingJudgmentInputs.empty() )
+		RecordJudgmentLatency( iRow );
+
 	if( m_bSendJudgmentAndComboMessages )
 	{
 		Message msg("Judgment");
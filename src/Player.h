@@ -6,12 +6,14 @@
 #include "NoteDataWithScoring.h"
 #include "RageSound.h"
 #include "AttackDisplay.h"
+#include "CompiledNoteData.h"
 #include "NoteData.h"
 #include "ScreenMessage.h"
 #include "ThemeMetric.h"
 #include "InputEventPlus.h"
 #include "TimingData.h"
 
+#include <utility>
 #include <vector>
 
 
@@ -156,6 +158,8 @@ protected:
 	void SetMineJudgment( TapNoteScore tns , int iTrack );
 	void SetJudgment( int iRow, int iFirstTrack, const TapNote &tn ) { SetJudgment( iRow, iFirstTrack, tn, tn.result.tns, tn.result.fTapNoteOffset ); }
 	void SetJudgment( int iRow, int iFirstTrack, const TapNote &tn, TapNoteScore tns, float fTapNoteOffset );	// -1 if no track as in TNS_Miss
+	void RecordStepLatency( int iRow, TapNoteType type, const RageTimer &tm );
+	void RecordJudgmentLatency( int iRow );
 	void SetHoldJudgment( TapNote &tn, int iTrack );
 	void SetCombo( unsigned int iCombo, unsigned int iMisses );
 	void IncrementComboOrMissCombo( bool bComboOrMissCombo );
@@ -214,9 +218,15 @@ protected:
 	Inventory		*m_pInventory;
 
 	int			m_iFirstUncrossedRow;	// used by hold checkpoints logic
-	NoteData::all_tracks_iterator *m_pIterNeedsTapJudging;
+	/** @brief m_NoteData laid out for judging; see CompiledNoteData. */
+	CompiledNoteData	m_CompiledNotes;
+	// Indexes into m_CompiledNotes.
+	std::size_t		m_iNextNoteNeedsTapJudging;
+	std::size_t		m_iNextUncrossedNote;
+	/** @brief The row and timestamp of the last input that scored a note on
+	 * each row that hasn't had its judgment sent yet, for JudgmentLatency. */
+	std::vector<std::pair<int,RageTimer>>	m_vPendingJudgmentInputs;
 	NoteData::all_tracks_iterator *m_pIterNeedsHoldJudging;
-	NoteData::all_tracks_iterator *m_pIterUncrossedRows;
 	NoteData::all_tracks_iterator *m_pIterUnjudgedRows;
 	NoteData::all_tracks_iterator *m_pIterUnjudgedMineRows;
 	unsigned int	m_iLastSeenCombo;
@@ -53,7 +53,7 @@ RageSoundLoadParams::RageSoundLoadParams():
 RageSound::RageSound():
 	m_Mutex( "RageSound" ), m_pSource(nullptr),
 	m_sFilePath(""), m_Param(), m_iStreamFrame(0),
-	m_iStoppedSourceFrame(0), m_bPlaying(false),
+	m_iStoppedSourceFrame(0), m_iPreparedFrame(-1), m_bPlaying(false),
 	m_bDeleteWhenFinished(false), m_sError("")
 {
 	ASSERT( SOUNDMAN != nullptr );
@@ -86,6 +86,7 @@ RageSound &RageSound::operator=( const RageSound &cpy )
 	m_Param = cpy.m_Param;
 	m_iStreamFrame = cpy.m_iStreamFrame;
 	m_iStoppedSourceFrame = cpy.m_iStoppedSourceFrame;
+	m_iPreparedFrame = -1;
 	m_bPlaying = false;
 	m_bDeleteWhenFinished = false;
 
@@ -243,6 +244,7 @@ void RageSound::LoadSoundReader( RageSoundReader *pSound )
 	Unload();
 
 	m_iStreamFrame = m_iStoppedSourceFrame = 0;
+	m_iPreparedFrame = -1;
 
 	const int iNeededRate = SOUNDMAN->GetDriverSampleRate();
 	bool bSupportRateChange = false;
@@ -325,13 +327,38 @@ void RageSound::CommitPlayingPosition( std::int64_t iHardwareFrame, std::int64_t
 	m_Mutex.Unlock();
 }
 
+void RageSound::PrepareToPlay( float fBufferSeconds )
+{
+	ASSERT( !m_bPlaying );
+
+	const int iStartFrame = std::lrint( m_Param.m_StartSecond * samplerate() );
+	if( !SetPositionFrames(iStartFrame) )
+		return;
+
+	/* Decode ahead into the read-ahead buffer, if the sound has one. */
+	for( RageSoundReader *pReader = m_pSource; pReader != nullptr; pReader = pReader->GetSource() )
+	{
+		RageSoundReader_ThreadedBuffer *pBuffer = dynamic_cast<RageSoundReader_ThreadedBuffer *>( pReader );
+		if( pBuffer != nullptr )
+		{
+			pBuffer->Prebuffer( std::lrint(fBufferSeconds * pBuffer->GetSampleRate()) );
+			break;
+		}
+	}
+
+	m_iPreparedFrame = iStartFrame;
+}
+
 /* Start playing from the current position. */
 void RageSound::StartPlaying()
 {
 	ASSERT( !m_bPlaying );
 
-	// Move to the start position.
-	SetPositionFrames( std::lrint(m_Param.m_StartSecond * samplerate()) );
+	// Move to the start position, unless PrepareToPlay already has.
+	const int iStartFrame = std::lrint( m_Param.m_StartSecond * samplerate() );
+	if( iStartFrame != m_iPreparedFrame )
+		SetPositionFrames( iStartFrame );
+	m_iPreparedFrame = -1;
 
 	/* If m_StartTime is in the past, then we probably set a start time but took too
 	 * long loading.  We don't want that; log it, since it can be unobvious. */
@@ -554,6 +581,7 @@ bool RageSound::SetPositionFrames( int iFrames )
 	{
 		m_iStoppedSourceFrame = iFrames;
 	}
+	m_iPreparedFrame = -1;
 
 	return iRet == 1;
 }
@@ -117,6 +117,11 @@ public:
 	bool IsLoaded() const;
 	void DeleteSelfWhenFinishedPlaying();
 
+	/* Seek to the start position and fill the read-ahead buffer with up to
+	 * fBufferSeconds of sound, so StartPlaying doesn't have to touch the file.
+	 * This can take a while, so it may be called from another thread before
+	 * the sound is started. */
+	void PrepareToPlay( float fBufferSeconds );
 	void StartPlaying();
 	void StopPlaying();
 
@@ -170,6 +175,8 @@ private:
 	 * Keep track of the position after a seek or stop, so we can return a sane
 	 * position when stopped, and when playing but pos_map hasn't yet been filled. */
 	int m_iStoppedSourceFrame;
+	/* The frame PrepareToPlay seeked to, or -1 if the sound has been moved since. */
+	int m_iPreparedFrame;
 	bool m_bPlaying;
 	bool m_bDeleteWhenFinished;
 
@@ -0,0 +1,363 @@
+#include "global.h"
+#include "RageSoundKernels.h"
+#include "RageUtil.h"
+
+#include <cmath>
+#include <cstdint>
+
+/* SSE2 is always there on x86-64, and on 32-bit x86 when we're built for it.
+ * AVX2 is compiled for the functions that use it, and only used if the CPU
+ * has it. */
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define HAVE_X86_KERNELS
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define TARGET_AVX2
+#else
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace
+{
+	void Mix_Scalar( float *pDest, const float *pSrc, unsigned iSize, int iSrcStride, int iDestStride )
+	{
+		while( iSize )
+		{
+			*pDest += *pSrc;
+			pSrc += iSrcStride;
+			pDest += iDestStride;
+			--iSize;
+		}
+	}
+
+	void ConvertToInt16Clipped_Scalar( const float *pFrom, std::int16_t *pTo, unsigned iSamples )
+	{
+		for( unsigned i = 0; i < iSamples; ++i )
+		{
+			float fOut = clamp( pFrom[i], -1.0f, +1.0f );
+			pTo[i] = std::lrint( fOut * 32767 );
+		}
+	}
+
+	void Deinterleave_Scalar( const float *pFrom, float *const *pTo, int iChannels, unsigned iFrames )
+	{
+		for( unsigned i = 0; i < iFrames; ++i )
+			for( int ch = 0; ch < iChannels; ++ch )
+				pTo[ch][i] = pFrom[iChannels * i + ch];
+	}
+
+	float DotProduct8_Scalar( const float *a, const float *b )
+	{
+		float fTot = 0;
+		for( int j = 0; j < 8; ++j )
+			fTot += a[j]*b[j];
+		return fTot;
+	}
+
+#if defined(HAVE_X86_KERNELS)
+	/*
+	 * With equal strides of 2 (one channel of a stereo buffer to one channel
+	 * of another), each vector holds every other value we want.  Add to all of
+	 * them and keep the sum only in the lanes that are ours, so the other
+	 * channel is written back exactly as it was.  These never read past the
+	 * last sample, since the value after it may not be there.
+	 */
+	void Mix_SSE2( float *pDest, const float *pSrc, unsigned iSize, int iSrcStride, int iDestStride )
+	{
+		unsigned i = 0;
+		if( iSrcStride == 1 && iDestStride == 1 )
+		{
+			for( ; i + 4 <= iSize; i += 4 )
+				_mm_storeu_ps( pDest+i, _mm_add_ps(_mm_loadu_ps(pDest+i), _mm_loadu_ps(pSrc+i)) );
+		}
+		else if( iSrcStride == 2 && iDestStride == 2 )
+		{
+			const __m128 mask = _mm_castsi128_ps( _mm_set_epi32(0, -1, 0, -1) );
+			for( ; i + 2 < iSize; i += 2 )
+			{
+				const __m128 dest = _mm_loadu_ps( pDest+i*2 );
+				const __m128 sum = _mm_add_ps( dest, _mm_loadu_ps(pSrc+i*2) );
+				_mm_storeu_ps( pDest+i*2, _mm_or_ps(_mm_and_ps(mask, sum), _mm_andnot_ps(mask, dest)) );
+			}
+		}
+		Mix_Scalar( pDest + i*iDestStride, pSrc + i*iSrcStride, iSize - i, iSrcStride, iDestStride );
+	}
+
+	void ConvertToInt16Clipped_SSE2( const float *pFrom, std::int16_t *pTo, unsigned iSamples )
+	{
+		const __m128 fMin = _mm_set1_ps( -1.0f );
+		const __m128 fMax = _mm_set1_ps( +1.0f );
+		const __m128 fScale = _mm_set1_ps( 32767 );
+		unsigned i = 0;
+		for( ; i + 8 <= iSamples; i += 8 )
+		{
+			/* _mm_cvtps_epi32 rounds like lrint, to the nearest and to even. */
+			const __m128 a = _mm_min_ps( _mm_max_ps(_mm_loadu_ps(pFrom+i), fMin), fMax );
+			const __m128 b = _mm_min_ps( _mm_max_ps(_mm_loadu_ps(pFrom+i+4), fMin), fMax );
+			const __m128i ia = _mm_cvtps_epi32( _mm_mul_ps(a, fScale) );
+			const __m128i ib = _mm_cvtps_epi32( _mm_mul_ps(b, fScale) );
+			_mm_storeu_si128( (__m128i *) (pTo+i), _mm_packs_epi32(ia, ib) );
+		}
+		ConvertToInt16Clipped_Scalar( pFrom+i, pTo+i, iSamples-i );
+	}
+
+	void Deinterleave_SSE2( const float *pFrom, float *const *pTo, int iChannels, unsigned iFrames )
+	{
+		if( iChannels != 2 )
+		{
+			Deinterleave_Scalar( pFrom, pTo, iChannels, iFrames );
+			return;
+		}
+
+		unsigned i = 0;
+		for( ; i + 4 <= iFrames; i += 4 )
+		{
+			const __m128 a = _mm_loadu_ps( pFrom + i*2 );
+			const __m128 b = _mm_loadu_ps( pFrom + i*2 + 4 );
+			_mm_storeu_ps( pTo[0]+i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(2,0,2,0)) );
+			_mm_storeu_ps( pTo[1]+i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(3,1,3,1)) );
+		}
+		for( ; i < iFrames; ++i )
+		{
+			pTo[0][i] = pFrom[i*2];
+			pTo[1][i] = pFrom[i*2+1];
+		}
+	}
+
+	float HorizontalSum( __m128 v )
+	{
+		v = _mm_add_ps( v, _mm_movehl_ps(v, v) );
+		v = _mm_add_ss( v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1,1,1,1)) );
+		return _mm_cvtss_f32( v );
+	}
+
+	float DotProduct8_SSE2( const float *a, const float *b )
+	{
+		const __m128 lo = _mm_mul_ps( _mm_loadu_ps(a), _mm_loadu_ps(b) );
+		const __m128 hi = _mm_mul_ps( _mm_loadu_ps(a+4), _mm_loadu_ps(b+4) );
+		return HorizontalSum( _mm_add_ps(lo, hi) );
+	}
+
+	TARGET_AVX2 void Mix_AVX2( float *pDest, const float *pSrc, unsigned iSize, int iSrcStride, int iDestStride )
+	{
+		unsigned i = 0;
+		if( iSrcStride == 1 && iDestStride == 1 )
+		{
+			for( ; i + 8 <= iSize; i += 8 )
+				_mm256_storeu_ps( pDest+i, _mm256_add_ps(_mm256_loadu_ps(pDest+i), _mm256_loadu_ps(pSrc+i)) );
+		}
+		else if( iSrcStride == 2 && iDestStride == 2 )
+		{
+			for( ; i + 4 < iSize; i += 4 )
+			{
+				const __m256 dest = _mm256_loadu_ps( pDest+i*2 );
+				const __m256 sum = _mm256_add_ps( dest, _mm256_loadu_ps(pSrc+i*2) );
+				_mm256_storeu_ps( pDest+i*2, _mm256_blend_ps(dest, sum, 0x55) );
+			}
+		}
+		Mix_SSE2( pDest + i*iDestStride, pSrc + i*iSrcStride, iSize - i, iSrcStride, iDestStride );
+	}
+
+	TARGET_AVX2 void ConvertToInt16Clipped_AVX2( const float *pFrom, std::int16_t *pTo, unsigned iSamples )
+	{
+		const __m256 fMin = _mm256_set1_ps( -1.0f );
+		const __m256 fMax = _mm256_set1_ps( +1.0f );
+		const __m256 fScale = _mm256_set1_ps( 32767 );
+		unsigned i = 0;
+		for( ; i + 16 <= iSamples; i += 16 )
+		{
+			const __m256 a = _mm256_min_ps( _mm256_max_ps(_mm256_loadu_ps(pFrom+i), fMin), fMax );
+			const __m256 b = _mm256_min_ps( _mm256_max_ps(_mm256_loadu_ps(pFrom+i+8), fMin), fMax );
+			const __m256i ia = _mm256_cvtps_epi32( _mm256_mul_ps(a, fScale) );
+			const __m256i ib = _mm256_cvtps_epi32( _mm256_mul_ps(b, fScale) );
+			/* Packing works within each half, so put the quarters back in order. */
+			const __m256i packed = _mm256_packs_epi32( ia, ib );
+			_mm256_storeu_si256( (__m256i *) (pTo+i), _mm256_permute4x64_epi64(packed, _MM_SHUFFLE(3,1,2,0)) );
+		}
+		ConvertToInt16Clipped_SSE2( pFrom+i, pTo+i, iSamples-i );
+	}
+
+	TARGET_AVX2 void Deinterleave_AVX2( const float *pFrom, float *const *pTo, int iChannels, unsigned iFrames )
+	{
+		if( iChannels != 2 )
+		{
+			Deinterleave_Scalar( pFrom, pTo, iChannels, iFrames );
+			return;
+		}
+
+		unsigned i = 0;
+		for( ; i + 8 <= iFrames; i += 8 )
+		{
+			const __m256 a = _mm256_loadu_ps( pFrom + i*2 );
+			const __m256 b = _mm256_loadu_ps( pFrom + i*2 + 8 );
+			/* Shuffling works within each half, so put the pairs back in order. */
+			const __m256 left = _mm256_shuffle_ps( a, b, _MM_SHUFFLE(2,0,2,0) );
+			const __m256 right = _mm256_shuffle_ps( a, b, _MM_SHUFFLE(3,1,3,1) );
+			_mm256_storeu_ps( pTo[0]+i, _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(left), _MM_SHUFFLE(3,1,2,0))) );
+			_mm256_storeu_ps( pTo[1]+i, _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(right), _MM_SHUFFLE(3,1,2,0))) );
+		}
+		float *pRest[2] = { pTo[0]+i, pTo[1]+i };
+		Deinterleave_SSE2( pFrom + i*2, pRest, 2, iFrames-i );
+	}
+
+	TARGET_AVX2 float DotProduct8_AVX2( const float *a, const float *b )
+	{
+		const __m256 v = _mm256_mul_ps( _mm256_loadu_ps(a), _mm256_loadu_ps(b) );
+		return HorizontalSum( _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1)) );
+	}
+
+	bool CPUHasAVX2()
+	{
+#if defined(_MSC_VER)
+		int info[4];
+		__cpuid( info, 0 );
+		if( info[0] < 7 )
+			return false;
+
+		/* The OS has to save the AVX registers, too. */
+		__cpuid( info, 1 );
+		const bool bOSXSAVE = (info[2] & (1<<27)) != 0;
+		const bool bAVX = (info[2] & (1<<28)) != 0;
+		if( !bOSXSAVE || !bAVX || (_xgetbv(0) & 6) != 6 )
+			return false;
+
+		__cpuidex( info, 7, 0 );
+		return (info[1] & (1<<5)) != 0;
+#else
+		__builtin_cpu_init();
+		return __builtin_cpu_supports( "avx2" );
+#endif
+	}
+#endif
+
+	struct Kernels
+	{
+		void (*Mix)( float *pDest, const float *pSrc, unsigned iSize, int iSrcStride, int iDestStride );
+		void (*ConvertToInt16Clipped)( const float *pFrom, std::int16_t *pTo, unsigned iSamples );
+		void (*Deinterleave)( const float *pFrom, float *const *pTo, int iChannels, unsigned iFrames );
+		float (*DotProduct8)( const float *a, const float *b );
+	};
+
+	const Kernels g_Kernels[RageSoundKernels::NUM_InstructionSet] =
+	{
+		{ Mix_Scalar, ConvertToInt16Clipped_Scalar, Deinterleave_Scalar, DotProduct8_Scalar },
+#if defined(HAVE_X86_KERNELS)
+		{ Mix_SSE2, ConvertToInt16Clipped_SSE2, Deinterleave_SSE2, DotProduct8_SSE2 },
+		{ Mix_AVX2, ConvertToInt16Clipped_AVX2, Deinterleave_AVX2, DotProduct8_AVX2 },
+#else
+		{ Mix_Scalar, ConvertToInt16Clipped_Scalar, Deinterleave_Scalar, DotProduct8_Scalar },
+		{ Mix_Scalar, ConvertToInt16Clipped_Scalar, Deinterleave_Scalar, DotProduct8_Scalar },
+#endif
+	};
+
+	const char *InstructionSetNames[] = {
+		"Scalar",
+		"SSE2",
+		"AVX2",
+	};
+
+	RageSoundKernels::InstructionSet GetBestInstructionSet()
+	{
+		if( RageSoundKernels::IsSupported(RageSoundKernels::InstructionSet_AVX2) )
+			return RageSoundKernels::InstructionSet_AVX2;
+		if( RageSoundKernels::IsSupported(RageSoundKernels::InstructionSet_SSE2) )
+			return RageSoundKernels::InstructionSet_SSE2;
+		return RageSoundKernels::InstructionSet_Scalar;
+	}
+
+	/* This is only changed by tests, so it doesn't need a lock. */
+	RageSoundKernels::InstructionSet &CurrentInstructionSet()
+	{
+		static RageSoundKernels::InstructionSet is = GetBestInstructionSet();
+		return is;
+	}
+
+	const Kernels &CurrentKernels()
+	{
+		return g_Kernels[CurrentInstructionSet()];
+	}
+}
+
+const char *RageSoundKernels::GetInstructionSetName( InstructionSet is )
+{
+	ASSERT( is < NUM_InstructionSet );
+	return InstructionSetNames[is];
+}
+
+bool RageSoundKernels::IsSupported( InstructionSet is )
+{
+	switch( is )
+	{
+	case InstructionSet_Scalar:
+		return true;
+#if defined(HAVE_X86_KERNELS)
+	case InstructionSet_SSE2:
+		return true;
+	case InstructionSet_AVX2:
+	{
+		static const bool bHaveAVX2 = CPUHasAVX2();
+		return bHaveAVX2;
+	}
+#endif
+	default:
+		return false;
+	}
+}
+
+RageSoundKernels::InstructionSet RageSoundKernels::GetInstructionSet()
+{
+	return CurrentInstructionSet();
+}
+
+void RageSoundKernels::SetInstructionSet( InstructionSet is )
+{
+	ASSERT( IsSupported(is) );
+	CurrentInstructionSet() = is;
+}
+
+void RageSoundKernels::Mix( float *pDest, const float *pSrc, unsigned iSize, int iSrcStride, int iDestStride )
+{
+	CurrentKernels().Mix( pDest, pSrc, iSize, iSrcStride, iDestStride );
+}
+
+void RageSoundKernels::ConvertToInt16Clipped( const float *pFrom, std::int16_t *pTo, unsigned iSamples )
+{
+	CurrentKernels().ConvertToInt16Clipped( pFrom, pTo, iSamples );
+}
+
+void RageSoundKernels::Deinterleave( const float *pFrom, float *const *pTo, int iChannels, unsigned iFrames )
+{
+	CurrentKernels().Deinterleave( pFrom, pTo, iChannels, iFrames );
+}
+
+float RageSoundKernels::DotProduct8( const float *a, const float *b )
+{
+	return CurrentKernels().DotProduct8( a, b );
+}
+
+/*
+ * (c) 2026 Stepmania team
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, and/or sell copies of the Software, and to permit persons to
+ * whom the Software is furnished to do so, provided that the above
+ * copyright notice(s) and this permission notice appear in all copies of
+ * the Software and that both the above copyright notice(s) and this
+ * permission notice appear in supporting documentation.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT OF
+ * THIRD PARTY RIGHTS. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR HOLDERS
+ * INCLUDED IN THIS NOTICE BE LIABLE FOR ANY CLAIM, OR ANY SPECIAL INDIRECT
+ * OR CONSEQUENTIAL DAMAGES, OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS
+ * OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
@@ -0,0 +1,64 @@
+#ifndef RAGE_SOUND_KERNELS_H
+#define RAGE_SOUND_KERNELS_H
+
+#include <cstdint>
+
+/**
+ * @brief The inner loops of mixing and resampling.
+ *
+ * Each of these has a plain C++ version and, on x86, SSE2 and AVX2 versions.
+ * The best set the CPU supports is chosen the first time any of them is
+ * called.  Every version gives exactly the same results as the plain one,
+ * except DotProduct8, which adds in a different order. */
+namespace RageSoundKernels
+{
+	enum InstructionSet
+	{
+		InstructionSet_Scalar,
+		InstructionSet_SSE2,
+		InstructionSet_AVX2,
+		NUM_InstructionSet
+	};
+	const char *GetInstructionSetName( InstructionSet is );
+	/** @brief Can this CPU, and this build, use is? */
+	bool IsSupported( InstructionSet is );
+	InstructionSet GetInstructionSet();
+	/** @brief Use is instead of the best set, to compare them.  It must be supported. */
+	void SetInstructionSet( InstructionSet is );
+
+	/** @brief Add pSrc[i*iSrcStride] to pDest[i*iDestStride] for each i below iSize. */
+	void Mix( float *pDest, const float *pSrc, unsigned iSize, int iSrcStride, int iDestStride );
+	/** @brief Clip to [-1,+1] and scale to 16 bits, rounding to the nearest value. */
+	void ConvertToInt16Clipped( const float *pFrom, std::int16_t *pTo, unsigned iSamples );
+	/** @brief Split iFrames interleaved frames into a buffer for each channel. */
+	void Deinterleave( const float *pFrom, float *const *pTo, int iChannels, unsigned iFrames );
+	/** @brief The sum of a[i]*b[i] for i below 8: one output of an 8-tap filter. */
+	float DotProduct8( const float *a, const float *b );
+}
+
+#endif
+
+/*
+ * (c) 2026 Stepmania team
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, and/or sell copies of the Software, and to permit persons to
+ * whom the Software is furnished to do so, provided that the above
+ * copyright notice(s) and this permission notice appear in all copies of
+ * the Software and that both the above copyright notice(s) and this
+ * permission notice appear in supporting documentation.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT OF
+ * THIRD PARTY RIGHTS. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR HOLDERS
+ * INCLUDED IN THIS NOTICE BE LIABLE FOR ANY CLAIM, OR ANY SPECIAL INDIRECT
+ * OR CONSEQUENTIAL DAMAGES, OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS
+ * OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
@@ -1,17 +1,10 @@
 #include "global.h"
 #include "RageSoundMixBuffer.h"
+#include "RageSoundKernels.h"
 #include "RageUtil.h"
 
-#include <cmath>
 #include <cstdint>
 
-#if defined(MACOSX)
-#include "archutils/Darwin/VectorHelper.h"
-#ifdef USE_VEC
-static bool g_bVector = Vector::CheckForVector();
-#endif
-#endif
-
 RageSoundMixBuffer::RageSoundMixBuffer()
 {
 	m_iBufSize = m_iBufUsed = 0;
@@ -58,32 +51,12 @@ void RageSoundMixBuffer::write( const float *pBuf, unsigned iSize, int iSourceSt
 
 	/* Scale volume and add. */
 	float *pDestBuf = m_pMixbuf+m_iOffset;
-
-#ifdef USE_VEC
-	if( g_bVector && iSourceStride == 1 && iDestStride == 1 )
-	{
-		Vector::FastSoundWrite( pDestBuf, pBuf, iSize );
-		return;
-	}
-#endif
-
-	while( iSize )
-	{
-		*pDestBuf += *pBuf;
-		pBuf += iSourceStride;
-		pDestBuf += iDestStride;
-		--iSize;
-	}
+	RageSoundKernels::Mix( pDestBuf, pBuf, iSize, iSourceStride, iDestStride );
 }
 
 void RageSoundMixBuffer::read( std::int16_t *pBuf )
 {
-	for( unsigned iPos = 0; iPos < m_iBufUsed; ++iPos )
-	{
-		float iOut = m_pMixbuf[iPos];
-		iOut = clamp( iOut, -1.0f, +1.0f );
-		pBuf[iPos] = std::lrint(iOut * 32767);
-	}
+	RageSoundKernels::ConvertToInt16Clipped( m_pMixbuf, pBuf, m_iBufUsed );
 	m_iBufUsed = 0;
 }
 
@@ -95,9 +68,7 @@ void RageSoundMixBuffer::read( float *pBuf )
 
 void RageSoundMixBuffer::read_deinterlace( float **pBufs, int channels )
 {
-	for( unsigned i = 0; i < m_iBufUsed / channels; ++i )
-		for( int ch = 0; ch < channels; ++ch )
-			pBufs[ch][i] = m_pMixbuf[channels * i + ch];
+	RageSoundKernels::Deinterleave( m_pMixbuf, pBufs, channels, m_iBufUsed / channels );
 	m_iBufUsed = 0;
 }
 
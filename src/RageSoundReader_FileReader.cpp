@@ -12,7 +12,7 @@
 #include "RageSoundReader_MP3.h"
 #include "RageSoundReader_Vorbisfile.h"
 
-RageSoundReader_FileReader *RageSoundReader_FileReader::TryOpenFile( RageFileBasic *pFile, RString &error, RString format, bool &bKeepTrying )
+RageSoundReader_FileReader *RageSoundReader_FileReader::TryOpenFile( RageFileBasic *pFile, RString &error, RString format, bool &bKeepTrying, const RString &sPath )
 {
 	RageSoundReader_FileReader *Sample = nullptr;
 
@@ -28,6 +28,7 @@ RageSoundReader_FileReader *RageSoundReader_FileReader::TryOpenFile( RageFileBas
 	if( !Sample )
 		return nullptr;
 
+	Sample->m_sPath = sPath;
 	OpenResult ret = Sample->Open( pFile );
 	pFile = nullptr; // Sample owns it now
 	if( ret == OPEN_OK )
@@ -130,7 +131,7 @@ RageSoundReader_FileReader *RageSoundReader_FileReader::OpenFile( RString filena
 	/* If the extension matches a format, try that first. */
 	if( FileTypes.find(format) != FileTypes.end() )
 	{
-		RageSoundReader_FileReader *NewSample = TryOpenFile( pFile->Copy(), error, format, bKeepTrying );
+		RageSoundReader_FileReader *NewSample = TryOpenFile( pFile->Copy(), error, format, bKeepTrying, filename );
 		if( NewSample )
 			return NewSample;
 		FileTypes.erase( format );
@@ -138,7 +139,7 @@ RageSoundReader_FileReader *RageSoundReader_FileReader::OpenFile( RString filena
 
 	for( std::set<RString>::iterator it = FileTypes.begin(); bKeepTrying && it != FileTypes.end(); ++it )
 	{
-		RageSoundReader_FileReader *NewSample = TryOpenFile( pFile->Copy(), error, *it, bKeepTrying );
+		RageSoundReader_FileReader *NewSample = TryOpenFile( pFile->Copy(), error, *it, bKeepTrying, filename );
 		if( NewSample )
 		{
 			LOG->UserLog( "Sound file", pFile->GetDisplayPath(), "is really %s.", it->c_str() );
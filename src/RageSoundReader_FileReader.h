@@ -39,9 +39,12 @@ public:
 protected:
 	void SetError( RString sError ) const { m_sError = sError; }
 	HiddenPtr<RageFileBasic> m_pFile;
+	/* The path the file was opened with, for looking it up in AudioMetadataCache.
+	 * This is set before Open is called. */
+	RString m_sPath;
 
 private:
-	static RageSoundReader_FileReader *TryOpenFile( RageFileBasic *pFile, RString &error, RString format, bool &bKeepTrying );
+	static RageSoundReader_FileReader *TryOpenFile( RageFileBasic *pFile, RString &error, RString format, bool &bKeepTrying, const RString &sPath );
 	mutable RString m_sError;
 };
 
@@ -2,13 +2,14 @@
 
 #include "global.h"
 #include "RageSoundReader_MP3.h"
+#include "AudioMetadataCache.h"
+#include "FlatMap.h"
 #include "RageLog.h"
 #include "RageUtil.h"
 
 #include <cerrno>
 #include <cstdint>
 #include <cstdio>
-#include <map>
 
 #include "mad.h"
 
@@ -164,6 +165,10 @@ static void mad_timer_sub(mad_timer_t *a, mad_timer_t b)
 
 
 
+/* The frame index has an entry at most every this many frames, so seeking
+ * with it never decodes more than this many frames to catch up. */
+static const int INDEX_INTERVAL = 16;
+
 /* internal->decoder_private field */
 struct madlib_t
 {
@@ -204,18 +209,12 @@ struct madlib_t
 	int timer_accurate;
 
 	/*
-	 * Frame index of each percentage of the file.  This is constructed
-	 * as we read the file, so we can quickly seek back later.
+	 * Frame index: the byte offset of every INDEX_INTERVAL'th frame, by the
+	 * sample frame it starts at.  This is constructed as we read the file, or
+	 * read from AudioMetadataCache, so we can seek with a binary search and a
+	 * short decode.
 	 */
-	struct mad_timer_compare_lt
-	{
-		bool operator() ( const mad_timer_t &timer1, const mad_timer_t &timer2 ) const
-		{
-			return mad_timer_compare( timer1, timer2 ) < 0;
-		}
-	};
-
-	typedef std::map<mad_timer_t, int, mad_timer_compare_lt> tocmap_t;
+	typedef FlatMap<int, int> tocmap_t;
 	tocmap_t tocmap;
 
 	/* Position in the file of inbuf: */
@@ -368,21 +367,26 @@ void fill_frame_index_cache( madlib_t *mad )
 	/* the frame we just decoded: */
 	pos = get_this_frame_byte(mad);
 
-	/* Fill in the TOC percent. */
+	if( mad->Frame.header.samplerate == 0 )
+		return;
+	const mad_units units = mad_units( mad->Frame.header.samplerate );
+	const int iFrame = mad_timer_count( mad->Timer, units );
+
 	if( !mad->tocmap.empty() )
 	{
-		/* Don't add an entry if one already exists near this time. */
-		madlib_t::tocmap_t::iterator it = mad->tocmap.upper_bound( mad->Timer );
+		/* Don't add an entry if one already exists within INDEX_INTERVAL frames
+		 * before this one. */
+		madlib_t::tocmap_t::iterator it = mad->tocmap.upper_bound( iFrame );
 		if( it != mad->tocmap.begin() )
 		{
 			--it;
-			int iDiffSeconds = mad->Timer.seconds - it->first.seconds;
-			if( iDiffSeconds < 5 )
+			const int iFrameLength = mad_timer_count( mad->Frame.header.duration, units );
+			if( iFrame - it->first < INDEX_INTERVAL * iFrameLength )
 				return;
 		}
 	}
 
-	mad->tocmap[mad->Timer] = pos;
+	mad->tocmap[iFrame] = pos;
 }
 
 /* Handle first-stage decoding: extracting the MP3 frame data. */
@@ -528,6 +532,7 @@ void RageSoundReader_MP3::synth_output()
  * to use this. */
 int RageSoundReader_MP3::seek_stream_to_byte( int byte )
 {
+	m_bReadFromStart = false;
 	if( m_pFile->Seek(byte) == -1 )
 	{
 		SetError( strerror(errno) );
@@ -602,6 +607,9 @@ RageSoundReader_MP3::RageSoundReader_MP3()
 {
 	mad = new madlib_t;
 	m_bAccurateSync = false;
+	m_bCheckedSeekTable = false;
+	m_bHaveSeekTable = false;
+	m_bReadFromStart = true;
 
 	mad_stream_init( &mad->Stream );
 	mad_frame_init( &mad->Frame );
@@ -678,6 +686,7 @@ RageSoundReader_MP3 *RageSoundReader_MP3::Copy() const
 
 	ret->m_pFile = m_pFile->Copy();
 	ret->m_pFile->Seek( 0 );
+	ret->m_sPath = m_sPath;
 	ret->m_bAccurateSync = m_bAccurateSync;
 	ret->mad->filesize = mad->filesize;
 	ret->mad->bitrate = mad->bitrate;
@@ -685,6 +694,9 @@ RageSoundReader_MP3 *RageSoundReader_MP3::Copy() const
 	ret->mad->framelength = mad->framelength;
 	ret->Channels = Channels;
 	ret->mad->length = mad->length;
+	ret->mad->tocmap = mad->tocmap;
+	ret->m_bCheckedSeekTable = m_bCheckedSeekTable;
+	ret->m_bHaveSeekTable = m_bHaveSeekTable;
 
 //	int n = ret->do_mad_frame_decode();
 //	ASSERT( n > 0 );
@@ -718,7 +730,18 @@ int RageSoundReader_MP3::Read( float *buf, int iFrames )
 		/* Decode more from the MP3 stream. */
 		int ret = do_mad_frame_decode();
 		if( ret == 0 )
+		{
+			/* Having read the whole file in order, the index covers all of it,
+			 * so keep it for seeking next time. */
+			if( m_bReadFromStart && mad->timer_accurate && !LoadSeekTable() )
+			{
+				mad_timer_t end = mad->Timer;
+				mad_timer_add( &end, mad->framelength );
+				WriteMetadata( mad_timer_count(end, MAD_UNITS_MILLISECONDS) );
+				m_bHaveSeekTable = true;
+			}
 			return END_OF_FILE;
+		}
 		if( ret == -1 )
 			return ERROR;
 
@@ -731,6 +754,7 @@ int RageSoundReader_MP3::Read( float *buf, int iFrames )
 bool RageSoundReader_MP3::MADLIB_rewind()
 {
 	m_pFile->Seek(0);
+	m_bReadFromStart = true;
 
 	mad_frame_mute(&mad->Frame);
 	mad_synth_mute(&mad->Synth);
@@ -757,8 +781,9 @@ bool RageSoundReader_MP3::MADLIB_rewind()
  *
  * 1. We can jump based on a TOC.  We potentially have two; the Xing TOC and our
  *    own index.  The Xing TOC is only accurate to 1/256th of the file size,
- *    so it's unsuitable for precise seeks.  Our own TOC is byte-accurate.
- *    (SetPosition_toc)
+ *    so it's unsuitable for precise seeks.  Our own TOC is byte-accurate, and
+ *    once the whole file has been indexed (LoadSeekTable), it has an entry
+ *    every INDEX_INTERVAL frames.  (SetPosition_toc)
  *
  * 2. We can jump based on the bitrate.  This is fast, but not accurate.
  *    (SetPosition_estimate)
@@ -783,6 +808,7 @@ int RageSoundReader_MP3::SetPosition_toc( int iFrame, bool Xing )
 	mad->timer_accurate = !Xing;
 
 	int bytepos = -1;
+	mad_timer_t toc_timer = mad_timer_zero;
 	if( Xing )
 	{
 		/* We can speed up the seek using the XING tag.  First, figure
@@ -803,20 +829,17 @@ int RageSoundReader_MP3::SetPosition_toc( int iFrame, bool Xing )
 	}
 	else
 	{
-		mad_timer_t desired;
-		mad_timer_set( &desired, 0, iFrame, SampleRate );
-
 		if( mad->tocmap.empty() )
 			return 1; /* don't have any info */
 
 		/* Find the last entry <= iFrame that we actually have an entry for;
 		 * this will get us as close as possible. */
-		madlib_t::tocmap_t::iterator it = mad->tocmap.upper_bound( desired );
+		madlib_t::tocmap_t::iterator it = mad->tocmap.upper_bound( iFrame );
 		if( it == mad->tocmap.begin() )
 			return 1; /* don't have any info */
 		--it;
 
-		mad->Timer = it->first;
+		mad_timer_set( &toc_timer, 0, it->first, SampleRate );
 		bytepos = it->second;
 	}
 
@@ -826,12 +849,23 @@ int RageSoundReader_MP3::SetPosition_toc( int iFrame, bool Xing )
 		const int seekpos = std::max( 0, bytepos - 1024*4 );
 		seek_stream_to_byte( seekpos );
 
+		/* The frames decoded on the way to bytepos advance the timer, so it's
+		 * only right once we get there; don't index them. */
+		if( !Xing )
+			mad->timer_accurate = false;
+
 		do
 		{
 			int ret = do_mad_frame_decode();
 			if( ret <= 0 )
 				return ret; /* it set the error */
 		} while( get_this_frame_byte(mad) < bytepos );
+
+		if( !Xing && get_this_frame_byte(mad) == bytepos )
+		{
+			mad->Timer = toc_timer;
+			mad->timer_accurate = true;
+		}
 		synth_output();
 	}
 
@@ -853,12 +887,22 @@ int RageSoundReader_MP3::SetPosition_hard( int iFrame )
 	 * same frame twice. */
 	bool synthed=true;
 
-	/* If we're already past the requested position, rewind. */
+	/* If we're already past the requested position, go back.  If we have an
+	 * index entry before it, start from there instead of the beginning. */
 	if(mad_timer_compare(mad->Timer, desired) > 0)
 	{
-		MADLIB_rewind();
-		do_mad_frame_decode();
-		synthed = false;
+		if( !mad->tocmap.empty() && mad->tocmap.begin()->first <= iFrame )
+		{
+			int ret = SetPosition_toc( iFrame, false );
+			if( ret <= 0 )
+				return ret; /* it set the error */
+		}
+		else
+		{
+			MADLIB_rewind();
+			do_mad_frame_decode();
+			synthed = false;
+		}
 	}
 
 	/* Decode frames until the current frame contains the desired offset. */
@@ -960,8 +1004,13 @@ int RageSoundReader_MP3::SetPosition_estimate( int iFrame )
 
 int RageSoundReader_MP3::SetPosition( int iFrame )
 {
-	if( m_bAccurateSync )
+	/* With a cached index of the whole file, every seek is accurate and
+	 * cheap, so use it even if we weren't asked to be accurate.  Without one,
+	 * seek as before; the index is only built by reading the whole file. */
+	if( m_bAccurateSync || (iFrame && LoadSeekTable()) )
 	{
+		LoadSeekTable();
+
 		/* Seek using our own internal (accurate) TOC. */
 		int ret = SetPosition_toc( iFrame, false );
 		if( ret <= 0 )
@@ -1012,6 +1061,10 @@ int RageSoundReader_MP3::GetLengthInternal( bool fast )
 	if( mad->has_xing && mad->length != -1 )
 		return mad->length; /* should be accurate */
 
+	AudioMetadataCache::Info info;
+	if( AudioMetadataCache::GetInfo(m_sPath, info) )
+		return info.m_iLengthMilliseconds;
+
 	/* Check to see if a frame in the middle of the file is the same
 	 * bitrate as the first frame.  If it is, assume the file is really CBR. */
 	seek_stream_to_byte( mad->filesize / 2 );
@@ -1035,7 +1088,19 @@ int RageSoundReader_MP3::GetLengthInternal( bool fast )
 		return -1;
 	}
 
+	return ScanFile();
+}
+
+/* Read the header of every frame from the beginning, indexing the whole file.
+ * This leaves the stream at the end.  Returns the length in milliseconds, or
+ * -1 on error. */
+int RageSoundReader_MP3::ScanFile()
+{
+	/* Anything already in the index may have been put there while looking
+	 * around the file, so start it over. */
 	MADLIB_rewind();
+	mad->tocmap.clear();
+	mad->timer_accurate = true;
 	for(;;)
 	{
 		int ret = do_mad_frame_decode( true );
@@ -1055,7 +1120,40 @@ int RageSoundReader_MP3::GetLengthInternal( bool fast )
 	mad_timer_add( &end, mad->framelength );
 
 	/* Count milliseconds. */
-	return mad_timer_count( end, MAD_UNITS_MILLISECONDS );
+	const int iLength = mad_timer_count( end, MAD_UNITS_MILLISECONDS );
+	WriteMetadata( iLength );
+	return iLength;
+}
+
+/* Add the index of the whole file from the cache, if a previous read or scan
+ * of the file left one.  This never reads the MP3 itself, so a seek never
+ * waits for the whole file.  Returns whether the index covers the file. */
+bool RageSoundReader_MP3::LoadSeekTable()
+{
+	if( m_bCheckedSeekTable )
+		return m_bHaveSeekTable;
+	m_bCheckedSeekTable = true;
+
+	AudioMetadataCache::SeekTable table;
+	if( !AudioMetadataCache::GetSeekTable(m_sPath, table) )
+		return false;
+	mad->tocmap.insert( table.begin(), table.end() );
+	m_bHaveSeekTable = true;
+	return true;
+}
+
+/* Called after reading or scanning the whole file, when the index covers all
+ * of it. */
+void RageSoundReader_MP3::WriteMetadata( int iLengthMilliseconds ) const
+{
+	AudioMetadataCache::Info info;
+	info.m_iLengthMilliseconds = iLengthMilliseconds;
+	info.m_iSampleRate = SampleRate;
+	info.m_iChannels = Channels;
+	AudioMetadataCache::SetInfo( m_sPath, info );
+
+	const AudioMetadataCache::SeekTable table( mad->tocmap.begin(), mad->tocmap.end() );
+	AudioMetadataCache::SetSeekTable( m_sPath, table );
 }
 
 int RageSoundReader_MP3::GetLengthConst( bool fast ) const
@@ -36,9 +36,17 @@ private:
 	int SampleRate;
 	int Channels;
 	bool m_bAccurateSync;
+	bool m_bCheckedSeekTable;
+	bool m_bHaveSeekTable;
+	/* Whether everything since the start of the file has been decoded in
+	 * order, so the index has every frame so far. */
+	bool m_bReadFromStart;
 
 	madlib_t *mad;
 
+	bool LoadSeekTable();
+	int ScanFile();
+	void WriteMetadata( int iLengthMilliseconds ) const;
 
 	bool MADLIB_rewind();
 	int SetPosition_toc( int iSample, bool Xing );
@@ -7,6 +7,7 @@
  */
 #include "global.h"
 #include "RageSoundReader_Resample_Good.h"
+#include "RageSoundKernels.h"
 #include "RageLog.h"
 #include "RageUtil.h"
 #include "RageMath.h"
@@ -17,8 +18,10 @@
 #include <cstdint>
 #include <numeric>
 
-/* Filter length.  This must be a power of 2. */
+/* Filter length.  This must be a power of 2, and RunPolyphaseFilter
+ * assumes it's 8. */
 #define L 8
+static_assert( L == 8, "RunPolyphaseFilter uses RageSoundKernels::DotProduct8" );
 
 namespace
 {
@@ -318,10 +321,7 @@ int PolyphaseFilter::RunPolyphaseFilter(
 			const float *pCurPoly = &m_pPolyphase[iPolyIndex*L];
 			const float *pInData = &State.m_fBuf[State.m_iBufNext];
 
-			float fTot = 0;
-			for( int j = 0; j < L; ++j )
-				fTot += pInData[j]*pCurPoly[j];
-			*pOut = fTot;
+			*pOut = RageSoundKernels::DotProduct8( pInData, pCurPoly );
 			pOut += iSampleStride;
 
 			iPolyIndex += iDownFactor;
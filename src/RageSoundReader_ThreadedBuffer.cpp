@@ -18,8 +18,8 @@
 // The amount of data to read at once:
 static const unsigned g_iReadBlockSizeFrames = 1024;
 
-// The maximum number of frames to buffer:
-static const int g_iStreamingBufferFrames = 1024*32;
+// The maximum number of frames to buffer; a little over a second at 44.1kHz:
+static const int g_iStreamingBufferFrames = 1024*48;
 
 /* When a sound has fewer than g_iMinFillFrames buffered, buffer at maximum speed.
  * Once beyond that, fill at a limited rate. */
@@ -137,6 +137,26 @@ int RageSoundReader_ThreadedBuffer::SetPosition( int iFrame )
 	return iRet;
 }
 
+void RageSoundReader_ThreadedBuffer::Prebuffer( int iFrames )
+{
+	bool bWasEnabled = DisableBuffering();
+
+	m_Event.Lock();
+	m_bFilling = true;
+	while( !m_bEOF && GetFilledFrames() < iFrames )
+	{
+		// This stops when the buffer is full, or at the end of the file.
+		if( FillBlock() <= 0 )
+			break;
+	}
+	m_bFilling = false;
+	m_Event.Broadcast();
+	m_Event.Unlock();
+
+	if( bWasEnabled )
+		EnableBuffering();
+}
+
 int RageSoundReader_ThreadedBuffer::GetEmptyFrames() const
 {
 	int iSamplesPerFrame = this->GetNumChannels();
@@ -36,6 +36,10 @@ public:
 	bool DisableBuffering();
 	bool DisableBuffering() const { return const_cast<RageSoundReader_ThreadedBuffer *>(this)->DisableBuffering(); }
 
+	/* Fill the buffer with up to iFrames frames from the calling thread, so a
+	 * sound that's about to start doesn't wait for the buffering thread. */
+	void Prebuffer( int iFrames );
+
 private:
 	int FillFrames( int iBytes );
 	int FillBlock();
@@ -1284,6 +1284,16 @@ void Trim( RString &sStr, const char *s )
 	sStr.assign( sStr.substr(b, e-b) );
 }
 
+void Trim( std::string_view &sStr, const char *s )
+{
+	std::string_view::size_type b = 0, e = sStr.size();
+	while( b < e && strchr(s, sStr[b]) )
+		++b;
+	while( b < e && strchr(s, sStr[e-1]) )
+		--e;
+	sStr = sStr.substr( b, e-b );
+}
+
 void StripCrnl( RString &s )
 {
 	while( s.size() && (s[s.size()-1] == '\r' || s[s.size()-1] == '\n') )
@@ -12,6 +12,7 @@
 #include <map>
 #include <random>
 #include <sstream>
+#include <string_view>
 #include <vector>
 
 class RageFileDriver;
@@ -494,6 +495,7 @@ inline T Decrement( T a ) { --a; return a; }
 void TrimLeft( RString &sStr, const char *szTrim = "\r\n\t " );
 void TrimRight( RString &sStr, const char *szTrim = "\r\n\t " );
 void Trim( RString &sStr, const char *szTrim = "\r\n\t " );
+void Trim( std::string_view &sStr, const char *szTrim = "\r\n\t " );
 void StripCrnl( RString &sStr );
 bool BeginsWith( const RString &sTestThis, const RString &sBeginning );
 bool EndsWith( const RString &sTestThis, const RString &sEnding );
@@ -30,6 +30,7 @@
 #include "ScreenSyncOverlay.h"
 #include "ThemeMetric.h"
 #include "XmlToLua.h"
+#include "JudgmentLatency.h"
 
 #include "calm/CalmDisplay.h"
 
@@ -594,6 +595,7 @@ static LocalizedString VISUAL_DELAY_DOWN	( "ScreenDebugOverlay", "Visual Delay D
 static LocalizedString VOLUME_UP		( "ScreenDebugOverlay", "Volume Up" );
 static LocalizedString VOLUME_DOWN		( "ScreenDebugOverlay", "Volume Down" );
 static LocalizedString UPTIME			( "ScreenDebugOverlay", "Uptime" );
+static LocalizedString JUDGMENT_LATENCY	( "ScreenDebugOverlay", "Judgment Latency" );
 static LocalizedString FORCE_CRASH		( "ScreenDebugOverlay", "Force Crash" );
 static LocalizedString SLOW			( "ScreenDebugOverlay", "Slow" );
 static LocalizedString CPU				( "ScreenDebugOverlay", "CPU" );
@@ -1326,6 +1328,22 @@ class DebugLineUptime : public IDebugLine
 	virtual void DoAndLog( RString &sMessageOut ) {}
 };
 
+class DebugLineJudgmentLatency : public IDebugLine
+{
+	virtual RString GetDisplayTitle() { return JUDGMENT_LATENCY.GetValue(); }
+	virtual RString GetDisplayValue()
+	{
+		const JudgmentLatency::Summary s = JudgmentLatency::GetSummary( LatencyStage_Judgment );
+		return ssprintf( "%.1f/%.1f/%.1fms (%u)", s.m_fMin*1000, s.m_fMedian*1000, s.m_fP99*1000, s.m_iCount );
+	}
+	virtual bool IsEnabled() { return false; }
+	virtual void DoAndLog( RString &sMessageOut )
+	{
+		JudgmentLatency::Write();
+		IDebugLine::DoAndLog( sMessageOut );
+	}
+};
+
 /* #ifdef out the lines below if you don't want them to appear on certain
  * platforms.  This is easier than #ifdefing the whole DebugLine definitions
  * that can span pages.
@@ -1370,6 +1388,7 @@ DECLARE_ONE( DebugLineVisualDelayDown );
 DECLARE_ONE( DebugLineVisualDelayUp );
 DECLARE_ONE( DebugLineForceCrash );
 DECLARE_ONE( DebugLineUptime );
+DECLARE_ONE( DebugLineJudgmentLatency );
 DECLARE_ONE( DebugLineResetKeyMapping );
 DECLARE_ONE( DebugLineMuteActions );
 
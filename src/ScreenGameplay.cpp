@@ -1492,7 +1492,11 @@ void ScreenGameplay::StartPlayingSong( float fMinTimeToNotes, float fMinTimeToMu
 	{
 		if(GAMESTATE->m_pCurSteps[pn])
 		{
-			GAMESTATE->m_pCurSteps[pn]->GetTimingData()->PrepareLookup();
+			// Work out the time of every row up to the last note, so the
+			// notes' times don't have to be searched for every frame.
+			TimingData *pTiming = GAMESTATE->m_pCurSteps[pn]->GetTimingData();
+			const float fLastBeat = pTiming->GetBeatFromElapsedTime( GAMESTATE->m_pCurSong->GetLastSecond() );
+			pTiming->PrepareLookup( BeatToNoteRow(fLastBeat) + ROWS_PER_BEAT );
 		}
 	}
 }
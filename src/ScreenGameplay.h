@@ -229,7 +229,7 @@ protected:
 	void SendCrossedMessages();
 
 	void PlayTicks();
-	void UpdateSongPosition( float fDeltaTime );
+	virtual void UpdateSongPosition( float fDeltaTime );
 	void UpdateLyrics( float fDeltaTime );
 	void SongFinished();
 	virtual void SaveStats();
@@ -0,0 +1,112 @@
+#include "global.h"
+#include "ScreenGameplayBenchmark.h"
+#include "CommonMetrics.h"
+#include "GameplayBenchmark.h"
+#include "GameState.h"
+#include "PlayerState.h"
+#include "RageSound.h"
+#include "Song.h"
+#include "StatsManager.h"
+
+
+REGISTER_SCREEN_CLASS( ScreenGameplayBenchmark );
+
+void ScreenGameplayBenchmark::Init()
+{
+	const GameplayBenchmark::Chart *pChart = GameplayBenchmark::GetChart();
+	ASSERT( pChart != nullptr );
+
+	// Start every chart from the same state.
+	GAMESTATE->Reset();
+	STATSMAN->Reset();
+	GAMESTATE->JoinPlayer( PLAYER_1 );
+	GAMESTATE->m_PlayMode.Set( PLAY_MODE_REGULAR );
+	GAMESTATE->SetCurrentStyle( pChart->m_pStyle, PLAYER_1 );
+	GAMESTATE->m_pCurSong.Set( pChart->m_pSong );
+	GAMESTATE->m_pCurSteps[PLAYER_1].Set( pChart->m_pSteps );
+
+	/* Leave out the machine's default modifiers, so that every machine plays
+	 * the chart the same way. */
+	PlayerOptions po;
+	po.Init();
+	po.FromString( CommonMetrics::DEFAULT_MODIFIERS );
+	po.FromString( pChart->m_sModifiers );
+	if( po.m_sNoteSkin.empty() )
+		po.m_sNoteSkin = CommonMetrics::DEFAULT_NOTESKIN_NAME;
+	po.m_fPlayerAutoPlay = 1;
+	po.m_FailType = FailType_Off;
+	GAMESTATE->m_pPlayerState[PLAYER_1]->m_PlayerOptions.Assign( ModsLevel_Stage, po );
+
+	SongOptions so;
+	so.Init();
+	so.FromString( CommonMetrics::DEFAULT_MODIFIERS );
+	GAMESTATE->m_SongOptions.Assign( ModsLevel_Stage, so );
+
+	m_fMusicSeconds = 0;
+	m_bMusicStarted = false;
+
+	ScreenGameplayNormal::Init();
+
+	ClearMessageQueue();	// remove all of the messages set in ScreenGameplay that animate "ready", "here we go", etc.
+
+	GAMESTATE->m_bGameplayLeadIn.Set( false );
+
+	m_DancingState = STATE_DANCING;
+
+	GameplayBenchmark::BeginChart();
+}
+
+void ScreenGameplayBenchmark::HandleScreenMessage( const ScreenMessage SM )
+{
+	if( SM == SM_NotesEnded )
+	{
+		GameplayBenchmark::EndChart();
+		return;	// handled
+	}
+
+	ScreenGameplayNormal::HandleScreenMessage( SM );
+}
+
+void ScreenGameplayBenchmark::UpdateSongPosition( float fDeltaTime )
+{
+	/* Nothing is heard, and frames are made as fast as they can be, so the
+	 * music's position is worked out from the frames instead of asked of the
+	 * sound.  It starts wherever StartPlayingSong started the music. */
+	const RageSoundParams &params = m_pSoundMusic->GetParams();
+	if( !m_bMusicStarted )
+	{
+		m_fMusicSeconds = params.m_StartSecond;
+		m_bMusicStarted = true;
+	}
+	else if( !IsPaused() )
+	{
+		m_fMusicSeconds += fDeltaTime * params.m_fSpeed;
+	}
+
+	GAMESTATE->UpdateSongPosition( m_fMusicSeconds, GAMESTATE->m_pCurSong->m_SongTiming, RageTimer() );
+}
+
+/*
+ * (c) 2026 Stepmania team
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, and/or sell copies of the Software, and to permit persons to
+ * whom the Software is furnished to do so, provided that the above
+ * copyright notice(s) and this permission notice appear in all copies of
+ * the Software and that both the above copyright notice(s) and this
+ * permission notice appear in supporting documentation.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT OF
+ * THIRD PARTY RIGHTS. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR HOLDERS
+ * INCLUDED IN THIS NOTICE BE LIABLE FOR ANY CLAIM, OR ANY SPECIAL INDIRECT
+ * OR CONSEQUENTIAL DAMAGES, OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS
+ * OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
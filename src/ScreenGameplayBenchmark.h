@@ -1,21 +1,30 @@
-#ifndef VECTOR_HELPER_H
-#define VECTOR_HELPER_H
+#ifndef ScreenGameplayBenchmark_H
+#define ScreenGameplayBenchmark_H
 
-#if ( defined(__VEC__) || (defined(__SSE__) && defined(__SSE2__)) ) && defined(__GNUC__)
-namespace Vector
+#include "ScreenGameplayNormal.h"
+
+/** @brief Plays the charts GameplayBenchmark was given, one after another, on autoplay. */
+class ScreenGameplayBenchmark : public ScreenGameplayNormal
 {
-	bool CheckForVector();
-	void FastSoundWrite( float *dest, const float *src, unsigned size );
-}
-#define USE_VEC
-#endif
+public:
+	virtual void Init();
+
+	virtual void HandleScreenMessage( const ScreenMessage SM );
+
+protected:
+	virtual void UpdateSongPosition( float fDeltaTime );
+
+	/** @brief Where the music would be, if it were being heard. */
+	float	m_fMusicSeconds;
+	bool	m_bMusicStarted;
+};
 
 #endif
 
 /*
- * (c) 2006 Steve Checkoway
+ * (c) 2026 Stepmania team
  * All rights reserved.
- * 
+ *
  * Permission is hereby granted, free of charge, to any person obtaining a
  * copy of this software and associated documentation files (the
  * "Software"), to deal in the Software without restriction, including
@@ -25,7 +34,7 @@ namespace Vector
  * copyright notice(s) and this permission notice appear in all copies of
  * the Software and that both the above copyright notice(s) and this
  * permission notice appear in supporting documentation.
- * 
+ *
  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
  * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
  * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT OF
@@ -142,6 +142,8 @@ void ScreenSelectMusic::Init()
 
 	this->SubscribeToMessage( Message_PlayerJoined );
 	this->SubscribeToMessage( Message_PlayerProfileSet );
+	this->SubscribeToMessage( Message_SongGroupsLoaded );
+	m_bSongGroupsLoaded = false;
 
 	// Cache these values
 	// Marking for change -- Midiman (why? -aj)
@@ -404,6 +406,14 @@ void ScreenSelectMusic::Update( float fDeltaTime )
 
 	ScreenWithMenuElements::Update( fDeltaTime );
 
+	// Add songs loaded in the background once the wheel is still.
+	if( m_bSongGroupsLoaded && !IsTransitioning() &&
+		m_SelectionState == SelectionState_SelectingSong && m_MusicWheel.IsSettled() )
+	{
+		m_bSongGroupsLoaded = false;
+		m_MusicWheel.SongsAdded();
+	}
+
 	CheckBackgroundRequests( false );
 }
 
@@ -1094,6 +1104,9 @@ void ScreenSelectMusic::ChangeSteps( PlayerNumber pn, int dir )
 
 void ScreenSelectMusic::HandleMessage( const Message &msg )
 {
+	if( msg == Message_SongGroupsLoaded )
+		m_bSongGroupsLoaded = true;
+
 	if( m_bRunning && msg == Message_PlayerJoined )
 	{
 		PlayerNumber master_pn = GAMESTATE->GetMasterPlayerNumber();
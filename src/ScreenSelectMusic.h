@@ -147,6 +147,8 @@ protected:
 	SelectionState	m_SelectionState;
 	bool			m_bStepsChosen[NUM_PLAYERS];	// only used in SelectionState_SelectingSteps
 	bool			m_bGoToOptions;
+	/** @brief Have more songs been loaded in the background since the wheel was built? */
+	bool			m_bSongGroupsLoaded;
 	RString			m_sSampleMusicToPlay;
 	TimingData		*m_pSampleMusicTimingData;
 	float			m_fSampleStartSeconds, m_fSampleLengthSeconds;
@@ -1,11 +1,14 @@
 #include "global.h"
 #include "Song.h"
 #include "Steps.h"
+#include "AudioMetadataCache.h"
+#include "ChartHashCache.h"
 #include "RageUtil.h"
 #include "RageLog.h"
 #include "NoteData.h"
 #include "RageSoundReader_FileReader.h"
 #include "RageSurface_Load.h"
+#include "SongCacheBinary.h"
 #include "SongCacheIndex.h"
 #include "GameManager.h"
 #include "PrefsManager.h"
@@ -19,6 +22,7 @@
 #include "RageFileManager.h"
 #include "RageSurface.h"
 #include "RageTextureManager.h"
+#include "RageThreads.h"
 #include "NoteDataUtil.h"
 #include "SongUtil.h"
 #include "SongManager.h"
@@ -34,6 +38,7 @@
 #include "NotesWriterSSC.h"
 #include "UnlockManager.h"
 #include "LyricsLoader.h"
+#include "LoadProfiler.h"
 #include "ActorUtil.h"
 #include "CommonMetrics.h"
 
@@ -51,7 +56,7 @@
  * @brief The internal version of the cache for StepMania.
  *
  * Increment this value to invalidate the current cache. */
-const int FILE_CACHE_VERSION = 227;
+const int FILE_CACHE_VERSION = 228;
 
 /** @brief How long does a song sample last by default? */
 const float DEFAULT_MUSIC_SAMPLE_LENGTH = 12.f;
@@ -275,6 +280,28 @@ const RString &Song::GetSongFilePath() const
 /* Hack: This should be a parameter to TidyUpData, but I don't want to pull in
  * <set> into Song.h, which is heavily used. */
 static std::set<RString> BlacklistedImages;
+/* Songs may be loaded on several threads at once; this protects BlacklistedImages. */
+static RageMutex g_BlacklistedImagesMutex( "BlacklistedImages" );
+
+static void AddBlacklistedImages( const std::set<RString> &images )
+{
+	if( images.empty() )
+		return;
+	LockMut( g_BlacklistedImagesMutex );
+	BlacklistedImages.insert( images.begin(), images.end() );
+}
+
+static bool IsImageBlacklisted( const RString &sLowerImage )
+{
+	LockMut( g_BlacklistedImagesMutex );
+	return BlacklistedImages.find( sLowerImage ) != BlacklistedImages.end();
+}
+
+static unsigned GetProfiledHashForDirectory( const RString &sDir )
+{
+	LoadProfiler::StageTimer timer( LoadStage_ListDirectories );
+	return GetHashForDirectory( sDir );
+}
 
 /* If PREFSMAN->m_bFastLoad is true, always load from cache if possible.
  * Don't read the contents of sDir if we can avoid it. That means we can't call
@@ -313,28 +340,61 @@ bool Song::LoadFromSongDir(RString sDir, bool load_autosave, ProfileSlot from_pr
 		use_cache= false;
 	}
 
+	LoadProfiler::SongTimer profile_timer(m_sGroupName, m_sSongDir);
+
 	RString cache_file_path;
+	RString cache_record;
 	if(m_LoadedFromProfile == ProfileSlot_Invalid)
 	{
 		// First, look in the cache for this song (without loading NoteData)
 		unsigned uCacheHash = SONGINDEX->GetCacheHash(m_sSongDir);
 		cache_file_path = GetCacheFilePath();
 
-		if( !DoesFileExist(cache_file_path) )
+		LoadProfiler::StageTimer read_timer(LoadStage_ReadCache);
+		if(SongCacheBinary::IsEnabled()?
+			!SONGINDEX->GetCacheRecord(m_sSongDir, cache_record) :
+			!DoesFileExist(cache_file_path))
 		{ use_cache = false; }
-		else if(!PREFSMAN->m_bFastLoad && GetHashForDirectory(m_sSongDir) != uCacheHash)
+		// If the directory, simfile and music haven't changed since the last
+		// scan, the cache entry is still good and hashing every file in the
+		// directory can be skipped.
+		else if(!PREFSMAN->m_bFastLoad &&
+			!(uCacheHash != 0 && SONGMAN != nullptr && SONGMAN->IsSongDirUnchanged(m_sSongDir)) &&
+			GetProfiledHashForDirectory(m_sSongDir) != uCacheHash)
 		{ use_cache = false; } // this cache is out of date
 		else if(load_autosave)
 		{ use_cache= false; }
 	}
 
-	if(use_cache)
+	if(use_cache && SongCacheBinary::IsEnabled())
+	{
+		LoadProfiler::StageTimer read_timer(LoadStage_ReadCache);
+		// A record that fails its checks is treated like a stale cache entry.
+		RString error;
+		use_cache = SongCacheBinary::ReadRecord(cache_record, *this, error);
+		if(!use_cache)
+		{
+			LOG->Trace("Cache record for \"%s\" rejected: %s", m_sSongDir.c_str(), error.c_str());
+			// The record may have been rejected partway through, after some
+			// fields were already filled in.  Start the simfile load from a
+			// clean song.
+			RString dir = m_sSongDir, name = m_sSongName, group = m_sGroupName;
+			Reset();
+			m_sSongDir = dir;
+			m_sSongName = name;
+			m_sGroupName = group;
+		}
+		if(use_cache)
+		{ TidyUpData(true, true); }
+	}
+	else if(use_cache)
 	{
 		/*
 		LOG->Trace("Loading '%s' from cache file '%s'.",
 				   m_sSongDir.c_str(),
 				   GetCacheFilePath().c_str());
 		*/
+		LoadProfiler::StageTimer read_timer(LoadStage_ReadCache);
 		SSCLoader loaderSSC;
 		bool bLoadedFromSSC = loaderSSC.LoadFromSimfile( cache_file_path, *this, true );
 		if( !bLoadedFromSSC )
@@ -344,6 +404,10 @@ bool Song::LoadFromSongDir(RString sDir, bool load_autosave, ProfileSlot from_pr
 			loaderSM.LoadFromSimfile( cache_file_path, *this, true );
 			loaderSM.TidyUpData( *this, true );
 		}
+	}
+
+	if(use_cache)
+	{
 		if(m_sMainTitle == "" || (m_sMusicFile == "" && m_vsKeysoundFile.empty()))
 		{
 			LOG->Warn("Main title or music file for '%s' came up blank, forced to fall back on TidyUpData to fix title and paths.  Do not use # or ; in a song title.", m_sSongDir.c_str());
@@ -357,7 +421,10 @@ bool Song::LoadFromSongDir(RString sDir, bool load_autosave, ProfileSlot from_pr
 		// There was no entry in the cache for this song, or it was out of date.
 		// Let's load it from a file, then write a cache entry.
 
-		if(!NotesLoader::LoadFromDir(sDir, *this, BlacklistedImages, load_autosave))
+		std::set<RString> blacklisted_images;
+		const bool loaded = NotesLoader::LoadFromDir(sDir, *this, blacklisted_images, load_autosave);
+		AddBlacklistedImages(blacklisted_images);
+		if(!loaded)
 		{
 			LOG->UserLog( "Song", sDir, "has no SSC, SM, SMA, DWI, BMS, or KSF files." );
 
@@ -465,6 +532,7 @@ bool Song::ReloadFromSongDir( RString sDir )
 	// Remove the cache file to force the song to reload from its dir instead
 	// of loading from the cache. -Kyz
 	FILEMAN->Remove(GetCacheFilePath());
+	SONGINDEX->RemoveCacheIndex(m_sSongDir);
 
 	RemoveAutoGenNotes();
 	std::vector<Steps*> vOldSteps = m_vpSteps;
@@ -554,6 +622,7 @@ bool Song::ReloadFromSongDir( RString sDir )
 
 void Song::LoadEditsFromSongDir(RString dir)
 {
+	LoadProfiler::StageTimer timer(LoadStage_ParseSimfile);
 	// Load any .edit files in the song folder.
 	// Doing this BEFORE setting up AutoGen just in case.
 	std::vector<RString> vs;
@@ -628,6 +697,7 @@ void FixupPath( RString &path, const RString &sSongPath )
 // Songs in BlacklistImages will never be autodetected as song images.
 void Song::TidyUpData( bool from_cache, bool /* duringCache */ )
 {
+	LoadProfiler::StageTimer timer(LoadStage_TidyUp);
 	// We need to do this before calling any of HasMusic, HasHasCDTitle, etc.
 	ASSERT_M(m_sSongDir.Left(3) != "../", m_sSongDir); // meaningless
 	FixupPath(m_sSongDir, "");
@@ -768,7 +838,13 @@ void Song::TidyUpData( bool from_cache, bool /* duringCache */ )
 			}
 		}
 		// This must be done before radar calculation.
-		if(m_bHasMusic)
+		AudioMetadataCache::Info info;
+		if(m_bHasMusic && AudioMetadataCache::GetInfo(GetMusicPath(), info))
+		{
+			// It's been opened before and hasn't changed since.
+			m_fMusicLengthSeconds = info.m_iLengthMilliseconds / 1000.0f;
+		}
+		else if(m_bHasMusic)
 		{
 			RString error;
 			RageSoundReader *Sample = RageSoundReader_FileReader::OpenFile(GetMusicPath(), error);
@@ -784,7 +860,10 @@ void Song::TidyUpData( bool from_cache, bool /* duringCache */ )
 			}
 			else if(Sample != nullptr)
 			{
-				m_fMusicLengthSeconds = Sample->GetLength() / 1000.0f;
+				info.m_iLengthMilliseconds = Sample->GetLength();
+				info.m_iSampleRate = Sample->GetSampleRate();
+				info.m_iChannels = Sample->GetNumChannels();
+				m_fMusicLengthSeconds = info.m_iLengthMilliseconds / 1000.0f;
 				delete Sample;
 
 				if(m_fMusicLengthSeconds < 0)
@@ -792,9 +871,11 @@ void Song::TidyUpData( bool from_cache, bool /* duringCache */ )
 					// It failed; bad file or something. It's already logged a warning.
 					m_fMusicLengthSeconds = 100; // guess
 				}
-				else if(m_fMusicLengthSeconds == 0)
+				else
 				{
-					LOG->UserLog("Sound file", GetMusicPath(), "is empty.");
+					if(m_fMusicLengthSeconds == 0)
+						LOG->UserLog("Sound file", GetMusicPath(), "is empty.");
+					AudioMetadataCache::SetInfo(GetMusicPath(), info);
 				}
 			}
 		}
@@ -814,7 +895,12 @@ void Song::TidyUpData( bool from_cache, bool /* duringCache */ )
 				m_fMusicLengthSeconds);
 			m_fMusicLengthSeconds = 0;
 		}
-		if(!m_PreviewFile.empty() && m_fMusicSampleLengthSeconds <= 0.00f) { // if there's a preview file and sample length isn't specified, set sample length to length of preview file
+		if(!m_PreviewFile.empty() && m_fMusicSampleLengthSeconds <= 0.00f &&
+			AudioMetadataCache::GetInfo(GetPreviewMusicPath(), info))
+		{
+			m_fMusicSampleLengthSeconds = info.m_iLengthMilliseconds / 1000.0f;
+		}
+		else if(!m_PreviewFile.empty() && m_fMusicSampleLengthSeconds <= 0.00f) { // if there's a preview file and sample length isn't specified, set sample length to length of preview file
 			RString error;
 			RageSoundReader *Sample = RageSoundReader_FileReader::OpenFile(GetPreviewMusicPath(), error);
 			if(Sample == nullptr && m_sMusicFile != "")
@@ -827,7 +913,10 @@ void Song::TidyUpData( bool from_cache, bool /* duringCache */ )
 			}
 			else if(Sample != nullptr)
 			{
-				m_fMusicSampleLengthSeconds = Sample->GetLength() / 1000.0f;
+				info.m_iLengthMilliseconds = Sample->GetLength();
+				info.m_iSampleRate = Sample->GetSampleRate();
+				info.m_iChannels = Sample->GetNumChannels();
+				m_fMusicSampleLengthSeconds = info.m_iLengthMilliseconds / 1000.0f;
 				delete Sample;
 
 				if(m_fMusicSampleLengthSeconds < 0)
@@ -835,9 +924,11 @@ void Song::TidyUpData( bool from_cache, bool /* duringCache */ )
 					// It failed; bad file or something. It's already logged a warning.
 					m_fMusicSampleLengthSeconds = DEFAULT_MUSIC_SAMPLE_LENGTH;
 				}
-				else if(m_fMusicSampleLengthSeconds == 0)
+				else
 				{
-					LOG->UserLog("Sound file", GetPreviewMusicPath(), "is empty.");
+					if(m_fMusicSampleLengthSeconds == 0)
+						LOG->UserLog("Sound file", GetPreviewMusicPath(), "is empty.");
+					AudioMetadataCache::SetInfo(GetPreviewMusicPath(), info);
 				}
 			}
 		} else { // no preview file, calculate sample from music as normal
@@ -967,7 +1058,7 @@ void Song::TidyUpData( bool from_cache, bool /* duringCache */ )
 				// ignore DWI "-char" graphics
 				RString lower = image_list[i];
 				lower.MakeLower();
-				if(BlacklistedImages.find(lower) != BlacklistedImages.end())
+				if(IsImageBlacklisted(lower))
 				continue;	// skip
 
 				// Skip any image that we've already classified
@@ -1133,6 +1224,7 @@ void Song::TranslateTitles()
 
 void Song::ReCalculateRadarValuesAndLastSecond(bool fromCache, bool duringCache)
 {
+	LoadProfiler::StageTimer timer(LoadStage_RadarValues);
 	if( fromCache && this->GetFirstSecond() >= 0 && this->GetLastSecond() > 0 )
 	{
 		// this is loaded from cache, then we just have to calculate the radar values.
@@ -1180,8 +1272,9 @@ void Song::ReCalculateRadarValuesAndLastSecond(bool fromCache, bool duringCache)
 			}
 		}
 
-		// Wipe NoteData
-		if (duringCache)
+		// Wipe NoteData.  The binary cache stores the note data, so leave it
+		// for SaveToCacheFile; Compress frees it right after that.
+		if (duringCache && !SongCacheBinary::IsEnabled())
 		{
 			NoteData dummy;
 			dummy.SetNumTracks(tempNoteData.GetNumTracks());
@@ -1368,10 +1461,26 @@ bool Song::SaveToJsonFile( RString sPath )
 
 bool Song::SaveToCacheFile()
 {
+	LoadProfiler::StageTimer timer(LoadStage_WriteCache);
 	if(SONGMAN->IsGroupNeverCached(m_sGroupName))
 	{
 		return true;
 	}
+	if(SongCacheBinary::IsEnabled())
+	{
+		std::vector<Steps*> vpStepsToSave;
+		for (Steps *pSteps : m_vpSteps)
+		{
+			if( pSteps->IsAutogen() || pSteps->WasLoadedFromProfile() )
+				continue;
+			vpStepsToSave.push_back( pSteps );
+		}
+		vpStepsToSave.insert(vpStepsToSave.end(), m_UnknownStyleSteps.begin(), m_UnknownStyleSteps.end());
+		RString record;
+		SongCacheBinary::WriteRecord(*this, vpStepsToSave, record);
+		SONGINDEX->AddCacheIndex(m_sSongDir, GetHashForDirectory(m_sSongDir), record);
+		return true;
+	}
 	SONGINDEX->AddCacheIndex(m_sSongDir, GetHashForDirectory(m_sSongDir));
 	const RString sPath = GetCacheFilePath();
 	return SaveToSSCFile(sPath, true);
@@ -1736,10 +1845,13 @@ RString Song::GetFileHash()
 			sPath = SetExtension(GetSongFilePath(), "jso");
 		if (!IsAFile(sPath))
 			sPath = SetExtension(GetSongFilePath(), "ssc");
-		if (IsAFile(sPath))
-			m_sFileHash = BinaryToHex(CRYPTMAN->GetSHA1ForFile(sPath));
-		else
+		if (!IsAFile(sPath))
 			m_sFileHash = "";
+		else if (!ChartHashCache::Get(sPath, "FileHash", m_sFileHash))
+		{
+			m_sFileHash = BinaryToHex(CRYPTMAN->GetSHA1ForFile(sPath));
+			ChartHashCache::Set(sPath, "FileHash", m_sFileHash);
+		}
 	}
 	return m_sFileHash;
 }
@@ -2247,6 +2359,11 @@ public:
 		lua_pushstring(L, p->GetSongFilePath() );
 		return 1;
 	}
+	static int GetFileHash( T* p, lua_State *L )
+	{
+		lua_pushstring(L, p->GetFileHash() );
+		return 1;
+	}
 	static int IsTutorial( T* p, lua_State *L )
 	{
 		lua_pushboolean(L, p->IsTutorial());
@@ -2482,6 +2599,7 @@ public:
 		ADD_METHOD( GetCDTitlePath );
 		ADD_METHOD( GetLyricsPath );
 		ADD_METHOD( GetSongFilePath );
+		ADD_METHOD( GetFileHash );
 		ADD_METHOD( IsTutorial );
 		ADD_METHOD( IsEnabled );
 		ADD_METHOD(IsCustomSong);
@@ -0,0 +1,682 @@
+#include "global.h"
+#include "SongCacheBinary.h"
+#include "Song.h"
+#include "Steps.h"
+#include "BackgroundUtil.h"
+#include "GameManager.h"
+#include "PrefsManager.h"
+#include "RageFile.h"
+#include "RageFileDriverDeflate.h"
+#include "RageLog.h"
+#include "RageUtil.h"
+#include "SongCacheIndex.h"
+
+#include <cstdint>
+#include <cstring>
+
+static Preference<bool> g_bBinarySongCache( "BinarySongCache", false );
+
+/* "SMBC"; everything in a record is little-endian. */
+static const uint32_t RECORD_MAGIC = 0x43424D53;
+/* Bump this whenever the payload layout changes. */
+static const uint32_t RECORD_FORMAT_VERSION = 3;
+/* magic, format version, FILE_CACHE_VERSION, payload size, payload CRC32 */
+static const std::size_t RECORD_HEADER_SIZE = 5*sizeof(uint32_t);
+
+namespace
+{
+	class RecordWriter
+	{
+	public:
+		RecordWriter( RString &sOut ): m_sOut(sOut) { }
+
+		void Raw( const void *p, std::size_t iSize ) { m_sOut.append( static_cast<const char *>(p), iSize ); }
+		void U8( uint8_t i ) { Raw( &i, sizeof(i) ); }
+		void U32( uint32_t i ) { i = Swap32LE( i ); Raw( &i, sizeof(i) ); }
+		void I32( int32_t i ) { U32( uint32_t(i) ); }
+		void F32( float f ) { uint32_t i; memcpy( &i, &f, sizeof(i) ); U32( i ); }
+		void Bool( bool b ) { U8( b? 1:0 ); }
+		void String( const RString &s )
+		{
+			U32( s.size() );
+			Raw( s.data(), s.size() );
+		}
+		void Strings( const std::vector<RString> &v )
+		{
+			U32( v.size() );
+			for( RString const &s : v )
+				String( s );
+		}
+
+	private:
+		RString &m_sOut;
+	};
+
+	/* Every read is bounds checked; once a read fails, all further reads
+	 * return defaults and Failed() is true. */
+	class RecordReader
+	{
+	public:
+		RecordReader( const char *p, std::size_t iSize ): m_pPos(p), m_pEnd(p+iSize), m_bFailed(false) { }
+
+		bool Failed() const { return m_bFailed; }
+		bool Raw( void *p, std::size_t iSize )
+		{
+			if( m_bFailed || std::size_t(m_pEnd - m_pPos) < iSize )
+			{
+				m_bFailed = true;
+				return false;
+			}
+			memcpy( p, m_pPos, iSize );
+			m_pPos += iSize;
+			return true;
+		}
+		uint8_t U8() { uint8_t i = 0; Raw( &i, sizeof(i) ); return i; }
+		uint32_t U32() { uint32_t i = 0; Raw( &i, sizeof(i) ); return Swap32LE( i ); }
+		int32_t I32() { return int32_t( U32() ); }
+		float F32() { uint32_t i = U32(); float f; memcpy( &f, &i, sizeof(f) ); return f; }
+		bool Bool() { return U8() != 0; }
+		RString String()
+		{
+			uint32_t iSize = U32();
+			if( m_bFailed || std::size_t(m_pEnd - m_pPos) < iSize )
+			{
+				m_bFailed = true;
+				return RString();
+			}
+			RString s( m_pPos, iSize );
+			m_pPos += iSize;
+			return s;
+		}
+		void Strings( std::vector<RString> &v )
+		{
+			uint32_t iCount = U32();
+			v.clear();
+			for( uint32_t i = 0; i < iCount && !m_bFailed; ++i )
+				v.push_back( String() );
+		}
+		/* Validate a count before using it to size anything. */
+		uint32_t Count( std::size_t iMinBytesEach )
+		{
+			uint32_t iCount = U32();
+			if( !m_bFailed && iMinBytesEach != 0 && iCount > std::size_t(m_pEnd - m_pPos) / iMinBytesEach )
+				m_bFailed = true;
+			return m_bFailed? 0:iCount;
+		}
+		const char *GetPos() const { return m_pPos; }
+		void Skip( std::size_t iSize )
+		{
+			if( m_bFailed || std::size_t(m_pEnd - m_pPos) < iSize )
+				m_bFailed = true;
+			else
+				m_pPos += iSize;
+		}
+
+	private:
+		const char *m_pPos;
+		const char *m_pEnd;
+		bool m_bFailed;
+	};
+}
+
+bool SongCacheBinary::IsEnabled()
+{
+	return g_bBinarySongCache.Get();
+}
+
+static void WriteTimingData( RecordWriter &w, const TimingData &td )
+{
+	w.String( td.m_sFile );
+	w.F32( td.m_fBeat0OffsetInSeconds );
+	FOREACH_TimingSegmentType( tst )
+	{
+		const std::vector<TimingSegment*> &vSegs = td.GetTimingSegments( tst );
+		w.U32( vSegs.size() );
+		for( const TimingSegment *seg : vSegs )
+		{
+			w.I32( seg->GetRow() );
+			switch( tst )
+			{
+				case SEGMENT_BPM:	w.F32( ToBPM(seg)->GetBPS() ); break;
+				case SEGMENT_STOP:	w.F32( ToStop(seg)->GetPause() ); break;
+				case SEGMENT_DELAY:	w.F32( ToDelay(seg)->GetPause() ); break;
+				case SEGMENT_TIME_SIG:
+					w.I32( ToTimeSignature(seg)->GetNum() );
+					w.I32( ToTimeSignature(seg)->GetDen() );
+					break;
+				case SEGMENT_WARP:	w.I32( ToWarp(seg)->GetLengthRows() ); break;
+				case SEGMENT_LABEL:	w.String( ToLabel(seg)->GetLabel() ); break;
+				case SEGMENT_TICKCOUNT:	w.I32( ToTickcount(seg)->GetTicks() ); break;
+				case SEGMENT_COMBO:
+					w.I32( ToCombo(seg)->GetCombo() );
+					w.I32( ToCombo(seg)->GetMissCombo() );
+					break;
+				case SEGMENT_SPEED:
+					w.F32( ToSpeed(seg)->GetRatio() );
+					w.F32( ToSpeed(seg)->GetDelay() );
+					w.U8( ToSpeed(seg)->GetUnit() );
+					break;
+				case SEGMENT_SCROLL:	w.F32( ToScroll(seg)->GetRatio() ); break;
+				case SEGMENT_FAKE:	w.I32( ToFake(seg)->GetLengthRows() ); break;
+				default: FAIL_M( ssprintf("Unhandled timing segment type %i", tst) );
+			}
+		}
+	}
+}
+
+static void ReadTimingData( RecordReader &r, TimingData &td )
+{
+	td.Clear();
+	td.m_sFile = r.String();
+	td.m_fBeat0OffsetInSeconds = r.F32();
+	FOREACH_TimingSegmentType( tst )
+	{
+		std::vector<TimingSegment*> &vSegs = td.GetTimingSegments( tst );
+		uint32_t iCount = r.Count( sizeof(int32_t) );
+		vSegs.reserve( iCount );
+		for( uint32_t i = 0; i < iCount && !r.Failed(); ++i )
+		{
+			/* The segments were sorted and deduplicated when the song was first
+			 * loaded, so they can go straight in without AddSegment. */
+			int iRow = r.I32();
+			TimingSegment *seg = nullptr;
+			switch( tst )
+			{
+				case SEGMENT_BPM:
+				{
+					BPMSegment *bpm = new BPMSegment( iRow );
+					bpm->SetBPS( r.F32() );
+					seg = bpm;
+					break;
+				}
+				case SEGMENT_STOP:	seg = new StopSegment( iRow, r.F32() ); break;
+				case SEGMENT_DELAY:	seg = new DelaySegment( iRow, r.F32() ); break;
+				case SEGMENT_TIME_SIG:
+				{
+					int iNum = r.I32();
+					int iDen = r.I32();
+					seg = new TimeSignatureSegment( iRow, iNum, iDen );
+					break;
+				}
+				case SEGMENT_WARP:	seg = new WarpSegment( iRow, int(r.I32()) ); break;
+				case SEGMENT_LABEL:	seg = new LabelSegment( iRow, r.String() ); break;
+				case SEGMENT_TICKCOUNT:	seg = new TickcountSegment( iRow, r.I32() ); break;
+				case SEGMENT_COMBO:
+				{
+					int iCombo = r.I32();
+					int iMissCombo = r.I32();
+					seg = new ComboSegment( iRow, iCombo, iMissCombo );
+					break;
+				}
+				case SEGMENT_SPEED:
+				{
+					float fRatio = r.F32();
+					float fDelay = r.F32();
+					SpeedSegment::BaseUnit unit = r.U8() == SpeedSegment::UNIT_SECONDS?
+						SpeedSegment::UNIT_SECONDS : SpeedSegment::UNIT_BEATS;
+					seg = new SpeedSegment( iRow, fRatio, fDelay, unit );
+					break;
+				}
+				case SEGMENT_SCROLL:	seg = new ScrollSegment( iRow, r.F32() ); break;
+				case SEGMENT_FAKE:	seg = new FakeSegment( iRow, int(r.I32()) ); break;
+				default: FAIL_M( ssprintf("Unhandled timing segment type %i", tst) );
+			}
+			vSegs.push_back( seg );
+		}
+	}
+}
+
+static void WriteBackgroundChanges( RecordWriter &w, const std::vector<BackgroundChange> &vChanges )
+{
+	w.U32( vChanges.size() );
+	for( BackgroundChange const &bgc : vChanges )
+	{
+		w.String( bgc.m_def.m_sEffect );
+		w.String( bgc.m_def.m_sFile1 );
+		w.String( bgc.m_def.m_sFile2 );
+		w.String( bgc.m_def.m_sColor1 );
+		w.String( bgc.m_def.m_sColor2 );
+		w.F32( bgc.m_fStartBeat );
+		w.F32( bgc.m_fRate );
+		w.String( bgc.m_sTransition );
+	}
+}
+
+static void ReadBackgroundChanges( RecordReader &r, std::vector<BackgroundChange> &vChanges )
+{
+	uint32_t iCount = r.Count( 6*sizeof(uint32_t) + 2*sizeof(float) );
+	vChanges.clear();
+	vChanges.reserve( iCount );
+	for( uint32_t i = 0; i < iCount && !r.Failed(); ++i )
+	{
+		BackgroundChange bgc;
+		bgc.m_def.m_sEffect = r.String();
+		bgc.m_def.m_sFile1 = r.String();
+		bgc.m_def.m_sFile2 = r.String();
+		bgc.m_def.m_sColor1 = r.String();
+		bgc.m_def.m_sColor2 = r.String();
+		bgc.m_fStartBeat = r.F32();
+		bgc.m_fRate = r.F32();
+		bgc.m_sTransition = r.String();
+		vChanges.push_back( bgc );
+	}
+}
+
+static void WriteAttacks( RecordWriter &w, const AttackArray &attacks, const std::vector<RString> &vsAttackString )
+{
+	w.Strings( vsAttackString );
+	w.U32( attacks.size() );
+	for( Attack const &a : attacks )
+	{
+		w.I32( a.level );
+		w.F32( a.fStartSecond );
+		w.F32( a.fSecsRemaining );
+		w.String( a.sModifiers );
+		w.Bool( a.bOn );
+		w.Bool( a.bGlobal );
+		w.Bool( a.bShowInAttackList );
+	}
+}
+
+static void ReadAttacks( RecordReader &r, AttackArray &attacks, std::vector<RString> &vsAttackString )
+{
+	r.Strings( vsAttackString );
+	uint32_t iCount = r.Count( sizeof(int32_t) + 2*sizeof(float) + sizeof(uint32_t) + 3 );
+	attacks.clear();
+	attacks.reserve( iCount );
+	for( uint32_t i = 0; i < iCount && !r.Failed(); ++i )
+	{
+		Attack a;
+		a.level = AttackLevel( r.I32() );
+		a.fStartSecond = r.F32();
+		a.fSecsRemaining = r.F32();
+		a.sModifiers = r.String();
+		a.bOn = r.Bool();
+		a.bGlobal = r.Bool();
+		a.bShowInAttackList = r.Bool();
+		attacks.push_back( a );
+	}
+}
+
+static void WriteSteps( RecordWriter &w, const Steps &steps )
+{
+	w.String( steps.m_StepsTypeStr );
+	w.String( steps.GetChartName() );
+	w.String( steps.GetDescription() );
+	w.String( steps.GetChartStyle() );
+	w.String( steps.GetCredit() );
+	w.String( steps.GetMusicFile() );
+	w.String( steps.GetFilename() );
+	w.I32( steps.GetDifficulty() );
+	w.I32( steps.GetMeter() );
+	w.I32( steps.GetDisplayBPM() );
+	w.F32( steps.GetMinBPM() );
+	w.F32( steps.GetMaxBPM() );
+
+	w.U32( NUM_RadarCategory );
+	FOREACH_PlayerNumber( pn )
+	{
+		const RadarValues &rv = steps.GetRadarValues( pn );
+		FOREACH_ENUM( RadarCategory, rc )
+			w.F32( rv[rc] );
+	}
+	FOREACH_PlayerNumber( pn )
+	{
+		const std::vector<uint8_t> &vCounts = steps.GetNotesPerMeasure( pn );
+		w.U32( vCounts.size() );
+		w.Raw( vCounts.data(), vCounts.size() );
+		w.F32( steps.GetPeakNPS( pn ) );
+	}
+
+	WriteAttacks( w, steps.m_Attacks, steps.m_sAttackString );
+
+	/* Steps without their own timing use the song's; don't duplicate it. */
+	const bool bOwnTiming = !steps.m_Timing.empty();
+	w.Bool( bOwnTiming );
+	if( bOwnTiming )
+		WriteTimingData( w, steps.m_Timing );
+
+	RString sNoteData, sCompressed;
+	steps.GetSMNoteData( sNoteData );
+	if( !sNoteData.empty() )
+		GzipString( sNoteData, sCompressed );
+	w.U32( sNoteData.empty()? 0 : GetHashForString(sNoteData) );
+	w.U32( sNoteData.size() );
+	w.String( sCompressed );
+}
+
+static Steps *ReadSteps( RecordReader &r, Song &song, const char *pRecord, uint32_t iRecordCRC )
+{
+	Steps *pSteps = song.CreateSteps();
+	pSteps->m_StepsTypeStr = r.String();
+	pSteps->m_StepsType = GAMEMAN->StringToStepsType( pSteps->m_StepsTypeStr );
+	pSteps->SetChartName( r.String() );
+	RString sDescription = r.String();
+	pSteps->SetChartStyle( r.String() );
+	pSteps->SetCredit( r.String() );
+	pSteps->SetMusicFile( r.String() );
+	pSteps->SetFilename( r.String() );
+	Difficulty dc = Difficulty( r.I32() );
+	pSteps->SetDifficultyAndDescription( dc, sDescription );
+	pSteps->SetMeter( r.I32() );
+	pSteps->SetDisplayBPM( DisplayBPM(r.I32()) );
+	pSteps->SetMinBPM( r.F32() );
+	pSteps->SetMaxBPM( r.F32() );
+
+	if( r.U32() != NUM_RadarCategory )
+	{
+		delete pSteps;
+		return nullptr;
+	}
+	RadarValues rv[NUM_PLAYERS];
+	FOREACH_PlayerNumber( pn )
+	{
+		FOREACH_ENUM( RadarCategory, rc )
+			rv[pn][rc] = r.F32();
+	}
+	pSteps->SetCachedRadarValues( rv );
+	std::vector<uint8_t> vNotesPerMeasure[NUM_PLAYERS];
+	float fPeakNPS[NUM_PLAYERS];
+	FOREACH_PlayerNumber( pn )
+	{
+		vNotesPerMeasure[pn].resize( r.Count(1) );
+		r.Raw( vNotesPerMeasure[pn].data(), vNotesPerMeasure[pn].size() );
+		fPeakNPS[pn] = r.F32();
+	}
+	pSteps->SetCachedNotesPerMeasure( vNotesPerMeasure );
+	pSteps->SetCachedPeakNPS( fPeakNPS );
+
+	ReadAttacks( r, pSteps->m_Attacks, pSteps->m_sAttackString );
+
+	if( r.Bool() )
+		ReadTimingData( r, pSteps->m_Timing );
+
+	/* Only remember where the note data is; Steps::Decompress reads it from
+	 * the cache when it's needed. */
+	Steps::CachedNoteData cached;
+	cached.m_iHash = r.U32();
+	cached.m_iRawSize = r.U32();
+	cached.m_iSize = r.U32();
+	cached.m_iOffset = r.GetPos() - pRecord;
+	cached.m_iRecordCRC = iRecordCRC;
+	r.Skip( cached.m_iSize );
+	pSteps->SetCachedNoteData( cached );
+
+	if( r.Failed() )
+	{
+		delete pSteps;
+		return nullptr;
+	}
+	return pSteps;
+}
+
+void SongCacheBinary::WriteRecord( const Song &song, const std::vector<Steps*> &vpSteps, RString &sOut )
+{
+	RString sPayload;
+	RecordWriter w( sPayload );
+
+	w.String( song.m_sSongFileName );
+	w.String( song.m_sMainTitle );
+	w.String( song.m_sSubTitle );
+	w.String( song.m_sArtist );
+	w.String( song.m_sMainTitleTranslit );
+	w.String( song.m_sSubTitleTranslit );
+	w.String( song.m_sArtistTranslit );
+	w.String( song.m_sGenre );
+	w.String( song.m_sOrigin );
+	w.String( song.m_sCredit );
+	w.String( song.m_sBannerFile );
+	w.String( song.m_sBackgroundFile );
+	w.String( song.m_sPreviewVidFile );
+	w.String( song.m_sJacketFile );
+	w.String( song.m_sCDFile );
+	w.String( song.m_sDiscFile );
+	w.String( song.m_sLyricsFile );
+	w.String( song.m_sCDTitleFile );
+	w.String( song.m_sMusicFile );
+	w.String( song.m_PreviewFile );
+	FOREACH_ENUM( InstrumentTrack, it )
+		w.String( song.m_sInstrumentTrackFile[it] );
+
+	w.F32( song.m_fVersion );
+	w.F32( song.m_fMusicLengthSeconds );
+	w.F32( song.m_fMusicSampleStartSeconds );
+	w.F32( song.m_fMusicSampleLengthSeconds );
+	w.F32( song.GetFirstSecond() );
+	w.F32( song.GetLastSecond() );
+	w.F32( song.GetSpecifiedLastSecond() );
+	w.I32( song.m_SelectionDisplay );
+	w.I32( song.m_DisplayBPMType );
+	w.F32( song.m_fSpecifiedBPMMin );
+	w.F32( song.m_fSpecifiedBPMMax );
+	w.Bool( song.m_bHasMusic );
+	w.Bool( song.m_bHasBanner );
+	w.Bool( song.m_bHasBackground );
+
+	WriteTimingData( w, song.m_SongTiming );
+	FOREACH_BackgroundLayer( bl )
+		WriteBackgroundChanges( w, song.GetBackgroundChanges(bl) );
+	WriteBackgroundChanges( w, song.GetForegroundChanges() );
+	w.Strings( song.m_vsKeysoundFile );
+	WriteAttacks( w, song.m_Attacks, song.m_sAttackString );
+
+	w.U32( vpSteps.size() );
+	for( const Steps *pSteps : vpSteps )
+		WriteSteps( w, *pSteps );
+
+	unsigned iCRC = 0;
+	CRC32( iCRC, sPayload.data(), sPayload.size() );
+
+	sOut.clear();
+	sOut.reserve( RECORD_HEADER_SIZE + sPayload.size() );
+	RecordWriter header( sOut );
+	header.U32( RECORD_MAGIC );
+	header.U32( RECORD_FORMAT_VERSION );
+	header.U32( FILE_CACHE_VERSION );
+	header.U32( sPayload.size() );
+	header.U32( iCRC );
+	sOut.append( sPayload );
+}
+
+bool SongCacheBinary::ReadRecord( const RString &sRecord, Song &out, RString &sError )
+{
+	if( sRecord.size() < RECORD_HEADER_SIZE )
+	{
+		sError = "truncated header";
+		return false;
+	}
+	RecordReader header( sRecord.data(), RECORD_HEADER_SIZE );
+	const uint32_t iMagic = header.U32();
+	const uint32_t iFormatVersion = header.U32();
+	const uint32_t iCacheVersion = header.U32();
+	const uint32_t iPayloadSize = header.U32();
+	const uint32_t iPayloadCRC = header.U32();
+	if( iMagic != RECORD_MAGIC )
+	{
+		sError = "bad magic";
+		return false;
+	}
+	if( iFormatVersion != RECORD_FORMAT_VERSION || iCacheVersion != uint32_t(FILE_CACHE_VERSION) )
+	{
+		sError = ssprintf( "version %u/%u, expected %u/%i", iFormatVersion,
+			iCacheVersion, RECORD_FORMAT_VERSION, FILE_CACHE_VERSION );
+		return false;
+	}
+	if( sRecord.size() - RECORD_HEADER_SIZE != iPayloadSize )
+	{
+		sError = "payload size mismatch";
+		return false;
+	}
+	const char *pPayload = sRecord.data() + RECORD_HEADER_SIZE;
+	unsigned iCRC = 0;
+	CRC32( iCRC, pPayload, iPayloadSize );
+	if( iCRC != iPayloadCRC )
+	{
+		sError = "CRC mismatch";
+		return false;
+	}
+
+	RecordReader r( pPayload, iPayloadSize );
+
+	out.m_sSongFileName = r.String();
+	out.m_sMainTitle = r.String();
+	out.m_sSubTitle = r.String();
+	out.m_sArtist = r.String();
+	out.m_sMainTitleTranslit = r.String();
+	out.m_sSubTitleTranslit = r.String();
+	out.m_sArtistTranslit = r.String();
+	out.m_sGenre = r.String();
+	out.m_sOrigin = r.String();
+	out.m_sCredit = r.String();
+	out.m_sBannerFile = r.String();
+	out.m_sBackgroundFile = r.String();
+	out.m_sPreviewVidFile = r.String();
+	out.m_sJacketFile = r.String();
+	out.m_sCDFile = r.String();
+	out.m_sDiscFile = r.String();
+	out.m_sLyricsFile = r.String();
+	out.m_sCDTitleFile = r.String();
+	out.m_sMusicFile = r.String();
+	out.m_PreviewFile = r.String();
+	FOREACH_ENUM( InstrumentTrack, it )
+		out.m_sInstrumentTrackFile[it] = r.String();
+
+	out.m_fVersion = r.F32();
+	out.m_fMusicLengthSeconds = r.F32();
+	out.m_fMusicSampleStartSeconds = r.F32();
+	out.m_fMusicSampleLengthSeconds = r.F32();
+	out.SetFirstSecond( r.F32() );
+	out.SetLastSecond( r.F32() );
+	out.SetSpecifiedLastSecond( r.F32() );
+	out.m_SelectionDisplay = Song::SelectionDisplay( r.I32() );
+	out.m_DisplayBPMType = DisplayBPM( r.I32() );
+	out.m_fSpecifiedBPMMin = r.F32();
+	out.m_fSpecifiedBPMMax = r.F32();
+	out.m_bHasMusic = r.Bool();
+	out.m_bHasBanner = r.Bool();
+	out.m_bHasBackground = r.Bool();
+
+	ReadTimingData( r, out.m_SongTiming );
+	FOREACH_BackgroundLayer( bl )
+		ReadBackgroundChanges( r, out.GetBackgroundChanges(bl) );
+	ReadBackgroundChanges( r, out.GetForegroundChanges() );
+	r.Strings( out.m_vsKeysoundFile );
+	ReadAttacks( r, out.m_Attacks, out.m_sAttackString );
+
+	std::vector<Steps*> vpSteps;
+	uint32_t iNumSteps = r.Count( 1 );
+	for( uint32_t i = 0; i < iNumSteps && !r.Failed(); ++i )
+	{
+		Steps *pSteps = ReadSteps( r, out, sRecord.data(), iPayloadCRC );
+		if( pSteps == nullptr )
+			break;
+		vpSteps.push_back( pSteps );
+	}
+
+	if( r.Failed() || vpSteps.size() != iNumSteps )
+	{
+		for( Steps *pSteps : vpSteps )
+			delete pSteps;
+		sError = "truncated payload";
+		return false;
+	}
+
+	for( Steps *pSteps : vpSteps )
+		out.AddSteps( pSteps );
+	return true;
+}
+
+bool SongCacheBinary::LoadNoteData( const Steps &steps, RString &sNoteDataOut )
+{
+	const Steps::CachedNoteData &cached = steps.GetCachedNoteData();
+	if( cached.m_iSize == 0 || steps.m_pSong == nullptr || SONGINDEX == nullptr )
+		return false;
+
+	/* The record may have been replaced since the Steps were loaded; if so,
+	 * the offset means nothing. */
+	const RString &sSongDir = steps.m_pSong->GetSongDir();
+	RString sHeader, sCompressed;
+	if( !SONGINDEX->GetCacheRecordPart(sSongDir, 0, RECORD_HEADER_SIZE, sHeader) ||
+		!SONGINDEX->GetCacheRecordPart(sSongDir, cached.m_iOffset, cached.m_iSize, sCompressed) )
+		return false;
+	RecordReader header( sHeader.data(), sHeader.size() );
+	header.Skip( RECORD_HEADER_SIZE - sizeof(uint32_t) );
+	if( header.U32() != cached.m_iRecordCRC )
+		return false;
+
+	RString sError;
+	if( !GunzipString(sCompressed, sNoteDataOut, sError) || sNoteDataOut.size() != cached.m_iRawSize )
+	{
+		LOG->Trace( "Cached note data for \"%s\" rejected: %s", sSongDir.c_str(),
+			sError.empty()? "size mismatch":sError.c_str() );
+		sNoteDataOut = RString();
+		return false;
+	}
+	return true;
+}
+
+bool SongCacheBinary::SaveToFile( const RString &sPath, const Song &song, const std::vector<Steps*> &vpSteps )
+{
+	RString sRecord;
+	WriteRecord( song, vpSteps, sRecord );
+
+	RageFile f;
+	if( !f.Open(sPath, RageFile::WRITE) )
+	{
+		LOG->UserLog( "Cache file", sPath, "couldn't be opened for writing: %s", f.GetError().c_str() );
+		return false;
+	}
+	if( f.Write(sRecord) == -1 || f.Flush() == -1 )
+	{
+		LOG->UserLog( "Cache file", sPath, "couldn't be written: %s", f.GetError().c_str() );
+		return false;
+	}
+	return true;
+}
+
+bool SongCacheBinary::LoadFromFile( const RString &sPath, Song &out )
+{
+	RageFile f;
+	if( !f.Open(sPath, RageFile::READ) )
+		return false;
+
+	RString sRecord;
+	if( f.Read(sRecord, f.GetFileSize()) == -1 )
+	{
+		LOG->UserLog( "Cache file", sPath, "couldn't be read: %s", f.GetError().c_str() );
+		return false;
+	}
+
+	RString sError;
+	if( !ReadRecord(sRecord, out, sError) )
+	{
+		LOG->Trace( "Cache file \"%s\" rejected: %s", sPath.c_str(), sError.c_str() );
+		return false;
+	}
+	return true;
+}
+
+/*
+ * (c) 2026 Stepmania team
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, and/or sell copies of the Software, and to permit persons to
+ * whom the Software is furnished to do so, provided that the above
+ * copyright notice(s) and this permission notice appear in all copies of
+ * the Software and that both the above copyright notice(s) and this
+ * permission notice appear in supporting documentation.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT OF
+ * THIRD PARTY RIGHTS. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR HOLDERS
+ * INCLUDED IN THIS NOTICE BE LIABLE FOR ANY CLAIM, OR ANY SPECIAL INDIRECT
+ * OR CONSEQUENTIAL DAMAGES, OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS
+ * OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
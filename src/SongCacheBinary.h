@@ -0,0 +1,93 @@
+#ifndef SONG_CACHE_BINARY_H
+#define SONG_CACHE_BINARY_H
+
+#include <vector>
+
+class Song;
+class Steps;
+
+/**
+ * @brief Reads and writes the binary song cache.
+ *
+ * Each cached song is a single record: a fixed header holding a magic
+ * number, the record format version, FILE_CACHE_VERSION, the payload size
+ * and a CRC32 of the payload, followed by the payload itself.  The payload
+ * holds everything the SSC cache does (song tags, timing segments, steps
+ * metadata and radar values) plus the gzipped note data of each Steps,
+ * little-endian with length-prefixed strings, so it can be loaded without
+ * tokenizing any text.  Records are kept in the song cache database (see
+ * SongCacheIndex).  A record that fails any of the header checks is treated
+ * as missing, and the song is reloaded from its simfile. */
+namespace SongCacheBinary
+{
+	/** @brief Is the binary cache used instead of SSC cache files? */
+	bool IsEnabled();
+
+	/**
+	 * @brief Serialize a song into a cache record.
+	 * @param song the Song to serialize.
+	 * @param vpSteps the Steps to store with it.
+	 * @param sOut the finished record, header included. */
+	void WriteRecord( const Song &song, const std::vector<Steps*> &vpSteps, RString &sOut );
+
+	/**
+	 * @brief Restore a song from a cache record.
+	 *
+	 * Steps are only added to the song once the whole record has been read.
+	 * Their note data is left in the record; see LoadNoteData.  A record
+	 * rejected partway through may still have filled in other fields of the
+	 * song, so reset it before loading it some other way.
+	 * @param sRecord the record, header included.
+	 * @param out the Song to fill in.
+	 * @param sError the reason the record was rejected.
+	 * @return true if the record was valid. */
+	bool ReadRecord( const RString &sRecord, Song &out, RString &sError );
+
+	/**
+	 * @brief Read the note data of Steps loaded from a cache record.
+	 *
+	 * ReadRecord only remembers where each chart's note data is in the
+	 * record; this reads it back from the song cache database when it's
+	 * needed.
+	 * @param steps the Steps to get note data for.
+	 * @param sNoteDataOut the note data, as SMData.
+	 * @return false if it isn't in the cache, or the record has changed. */
+	bool LoadNoteData( const Steps &steps, RString &sNoteDataOut );
+
+	/**
+	 * @brief Write a song's cache record to a file of its own.
+	 * @return its success or failure. */
+	bool SaveToFile( const RString &sPath, const Song &song, const std::vector<Steps*> &vpSteps );
+
+	/**
+	 * @brief Load a song from a cache record written by SaveToFile.
+	 * @return its success or failure. */
+	bool LoadFromFile( const RString &sPath, Song &out );
+}
+
+#endif
+
+/*
+ * (c) 2026 Stepmania team
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, and/or sell copies of the Software, and to permit persons to
+ * whom the Software is furnished to do so, provided that the above
+ * copyright notice(s) and this permission notice appear in all copies of
+ * the Software and that both the above copyright notice(s) and this
+ * permission notice appear in supporting documentation.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT OF
+ * THIRD PARTY RIGHTS. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR HOLDERS
+ * INCLUDED IN THIS NOTICE BE LIABLE FOR ANY CLAIM, OR ANY SPECIAL INDIRECT
+ * OR CONSEQUENTIAL DAMAGES, OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS
+ * OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
@@ -4,13 +4,26 @@
 #include "RageLog.h"
 #include "RageUtil.h"
 #include "RageFileManager.h"
+#include "RageFileDriverDirectHelpers.h"
 #include "Song.h"
 #include "SpecialFiles.h"
 #include "CommonMetrics.h"
 
+#include <algorithm>
+#include <cerrno>
 #include <cstddef>
+#include <cstring>
 #include <vector>
 
+#if defined(WIN32)
+#include <windows.h>
+#include <io.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 /*
  * A quick explanation of song cache hashes: Each song has two hashes; a hash of the
  * song path, and a hash of the song directory.  The former is Song::GetCacheFilePath;
@@ -28,8 +41,56 @@
  * path; we don't have to actually look in the directory (to find out the directory hash)
  * in order to find the cache file.
  */
-#define CACHE_INDEX SpecialFiles::CACHE_DIR + "index.cache"
+#define CACHE_DB SpecialFiles::CACHE_DIR + "cache.db"
+
+/* The database is a local cache, so it's kept in host byte order.  A file
+ * from a machine with the other byte order fails the magic check and is
+ * rebuilt. */
+static const uint32_t DB_MAGIC = 0x42444D53; // "SMDB"
+static const uint32_t DB_FORMAT_VERSION = 1;
+/* Don't bother compacting until at least this much of the file is stale. */
+static const uint64_t DB_MIN_DEAD_BYTES_TO_COMPACT = 1024*1024;
+/* While saving is delayed, write the pending records out once they add up
+ * to this much, rather than holding the whole library in memory. */
+static const std::size_t DB_MAX_PENDING_BYTES = 16*1024*1024;
 
+namespace
+{
+	struct DatabaseHeader
+	{
+		uint32_t m_iMagic;
+		uint32_t m_iFormatVersion;
+		uint32_t m_iCacheVersion;
+		uint32_t m_iNumEntries;
+		uint64_t m_iIndexOffset;
+		uint32_t m_iStringsSize;
+		uint32_t m_iIndexCRC;
+		/* Bytes of superseded records and old indexes. */
+		uint64_t m_iDeadBytes;
+	};
+}
+
+struct SongCacheIndex::IndexEntry
+{
+	uint64_t m_iPathHash;
+	uint64_t m_iRecordOffset;
+	uint32_t m_iRecordSize; // 0 if there's no record
+	uint32_t m_iDirHash;
+	uint32_t m_iPathOffset;
+	uint32_t m_iPathLength;
+};
+
+/* FNV-1a */
+static uint64_t HashPath( const char *p, std::size_t iSize )
+{
+	uint64_t iHash = 14695981039346656037ULL;
+	for( std::size_t i = 0; i < iSize; ++i )
+	{
+		iHash ^= static_cast<unsigned char>(p[i]);
+		iHash *= 1099511628211ULL;
+	}
+	return iHash;
+}
 
 SongCacheIndex *SONGINDEX; // global and accessible from anywhere in our program
 
@@ -57,14 +118,18 @@ RString SongCacheIndex::GetCacheFilePath( const RString &sGroup, const RString &
 	return ssprintf( "%s%s/%s", SpecialFiles::CACHE_DIR.c_str(), sGroup.c_str(), s.c_str() );
 }
 
-SongCacheIndex::SongCacheIndex()
+SongCacheIndex::SongCacheIndex(): delay_save_cache( false ), m_Mutex( "SongCacheIndex" ),
+	m_iPendingBytes( 0 ), m_pData( nullptr ), m_iDataSize( 0 ), m_pMapping( nullptr ),
+	m_pEntries( nullptr ), m_iNumEntries( 0 ), m_pStrings( nullptr ), m_iStringsSize( 0 )
 {
 	ReadCacheIndex();
 }
 
 SongCacheIndex::~SongCacheIndex()
 {
-
+	LockMut( m_Mutex );
+	Flush();
+	UnmapFile();
 }
 
 void SongCacheIndex::ReadFromDisk()
@@ -85,14 +150,146 @@ static void EmptyDir( RString dir )
 	}
 }
 
-void SongCacheIndex::ReadCacheIndex()
+void SongCacheIndex::UnmapFile()
 {
-	CacheIndex.ReadFile( CACHE_INDEX );	// don't care if this fails
+	if( m_pMapping != nullptr )
+	{
+#if defined(WIN32)
+		UnmapViewOfFile( m_pData );
+#else
+		munmap( const_cast<char *>(m_pData), m_iDataSize );
+#endif
+	}
+	m_pMapping = nullptr;
+	m_sFallbackData = RString();
+	m_pData = nullptr;
+	m_iDataSize = 0;
+	m_pEntries = nullptr;
+	m_iNumEntries = 0;
+	m_pStrings = nullptr;
+	m_iStringsSize = 0;
+}
 
-	int iCacheVersion = -1;
-	CacheIndex.GetValue( "Cache", "CacheVersion", iCacheVersion );
-	if( iCacheVersion == FILE_CACHE_VERSION )
-		return; // OK
+/* Map the database and validate its header and index.  On failure,
+ * nothing is mapped. */
+SongCacheIndex::MapResult SongCacheIndex::MapFile()
+{
+	UnmapFile();
+
+	const RString sPath = FILEMAN->ResolvePath( CACHE_DB );
+	int fd = DoOpen( sPath, O_BINARY|O_RDONLY );
+	if( fd == -1 )
+		return MAP_OUT_OF_DATE;
+
+	const int64_t iSize = DoLseek( fd, 0, SEEK_END );
+	if( iSize < int64_t(sizeof(DatabaseHeader)) )
+	{
+		DoClose( fd );
+		return MAP_CORRUPT;
+	}
+
+#if defined(WIN32)
+	HANDLE hMapping = CreateFileMapping( (HANDLE) _get_osfhandle(fd), nullptr, PAGE_READONLY, 0, 0, nullptr );
+	if( hMapping != nullptr )
+	{
+		void *p = MapViewOfFile( hMapping, FILE_MAP_READ, 0, 0, 0 );
+		// The view keeps the mapping alive.
+		CloseHandle( hMapping );
+		if( p != nullptr )
+			m_pMapping = p;
+	}
+#else
+	void *p = mmap( nullptr, iSize, PROT_READ, MAP_SHARED, fd, 0 );
+	if( p != MAP_FAILED )
+		m_pMapping = p;
+#endif
+
+	if( m_pMapping != nullptr )
+	{
+		m_pData = static_cast<const char *>( m_pMapping );
+	}
+	else
+	{
+		/* Mapping isn't available everywhere; reading the whole file is
+		 * still only a few calls. */
+		LOG->Trace( "Couldn't map \"%s\"; reading it instead.", sPath.c_str() );
+		m_sFallbackData.resize( iSize );
+		DoLseek( fd, 0, SEEK_SET );
+		int64_t iGot = 0;
+		while( iGot < iSize )
+		{
+			int iRet = DoRead( fd, &m_sFallbackData[std::size_t(iGot)], iSize - iGot );
+			if( iRet <= 0 )
+				break;
+			iGot += iRet;
+		}
+		if( iGot != iSize )
+		{
+			DoClose( fd );
+			UnmapFile();
+			return MAP_CORRUPT;
+		}
+		m_pData = m_sFallbackData.data();
+	}
+	m_iDataSize = iSize;
+	DoClose( fd );
+
+	DatabaseHeader header;
+	memcpy( &header, m_pData, sizeof(header) );
+	const uint64_t iIndexSize = uint64_t(header.m_iNumEntries)*sizeof(IndexEntry) + header.m_iStringsSize;
+	if( header.m_iMagic != DB_MAGIC ||
+		header.m_iFormatVersion != DB_FORMAT_VERSION ||
+		header.m_iCacheVersion != uint32_t(FILE_CACHE_VERSION) )
+	{
+		UnmapFile();
+		return MAP_OUT_OF_DATE;
+	}
+	if( header.m_iIndexOffset < sizeof(header) ||
+		header.m_iIndexOffset % alignof(IndexEntry) != 0 ||
+		header.m_iIndexOffset > m_iDataSize ||
+		iIndexSize > m_iDataSize - header.m_iIndexOffset )
+	{
+		LOG->Warn( "Song cache database header is corrupt." );
+		UnmapFile();
+		return MAP_CORRUPT;
+	}
+
+	unsigned iCRC = 0;
+	CRC32( iCRC, m_pData + header.m_iIndexOffset, iIndexSize );
+	if( iCRC != header.m_iIndexCRC )
+	{
+		LOG->Warn( "Song cache database index is corrupt." );
+		UnmapFile();
+		return MAP_CORRUPT;
+	}
+
+	m_pEntries = reinterpret_cast<const IndexEntry *>( m_pData + header.m_iIndexOffset );
+	m_iNumEntries = header.m_iNumEntries;
+	m_pStrings = m_pData + header.m_iIndexOffset + m_iNumEntries*sizeof(IndexEntry);
+	m_iStringsSize = header.m_iStringsSize;
+	return MAP_OK;
+}
+
+void SongCacheIndex::ReadCacheIndex()
+{
+	LockMut( m_Mutex );
+	m_Pending.clear();
+	m_iPendingBytes = 0;
+	switch( MapFile() )
+	{
+	case MAP_OK:
+		return;
+	case MAP_CORRUPT:
+		/* The song and image cache files are still good; only the database
+		 * has to go.  Every song is then loaded from its simfile again and
+		 * saved to a new one. */
+		LOG->Trace( "Deleting the damaged song cache database." );
+		FILEMAN->Remove( CACHE_DB );
+		FILEMAN->FlushDirCache();
+		return;
+	case MAP_OUT_OF_DATE:
+		break;
+	}
 
 	LOG->Trace( "Cache format is out of date.  Deleting all cache files." );
 	EmptyDir( SpecialFiles::CACHE_DIR );
@@ -104,7 +301,6 @@ void SongCacheIndex::ReadCacheIndex()
 	for( unsigned c=0; c<ImageDir.size(); c++ )
 		EmptyDir( SpecialFiles::CACHE_DIR+ImageDir[c]+"/" );
 
-	CacheIndex.Clear();
 	/* This is right now in place because our song file paths are apparently being
 	 * cached in two distinct areas, and songs were loading from paths in FILEMAN.
 	 * This is admittedly a hack for now, but this does bring up a good question on
@@ -115,37 +311,352 @@ void SongCacheIndex::ReadCacheIndex()
 
 void SongCacheIndex::SaveCacheIndex()
 {
-	CacheIndex.WriteFile(CACHE_INDEX);
+	LockMut( m_Mutex );
+	Flush();
 }
 
 void SongCacheIndex::AddCacheIndex(const RString &path, unsigned hash)
 {
 	if( hash == 0 )
 		++hash; /* no 0 hash values */
-	CacheIndex.SetValue( "Cache", "CacheVersion", FILE_CACHE_VERSION );
-	CacheIndex.SetValue( "Cache", MangleName(path), hash );
+	LockMut( m_Mutex );
+	PendingEntry &entry = m_Pending[path];
+	m_iPendingBytes -= entry.m_sRecord.size();
+	entry = PendingEntry();
+	entry.m_iHash = hash;
+	if(!delay_save_cache)
+	{
+		Flush();
+	}
+}
+
+void SongCacheIndex::AddCacheIndex( const RString &path, unsigned hash, const RString &sRecord )
+{
+	if( hash == 0 )
+		++hash; /* no 0 hash values */
+	LockMut( m_Mutex );
+	PendingEntry &entry = m_Pending[path];
+	m_iPendingBytes -= entry.m_sRecord.size();
+	entry = PendingEntry();
+	entry.m_iHash = hash;
+	entry.m_bHasRecord = true;
+	entry.m_sRecord = sRecord;
+	m_iPendingBytes += sRecord.size();
+	if(!delay_save_cache || m_iPendingBytes >= DB_MAX_PENDING_BYTES)
+	{
+		Flush();
+	}
+}
+
+void SongCacheIndex::RemoveCacheIndex( const RString &path )
+{
+	LockMut( m_Mutex );
+	PendingEntry &entry = m_Pending[path];
+	m_iPendingBytes -= entry.m_sRecord.size();
+	entry = PendingEntry();
+	entry.m_bRemoved = true;
 	if(!delay_save_cache)
 	{
-		CacheIndex.WriteFile(CACHE_INDEX);
+		Flush();
+	}
+}
+
+const SongCacheIndex::IndexEntry *SongCacheIndex::FindEntry( const RString &path ) const
+{
+	const uint64_t iHash = HashPath( path.data(), path.size() );
+	const IndexEntry *pEnd = m_pEntries + m_iNumEntries;
+	const IndexEntry *p = std::lower_bound( m_pEntries, pEnd, iHash,
+		[]( const IndexEntry &e, uint64_t h ) { return e.m_iPathHash < h; } );
+	for( ; p != pEnd && p->m_iPathHash == iHash; ++p )
+	{
+		if( p->m_iPathLength == path.size() &&
+			uint64_t(p->m_iPathOffset) + p->m_iPathLength <= m_iStringsSize &&
+			!memcmp(m_pStrings + p->m_iPathOffset, path.data(), path.size()) )
+			return p;
 	}
+	return nullptr;
 }
 
 unsigned SongCacheIndex::GetCacheHash( const RString &path ) const
 {
-	unsigned iDirHash = 0;
-	if( !CacheIndex.GetValue( "Cache", MangleName(path), iDirHash ) )
+	LockMut( m_Mutex );
+	std::map<RString, PendingEntry>::const_iterator it = m_Pending.find( path );
+	if( it != m_Pending.end() )
+		return it->second.m_bRemoved? 0:it->second.m_iHash;
+
+	const IndexEntry *pEntry = FindEntry( path );
+	if( pEntry == nullptr )
 		return 0;
+	unsigned iDirHash = pEntry->m_iDirHash;
 	if( iDirHash == 0 )
 		++iDirHash; /* no 0 hash values */
 	return iDirHash;
 }
 
-RString SongCacheIndex::MangleName( const RString &Name )
+/* m_Mutex must be held for as long as the returned pointer is used. */
+const char *SongCacheIndex::FindRecord( const RString &path, std::size_t &iSizeOut ) const
 {
-	/* We store paths in an INI.  We can't store '='. */
-	RString ret = Name;
-	ret.Replace( "=", "");
-	return ret;
+	std::map<RString, PendingEntry>::const_iterator it = m_Pending.find( path );
+	if( it != m_Pending.end() )
+	{
+		if( !it->second.m_bHasRecord )
+			return nullptr;
+		iSizeOut = it->second.m_sRecord.size();
+		return it->second.m_sRecord.data();
+	}
+
+	const IndexEntry *pEntry = FindEntry( path );
+	if( pEntry == nullptr || pEntry->m_iRecordSize == 0 )
+		return nullptr;
+	if( pEntry->m_iRecordOffset < sizeof(DatabaseHeader) ||
+		pEntry->m_iRecordOffset + pEntry->m_iRecordSize > m_iDataSize )
+		return nullptr;
+	iSizeOut = pEntry->m_iRecordSize;
+	return m_pData + pEntry->m_iRecordOffset;
+}
+
+bool SongCacheIndex::GetCacheRecord( const RString &path, RString &sOut ) const
+{
+	LockMut( m_Mutex );
+	std::size_t iSize = 0;
+	const char *pRecord = FindRecord( path, iSize );
+	if( pRecord == nullptr )
+		return false;
+	sOut.assign( pRecord, iSize );
+	return true;
+}
+
+bool SongCacheIndex::GetCacheRecordPart( const RString &path, std::size_t iOffset, std::size_t iSize, RString &sOut ) const
+{
+	LockMut( m_Mutex );
+	std::size_t iRecordSize = 0;
+	const char *pRecord = FindRecord( path, iRecordSize );
+	if( pRecord == nullptr || iOffset > iRecordSize || iSize > iRecordSize - iOffset )
+		return false;
+	sOut.assign( pRecord + iOffset, iSize );
+	return true;
+}
+
+static bool WriteAll( int fd, const void *p, std::size_t iSize )
+{
+	const char *pBuf = static_cast<const char *>( p );
+	while( iSize > 0 )
+	{
+		int iRet = DoWrite( fd, pBuf, iSize );
+		if( iRet <= 0 )
+			return false;
+		pBuf += iRet;
+		iSize -= iRet;
+	}
+	return true;
+}
+
+/* Wait for what's been written to fd to reach the disk. */
+static bool SyncFile( int fd )
+{
+#if defined(WIN32)
+	return _commit( fd ) == 0;
+#else
+	return fsync( fd ) == 0;
+#endif
+}
+
+/* Pad the file with zeroes up to the next multiple of 8. */
+static bool AlignFile( int fd, uint64_t &iPos )
+{
+	static const char zero[8] = { 0 };
+	const std::size_t iPad = (8 - iPos % 8) % 8;
+	iPos += iPad;
+	return WriteAll( fd, zero, iPad );
+}
+
+/* Write the pending entries out.  New records and a new index are written
+ * after everything that's already in the file, and synced, and the header is
+ * updated last, so a crash part way through leaves the old index intact.  The
+ * header can't reach the disk before what it points to. */
+void SongCacheIndex::Flush()
+{
+	if( m_Pending.empty() )
+		return;
+
+	struct NewEntry
+	{
+		RString m_sPath;
+		uint64_t m_iPathHash;
+		uint32_t m_iDirHash;
+		uint64_t m_iRecordOffset;
+		uint32_t m_iRecordSize;
+		/* Record contents to write, or nullptr if it's already in the file. */
+		const RString *m_pRecord;
+		RString m_sMovedRecord;
+	};
+	std::vector<NewEntry> vEntries;
+	vEntries.reserve( m_iNumEntries + m_Pending.size() );
+
+	uint64_t iLiveBytes = 0, iDeadBytes = 0;
+	uint64_t iOldIndexOffset = 0;
+	if( m_pData != nullptr )
+	{
+		DatabaseHeader header;
+		memcpy( &header, m_pData, sizeof(header) );
+		iDeadBytes = header.m_iDeadBytes + m_iDataSize - header.m_iIndexOffset;
+		iOldIndexOffset = header.m_iIndexOffset;
+	}
+
+	for( uint32_t i = 0; i < m_iNumEntries; ++i )
+	{
+		const IndexEntry &e = m_pEntries[i];
+		NewEntry ne;
+		ne.m_sPath.assign( m_pStrings + e.m_iPathOffset, e.m_iPathLength );
+		if( m_Pending.find(ne.m_sPath) != m_Pending.end() )
+		{
+			iDeadBytes += e.m_iRecordSize;
+			continue;
+		}
+		ne.m_iPathHash = e.m_iPathHash;
+		ne.m_iDirHash = e.m_iDirHash;
+		ne.m_iRecordOffset = e.m_iRecordOffset;
+		ne.m_iRecordSize = e.m_iRecordSize;
+		ne.m_pRecord = nullptr;
+		iLiveBytes += sizeof(IndexEntry) + e.m_iPathLength + e.m_iRecordSize;
+		vEntries.push_back( ne );
+	}
+
+	for( std::map<RString, PendingEntry>::const_iterator it = m_Pending.begin(); it != m_Pending.end(); ++it )
+	{
+		if( it->second.m_bRemoved )
+			continue;
+		NewEntry ne;
+		ne.m_sPath = it->first;
+		ne.m_iPathHash = HashPath( it->first.data(), it->first.size() );
+		ne.m_iDirHash = it->second.m_iHash;
+		ne.m_iRecordOffset = 0;
+		ne.m_iRecordSize = it->second.m_bHasRecord? it->second.m_sRecord.size() : 0;
+		ne.m_pRecord = it->second.m_bHasRecord? &it->second.m_sRecord : nullptr;
+		iLiveBytes += sizeof(IndexEntry) + ne.m_sPath.size() + ne.m_iRecordSize;
+		vEntries.push_back( ne );
+	}
+
+	/* Rewrite the whole file once more of it is stale than live.  Entries
+	 * without a record (the SSC cache files are kept outside the database)
+	 * still count as live through their index entry, or every save would
+	 * compact once the old indexes add up.  The records that are kept have
+	 * to be copied out before the file is unmapped. */
+	const bool bCompact = m_pData == nullptr ||
+		(iDeadBytes > iLiveBytes && iDeadBytes > DB_MIN_DEAD_BYTES_TO_COMPACT);
+	if( bCompact )
+	{
+		for( NewEntry &ne : vEntries )
+		{
+			if( ne.m_pRecord != nullptr || ne.m_iRecordSize == 0 )
+				continue;
+			ne.m_sMovedRecord.assign( m_pData + ne.m_iRecordOffset, ne.m_iRecordSize );
+			ne.m_pRecord = &ne.m_sMovedRecord;
+		}
+		iDeadBytes = 0;
+	}
+	UnmapFile();
+
+	/* A compacted database is written to a new file and renamed over the
+	 * old one, so a crash part way through leaves the old file as it was. */
+	FILEMAN->CreateDir( SpecialFiles::CACHE_DIR );
+	const RString sPath = FILEMAN->ResolvePath( CACHE_DB );
+	const RString sWritePath = bCompact? sPath + ".new" : sPath;
+	int fd = DoOpen( sWritePath, O_BINARY|O_RDWR|O_CREAT|(bCompact? O_TRUNC:0), 0666 );
+	if( fd == -1 )
+	{
+		LOG->Warn( "Couldn't open \"%s\" for writing: %s", sWritePath.c_str(), strerror(errno) );
+		MapFile();
+		return;
+	}
+
+	DatabaseHeader header;
+	memset( &header, 0, sizeof(header) );
+	uint64_t iPos;
+	bool bOK = true;
+	if( bCompact )
+	{
+		// Write a blank header until the index is in place.
+		bOK = WriteAll( fd, &header, sizeof(header) );
+		iPos = sizeof(header);
+	}
+	else
+	{
+		iPos = DoLseek( fd, 0, SEEK_END );
+		ASSERT( iPos >= iOldIndexOffset );
+	}
+
+	for( NewEntry &ne : vEntries )
+	{
+		if( !bOK || ne.m_pRecord == nullptr )
+			continue;
+		ne.m_iRecordOffset = iPos;
+		bOK = WriteAll( fd, ne.m_pRecord->data(), ne.m_iRecordSize );
+		iPos += ne.m_iRecordSize;
+	}
+
+	std::sort( vEntries.begin(), vEntries.end(), []( const NewEntry &a, const NewEntry &b ) {
+		if( a.m_iPathHash != b.m_iPathHash )
+			return a.m_iPathHash < b.m_iPathHash;
+		return a.m_sPath < b.m_sPath;
+	} );
+
+	RString sIndex;
+	RString sStrings;
+	sIndex.reserve( vEntries.size()*sizeof(IndexEntry) );
+	for( NewEntry const &ne : vEntries )
+	{
+		IndexEntry e;
+		e.m_iPathHash = ne.m_iPathHash;
+		e.m_iRecordOffset = ne.m_iRecordOffset;
+		e.m_iRecordSize = ne.m_iRecordSize;
+		e.m_iDirHash = ne.m_iDirHash;
+		e.m_iPathOffset = sStrings.size();
+		e.m_iPathLength = ne.m_sPath.size();
+		sIndex.append( reinterpret_cast<const char *>(&e), sizeof(e) );
+		sStrings.append( ne.m_sPath );
+	}
+	sIndex.append( sStrings );
+
+	bOK = bOK && AlignFile( fd, iPos );
+	header.m_iMagic = DB_MAGIC;
+	header.m_iFormatVersion = DB_FORMAT_VERSION;
+	header.m_iCacheVersion = FILE_CACHE_VERSION;
+	header.m_iNumEntries = vEntries.size();
+	header.m_iIndexOffset = iPos;
+	header.m_iStringsSize = sStrings.size();
+	header.m_iIndexCRC = 0;
+	CRC32( header.m_iIndexCRC, sIndex.data(), sIndex.size() );
+	header.m_iDeadBytes = iDeadBytes;
+
+	bOK = bOK && WriteAll( fd, sIndex.data(), sIndex.size() );
+	bOK = bOK && SyncFile( fd );
+	bOK = bOK && DoLseek( fd, 0, SEEK_SET ) == 0;
+	bOK = bOK && WriteAll( fd, &header, sizeof(header) );
+	bOK = bOK && SyncFile( fd );
+	DoClose( fd );
+
+	if( bOK && bCompact )
+	{
+#if defined(WIN32)
+		bOK = WinMoveFile( sWritePath, sPath );
+#else
+		bOK = DoRename( sWritePath, sPath ) == 0;
+#endif
+	}
+
+	if( !bOK )
+	{
+		LOG->Warn( "Couldn't write \"%s\": %s", sWritePath.c_str(), strerror(errno) );
+		if( bCompact )
+			DoRemove( sWritePath );
+	}
+	else
+	{
+		m_Pending.clear();
+		m_iPendingBytes = 0;
+	}
+	MapFile();
 }
 
 /*
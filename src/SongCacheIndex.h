@@ -1,13 +1,24 @@
 #ifndef SONG_CACHE_INDEX_H
 #define SONG_CACHE_INDEX_H
 
-#include "IniFile.h"
+#include "RageThreads.h"
 
+#include <cstdint>
+#include <map>
+
+/**
+ * @brief The song cache database.
+ *
+ * Everything lives in one file: a header, the cache records, and an index
+ * of entries sorted by path hash followed by the string table holding the
+ * paths.  The file is memory mapped when it's read, so looking up an entry
+ * is a binary search that doesn't allocate or touch the disk.  Changes are
+ * kept in memory until they're saved, then the new records and a new index
+ * are appended and the header is rewritten to point at them.  Once more of
+ * the file is stale than live, it's compacted into a new file on the next
+ * save. */
 class SongCacheIndex
 {
-	IniFile CacheIndex;
-	static RString MangleName( const RString &Name );
-
 public:
 	SongCacheIndex();
 	~SongCacheIndex();
@@ -17,8 +28,70 @@ public:
 	void ReadCacheIndex();
 	void SaveCacheIndex();
 	void AddCacheIndex( const RString &path, unsigned hash );
+	/**
+	 * @brief Add an entry along with a cache record for it.
+	 * @param path the song or course path.
+	 * @param hash the directory hash the record was made from.
+	 * @param sRecord the record to store. */
+	void AddCacheIndex( const RString &path, unsigned hash, const RString &sRecord );
+	void RemoveCacheIndex( const RString &path );
 	unsigned GetCacheHash( const RString &path ) const;
+	/**
+	 * @brief Copy out the cache record stored with an entry.
+	 * @return false if there's no entry, or it has no record. */
+	bool GetCacheRecord( const RString &path, RString &sOut ) const;
+	/**
+	 * @brief Copy out part of the cache record stored with an entry.
+	 * @param iOffset the offset of the part within the record.
+	 * @param iSize the size of the part.
+	 * @return false if there's no record, or it's too short. */
+	bool GetCacheRecordPart( const RString &path, std::size_t iOffset, std::size_t iSize, RString &sOut ) const;
 	bool delay_save_cache;
+
+private:
+	struct IndexEntry;
+	struct PendingEntry
+	{
+		PendingEntry(): m_iHash(0), m_bRemoved(false), m_bHasRecord(false) { }
+		unsigned m_iHash;
+		bool m_bRemoved;
+		bool m_bHasRecord;
+		RString m_sRecord;
+	};
+
+	const IndexEntry *FindEntry( const RString &path ) const;
+	const char *FindRecord( const RString &path, std::size_t &iSizeOut ) const;
+	void Flush();
+	enum MapResult
+	{
+		MAP_OK,
+		/* There's no database, or it's from another version. */
+		MAP_OUT_OF_DATE,
+		/* The database is damaged. */
+		MAP_CORRUPT
+	};
+	MapResult MapFile();
+	void UnmapFile();
+
+	/* Songs may be loaded on several threads at once; this protects
+	 * everything below. */
+	mutable RageMutex m_Mutex;
+	/* Entries added or removed since the file was last written. */
+	std::map<RString, PendingEntry> m_Pending;
+	/* The size of the records in m_Pending. */
+	std::size_t m_iPendingBytes;
+
+	const char *m_pData;
+	std::size_t m_iDataSize;
+	/* Platform handle for the mapping; nullptr when nothing is mapped or
+	 * the file had to be read into m_sFallbackData. */
+	void *m_pMapping;
+	RString m_sFallbackData;
+
+	const IndexEntry *m_pEntries;
+	uint32_t m_iNumEntries;
+	const char *m_pStrings;
+	uint32_t m_iStringsSize;
 };
 
 extern SongCacheIndex *SONGINDEX;	// global and accessible from anywhere in our program
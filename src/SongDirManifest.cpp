@@ -0,0 +1,227 @@
+#include "global.h"
+
+#include "SongDirManifest.h"
+#include "Preference.h"
+#include "RageFile.h"
+#include "RageFileDriverDirectHelpers.h"
+#include "RageFileManager.h"
+#include "RageLog.h"
+#include "RageUtil.h"
+#include "Song.h"
+#include "SpecialFiles.h"
+
+#include <sys/stat.h>
+
+#define MANIFEST_FILE SpecialFiles::CACHE_DIR + "songs.manifest"
+static const RString MANIFEST_HEADER = "SongDirManifest 2";
+
+/* Some filesystems (and some network shares) don't update the modification
+ * time of a directory when something in it changes.  Turning this off goes
+ * back to listing and hashing every song directory on each load. */
+static Preference<bool> g_bIncrementalSongScan( "IncrementalSongScan", true );
+
+bool SongDirManifest::IsEnabled()
+{
+	return g_bIncrementalSongScan;
+}
+
+std::int64_t SongDirManifest::GetStamp( const RString &sPath )
+{
+	RString sNormalized = sPath;
+	if( sNormalized.Right(1) == "/" )
+		sNormalized.erase( sNormalized.size()-1 );
+
+	/* Stat the file directly if it's on a directory mount.  Asking FILEMAN
+	 * would read and stat everything in the containing directory, which is
+	 * exactly what we're trying to avoid. */
+	const RString sOSPath = FILEMAN->ResolvePath( sNormalized );
+	if( sOSPath != sNormalized )
+	{
+		struct stat st;
+		if( DoStat(sOSPath.c_str(), &st) == 0 )
+		{
+			/* Keep the two apart: summed, a change to one can cancel out a
+			 * change to the other. */
+			const std::int64_t iStamp = std::int64_t( (std::uint64_t(st.st_mtime) << 32) ^ std::uint64_t(st.st_size) );
+			return iStamp == -1? -2 : iStamp;
+		}
+	}
+
+	return FILEMAN->GetFileHash( sNormalized );
+}
+
+void SongDirManifest::Clear()
+{
+	m_Groups.clear();
+	m_Songs.clear();
+}
+
+/*
+ * The manifest is a text file.  After the header line, each line is one of:
+ *
+ * G <tab> stamp <tab> group dir
+ * D <tab> song dir			(a song directory in the last group)
+ * S <tab> stamp <tab> song dir
+ * F <tab> stamp <tab> file		(a file of the last song)
+ *
+ * Anything unexpected discards the whole manifest, which only costs a full
+ * scan.
+ */
+void SongDirManifest::ReadFromDisk()
+{
+	Clear();
+
+	RageFile f;
+	if( !f.Open(MANIFEST_FILE, RageFile::READ) )
+		return;
+
+	RString sLine;
+	if( f.GetLine(sLine) <= 0 || sLine != MANIFEST_HEADER )
+	{
+		LOG->Trace( "Song manifest is out of date; ignoring it." );
+		return;
+	}
+
+	GroupEntry *pGroup = nullptr;
+	SongEntry *pSong = nullptr;
+	while( f.GetLine(sLine) > 0 )
+	{
+		std::vector<RString> asParts;
+		split( sLine, "\t", asParts, false );
+
+		if( asParts.size() == 3 && asParts[0] == "G" )
+		{
+			pGroup = &m_Groups[asParts[2]];
+			pGroup->m_iStamp = StringToLLong( asParts[1] );
+			pGroup->m_vsSongDirs.clear();
+		}
+		else if( asParts.size() == 2 && asParts[0] == "D" && pGroup != nullptr )
+		{
+			pGroup->m_vsSongDirs.push_back( asParts[1] );
+		}
+		else if( asParts.size() == 3 && asParts[0] == "S" )
+		{
+			pSong = &m_Songs[asParts[2]];
+			pSong->m_iStamp = StringToLLong( asParts[1] );
+			pSong->m_vFiles.clear();
+		}
+		else if( asParts.size() == 3 && asParts[0] == "F" && pSong != nullptr )
+		{
+			pSong->m_vFiles.push_back( std::make_pair(asParts[2], std::int64_t(StringToLLong(asParts[1]))) );
+		}
+		else
+		{
+			LOG->Warn( "Song manifest has an invalid line \"%s\"; ignoring it.", sLine.c_str() );
+			Clear();
+			return;
+		}
+	}
+}
+
+void SongDirManifest::SaveToDisk() const
+{
+	RageFile f;
+	if( !f.Open(MANIFEST_FILE, RageFile::WRITE) )
+	{
+		LOG->Warn( "Couldn't write the song manifest: %s", f.GetError().c_str() );
+		return;
+	}
+
+	f.PutLine( MANIFEST_HEADER );
+	for( auto const &group : m_Groups )
+	{
+		f.PutLine( ssprintf("G\t%lld\t%s", (long long) group.second.m_iStamp, group.first.c_str()) );
+		for( RString const &sSongDir : group.second.m_vsSongDirs )
+			f.PutLine( "D\t" + sSongDir );
+	}
+	for( auto const &song : m_Songs )
+	{
+		f.PutLine( ssprintf("S\t%lld\t%s", (long long) song.second.m_iStamp, song.first.c_str()) );
+		for( auto const &file : song.second.m_vFiles )
+			f.PutLine( ssprintf("F\t%lld\t%s", (long long) file.second, file.first.c_str()) );
+	}
+
+	if( f.Flush() == -1 )
+		LOG->Warn( "Couldn't write the song manifest: %s", f.GetError().c_str() );
+}
+
+bool SongDirManifest::GetGroupSongDirs( const RString &sGroupDir, std::int64_t iStamp, std::vector<RString> &vsSongDirsOut ) const
+{
+	auto it = m_Groups.find( sGroupDir );
+	if( it == m_Groups.end() || iStamp == -1 || it->second.m_iStamp != iStamp )
+		return false;
+	vsSongDirsOut = it->second.m_vsSongDirs;
+	return true;
+}
+
+void SongDirManifest::SetGroupSongDirs( const RString &sGroupDir, std::int64_t iStamp, const std::vector<RString> &vsSongDirs )
+{
+	GroupEntry &group = m_Groups[sGroupDir];
+	group.m_iStamp = iStamp;
+	group.m_vsSongDirs = vsSongDirs;
+}
+
+bool SongDirManifest::IsSongUnchanged( const RString &sSongDir ) const
+{
+	auto it = m_Songs.find( sSongDir );
+	if( it == m_Songs.end() || it->second.m_iStamp == -1 )
+		return false;
+	if( GetStamp(sSongDir) != it->second.m_iStamp )
+		return false;
+	for( auto const &file : it->second.m_vFiles )
+	{
+		if( GetStamp(file.first) != file.second )
+			return false;
+	}
+	return true;
+}
+
+void SongDirManifest::SetSong( const Song &song )
+{
+	SongEntry &entry = m_Songs[song.GetSongDir()];
+	entry.m_iStamp = GetStamp( song.GetSongDir() );
+	entry.m_vFiles.clear();
+
+	std::vector<RString> vsFiles;
+	vsFiles.push_back( song.GetSongFilePath() );
+	if( !song.m_sMusicFile.empty() )
+		vsFiles.push_back( song.GetMusicPath() );
+	for( RString const &sFile : vsFiles )
+	{
+		if( sFile.empty() )
+			continue;
+		entry.m_vFiles.push_back( std::make_pair(sFile, GetStamp(sFile)) );
+	}
+}
+
+void SongDirManifest::CopySong( const SongDirManifest &from, const RString &sSongDir )
+{
+	auto it = from.m_Songs.find( sSongDir );
+	if( it != from.m_Songs.end() )
+		m_Songs[sSongDir] = it->second;
+}
+
+/*
+ * (c) 2026 Stepmania team
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, and/or sell copies of the Software, and to permit persons to
+ * whom the Software is furnished to do so, provided that the above
+ * copyright notice(s) and this permission notice appear in all copies of
+ * the Software and that both the above copyright notice(s) and this
+ * permission notice appear in supporting documentation.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT OF
+ * THIRD PARTY RIGHTS. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR HOLDERS
+ * INCLUDED IN THIS NOTICE BE LIABLE FOR ANY CLAIM, OR ANY SPECIAL INDIRECT
+ * OR CONSEQUENTIAL DAMAGES, OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS
+ * OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
@@ -0,0 +1,102 @@
+#ifndef SONG_DIR_MANIFEST_H
+#define SONG_DIR_MANIFEST_H
+
+#include <cstdint>
+#include <map>
+#include <vector>
+
+class Song;
+
+/**
+ * @brief Remembers what the Songs folder looked like at the last scan.
+ *
+ * For each group directory, the manifest keeps the group's stamp (its
+ * modification time and size) and the song directories found in it.  For
+ * each song, it keeps the stamp of the song directory and of the files the
+ * song was loaded from: its simfile and its music.
+ *
+ * A directory's modification time changes whenever an entry is added to,
+ * removed from or renamed in it, so a group whose stamp hasn't changed still
+ * holds the same song directories and doesn't have to be listed again.  A
+ * song whose directory, simfile and music stamps are all unchanged can be
+ * loaded from the cache without hashing every file in its directory. */
+class SongDirManifest
+{
+public:
+	/** @brief Is the manifest used to skip unchanged directories? */
+	static bool IsEnabled();
+
+	/**
+	 * @brief Get the stamp of a file or directory.
+	 * @return its modification time and size, packed into one value, or -1
+	 * if it doesn't exist. */
+	static std::int64_t GetStamp( const RString &sPath );
+
+	void Clear();
+	void ReadFromDisk();
+	void SaveToDisk() const;
+
+	/**
+	 * @brief Look up the song directories of an unchanged group.
+	 * @param sGroupDir the group directory, with a trailing slash.
+	 * @param iStamp the current stamp of the group directory.
+	 * @param vsSongDirsOut the song directories found in it last time.
+	 * @return true if the group is known and its stamp hasn't changed. */
+	bool GetGroupSongDirs( const RString &sGroupDir, std::int64_t iStamp, std::vector<RString> &vsSongDirsOut ) const;
+	void SetGroupSongDirs( const RString &sGroupDir, std::int64_t iStamp, const std::vector<RString> &vsSongDirs );
+
+	/**
+	 * @brief Has this song changed since it was last recorded?
+	 *
+	 * This stats the song directory and each recorded file, so it's safe to
+	 * call from several song loading threads at once.
+	 * @param sSongDir the song directory, with a trailing slash.
+	 * @return true if the song was recorded and none of its stamps changed. */
+	bool IsSongUnchanged( const RString &sSongDir ) const;
+	/** @brief Record the current stamps of a loaded song. */
+	void SetSong( const Song &song );
+	/** @brief Carry over a song's entry from another manifest, if it has one. */
+	void CopySong( const SongDirManifest &from, const RString &sSongDir );
+
+private:
+	struct GroupEntry
+	{
+		std::int64_t m_iStamp;
+		std::vector<RString> m_vsSongDirs;
+	};
+	struct SongEntry
+	{
+		std::int64_t m_iStamp;
+		std::vector<std::pair<RString, std::int64_t>> m_vFiles;
+	};
+
+	std::map<RString, GroupEntry> m_Groups;
+	std::map<RString, SongEntry> m_Songs;
+};
+
+#endif
+
+/*
+ * (c) 2026 Stepmania team
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, and/or sell copies of the Software, and to permit persons to
+ * whom the Software is furnished to do so, provided that the above
+ * copyright notice(s) and this permission notice appear in all copies of
+ * the Software and that both the above copyright notice(s) and this
+ * permission notice appear in supporting documentation.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT OF
+ * THIRD PARTY RIGHTS. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR HOLDERS
+ * INCLUDED IN THIS NOTICE BE LIABLE FOR ANY CLAIM, OR ANY SPECIAL INDIRECT
+ * OR CONSEQUENTIAL DAMAGES, OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS
+ * OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
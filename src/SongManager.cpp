@@ -4,15 +4,20 @@
 #include "ActorUtil.h"
 #include "AnnouncerManager.h"
 #include "BackgroundUtil.h"
+#include "AudioMetadataCache.h"
+#include "ChartHashCache.h"
 #include "ImageCache.h"
 #include "CommonMetrics.h"
 #include "Course.h"
 #include "CourseLoaderCRS.h"
 #include "CourseUtil.h"
+#include "FontCharAliases.h"
 #include "GameManager.h"
 #include "GameState.h"
+#include "LoadProfiler.h"
 #include "LocalizedString.h"
 #include "MemoryCardManager.h"
+#include "MessageManager.h"
 #include "MsdFile.h"
 #include "NoteSkinManager.h"
 #include "NotesLoaderDWI.h"
@@ -21,6 +26,8 @@
 #include "PrefsManager.h"
 #include "Profile.h"
 #include "ProfileManager.h"
+#include "Screen.h"
+#include "ScreenManager.h"
 #include "RageFile.h"
 #include "RageFileManager.h"
 #include "RageLog.h"
@@ -38,7 +45,12 @@
 #include "UnlockManager.h"
 #include "SpecialFiles.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cstddef>
+#include <deque>
+#include <memory>
+#include <thread>
 #include <tuple>
 #include <vector>
 
@@ -59,6 +71,17 @@ static const ThemeMetric<int>		EXTRA_STAGE2_DIFFICULTY_MAX	( "SongManager", "Ext
 
 static Preference<RString> g_sDisabledSongs( "DisabledSongs", "" );
 static Preference<bool> g_bHideIncompleteCourses( "HideIncompleteCourses", false );
+/* The number of threads used to load songs.  1 loads them one at a time on the
+ * main thread; 0 uses one thread per CPU. */
+static Preference<int> g_iSongLoadThreads( "SongLoadThreads", 1 );
+/* When loading every song, only load this many groups (plus any with songs in
+ * the theme's preferred sort) before carrying on; the rest are loaded in the
+ * background and added as they finish.  0 loads every group up front. */
+static Preference<int> g_iSongLoadForegroundGroups( "SongLoadForegroundGroups", 0 );
+/* How often to tell screens that more groups were loaded in the background. */
+static const float BACKGROUND_LOAD_MESSAGE_SECONDS = 1.0f;
+/* How many banners to preload each frame once a background load is done. */
+static const std::size_t BACKGROUND_LOAD_IMAGES_PER_FRAME = 32;
 
 RString SONG_GROUP_COLOR_NAME( std::size_t i )   { return ssprintf( "SongGroupColor%i", (int) i+1 ); }
 RString COURSE_GROUP_COLOR_NAME( std::size_t i ) { return ssprintf( "CourseGroupColor%i", (int) i+1 ); }
@@ -66,7 +89,8 @@ RString profile_song_group_color_name(std::size_t i) { return ssprintf("ProfileS
 
 static const float next_loading_window_update= 0.02f;
 
-SongManager::SongManager()
+SongManager::SongManager():
+	m_bSongDirManifestLoaded(false), m_pBackgroundLoad(nullptr)
 {
 	// Register with Lua.
 	{
@@ -90,6 +114,11 @@ SongManager::~SongManager()
 	// Unregister with Lua.
 	LUA->UnsetGlobal( "SONGMAN" );
 
+	CancelBackgroundLoad();
+	ChartHashCache::WriteToDisk();
+	AudioMetadataCache::WriteToDisk();
+	AudioMetadataCache::PruneFrameIndexes();
+
 	// Courses depend on Songs and Songs don't depend on Courses.
 	// So, delete the Courses first.
 	FreeCourses();
@@ -98,6 +127,10 @@ SongManager::~SongManager()
 
 void SongManager::InitAll( LoadingWindow *ld, bool onlyAdditions )
 {
+	// Groups still loading in the background have to be in before looking
+	// for anything new.
+	FinishBackgroundLoad();
+
 	std::vector<RString> never_cache;
 	split(PREFSMAN->m_NeverCacheList, ",", never_cache);
 	for(std::vector<RString>::iterator group= never_cache.begin();
@@ -105,14 +138,21 @@ void SongManager::InitAll( LoadingWindow *ld, bool onlyAdditions )
 	{
 		m_GroupsToNeverCache.insert(*group);
 	}
+	LoadProfiler::Begin();
 	InitSongsFromDisk( ld, onlyAdditions );
+	InitRandomAttacks();
+
+	// Courses are loaded with the songs that are in so far; if some are
+	// still loading in the background, the courses missing them are
+	// reloaded once they're done.
 	InitCoursesFromDisk( ld, onlyAdditions );
 	if (onlyAdditions)
 	{
 		DeleteAutogenCourses();
 	}
 	InitAutogenCourses();
-	InitRandomAttacks();
+	if( m_pBackgroundLoad == nullptr )
+		LoadProfiler::End();
 }
 
 static LocalizedString RELOADING ( "SongManager", "Reloading..." );
@@ -229,6 +269,15 @@ void SongManager::LoadAdditions( LoadingWindow *ld )
 	UpdatePreferredSort();
 }
 
+/* Write out the cache indexes InitSongsFromDisk told not to save after every song. */
+static void SaveDelayedCaches()
+{
+	SONGINDEX->SaveCacheIndex();
+	SONGINDEX->delay_save_cache = false;
+	IMAGECACHE->WriteToDisk();
+	IMAGECACHE->delay_save_cache = false;
+}
+
 void SongManager::InitSongsFromDisk( LoadingWindow *ld, bool onlyAdditions )
 {
 	RageTimer tm;
@@ -238,12 +287,17 @@ void SongManager::InitSongsFromDisk( LoadingWindow *ld, bool onlyAdditions )
 	IMAGECACHE->delay_save_cache = true;
 	LoadSongDir( SpecialFiles::SONGS_DIR, ld, onlyAdditions );
 	LoadEnabledSongsFromPref();
-	SONGINDEX->SaveCacheIndex();
-	SONGINDEX->delay_save_cache = false;
-	IMAGECACHE->WriteToDisk();
-	IMAGECACHE->delay_save_cache = false;
+	// A background load saves the caches once it's done.
+	if( m_pBackgroundLoad == nullptr )
+		SaveDelayedCaches();
 
 	LOG->Trace( "Found %d songs in %f seconds.", (int)m_pSongs.size(), tm.GetDeltaTime() );
+
+	NoteDataStats stats;
+	GetNoteDataStats( stats );
+	LOG->Trace( "Note data: %i of %i Steps resident, %i in the song cache (%.1f of %.1f MB not in memory).",
+		stats.m_iNumResident, stats.m_iNumSteps, stats.m_iNumCached,
+		stats.m_iBytesSaved / (1024.0f*1024.0f), stats.m_iCachedBytes / (1024.0f*1024.0f) );
 }
 
 static LocalizedString FOLDER_CONTAINS_MUSIC_FILES( "SongManager", "The folder \"%s\" appears to be a song folder.  All song folders must reside in a group folder.  For example, \"Songs/Originals/My Song\"." );
@@ -267,16 +321,9 @@ void SongManager::SanityCheckGroupDir( RString sDir ) const
 	}
 }
 
-void SongManager::AddGroup( RString sDir, RString sGroupDirName )
+/* This only reads the directory, so it's safe to call from any thread. */
+static RString FindGroupBanner( const RString &sDir, const RString &sGroupDirName )
 {
-	unsigned j;
-	for(j = 0; j < m_sSongGroupNames.size(); ++j)
-		if( sGroupDirName == m_sSongGroupNames[j] )
-			break;
-
-	if( j != m_sSongGroupNames.size() )
-		return; // the group is already added
-
 	// Look for a group banner in this group folder
 	std::vector<RString> arrayGroupBanners;
 	GetDirListing( sDir+sGroupDirName+"/*.png", arrayGroupBanners );
@@ -299,6 +346,18 @@ void SongManager::AddGroup( RString sDir, RString sGroupDirName )
 		if( !arrayGroupBanners.empty() )
 			sBannerPath = sDir+arrayGroupBanners[0];
 	}
+	return sBannerPath;
+}
+
+void SongManager::AddGroup( const RString &sGroupDirName, const RString &sBannerPath )
+{
+	unsigned j;
+	for(j = 0; j < m_sSongGroupNames.size(); ++j)
+		if( sGroupDirName == m_sSongGroupNames[j] )
+			break;
+
+	if( j != m_sSongGroupNames.size() )
+		return; // the group is already added
 
 	/* Other group graphics are a bit trickier, and usually don't exist.
 	 * A themer has a few options, namely checking the aspect ratio and
@@ -356,11 +415,24 @@ void SongManager::LoadSongDir( RString sDir, LoadingWindow *ld, bool onlyAdditio
 
 	// Find all group directories in "Songs" folder
 	std::vector<RString> arrayGroupDirs;
-	GetDirListing( sDir+"*", arrayGroupDirs, true );
+	{
+		LoadProfiler::StageTimer list_timer( LoadStage_ListDirectories );
+		GetDirListing( sDir+"*", arrayGroupDirs, true );
+	}
 	SortRStringArray( arrayGroupDirs );
 	StripCvsAndSvn( arrayGroupDirs );
 	StripMacResourceForks( arrayGroupDirs );
 
+	// The manifest from the last scan is only read here; the one for this
+	// scan is built as songs are added and replaces it at the end.
+	const bool bUseManifest = SongDirManifest::IsEnabled();
+	if( bUseManifest && !m_bSongDirManifestLoaded )
+	{
+		m_SongDirManifest.ReadFromDisk();
+		m_bSongDirManifestLoaded = true;
+	}
+	SongDirManifest newManifest;
+
 	std::vector<std::vector<RString>> arrayGroupSongDirs;
 	int groupIndex, songCount, songIndex;
 
@@ -381,33 +453,68 @@ void SongManager::LoadSongDir( RString sDir, LoadingWindow *ld, bool onlyAdditio
 			ld->SetText(SANITY_CHECKING_GROUPS.GetValue() + ssprintf("\n%s",
 					Basename(sGroupDirName).c_str()));
 		}
-		// TODO: If this check fails, log a warning instead of crashing.
-		SanityCheckGroupDir(sDir+sGroupDirName);
-
-		// Find all Song folders in this group directory
+		// A group whose directory stamp hasn't changed still holds the same
+		// song folders, so don't list it again.
+		LoadProfiler::SongTimer group_timer( sGroupDirName, RString() );
+		LoadProfiler::StageTimer list_timer( LoadStage_ListDirectories );
 		std::vector<RString> arraySongDirs;
-		GetDirListing( sDir+sGroupDirName + "/*", arraySongDirs, true, true );
-		StripCvsAndSvn( arraySongDirs );
-		StripMacResourceForks( arraySongDirs );
-		SortRStringArray( arraySongDirs );
+		const RString sGroupDir = sDir + sGroupDirName + "/";
+		const std::int64_t iGroupStamp = bUseManifest? SongDirManifest::GetStamp(sGroupDir) : -1;
+		if( !bUseManifest || !m_SongDirManifest.GetGroupSongDirs(sGroupDir, iGroupStamp, arraySongDirs) )
+		{
+			// TODO: If this check fails, log a warning instead of crashing.
+			SanityCheckGroupDir(sDir+sGroupDirName);
+
+			// Find all Song folders in this group directory
+			GetDirListing( sDir+sGroupDirName + "/*", arraySongDirs, true, true );
+			StripCvsAndSvn( arraySongDirs );
+			StripMacResourceForks( arraySongDirs );
+			SortRStringArray( arraySongDirs );
+		}
+		if( bUseManifest )
+			newManifest.SetGroupSongDirs( sGroupDir, iGroupStamp, arraySongDirs );
 
 		arrayGroupSongDirs.push_back(arraySongDirs);
 		songCount += arraySongDirs.size();
 
 	}
 
-	if( songCount==0 ) return;
+	if( !onlyAdditions )
+		SplitBackgroundGroups( sDir, arrayGroupDirs, arrayGroupSongDirs, songCount );
+
+	if( songCount==0 && m_pBackgroundLoad == nullptr )
+	{
+		if( bUseManifest )
+		{
+			m_SongDirManifest = newManifest;
+			m_SongDirManifest.SaveToDisk();
+		}
+		return;
+	}
 
 	if( ld ) {
 		ld->SetIndeterminate( false );
 		ld->SetTotalWork( songCount );
 	}
 
+	// If threaded loading is on, parse every song up front; the loop below
+	// then only adds them, so groups and songs still end up in sorted order.
+	int iThreads = g_iSongLoadThreads;
+	if( iThreads <= 0 )
+		iThreads = std::max( 1, (int) std::thread::hardware_concurrency() );
+	iThreads = std::min( iThreads, songCount );
+	std::vector<std::vector<Song*>> arrayGroupSongs;
+	const bool bThreaded = iThreads > 1;
+	if( bThreaded )
+		LoadSongsThreaded( arrayGroupSongDirs, arrayGroupSongs, iThreads, ld, onlyAdditions );
+
 	groupIndex = 0;
 	songIndex = 0;
 	for (RString const &sGroupDirName : arrayGroupDirs)	// foreach dir in /Songs/
 	{
-		std::vector<RString> &arraySongDirs = arrayGroupSongDirs[groupIndex++];
+		std::vector<RString> &arraySongDirs = arrayGroupSongDirs[groupIndex];
+		std::vector<Song*> *pLoadedSongs = bThreaded? &arrayGroupSongs[groupIndex]:nullptr;
+		++groupIndex;
 
 		LOG->Trace("Attempting to load %i songs from \"%s\"", int(arraySongDirs.size()),
 				   (sDir+sGroupDirName).c_str() );
@@ -419,13 +526,35 @@ void SongManager::LoadSongDir( RString sDir, LoadingWindow *ld, bool onlyAdditio
 		{
 			RString sSongDirName = arraySongDirs[j];
 
+			if( pLoadedSongs )
+			{
+				Song *pLoadedSong = (*pLoadedSongs)[j];
+				if( pLoadedSong == nullptr )
+				{
+					if( bUseManifest && onlyAdditions )
+						newManifest.CopySong( m_SongDirManifest, sSongDirName + "/" );
+					continue;
+				}
+				AddSongToList( pLoadedSong );
+				if( bUseManifest )
+					newManifest.SetSong( *pLoadedSong );
+				index_entry.push_back( pLoadedSong );
+				loaded++;
+				songIndex++;
+				continue;
+			}
+
 			// Skip already loaded songs if onlyAdditions is set.
 			if (onlyAdditions)
 			{
 				SongID songID;
 				songID.FromString(sSongDirName);
 				if (songID.ToSong() != nullptr)
+				{
+					if( bUseManifest )
+						newManifest.CopySong( m_SongDirManifest, sSongDirName + "/" );
 					continue;
+				}
 			}
 
 			// this is a song directory. Load a new song.
@@ -449,6 +578,8 @@ void SongManager::LoadSongDir( RString sDir, LoadingWindow *ld, bool onlyAdditio
 				continue;
 			}
 			AddSongToList(pNewSong);
+			if( bUseManifest )
+				newManifest.SetSong( *pNewSong );
 
 			index_entry.push_back( pNewSong );
 			loaded++;
@@ -460,14 +591,16 @@ void SongManager::LoadSongDir( RString sDir, LoadingWindow *ld, bool onlyAdditio
 		// Don't add the group name if we didn't load any songs in this group.
 		if(!loaded) continue;
 
-		// Add this group to the group array.
-		AddGroup(sDir, sGroupDirName);
-
-		// Cache and load the group banner. (and background if it has one -aj)
-		IMAGECACHE->CacheImage( "Banner", GetSongGroupBannerPath(sGroupDirName) );
+		AddLoadedGroup( sDir, sGroupDirName );
+	}
 
-		// Load the group sym links (if any)
-		LoadGroupSymLinks(sDir, sGroupDirName);
+	// The background load finishes the manifest as it adds its groups.
+	if( m_pBackgroundLoad != nullptr )
+		StartBackgroundLoad( newManifest );
+	else if( bUseManifest )
+	{
+		m_SongDirManifest = newManifest;
+		m_SongDirManifest.SaveToDisk();
 	}
 
 	if( ld ) {
@@ -475,6 +608,597 @@ void SongManager::LoadSongDir( RString sDir, LoadingWindow *ld, bool onlyAdditio
 	}
 }
 
+void SongManager::AddLoadedGroup( const RString &sDir, const RString &sGroupDirName )
+{
+	LoadProfiler::SongTimer group_timer( sGroupDirName, RString() );
+	const RString sBannerPath = FindGroupBanner( sDir, sGroupDirName );
+
+	// Cache and load the group banner. (and background if it has one -aj)
+	IMAGECACHE->CacheImage( "Banner", sBannerPath );
+
+	AddLoadedGroup( sDir, sGroupDirName, sBannerPath );
+}
+
+void SongManager::AddLoadedGroup( const RString &sDir, const RString &sGroupDirName, const RString &sBannerPath )
+{
+	// Add this group to the group array.
+	AddGroup( sGroupDirName, sBannerPath );
+
+	// Load the group sym links (if any)
+	LoadGroupSymLinks(sDir, sGroupDirName);
+}
+
+bool SongManager::IsSongDirUnchanged( const RString &sSongDir ) const
+{
+	return SongDirManifest::IsEnabled() && m_SongDirManifest.IsSongUnchanged( sSongDir );
+}
+
+void SongManager::GetNoteDataStats( NoteDataStats &out ) const
+{
+	out.m_iNumSteps = 0;
+	out.m_iNumResident = 0;
+	out.m_iNumCached = 0;
+	out.m_iCachedBytes = 0;
+	out.m_iBytesSaved = 0;
+	for( const Song *pSong : m_pSongs )
+	{
+		for( const Steps *pSteps : pSong->GetAllSteps() )
+		{
+			++out.m_iNumSteps;
+			const bool bResident = pSteps->IsNoteDataResident();
+			if( bResident )
+				++out.m_iNumResident;
+
+			const Steps::CachedNoteData &cached = pSteps->GetCachedNoteData();
+			if( cached.m_iSize == 0 )
+				continue;
+			++out.m_iNumCached;
+			out.m_iCachedBytes += cached.m_iRawSize;
+			if( !bResident )
+				out.m_iBytesSaved += cached.m_iRawSize;
+		}
+	}
+}
+
+namespace
+{
+	/** @brief Hands out song directories to worker threads and collects the results. */
+	class ThreadedSongLoader
+	{
+	public:
+		ThreadedSongLoader( const std::vector<RString> &vSongDirs, std::vector<Song*> &vSongsOut ):
+			m_vSongDirs(vSongDirs), m_vSongsOut(vSongsOut),
+			m_Lock("ThreadedSongLoader"), m_SongFinished("ThreadedSongLoaderFinished"),
+			m_iNextSong(0)
+		{
+			m_vSongsOut.assign( m_vSongDirs.size(), nullptr );
+		}
+
+		void Start( int iThreads )
+		{
+			m_Threads.resize( iThreads );
+			for( int i = 0; i < iThreads; ++i )
+			{
+				m_Threads[i].SetName( ssprintf("SongLoader %i", i) );
+				m_Threads[i].Create( StartWorker, this );
+			}
+		}
+
+		/* Block until one more song has been loaded (or failed to load).
+		 * Returns the index of that song. */
+		std::size_t WaitForSong()
+		{
+			m_SongFinished.Wait( false );
+			LockMut( m_Lock );
+			ASSERT( !m_vFinished.empty() );
+			std::size_t iSong = m_vFinished.front();
+			m_vFinished.pop_front();
+			return iSong;
+		}
+
+		/* Like WaitForSong, but return false instead of blocking if no
+		 * more songs have finished. */
+		bool TryGetSong( std::size_t &iSong )
+		{
+			if( !m_SongFinished.TryWait() )
+				return false;
+			LockMut( m_Lock );
+			ASSERT( !m_vFinished.empty() );
+			iSong = m_vFinished.front();
+			m_vFinished.pop_front();
+			return true;
+		}
+
+		/* Don't start on any more songs.  The ones already being loaded
+		 * are still finished; Finish waits for them. */
+		void Abort()
+		{
+			LockMut( m_Lock );
+			m_iNextSong = m_vSongDirs.size();
+		}
+
+		void Finish()
+		{
+			for( RageThread &thread : m_Threads )
+				thread.Wait();
+			m_Threads.clear();
+		}
+
+	private:
+		static int StartWorker( void *p ) { ((ThreadedSongLoader *) p)->WorkerMain(); return 0; }
+
+		void WorkerMain()
+		{
+			for(;;)
+			{
+				m_Lock.Lock();
+				const std::size_t iSong = m_iNextSong++;
+				m_Lock.Unlock();
+				if( iSong >= m_vSongDirs.size() )
+					return;
+
+				Song* pNewSong = new Song;
+				if( !pNewSong->LoadFromSongDir( m_vSongDirs[iSong] ) )
+				{
+					// The song failed to load.
+					SAFE_DELETE( pNewSong );
+				}
+
+				m_Lock.Lock();
+				m_vSongsOut[iSong] = pNewSong;
+				m_vFinished.push_back( iSong );
+				m_Lock.Unlock();
+				m_SongFinished.Post();
+			}
+		}
+
+		const std::vector<RString> &m_vSongDirs;
+		std::vector<Song*> &m_vSongsOut;
+		std::vector<RageThread> m_Threads;
+		/* Protects everything below. */
+		RageMutex m_Lock;
+		RageSemaphore m_SongFinished;
+		std::size_t m_iNextSong;
+		std::deque<std::size_t> m_vFinished;
+	};
+}
+
+void SongManager::LoadSongsThreaded( const std::vector<std::vector<RString>> &vGroupSongDirs,
+	std::vector<std::vector<Song*>> &vSongsOut, int iThreads,
+	LoadingWindow *ld, bool onlyAdditions )
+{
+	/* These tables are filled in the first time they're used.  Make sure that
+	 * happens here, before the workers race to do it. */
+	RString sDummy;
+	FontCharAliases::ReplaceMarkers( sDummy );
+
+	// Flatten the groups into one list, so threads don't idle at the end of
+	// a small group.
+	std::vector<RString> vSongDirs;
+	std::vector<std::pair<std::size_t,std::size_t>> vSongIndex;
+	for( std::size_t i = 0; i < vGroupSongDirs.size(); ++i )
+	{
+		for( std::size_t j = 0; j < vGroupSongDirs[i].size(); ++j )
+		{
+			// Skip already loaded songs if onlyAdditions is set.
+			if( onlyAdditions )
+			{
+				SongID songID;
+				songID.FromString( vGroupSongDirs[i][j] );
+				if( songID.ToSong() != nullptr )
+					continue;
+			}
+			vSongDirs.push_back( vGroupSongDirs[i][j] );
+			vSongIndex.push_back( std::make_pair(i, j) );
+		}
+	}
+
+	vSongsOut.resize( vGroupSongDirs.size() );
+	for( std::size_t i = 0; i < vGroupSongDirs.size(); ++i )
+		vSongsOut[i].assign( vGroupSongDirs[i].size(), nullptr );
+
+	LOG->Trace( "Loading %i songs on %i threads", (int) vSongDirs.size(), iThreads );
+
+	std::vector<Song*> vLoadedSongs;
+	ThreadedSongLoader loader( vSongDirs, vLoadedSongs );
+	loader.Start( iThreads );
+
+	RageTimer loading_window_last_update_time;
+	for( std::size_t iDone = 0; iDone < vSongDirs.size(); ++iDone )
+	{
+		const std::size_t iSong = loader.WaitForSong();
+		if( ld && loading_window_last_update_time.Ago() > next_loading_window_update )
+		{
+			loading_window_last_update_time.Touch();
+			ld->SetProgress( iDone );
+			ld->SetText( LOADING_SONGS.GetValue() + ssprintf("\n%s\n%s",
+				Basename(Dirname(vSongDirs[iSong])).c_str(),
+				Basename(vSongDirs[iSong]).c_str()) );
+		}
+	}
+	loader.Finish();
+
+	for( std::size_t i = 0; i < vSongDirs.size(); ++i )
+		vSongsOut[vSongIndex[i].first][vSongIndex[i].second] = vLoadedSongs[i];
+}
+
+/** @brief The groups SplitBackgroundGroups left to load in the background. */
+struct SongManager::BackgroundLoad
+{
+	RString m_sDir;
+	/** @brief The groups, in the order they're added. */
+	std::vector<RString> m_vGroupDirs;
+	/** @brief The index in m_vSongDirs just past each group's last song. */
+	std::vector<std::size_t> m_vGroupEnd;
+	std::vector<RString> m_vSongDirs;
+	/** @brief The loaded songs, or nullptr for songs that failed or aren't loaded yet. */
+	std::vector<Song*> m_vSongs;
+	/** @brief Whether each song has finished loading. */
+	std::vector<char> m_vSongDone;
+	/** @brief The next group to add, and the first song not known to be done. */
+	std::size_t m_iNextGroup = 0;
+	std::size_t m_iNextSong = 0;
+	/** @brief The manifest LoadSongDir started, finished as groups are added. */
+	SongDirManifest m_NewManifest;
+	/** @brief Have groups been added since screens were last told? */
+	bool m_bGroupsAdded = false;
+	RageTimer m_LastMessage;
+	std::unique_ptr<ThreadedSongLoader> m_pLoader;
+
+	/** @brief Each group's banner, found and cached by m_BannerThread. */
+	std::vector<RString> m_vGroupBanners;
+	/** @brief How many groups, in order, m_BannerThread has done. */
+	std::atomic<std::size_t> m_iGroupBannersDone{ 0 };
+	std::atomic<bool> m_bStopBanners{ false };
+	RageThread m_BannerThread;
+
+	/* What's left once every group is in, a step at a time. */
+	enum FinishStep
+	{
+		FinishStep_Songs,
+		FinishStep_Courses,
+		FinishStep_AutogenCourses,
+		FinishStep_Unlocks,
+		FinishStep_Sorts,
+		FinishStep_RankingCourses,
+		FinishStep_Images,
+		NUM_FinishStep
+	};
+	int m_iFinishStep = FinishStep_Songs;
+	/** @brief The first song in m_pSongs loaded in the background. */
+	std::size_t m_iFirstSong = 0;
+	/** @brief The next song to preload the banner of. */
+	std::size_t m_iNextImage = 0;
+
+	std::size_t GetGroupBegin( std::size_t iGroup ) const { return iGroup == 0? 0:m_vGroupEnd[iGroup-1]; }
+
+	static int StartBannerThread( void *p ) { ((BackgroundLoad *) p)->BannerThreadMain(); return 0; }
+	void BannerThreadMain()
+	{
+		for( std::size_t i = 0; i < m_vGroupDirs.size() && !m_bStopBanners; ++i )
+		{
+			m_vGroupBanners[i] = FindGroupBanner( m_sDir, m_vGroupDirs[i] );
+			IMAGECACHE->CacheImage( "Banner", m_vGroupBanners[i] );
+			m_iGroupBannersDone.store( i+1, std::memory_order_release );
+		}
+	}
+	void StopBannerThread()
+	{
+		m_bStopBanners = true;
+		if( m_BannerThread.IsCreated() )
+			m_BannerThread.Wait();
+	}
+};
+
+void SongManager::SplitBackgroundGroups( const RString &sDir, std::vector<RString> &vGroupDirs,
+	std::vector<std::vector<RString>> &vGroupSongDirs, int &iSongCount )
+{
+	const int iForegroundGroups = g_iSongLoadForegroundGroups;
+	if( iForegroundGroups <= 0 || (int) vGroupDirs.size() <= iForegroundGroups )
+		return;
+
+	// Load the groups in the preferred sort up front, so it's complete from
+	// the start.
+	std::set<RString> setPreferredGroups;
+	const RString sPreferredSongs = THEME->GetPathO( "SongManager", "PreferredSongs.txt", true );
+	std::vector<RString> asLines;
+	if( !sPreferredSongs.empty() )
+		GetFileContents( sPreferredSongs, asLines );
+	for (RString const &sLine : asLines)
+	{
+		if( BeginsWith(sLine, "---") )
+			continue;
+		// Both "Group/Song" and "Group/*" name the group second to last.
+		std::vector<RString> asParts;
+		split( sLine, "/", asParts );
+		if( asParts.size() >= 2 )
+			setPreferredGroups.insert( asParts[asParts.size()-2].MakeLower() );
+	}
+
+	BackgroundLoad *pLoad = new BackgroundLoad;
+	pLoad->m_sDir = sDir;
+	std::vector<RString> vForegroundGroupDirs;
+	std::vector<std::vector<RString>> vForegroundSongDirs;
+	for( std::size_t i = 0; i < vGroupDirs.size(); ++i )
+	{
+		RString sGroup = vGroupDirs[i];
+		sGroup.MakeLower();
+		if( (int) i < iForegroundGroups || setPreferredGroups.find(sGroup) != setPreferredGroups.end() )
+		{
+			vForegroundGroupDirs.push_back( vGroupDirs[i] );
+			vForegroundSongDirs.push_back( vGroupSongDirs[i] );
+			continue;
+		}
+
+		pLoad->m_vGroupDirs.push_back( vGroupDirs[i] );
+		pLoad->m_vSongDirs.insert( pLoad->m_vSongDirs.end(), vGroupSongDirs[i].begin(), vGroupSongDirs[i].end() );
+		pLoad->m_vGroupEnd.push_back( pLoad->m_vSongDirs.size() );
+		iSongCount -= vGroupSongDirs[i].size();
+	}
+
+	if( pLoad->m_vGroupDirs.empty() )
+	{
+		delete pLoad;
+		return;
+	}
+
+	LOG->Trace( "Loading %i groups now and %i groups (%i songs) in the background",
+		int(vForegroundGroupDirs.size()), int(pLoad->m_vGroupDirs.size()), int(pLoad->m_vSongDirs.size()) );
+	vGroupDirs.swap( vForegroundGroupDirs );
+	vGroupSongDirs.swap( vForegroundSongDirs );
+	m_pBackgroundLoad = pLoad;
+}
+
+void SongManager::StartBackgroundLoad( const SongDirManifest &newManifest )
+{
+	BackgroundLoad &load = *m_pBackgroundLoad;
+	load.m_NewManifest = newManifest;
+	load.m_vSongDone.assign( load.m_vSongDirs.size(), 0 );
+
+	// Leave a CPU for the game when using one thread per CPU.
+	int iThreads = g_iSongLoadThreads;
+	if( iThreads <= 0 )
+		iThreads = (int) std::thread::hardware_concurrency() - 1;
+	iThreads = std::max( 1, std::min(iThreads, (int) load.m_vSongDirs.size()) );
+
+	// See LoadSongsThreaded.
+	RString sDummy;
+	FontCharAliases::ReplaceMarkers( sDummy );
+
+	LOG->Trace( "Loading %i songs in the background on %i threads", (int) load.m_vSongDirs.size(), iThreads );
+	load.m_pLoader.reset( new ThreadedSongLoader(load.m_vSongDirs, load.m_vSongs) );
+	load.m_pLoader->Start( iThreads );
+
+	// Group banners are read and cached on a thread of their own, so adding
+	// a group doesn't touch the disk.
+	load.m_iFirstSong = m_pSongs.size();
+	load.m_vGroupBanners.resize( load.m_vGroupDirs.size() );
+	load.m_BannerThread.SetName( "SongLoader banners" );
+	load.m_BannerThread.Create( BackgroundLoad::StartBannerThread, &load );
+}
+
+int SongManager::AddBackgroundGroups( bool bWait )
+{
+	BackgroundLoad &load = *m_pBackgroundLoad;
+	int iAdded = 0;
+	while( load.m_iNextGroup < load.m_vGroupDirs.size() )
+	{
+		std::size_t iSong;
+		while( load.m_pLoader->TryGetSong(iSong) )
+			load.m_vSongDone[iSong] = 1;
+
+		// Groups are added in order, once all of their songs and their
+		// banner are done.
+		const std::size_t iGroupEnd = load.m_vGroupEnd[load.m_iNextGroup];
+		while( load.m_iNextSong < iGroupEnd && load.m_vSongDone[load.m_iNextSong] )
+			++load.m_iNextSong;
+		if( load.m_iNextSong < iGroupEnd )
+		{
+			if( !bWait )
+				break;
+			load.m_vSongDone[load.m_pLoader->WaitForSong()] = 1;
+			continue;
+		}
+		if( load.m_iNextGroup >= load.m_iGroupBannersDone.load(std::memory_order_acquire) )
+		{
+			if( !bWait )
+				break;
+			load.m_BannerThread.Wait();
+			continue;
+		}
+
+		AddBackgroundGroup( load.m_iNextGroup );
+		++load.m_iNextGroup;
+		++iAdded;
+	}
+	return iAdded;
+}
+
+void SongManager::AddBackgroundGroup( std::size_t iGroup )
+{
+	BackgroundLoad &load = *m_pBackgroundLoad;
+	const RString &sGroupDirName = load.m_vGroupDirs[iGroup];
+	SongPointerVector& index_entry = m_mapSongGroupIndex[sGroupDirName];
+	int loaded = 0;
+	for( std::size_t i = load.GetGroupBegin(iGroup); i < load.m_vGroupEnd[iGroup]; ++i )
+	{
+		Song *pSong = load.m_vSongs[i];
+		if( pSong == nullptr )
+			continue;
+		AddSongToList( pSong );
+		if( SongDirManifest::IsEnabled() )
+			load.m_NewManifest.SetSong( *pSong );
+		index_entry.push_back( pSong );
+		loaded++;
+	}
+
+	LOG->Trace( "Loaded %i songs from \"%s\" in the background", loaded, (load.m_sDir+sGroupDirName).c_str() );
+	if( !loaded )
+		return;
+	AddLoadedGroup( load.m_sDir, sGroupDirName, load.m_vGroupBanners[iGroup] );
+
+	// AddGroup appends the group; move it to where it would have been had
+	// every group been loaded at once.
+	if( m_sSongGroupNames.back() != sGroupDirName )
+		return;
+	const std::size_t iPos = std::upper_bound( m_sSongGroupNames.begin(), m_sSongGroupNames.end()-1,
+		sGroupDirName, CompareRStringsAsc ) - m_sSongGroupNames.begin();
+	std::rotate( m_sSongGroupNames.begin()+iPos, m_sSongGroupNames.end()-1, m_sSongGroupNames.end() );
+	std::rotate( m_sSongGroupBannerPaths.begin()+iPos, m_sSongGroupBannerPaths.end()-1, m_sSongGroupBannerPaths.end() );
+}
+
+/* Songs in the background groups can be referred to by anything that was
+ * set up at startup, so once they're all in, that's redone.  None of it can
+ * be done while a course or a song list is in use, so it waits for a menu or
+ * attract screen, and only one step is done each frame. */
+bool SongManager::DoBackgroundFinishStep( bool bForce )
+{
+	BackgroundLoad &load = *m_pBackgroundLoad;
+	if( !bForce )
+	{
+		const Screen *pScreen = SCREENMAN->GetTopScreen();
+		if( pScreen == nullptr || (pScreen->GetScreenType() != game_menu && pScreen->GetScreenType() != attract) )
+			return false;
+	}
+	const Course *pCurCourse = GAMESTATE->m_pCurCourse;
+
+	switch( load.m_iFinishStep )
+	{
+	case BackgroundLoad::FinishStep_Songs:
+		load.m_pLoader->Finish();
+		load.m_pLoader.reset();
+		load.StopBannerThread();
+		if( SongDirManifest::IsEnabled() )
+		{
+			m_SongDirManifest = load.m_NewManifest;
+			m_SongDirManifest.SaveToDisk();
+		}
+		SaveDelayedCaches();
+		LOG->Trace( "Finished loading songs in the background; %d songs in all.", (int)m_pSongs.size() );
+		LoadProfiler::End();
+		break;
+
+	case BackgroundLoad::FinishStep_Courses:
+		// Courses were loaded without the songs that weren't in yet.  Reload
+		// the ones missing songs, and add the ones hidden for it.  The
+		// selected course keeps its trails; it's picked up by the next full
+		// reload.
+		for( Course *pCourse : m_pCourses )
+		{
+			if( pCourse == pCurCourse || pCourse->m_bIsAutogen )
+				continue;
+			if( pCourse->m_bIncomplete )
+				pCourse->RevertFromDisk();
+			else
+				pCourse->InvalidateTrailCache();
+		}
+		InitCoursesFromDisk( nullptr, true );
+		break;
+
+	case BackgroundLoad::FinishStep_AutogenCourses:
+		if( !bForce && pCurCourse != nullptr && pCurCourse->m_bIsAutogen )
+			return false;
+		DeleteAutogenCourses();
+		InitAutogenCourses();
+		break;
+
+	case BackgroundLoad::FinishStep_Unlocks:
+		UNLOCKMAN->Reload();
+		break;
+
+	case BackgroundLoad::FinishStep_Sorts:
+		UpdatePopular();
+		UpdateShuffled();
+		UpdatePreferredSort();
+		break;
+
+	case BackgroundLoad::FinishStep_RankingCourses:
+		UpdateRankingCourses();
+		break;
+
+	case BackgroundLoad::FinishStep_Images:
+		if( PREFSMAN->m_ImageCache == IMGCACHE_FULL )
+		{
+			// Startup preloaded the banners of the songs it had.
+			load.m_iNextImage = std::max( load.m_iNextImage, load.m_iFirstSong );
+			const std::size_t iEnd = bForce? m_pSongs.size() :
+				std::min( m_pSongs.size(), load.m_iNextImage + BACKGROUND_LOAD_IMAGES_PER_FRAME );
+			for( ; load.m_iNextImage < iEnd; ++load.m_iNextImage )
+			{
+				const Song *pSong = m_pSongs[load.m_iNextImage];
+				if( pSong->HasBanner() )
+					m_TexturePreload.Load( Sprite::SongBannerTexture(pSong->GetBannerPath()) );
+			}
+			if( load.m_iNextImage < m_pSongs.size() )
+				return false;
+		}
+		break;
+	}
+
+	if( ++load.m_iFinishStep < BackgroundLoad::NUM_FinishStep )
+		return false;
+	SAFE_DELETE( m_pBackgroundLoad );
+	return true;
+}
+
+void SongManager::FinishBackgroundLoad()
+{
+	if( m_pBackgroundLoad == nullptr )
+		return;
+	AddBackgroundGroups( true );
+	LoadEnabledSongsFromPref();
+	while( !DoBackgroundFinishStep(true) )
+		;
+}
+
+void SongManager::CancelBackgroundLoad()
+{
+	if( m_pBackgroundLoad == nullptr )
+		return;
+	BackgroundLoad &load = *m_pBackgroundLoad;
+	if( load.m_pLoader != nullptr )
+	{
+		load.m_pLoader->Abort();
+		load.m_pLoader->Finish();
+	}
+	load.StopBannerThread();
+
+	// Songs in groups that were already added are freed with the rest.
+	for( std::size_t i = load.GetGroupBegin(load.m_iNextGroup); i < load.m_vSongs.size(); ++i )
+		delete load.m_vSongs[i];
+	SAFE_DELETE( m_pBackgroundLoad );
+	SaveDelayedCaches();
+}
+
+void SongManager::Update()
+{
+	if( m_pBackgroundLoad == nullptr )
+		return;
+
+	BackgroundLoad &load = *m_pBackgroundLoad;
+	const bool bSongsDone = load.m_iNextGroup == load.m_vGroupDirs.size();
+	if( !bSongsDone && AddBackgroundGroups(false) > 0 )
+	{
+		LoadEnabledSongsFromPref();
+		load.m_bGroupsAdded = true;
+	}
+
+	const bool bFinished = bSongsDone && DoBackgroundFinishStep( false );
+	if( !bFinished )
+	{
+		// Don't make screens rebuild their song lists after every group,
+		// but tell them as soon as the last group is in.
+		if( !load.m_bGroupsAdded || (!bSongsDone && load.m_LastMessage.Ago() < BACKGROUND_LOAD_MESSAGE_SECONDS) )
+			return;
+		load.m_bGroupsAdded = false;
+		load.m_LastMessage.Touch();
+	}
+
+	Message msg( MessageIDToString(Message_SongGroupsLoaded) );
+	msg.SetParam( "Finished", bFinished );
+	MESSAGEMAN->Broadcast( msg );
+}
+
 // Instead of "symlinks", songs should have membership in multiple groups. -Chris
 void SongManager::LoadGroupSymLinks(RString sDir, RString sGroupFolder)
 {
@@ -546,6 +1270,8 @@ void SongManager::PreloadSongImages()
 
 void SongManager::FreeSongs()
 {
+	CancelBackgroundLoad();
+
 	m_sSongGroupNames.clear();
 	m_sSongGroupBannerPaths.clear();
 	//m_sSongGroupBackgroundPaths.clear();
@@ -1203,6 +1929,9 @@ void SongManager::InvalidateCachedTrails()
  * change screens. */
 void SongManager::Cleanup()
 {
+	ChartHashCache::WriteToDisk();
+	AudioMetadataCache::WriteToDisk();
+
 	for (Song *pSong : m_pShuffledSongs)
 	{
 		if (pSong)
@@ -2267,6 +2996,7 @@ public:
 	DEFINE_METHOD( GetCourseGroupBannerPath, GetCourseGroupBannerPath(SArg(1)) );
 	DEFINE_METHOD( DoesSongGroupExist, DoesSongGroupExist(SArg(1)) );
 	DEFINE_METHOD( DoesCourseGroupExist, DoesCourseGroupExist(SArg(1)) );
+	DEFINE_METHOD( IsLoadingSongsInBackground, IsLoadingSongsInBackground() );
 
 	static int GetPopularSongs( T* p, lua_State *L )
 	{
@@ -2295,6 +3025,24 @@ public:
 		return 1;
 	}
 
+	static int GetNoteDataStats( T* p, lua_State *L )
+	{
+		SongManager::NoteDataStats stats;
+		p->GetNoteDataStats( stats );
+		lua_newtable( L );
+		lua_pushinteger( L, stats.m_iNumSteps );
+		lua_setfield( L, -2, "NumSteps" );
+		lua_pushinteger( L, stats.m_iNumResident );
+		lua_setfield( L, -2, "NumResident" );
+		lua_pushinteger( L, stats.m_iNumCached );
+		lua_setfield( L, -2, "NumCached" );
+		lua_pushnumber( L, double(stats.m_iCachedBytes) );
+		lua_setfield( L, -2, "CachedBytes" );
+		lua_pushnumber( L, double(stats.m_iBytesSaved) );
+		lua_setfield( L, -2, "BytesSaved" );
+		return 1;
+	}
+
 	static int WasLoadedFromAdditionalSongs( T* p, lua_State *L )	{ lua_pushboolean(L, false); return 1; }	// deprecated
 	static int WasLoadedFromAdditionalCourses( T* p, lua_State *L )	{ lua_pushboolean(L, false); return 1; }	// deprecated
 
@@ -2338,6 +3086,8 @@ public:
 		ADD_METHOD( GetPopularCourses );
 		ADD_METHOD( SongToPreferredSortSectionName );
 		ADD_METHOD( GetPreferredSortSongsBySectionName );
+		ADD_METHOD( GetNoteDataStats );
+		ADD_METHOD( IsLoadingSongsInBackground );
 		ADD_METHOD( WasLoadedFromAdditionalSongs );	// deprecated
 		ADD_METHOD( WasLoadedFromAdditionalCourses );	// deprecated
 	}
@@ -18,8 +18,10 @@ struct lua_State;
 #include "ThemeMetric.h"
 #include "RageTexturePreloader.h"
 #include "RageUtil.h"
+#include "SongDirManifest.h"
 
 #include <cstddef>
+#include <cstdint>
 #include <vector>
 
 
@@ -51,6 +53,29 @@ public:
 	void Cleanup();
 
 	void Invalidate( const Song *pStaleSong );
+	/**
+	 * @brief Has this song directory changed since the last scan?
+	 *
+	 * Safe to call from the song loading threads.
+	 * @param sSongDir the song directory, with a trailing slash.
+	 * @return true if its directory, simfile and music are all unchanged. */
+	bool IsSongDirUnchanged( const RString &sSongDir ) const;
+
+	/** @brief How much note data is in memory, and how much is left in the song cache. */
+	struct NoteDataStats
+	{
+		/** @brief The number of Steps in all songs. */
+		int m_iNumSteps;
+		/** @brief The number of Steps with note data in memory. */
+		int m_iNumResident;
+		/** @brief The number of Steps whose note data can be read from the song cache. */
+		int m_iNumCached;
+		/** @brief The size of the note data in the song cache, as SMData. */
+		std::uint64_t m_iCachedBytes;
+		/** @brief How much of that isn't in memory. */
+		std::uint64_t m_iBytesSaved;
+	};
+	void GetNoteDataStats( NoteDataStats &out ) const;
 
 	void RegenerateNonFixedCourses();
 	void SetPreferences();
@@ -88,6 +113,17 @@ public:
 	 *        last invocation of this function
 	 */
 	void InitAll( LoadingWindow *ld, bool onlyAdditions );
+	/**
+	 * @brief Add the song groups that have finished loading in the background.
+	 *
+	 * This is called once a frame.  Message_SongGroupsLoaded is broadcast
+	 * when groups have been added.  Once the last group is in, this redoes
+	 * what startup did with only some of the songs loaded: courses,
+	 * unlocks, and the popular and preferred sorts.  That's done a step
+	 * each frame, and only on menu and attract screens. */
+	void Update();
+	/** @brief Are song groups still being loaded in the background? */
+	bool IsLoadingSongsInBackground() const { return m_pBackgroundLoad != nullptr; }
 	void Reload( bool bAllowFastLoad, LoadingWindow *ld=nullptr );
 	void LoadAdditions( LoadingWindow *ld=nullptr );
 	void PreloadSongImages();
@@ -210,9 +246,56 @@ protected:
 	 *        invocation of this function
 	 */
 	void LoadSongDir( RString sDir, LoadingWindow *ld, bool onlyAdditions );
+	/**
+	 * @brief Load songs on worker threads, ahead of LoadSongDir adding them
+	 * @param vGroupSongDirs the song directories of each group, in load order
+	 * @param vSongsOut filled with the loaded Song for each directory, or
+	 *        nullptr if it was skipped or failed to load
+	 * @param iThreads the number of worker threads to use
+	 * @param ld the loading window to be updated, or nullptr
+	 * @param onlyAdditions skip songs that are already loaded
+	 */
+	void LoadSongsThreaded( const std::vector<std::vector<RString>> &vGroupSongDirs,
+		std::vector<std::vector<Song*>> &vSongsOut, int iThreads,
+		LoadingWindow *ld, bool onlyAdditions );
+	/**
+	 * @brief Take out the groups to be loaded in the background
+	 *
+	 * Only the first SongLoadForegroundGroups groups, and those with songs
+	 * in the preferred sort, are left to load now.
+	 * @param sDir the directory the groups are in
+	 * @param vGroupDirs the groups, in load order
+	 * @param vGroupSongDirs the song directories of each group
+	 * @param iSongCount the number of songs in all of the groups
+	 */
+	void SplitBackgroundGroups( const RString &sDir, std::vector<RString> &vGroupDirs,
+		std::vector<std::vector<RString>> &vGroupSongDirs, int &iSongCount );
+	/** @brief Start loading the groups SplitBackgroundGroups took out. */
+	void StartBackgroundLoad( const SongDirManifest &newManifest );
+	/**
+	 * @brief Add the background groups whose songs are all loaded, in order
+	 * @param bWait wait for every group to finish loading
+	 * @return the number of groups added
+	 */
+	int AddBackgroundGroups( bool bWait );
+	void AddBackgroundGroup( std::size_t iGroup );
+	/** @brief Wait for every background group, add them, and finish up. */
+	void FinishBackgroundLoad();
+	/**
+	 * @brief Do the next step of finishing up once every background group is in.
+	 * @param bForce don't wait for steps that can't be done on this screen
+	 * @return true once every step is done, and the background load is freed
+	 */
+	bool DoBackgroundFinishStep( bool bForce );
+	/** @brief Stop loading in the background, throwing away groups not yet added. */
+	void CancelBackgroundLoad();
 	bool GetExtraStageInfoFromCourse( bool bExtra2, RString sPreferredGroup, Song*& pSongOut, Steps*& pStepsOut, StepsType stype );
 	void SanityCheckGroupDir( RString sDir ) const;
-	void AddGroup( RString sDir, RString sGroupDirName );
+	void AddGroup( const RString &sGroupDirName, const RString &sBannerPath );
+	/** @brief Add a group whose songs have been added, with its banner and symlinks. */
+	void AddLoadedGroup( const RString &sDir, const RString &sGroupDirName );
+	/** @brief Like AddLoadedGroup, with a banner that's already been found and cached. */
+	void AddLoadedGroup( const RString &sDir, const RString &sGroupDirName, const RString &sBannerPath );
 	int GetNumEditsLoadedFromProfile( ProfileSlot slot ) const;
 
 	void AddSongToList(Song* new_song);
@@ -220,6 +303,12 @@ protected:
 	std::vector<Song*>		m_pSongs;
 	std::map<RString, Song*> m_SongsByDir;
 	std::set<RString> m_GroupsToNeverCache;
+	/** @brief The Songs folder as of the last scan, used to skip unchanged directories. */
+	SongDirManifest m_SongDirManifest;
+	bool m_bSongDirManifestLoaded;
+	struct BackgroundLoad;
+	/** @brief The groups still loading in the background, if any. */
+	BackgroundLoad *m_pBackgroundLoad;
 
 	/** @brief Hold pointers to all the songs that have been deleted from disk but must at least be kept temporarily alive for smooth audio transitions. */
 	std::vector<Song*>	m_pDeletedSongs;
@@ -13,7 +13,7 @@ void SongPosition::UpdateSongPosition( float fPositionSeconds, const TimingData
 
 	TimingData::GetBeatArgs beat_info;
 	beat_info.elapsed_time= fPositionSeconds;
-	timing.GetBeatAndBPSFromElapsedTime(beat_info);
+	m_BeatCursor.GetBeatAndBPSFromElapsedTime(timing, beat_info);
 	m_fSongBeat= beat_info.beat;
 	m_fCurBPS= beat_info.bps_out;
 	m_bFreeze= beat_info.freeze_out;
@@ -27,13 +27,13 @@ void SongPosition::UpdateSongPosition( float fPositionSeconds, const TimingData
 
 	m_fMusicSeconds = fPositionSeconds;
 
-	m_fLightSongBeat = timing.GetBeatFromElapsedTime( fPositionSeconds + g_fLightsAheadSeconds );
+	m_fLightSongBeat = m_LightBeatCursor.GetBeatFromElapsedTime( timing, fPositionSeconds + g_fLightsAheadSeconds );
 
-	m_fSongBeatNoOffset = timing.GetBeatFromElapsedTimeNoOffset( fPositionSeconds );
+	m_fSongBeatNoOffset = m_NoOffsetBeatCursor.GetBeatFromElapsedTimeNoOffset( timing, fPositionSeconds );
 	
 	m_fMusicSecondsVisible = fPositionSeconds - g_fVisualDelaySeconds.Get() - fAdditionalVisualDelay;
 	beat_info.elapsed_time= m_fMusicSecondsVisible;
-	timing.GetBeatAndBPSFromElapsedTime(beat_info);
+	m_VisibleBeatCursor.GetBeatAndBPSFromElapsedTime(timing, beat_info);
 	m_fSongBeatVisible= beat_info.beat;
 }
 
@@ -33,6 +33,13 @@ public:
 	float		m_fMusicSecondsVisible;
 	float		m_fSongBeatVisible;
 
+	// The position only moves forward while playing, so each beat is found
+	// with its own cursor.
+	TimingData::BeatCursor m_BeatCursor;
+	TimingData::BeatCursor m_LightBeatCursor;
+	TimingData::BeatCursor m_NoOffsetBeatCursor;
+	TimingData::BeatCursor m_VisibleBeatCursor;
+
 	void Reset();
 	void UpdateSongPosition( float fPositionSeconds, const TimingData &timing, const RageTimer &timestamp = RageZeroTimer, float fAdditionalVisualDelay = 0.0f );
 
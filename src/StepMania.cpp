@@ -64,6 +64,7 @@
 #include "MessageManager.h"
 #include "StatsManager.h"
 #include "GameLoop.h"
+#include "GameplayBenchmark.h"
 #include "SpecialFiles.h"
 #include "Profile.h"
 #include "ActorUtil.h"
@@ -246,7 +247,10 @@ static void StartDisplay()
 	else
 	{
 		// Initialise DISPLAY2 (The new / deferred mechanism)
-		DISPLAY2 = CreateDisplay2();
+		// The benchmark is meant to run without a window or a GPU, so it only
+		// gets the null display below.
+		if( !GameplayBenchmark::IsRunning() )
+			DISPLAY2 = CreateDisplay2();
 		// TODO: But also a placeholder for DISPLAY
 		// Primarily this is used for RageDisplay::PushMatrix and friends,
 		// which actually just accesses g_ProjectionStack and similar.
@@ -1105,7 +1109,9 @@ int sm_main(int argc, char* argv[])
 
 	StartDisplay();
 
-	StoreActualGraphicOptions();
+	// The null display's options aren't worth keeping.
+	if( !GameplayBenchmark::IsRunning() )
+		StoreActualGraphicOptions();
 	LOG->Info( "%s", GetActualGraphicOptionsString().c_str() );
 
 	SONGMAN->PreloadSongImages();
@@ -1123,7 +1129,10 @@ int sm_main(int argc, char* argv[])
 	/* Now that GAMESTATE is reset, tell SCREENMAN to update the theme (load
 	 * overlay screens and global sounds), and load the initial screen. */
 	SCREENMAN->ThemeChanged();
-	SCREENMAN->SetNewScreen( StepMania::GetInitialScreen() );
+	if( GameplayBenchmark::IsRunning() )
+		GameplayBenchmark::Start();
+	else
+		SCREENMAN->SetNewScreen( StepMania::GetInitialScreen() );
 
 	// Do this after ThemeChanged so that we can show a system message
 	RString sMessage;
@@ -1135,6 +1144,8 @@ int sm_main(int argc, char* argv[])
 	// Run the main loop.
 	GameLoop::RunGameLoop();
 
+	GameplayBenchmark::End();
+
 	PREFSMAN->SavePrefsToDisk();
 
 	ShutdownGame();
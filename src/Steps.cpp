@@ -13,6 +13,7 @@
  * memory. */
 #include "global.h"
 #include "Steps.h"
+#include "ChartHashCache.h"
 #include "StepsUtil.h"
 #include "GameState.h"
 #include "Song.h"
@@ -22,15 +23,20 @@
 #include "GameManager.h"
 #include "SongManager.h"
 #include "NoteDataUtil.h"
+#include "ChartStats.h"
 #include "NotesLoaderSSC.h"
 #include "NotesLoaderSM.h"
 #include "NotesLoaderSMA.h"
 #include "NotesLoaderDWI.h"
 #include "NotesLoaderKSF.h"
 #include "NotesLoaderBMS.h"
+#include "Preference.h"
+#include "RageThreads.h"
+#include "SongCacheBinary.h"
 
 #include <algorithm>
 #include <cstddef>
+#include <cstdint>
 #include <vector>
 
 /* register DisplayBPM with StringConversion */
@@ -55,11 +61,90 @@ Steps::Steps(Song *song): m_StepsType(StepsType_Invalid), m_pSong(song),
 	m_sDescription(""), m_sChartStyle(""),
 	m_Difficulty(Difficulty_Invalid), m_iMeter(0),
 	m_bAreCachedRadarValuesJustLoaded(false),
+	m_fCachedPeakNPS(), m_bAreCachedNotesPerMeasureJustLoaded(false),
 	m_sCredit(""), displayBPMType(DISPLAY_BPM_ACTUAL),
 	specifiedBPMMin(0), specifiedBPMMax(0) {}
 
+/* NoteData loaded on demand stays in memory until the Steps are compressed,
+ * which normally happens when the screen changes.  Browsing through a large
+ * library can load a lot of it before then, so of the NoteData read from the
+ * binary song cache, only keep the most recently loaded; older Steps are
+ * compressed again and read their data back from the cache the next time
+ * it's used.  NoteData parsed from a simfile is never evicted, since parsing
+ * it again would cost far more than keeping it.  0 means no limit. */
+static Preference<int> g_iMaxResidentNoteData( "MaxResidentNoteData", 64 );
+
+namespace
+{
+	struct ResidentNoteData
+	{
+		const Steps *m_pSteps;
+		std::uint64_t m_iThreadID;
+	};
+	/* Oldest first.  Each thread only evicts the entries it added: song
+	 * loading threads use the NoteData of their own songs, and compress all
+	 * of it when each song is finished. */
+	std::vector<ResidentNoteData> g_vResidentNoteData;
+	RageMutex g_ResidentNoteDataLock( "ResidentNoteData" );
+}
+
+static void ForgetResidentNoteData( const Steps *pSteps )
+{
+	LockMut( g_ResidentNoteDataLock );
+	for( std::size_t i = 0; i < g_vResidentNoteData.size(); ++i )
+	{
+		if( g_vResidentNoteData[i].m_pSteps == pSteps )
+		{
+			g_vResidentNoteData.erase( g_vResidentNoteData.begin() + i );
+			return;
+		}
+	}
+}
+
+void Steps::TouchResidentNoteData() const
+{
+	const int iLimit = g_iMaxResidentNoteData;
+	const std::uint64_t iThreadID = RageThread::GetCurrentThreadID();
+	std::vector<const Steps *> vpEvict;
+	{
+		LockMut( g_ResidentNoteDataLock );
+		for( std::size_t i = 0; i < g_vResidentNoteData.size(); ++i )
+		{
+			if( g_vResidentNoteData[i].m_pSteps == this )
+			{
+				g_vResidentNoteData.erase( g_vResidentNoteData.begin() + i );
+				break;
+			}
+		}
+		ResidentNoteData entry = { this, iThreadID };
+		g_vResidentNoteData.push_back( entry );
+		if( iLimit <= 0 )
+			return;
+
+		int iOwned = 0;
+		for( ResidentNoteData const &e : g_vResidentNoteData )
+			if( e.m_iThreadID == iThreadID )
+				++iOwned;
+		for( std::size_t i = 0; i < g_vResidentNoteData.size() && iOwned > iLimit; )
+		{
+			if( g_vResidentNoteData[i].m_iThreadID != iThreadID )
+			{
+				++i;
+				continue;
+			}
+			vpEvict.push_back( g_vResidentNoteData[i].m_pSteps );
+			g_vResidentNoteData.erase( g_vResidentNoteData.begin() + i );
+			--iOwned;
+		}
+	}
+
+	for( const Steps *pSteps : vpEvict )
+		pSteps->Compress();
+}
+
 Steps::~Steps()
 {
+	ForgetResidentNoteData( this );
 }
 
 void Steps::GetDisplayBpms( DisplayBpms &AddTo ) const
@@ -91,6 +176,10 @@ unsigned Steps::GetHash() const
 		return m_iHash;
 	if( m_sNoteDataCompressed.empty() )
 	{
+		// The song cache hashed the SMData as it was loaded, which may not
+		// match SMData made again from the NoteData.
+		if( m_CachedNoteData.m_iHash != 0 )
+			return m_CachedNoteData.m_iHash;
 		if( !m_bNoteDataIsFilled )
 			return 0; // No data, no hash.
 		NoteDataUtil::GetSMNoteDataString( *m_pNoteData, m_sNoteDataCompressed );
@@ -179,11 +268,14 @@ void Steps::SetNoteData( const NoteData& noteDataNew )
 
 	DeAutogen( false );
 
+	// This data can't be reloaded from disk, so it mustn't be evicted.
+	ForgetResidentNoteData( this );
 	*m_pNoteData = noteDataNew;
 	m_bNoteDataIsFilled = true;
 
 	m_sNoteDataCompressed = RString();
 	m_iHash = 0;
+	m_CachedNoteData.m_iHash = 0;
 }
 
 void Steps::GetNoteData( NoteData& noteDataOut ) const
@@ -208,13 +300,18 @@ NoteData Steps::GetNoteData() const
 	return tmp;
 }
 
-void Steps::SetSMNoteData( const RString &notes_comp_ )
+void Steps::SetSMNoteData( std::string_view notes_comp_ )
 {
+	ForgetResidentNoteData( this );
 	m_pNoteData->Init();
 	m_bNoteDataIsFilled = false;
 
-	m_sNoteDataCompressed = notes_comp_;
-	m_iHash = 0;
+	m_sNoteDataCompressed.assign( notes_comp_.data(), notes_comp_.size() );
+	/* Hash it while it's here; the chart hash cache needs the hash to tell
+	 * charts apart, and the data is usually compressed away right after
+	 * loading. */
+	m_iHash = m_sNoteDataCompressed.empty()? 0 : GetHashForString( m_sNoteDataCompressed );
+	m_CachedNoteData.m_iHash = 0;
 }
 
 /* XXX: this function should pull data from m_sFilename, like Decompress() */
@@ -301,11 +398,14 @@ void Steps::CalculateRadarValues( float fMusicLengthSeconds )
 	if( parent != nullptr )
 		return;
 
-	if( m_bAreCachedRadarValuesJustLoaded )
-	{
-		m_bAreCachedRadarValuesJustLoaded = false;
+	// Caches from before the measures were counted only have the radar
+	// values, so work everything out again for those.
+	const bool bCachedValuesJustLoaded = m_bAreCachedRadarValuesJustLoaded &&
+		m_bAreCachedNotesPerMeasureJustLoaded;
+	m_bAreCachedRadarValuesJustLoaded = false;
+	m_bAreCachedNotesPerMeasureJustLoaded = false;
+	if( bCachedValuesJustLoaded )
 		return;
-	}
 
 	// Do write radar values, and leave it up to the reading app whether they want to trust
 	// the cached values without recalculating them.
@@ -315,20 +415,35 @@ void Steps::CalculateRadarValues( float fMusicLengthSeconds )
 		return;
 	*/
 
+	ChartStats stats[NUM_PLAYERS];
+	CalculateChartStats( fMusicLengthSeconds, stats );
+	FOREACH_PlayerNumber( pn )
+	{
+		m_CachedRadarValues[pn] = stats[pn].m_Radar;
+		m_CachedNotesPerMeasure[pn].assign( stats[pn].m_vNotesPerMeasure.begin(), stats[pn].m_vNotesPerMeasure.end() );
+		m_fCachedPeakNPS[pn] = stats[pn].m_fPeakNPS;
+	}
+}
+
+void Steps::CalculateChartStats( float fMusicLengthSeconds, ChartStats out[NUM_PLAYERS] ) const
+{
 	NoteData tempNoteData;
 	this->GetNoteData( tempNoteData );
 
 	FOREACH_PlayerNumber( pn )
-		m_CachedRadarValues[pn].Zero();
+		out[pn].Zero();
 
-	GAMESTATE->SetProcessedTimingData(this->GetTimingData());
+	// Themes can call this from Lua in the middle of gameplay, so put back
+	// whatever timing data was being processed.
+	TimingData *pOldTiming = GAMESTATE->GetProcessedTimingData();
+	GAMESTATE->SetProcessedTimingData(const_cast<TimingData *>(this->GetTimingData()));
 	if( tempNoteData.IsComposite() )
 	{
 		std::vector<NoteData> vParts;
 
 		NoteDataUtil::SplitCompositeNoteData( tempNoteData, vParts );
 		for( std::size_t pn = 0; pn < std::min(vParts.size(), std::size_t(NUM_PLAYERS)); ++pn )
-			NoteDataUtil::CalculateRadarValues( vParts[pn], fMusicLengthSeconds, m_CachedRadarValues[pn] );
+			NoteDataUtil::CalculateChartStats( vParts[pn], fMusicLengthSeconds, out[pn] );
 	}
 	else if (GAMEMAN->GetStepsTypeInfo(this->m_StepsType).m_StepsTypeCategory == StepsTypeCategory_Couple)
 	{
@@ -336,22 +451,22 @@ void Steps::CalculateRadarValues( float fMusicLengthSeconds )
 		// XXX: Assumption that couple will always have an even number of notes.
 		const int tracks = tempNoteData.GetNumTracks() / 2;
 		p1.SetNumTracks(tracks);
-		NoteDataUtil::CalculateRadarValues(p1,
+		NoteDataUtil::CalculateChartStats(p1,
 										   fMusicLengthSeconds,
-										   m_CachedRadarValues[PLAYER_1]);
+										   out[PLAYER_1]);
 		// at this point, p2 is tempNoteData.
 		NoteDataUtil::ShiftTracks(tempNoteData, tracks);
 		tempNoteData.SetNumTracks(tracks);
-		NoteDataUtil::CalculateRadarValues(tempNoteData,
+		NoteDataUtil::CalculateChartStats(tempNoteData,
 										   fMusicLengthSeconds,
-										   m_CachedRadarValues[PLAYER_2]);
+										   out[PLAYER_2]);
 	}
 	else
 	{
-		NoteDataUtil::CalculateRadarValues( tempNoteData, fMusicLengthSeconds, m_CachedRadarValues[0] );
-		std::fill_n( m_CachedRadarValues + 1, NUM_PLAYERS-1, m_CachedRadarValues[0] );
+		NoteDataUtil::CalculateChartStats( tempNoteData, fMusicLengthSeconds, out[0] );
+		std::fill_n( out + 1, NUM_PLAYERS-1, out[0] );
 	}
-	GAMESTATE->SetProcessedTimingData(nullptr);
+	GAMESTATE->SetProcessedTimingData(pOldTiming);
 }
 
 void Steps::ChangeFilenamesForCustomSong()
@@ -417,17 +532,23 @@ void Steps::Decompress()
 		return;
 	}
 
+	bool bLoadedFromCache = false;
 	if( !m_sFilename.empty() && m_sNoteDataCompressed.empty() )
 	{
-		// We have NoteData on disk and not in memory. Load it.
-		if (!this->GetNoteDataFromSimfile())
+		// We have NoteData on disk and not in memory. Load it, from the song
+		// cache if it's there; that's much cheaper than parsing the simfile.
+		bLoadedFromCache = SongCacheBinary::LoadNoteData(*this, m_sNoteDataCompressed);
+		if( !bLoadedFromCache )
 		{
-			LOG->Warn("Couldn't load the %s chart's NoteData from \"%s\"",
-					  DifficultyToString(m_Difficulty).c_str(), m_sFilename.c_str());
-			return;
-		}
+			if (!this->GetNoteDataFromSimfile())
+			{
+				LOG->Warn("Couldn't load the %s chart's NoteData from \"%s\"",
+						  DifficultyToString(m_Difficulty).c_str(), m_sFilename.c_str());
+				return;
+			}
 
-		this->GetSMNoteData( m_sNoteDataCompressed );
+			this->GetSMNoteData( m_sNoteDataCompressed );
+		}
 	}
 
 	if( m_sNoteDataCompressed.empty() )
@@ -442,11 +563,20 @@ void Steps::Decompress()
 		m_pNoteData->SetNumTracks( GAMEMAN->GetStepsTypeInfo(m_StepsType).iNumTracks );
 
 		NoteDataUtil::LoadFromSMNoteDataString( *m_pNoteData, m_sNoteDataCompressed, bComposite );
+
+		if( bLoadedFromCache )
+		{
+			// Don't keep the SMData too; it can be read from the cache again.
+			m_sNoteDataCompressed = RString();
+			TouchResidentNoteData();
+		}
 	}
 }
 
 void Steps::Compress() const
 {
+	ForgetResidentNoteData( this );
+
 	// Always leave lights data uncompressed.
 	if( this->m_StepsType == StepsType_lights_cabinet && m_bNoteDataIsFilled )
 	{
@@ -503,6 +633,8 @@ void Steps::DeAutogen( bool bCopyNoteData )
 	m_Difficulty		= Real()->m_Difficulty;
 	m_iMeter		= Real()->m_iMeter;
 	std::copy( Real()->m_CachedRadarValues, Real()->m_CachedRadarValues + NUM_PLAYERS, m_CachedRadarValues );
+	std::copy( Real()->m_CachedNotesPerMeasure, Real()->m_CachedNotesPerMeasure + NUM_PLAYERS, m_CachedNotesPerMeasure );
+	std::copy( Real()->m_fCachedPeakNPS, Real()->m_fCachedPeakNPS + NUM_PLAYERS, m_fCachedPeakNPS );
 	m_sCredit		= Real()->m_sCredit;
 	parent = nullptr;
 
@@ -631,6 +763,19 @@ void Steps::SetCachedRadarValues( const RadarValues v[NUM_PLAYERS] )
 	m_bAreCachedRadarValuesJustLoaded = true;
 }
 
+void Steps::SetCachedNotesPerMeasure( const std::vector<std::uint8_t> v[NUM_PLAYERS] )
+{
+	DeAutogen();
+	std::copy( v, v + NUM_PLAYERS, m_CachedNotesPerMeasure );
+	m_bAreCachedNotesPerMeasureJustLoaded = true;
+}
+
+void Steps::SetCachedPeakNPS( const float fPeakNPS[NUM_PLAYERS] )
+{
+	DeAutogen();
+	std::copy( fPeakNPS, fPeakNPS + NUM_PLAYERS, m_fCachedPeakNPS );
+}
+
 RString Steps::GenerateChartKey()
 {
 	ChartKey = this->GenerateChartKey(*m_pNoteData, this->GetTimingData());
@@ -639,65 +784,129 @@ RString Steps::GenerateChartKey()
 RString Steps::GetChartKey()
 {
 	if (ChartKey.empty()) {
+		// Autogen Steps have no file of their own to key the cache with.
+		const bool bUseCache = !IsAutogen() && !m_sFilename.empty();
+		const RString sHashName = ChartHashCache::GetStepsHashName(*this, "ChartKey");
+		if (bUseCache && ChartHashCache::Get(m_sFilename, sHashName, ChartKey))
+			return ChartKey;
+
 		this->Decompress();
 		ChartKey = this->GenerateChartKey(*m_pNoteData, this->GetTimingData());
 		this->Compress();
+		if (bUseCache)
+			ChartHashCache::Set(m_sFilename, sHashName, ChartKey);
 	}
 	return ChartKey;
 }
-RString Steps::GenerateChartKey(NoteData &nd, TimingData *td)
+namespace
 {
-	RString k = "";
-	RString o = "";
-	float bpm;
-	nd.LogNonEmptyRows();
-	std::vector<int>& nerv = nd.GetNonEmptyRowVector();
+	/* Formats the numbers that make up a chart key into a buffer, and hands
+	 * the buffer to SHA-1 whenever it fills up, so the key's text never has
+	 * to be built as a whole. */
+	class ChartKeyHasher
+	{
+	public:
+		ChartKeyHasher(): m_iUsed(0) { }
+
+		void AppendInt( int i )
+		{
+			if( m_iUsed + 12 > sizeof(m_Buffer) )
+				Flush();
+			char digits[10];
+			int iDigits = 0;
+			unsigned u = i < 0? 0u - unsigned(i) : unsigned(i);
+			do
+			{
+				digits[iDigits++] = char( '0' + u % 10 );
+				u /= 10;
+			} while( u != 0 );
+			if( i < 0 )
+				m_Buffer[m_iUsed++] = '-';
+			while( iDigits > 0 )
+				m_Buffer[m_iUsed++] = digits[--iDigits];
+		}
+
+		RString Finish()
+		{
+			Flush();
+			return m_Hash.Finish();
+		}
 
+	private:
+		void Flush()
+		{
+			m_Hash.Update( m_Buffer, m_iUsed );
+			m_iUsed = 0;
+		}
 
-	RString firstHalf = "";
-	RString secondHalf = "";
+		SHA1Hash m_Hash;
+		char m_Buffer[4096];
+		std::size_t m_iUsed;
+	};
 
-#pragma omp parallel sections
+	/* Gives the same result as TimingData::GetBPMAtRow, for rows that never
+	 * decrease, by stepping through the BPM segments instead of searching
+	 * them for every row. */
+	class BPMCursor
 	{
-#pragma omp section
+	public:
+		BPMCursor( const TimingData &td ):
+			m_vBPMs( td.GetTimingSegments(SEGMENT_BPM) ), m_iIndex( 0 ),
+			m_fNoSegmentsBPM( m_vBPMs.empty()? td.GetBPMAtRow(0) : 0 )
 		{
-			for (std::size_t r = 0; r < nerv.size() / 2; r++) {
-				int row = nerv[r];
-				for (int t = 0; t < nd.GetNumTracks(); ++t) {
-					const TapNote &tn = nd.GetTapNote(t, row);
-					std::ostringstream os;
-					os << tn.type;
-					firstHalf.append(os.str());
-				}
-				bpm = td->GetBPMAtRow(row);
-				std::ostringstream os;
-				os << static_cast<int>(bpm + 0.374643f);
-				firstHalf.append(os.str());
-			}
 		}
 
-#pragma omp section
+		float GetBPMAtRow( int iRow )
 		{
-			for (std::size_t r = nerv.size() / 2; r < nerv.size(); r++) {
-				int row = nerv[r];
-				for (int t = 0; t < nd.GetNumTracks(); ++t) {
-					const TapNote &tn = nd.GetTapNote(t, row);
-					std::ostringstream os;
-					os << tn.type;
-					secondHalf.append(os.str());
-				}
-				bpm = td->GetBPMAtRow(row);
-				std::ostringstream os;
-				os << static_cast<int>(bpm + 0.374643f);
-				firstHalf.append(os.str());
-			}
+			if( m_vBPMs.empty() )
+				return m_fNoSegmentsBPM;
+			while( m_iIndex + 1 < m_vBPMs.size() && m_vBPMs[m_iIndex + 1]->GetRow() <= iRow )
+				++m_iIndex;
+			return ToBPM( m_vBPMs[m_iIndex] )->GetBPM();
 		}
+
+	private:
+		const std::vector<TimingSegment*> &m_vBPMs;
+		std::size_t m_iIndex;
+		float m_fNoSegmentsBPM;
+	};
+}
+
+RString Steps::GenerateChartKey(NoteData &nd, TimingData *td)
+{
+	nd.LogNonEmptyRows();
+	const std::vector<int>& nerv = nd.GetNonEmptyRowVector();
+	const int iNumTracks = nd.GetNumTracks();
+	const std::size_t iHalf = nerv.size() / 2;
+
+	/* Keys are stored with scores, so the text being hashed can never
+	 * change.  It's the note types and rounded BPM of each row in the first
+	 * half of the chart, then the BPMs of the rows in the second half, then
+	 * the note types of the rows in the second half. */
+	ChartKeyHasher hasher;
+	BPMCursor bpms( *td );
+	for( std::size_t r = 0; r < iHalf; ++r )
+	{
+		const int row = nerv[r];
+		for( int t = 0; t < iNumTracks; ++t )
+			hasher.AppendInt( nd.GetTapNote(t, row).type );
+		const float bpm = bpms.GetBPMAtRow( row );
+		hasher.AppendInt( static_cast<int>(bpm + 0.374643f) );
+	}
+	for( std::size_t r = iHalf; r < nerv.size(); ++r )
+	{
+		const float bpm = bpms.GetBPMAtRow( nerv[r] );
+		hasher.AppendInt( static_cast<int>(bpm + 0.374643f) );
+	}
+	for( std::size_t r = iHalf; r < nerv.size(); ++r )
+	{
+		const int row = nerv[r];
+		for( int t = 0; t < iNumTracks; ++t )
+			hasher.AppendInt( nd.GetTapNote(t, row).type );
 	}
-	k = firstHalf + secondHalf;
 
-	//ChartKeyRecord = k;
-	o.append("X");	// I was thinking of using "C" to indicate chart.. however.. X is cooler... - Mina
-	o.append(BinaryToHex(CryptManager::GetSHA1ForString(k)));
+	RString o = "X";	// I was thinking of using "C" to indicate chart.. however.. X is cooler... - Mina
+	o.append( BinaryToHex(hasher.Finish()) );
 	return o;
 }
 
@@ -740,12 +949,89 @@ public:
 		rv.PushSelf(L);
 		return 1;
 	}
+	static int CalculateChartStats( T* p, lua_State *L )
+	{
+		PlayerNumber pn = PLAYER_1;
+		if (!lua_isnoneornil(L, 1)) {
+			pn = Enum::Check<PlayerNumber>(L, 1);
+		}
+
+		ChartStats stats[NUM_PLAYERS];
+		p->CalculateChartStats( p->m_pSong != nullptr? p->m_pSong->m_fMusicLengthSeconds : 0, stats );
+		stats[pn].PushSelf(L);
+		return 1;
+	}
+	static int GetNotesPerMeasure( T* p, lua_State *L )
+	{
+		PlayerNumber pn = PLAYER_1;
+		if (!lua_isnoneornil(L, 1)) {
+			pn = Enum::Check<PlayerNumber>(L, 1);
+		}
+
+		const std::vector<std::uint8_t> &v = p->GetNotesPerMeasure(pn);
+		lua_createtable( L, v.size(), 0 );
+		for( unsigned i = 0; i < v.size(); ++i )
+		{
+			lua_pushinteger( L, v[i] );
+			lua_rawseti( L, -2, i+1 );
+		}
+		return 1;
+	}
+	static int GetPeakNPS( T* p, lua_State *L )
+	{
+		PlayerNumber pn = PLAYER_1;
+		if (!lua_isnoneornil(L, 1)) {
+			pn = Enum::Check<PlayerNumber>(L, 1);
+		}
+
+		lua_pushnumber( L, p->GetPeakNPS(pn) );
+		return 1;
+	}
+	static int GetStreamBreakdown( T* p, lua_State *L )
+	{
+		PlayerNumber pn = PLAYER_1;
+		if (!lua_isnoneornil(L, 1)) {
+			pn = Enum::Check<PlayerNumber>(L, 1);
+		}
+		int iMinNotes = DEFAULT_STREAM_NOTES_PER_MEASURE;
+		if (!lua_isnoneornil(L, 2)) {
+			iMinNotes = IArg(2);
+		}
+
+		const std::vector<std::uint8_t> &v = p->GetNotesPerMeasure(pn);
+		std::vector<StreamRun> vRuns;
+		::GetStreamBreakdown( std::vector<int>(v.begin(), v.end()), iMinNotes, vRuns );
+		PushStreamBreakdown( L, vRuns );
+		return 1;
+	}
 	static int GetTimingData( T* p, lua_State *L )
 	{
 		p->GetTimingData()->PushSelf(L);
 		return 1;
 	}
 	static int GetHash( T* p, lua_State *L ) { lua_pushnumber( L, p->GetHash() ); return 1; }
+	static int GetChartKey( T* p, lua_State *L )
+	{
+		lua_pushstring( L, p->GetChartKey() );
+		return 1;
+	}
+	// Themes store hashes they compute themselves, such as GrooveStats
+	// hashes, with these, so they're only computed once per chart.
+	static int GetCachedHash( T* p, lua_State *L )
+	{
+		RString sHash;
+		if( p->IsAutogen() || !ChartHashCache::Get(p->GetFilename(), ChartHashCache::GetStepsHashName(*p, SArg(1)), sHash) )
+			lua_pushnil( L );
+		else
+			lua_pushstring( L, sHash );
+		return 1;
+	}
+	static int SetCachedHash( T* p, lua_State *L )
+	{
+		if( !p->IsAutogen() )
+			ChartHashCache::Set( p->GetFilename(), ChartHashCache::GetStepsHashName(*p, SArg(1)), SArg(2) );
+		COMMON_RETURN_SELF;
+	}
 	// untested
 	/*
 	static int GetSMNoteData( T* p, lua_State *L )
@@ -807,10 +1093,17 @@ public:
 		ADD_METHOD( GetDifficulty );
 		ADD_METHOD( GetFilename );
 		ADD_METHOD( GetHash );
+		ADD_METHOD( GetChartKey );
+		ADD_METHOD( GetCachedHash );
+		ADD_METHOD( SetCachedHash );
 		ADD_METHOD( GetMeter );
 		ADD_METHOD( HasSignificantTimingChanges );
 		ADD_METHOD( HasAttacks );
 		ADD_METHOD( GetRadarValues );
+		ADD_METHOD( CalculateChartStats );
+		ADD_METHOD( GetNotesPerMeasure );
+		ADD_METHOD( GetPeakNPS );
+		ADD_METHOD( GetStreamBreakdown );
 		ADD_METHOD( GetTimingData );
 		ADD_METHOD( GetChartName );
 		//ADD_METHOD( GetSMNoteData );
@@ -10,11 +10,14 @@
 #include "RageUtil_AutoPtr.h"
 #include "TimingData.h"
 
+#include <cstdint>
+#include <string_view>
 #include <vector>
 
 
 class Profile;
 class NoteData;
+struct ChartStats;
 struct lua_State;
 
 /**
@@ -56,6 +59,26 @@ public:
 	void Compress() const;
 	void Decompress() const;
 	void Decompress();
+
+	/** @brief Where the note data of these Steps is kept in the song cache. */
+	struct CachedNoteData
+	{
+		CachedNoteData(): m_iOffset(0), m_iSize(0), m_iRawSize(0), m_iRecordCRC(0), m_iHash(0) { }
+		/** @brief The offset of the gzipped note data in the song's cache record. */
+		unsigned m_iOffset;
+		/** @brief The size of the gzipped note data, or 0 if it isn't cached. */
+		unsigned m_iSize;
+		/** @brief The size of the note data once it's decompressed. */
+		unsigned m_iRawSize;
+		/** @brief The CRC of the record, to tell if it's been replaced since. */
+		unsigned m_iRecordCRC;
+		/** @brief GetHash() of the note data, so it's known without reading it. */
+		unsigned m_iHash;
+	};
+	void SetCachedNoteData( const CachedNoteData &cached )	{ m_CachedNoteData = cached; }
+	const CachedNoteData &GetCachedNoteData() const		{ return m_CachedNoteData; }
+	/** @brief Is the note data in memory, either as NoteData or as SMData? */
+	bool IsNoteDataResident() const		{ return m_bNoteDataIsFilled || !m_sNoteDataCompressed.empty(); }
 	/**
 	 * @brief Determine if these steps were created by the autogenerator.
 	 * @return true if they were, false otherwise.
@@ -102,6 +125,15 @@ public:
 	 */
 	int GetMeter() const				{ return Real()->m_iMeter; }
 	const RadarValues& GetRadarValues( PlayerNumber pn ) const { return Real()->m_CachedRadarValues[pn]; }
+	/**
+	 * @brief Retrieve the number of note rows in each measure, worked out
+	 * with the radar values.
+	 * @return the note rows in each measure for pn's part of the chart. */
+	const std::vector<std::uint8_t>& GetNotesPerMeasure( PlayerNumber pn ) const { return Real()->m_CachedNotesPerMeasure[pn]; }
+	/**
+	 * @brief Retrieve the most note rows per second in any measure.
+	 * @return the peak NPS for pn's part of the chart at normal speed. */
+	float GetPeakNPS( PlayerNumber pn ) const	{ return Real()->m_fCachedPeakNPS[pn]; }
 	/**
 	 * @brief Retrieve the author credit used for this edit.
 	 * @return the author credit used for this edit.
@@ -139,13 +171,15 @@ public:
 	void SetLoadedFromProfile( ProfileSlot slot )	{ m_LoadedFromProfile = slot; }
 	void SetMeter( int meter );
 	void SetCachedRadarValues( const RadarValues v[NUM_PLAYERS] );
+	void SetCachedNotesPerMeasure( const std::vector<std::uint8_t> v[NUM_PLAYERS] );
+	void SetCachedPeakNPS( const float fPeakNPS[NUM_PLAYERS] );
 	float PredictMeter() const;
 
 	unsigned GetHash() const;
 	void GetNoteData( NoteData& noteDataOut ) const;
 	NoteData GetNoteData() const;
 	void SetNoteData( const NoteData& noteDataNew );
-	void SetSMNoteData( const RString &notes_comp );
+	void SetSMNoteData( std::string_view notes_comp );
 	void GetSMNoteData( RString &notes_comp_out ) const;
 
 	/**
@@ -162,6 +196,12 @@ public:
 
 	void TidyUpData();
 	void CalculateRadarValues( float fMusicLengthSeconds );
+	/**
+	 * @brief Work out the ChartStats for each player's part of the chart.
+	 *
+	 * This always works them out from the notes, so it's as slow as
+	 * CalculateRadarValues. */
+	void CalculateChartStats( float fMusicLengthSeconds, ChartStats out[NUM_PLAYERS] ) const;
 
 	/**
 	 * @brief The TimingData used by the Steps.
@@ -228,6 +268,8 @@ private:
 	mutable HiddenPtr<NoteData>	m_pNoteData;
 	mutable bool			m_bNoteDataIsFilled;
 	mutable RString			m_sNoteDataCompressed;
+	CachedNoteData			m_CachedNoteData;
+	void TouchResidentNoteData() const;
 
 	/** @brief The name of the file where these steps are stored. */
 	RString				m_sFilename;
@@ -253,6 +295,12 @@ private:
 	/** @brief The radar values used for each player. */
 	RadarValues			m_CachedRadarValues[NUM_PLAYERS];
 	bool                m_bAreCachedRadarValuesJustLoaded;
+	/** @brief The note rows in each measure for each player.  A measure
+	 * has at most ROWS_PER_BEAT*4 rows, so a byte holds the count. */
+	std::vector<std::uint8_t>	m_CachedNotesPerMeasure[NUM_PLAYERS];
+	/** @brief The most note rows per second in any measure for each player. */
+	float				m_fCachedPeakNPS[NUM_PLAYERS];
+	bool				m_bAreCachedNotesPerMeasureJustLoaded;
 	/** @brief The name of the person who created the Steps. */
 	RString				m_sCredit;
 	/** @brief The name of the chart. */
@@ -15,6 +15,9 @@
 
 static void EraseSegment(std::vector<TimingSegment*> &vSegs, int index, TimingSegment *cur);
 static const int INVALID_INDEX = -1;
+// Each PrepareLookup gets a new version, so a BeatCursor can't mistake a new
+// lookup for the one it started from.
+static unsigned int g_iNextLookupVersion = 1;
 
 TimingSegment* GetSegmentAtRow( int iNoteRow, TimingSegmentType tst );
 
@@ -41,6 +44,8 @@ void TimingData::Copy( const TimingData& cpy )
 
 void TimingData::Clear()
 {
+	ReleaseLookup();
+
 	/* Delete all pointers owned by this TimingData. */
 	FOREACH_TimingSegmentType( tst )
 	{
@@ -82,7 +87,7 @@ TimingData::~TimingData()
 	Clear();
 }
 
-void TimingData::PrepareLookup()
+void TimingData::PrepareLookup( int iLastRow )
 {
 	// If multiple players have the same timing data, then adding to the
 	// lookups would probably cause FindEntryInLookup to return the wrong
@@ -119,6 +124,15 @@ void TimingData::PrepareLookup()
 	{
 		ReleaseLookup();
 	}
+	if(iLastRow >= 0)
+	{
+		PrepareRowTimes(iLastRow);
+	}
+	m_iLookupVersion= g_iNextLookupVersion++;
+	if(g_iNextLookupVersion == 0)
+	{
+		g_iNextLookupVersion= 1;
+	}
 	// DumpLookupTables();
 }
 
@@ -136,6 +150,8 @@ void TimingData::ReleaseLookup()
 	CLEAR_LOOKUP(m_beat_start_lookup);
 	CLEAR_LOOKUP(m_time_start_lookup);
 #undef CLEAR_LOOKUP
+	std::vector<float>().swap(m_vRowSeconds);
+	m_iLookupVersion= 0;
 }
 
 RString SegInfoStr(const std::vector<TimingSegment*>& segs, unsigned int index, const RString& name)
@@ -927,6 +943,49 @@ void TimingData::GetBeatAndBPSFromElapsedTimeNoOffset(GetBeatArgs& args) const
 	GetBeatInternal(start, args, INT_MAX);
 }
 
+// Passes an event FindEvent found while finding the time of a beat, other
+// than the beat itself.  start.last_time has to be the time the event is
+// reached.
+static void PassTimeEvent(TimingData::GetBeatStarts& start, float& bps,
+	int event_type, unsigned int& curr_segment,
+	const std::vector<TimingSegment*>& bpms, const std::vector<TimingSegment*>& warps,
+	const std::vector<TimingSegment*>& stops, const std::vector<TimingSegment*>& delays)
+{
+#define INC_INDEX(index) ++curr_segment; ++index;
+	switch(event_type)
+	{
+		case FOUND_WARP_DESTINATION:
+			start.is_warping= false;
+			break;
+		case FOUND_BPM_CHANGE:
+			bps= ToBPM(bpms[start.bpm])->GetBPS();
+			INC_INDEX(start.bpm);
+			break;
+		case FOUND_STOP:
+		case FOUND_STOP_DELAY:
+			start.last_time= start.last_time + ToStop(stops[start.stop])->GetPause();
+			INC_INDEX(start.stop);
+			break;
+		case FOUND_DELAY:
+			start.last_time= start.last_time + ToDelay(delays[start.delay])->GetPause();
+			INC_INDEX(start.delay);
+			break;
+		case FOUND_WARP:
+			{
+				start.is_warping= true;
+				WarpSegment* ws= ToWarp(warps[start.warp]);
+				float warp_sum= ws->GetLength() + ws->GetBeat();
+				if(warp_sum > start.warp_destination)
+				{
+					start.warp_destination= warp_sum;
+				}
+				INC_INDEX(start.warp);
+				break;
+			}
+	}
+#undef INC_INDEX
+}
+
 float TimingData::GetElapsedTimeInternal(GetBeatStarts& start, float beat,
 	unsigned int max_segment) const
 {
@@ -937,7 +996,6 @@ float TimingData::GetElapsedTimeInternal(GetBeatStarts& start, float beat,
 	unsigned int curr_segment= start.bpm+start.warp+start.stop+start.delay;
 
 	float bps= GetBPMAtRow(start.last_row) / 60.0f;
-#define INC_INDEX(index) ++curr_segment; ++index;
 	bool find_marker= beat < FLT_MAX;
 
 	while(curr_segment < max_segment)
@@ -950,49 +1008,59 @@ float TimingData::GetElapsedTimeInternal(GetBeatStarts& start, float beat,
 			NoteRowToBeat(event_row - start.last_row) / bps;
 		float next_event_time= start.last_time + time_to_next_event;
 		start.last_time= next_event_time;
-		switch(event_type)
+		if(event_type == FOUND_MARKER)
 		{
-			case FOUND_WARP_DESTINATION:
-				start.is_warping= false;
-				break;
-			case FOUND_BPM_CHANGE:
-				bps= ToBPM(bpms[start.bpm])->GetBPS();
-				INC_INDEX(start.bpm);
-				break;
-			case FOUND_STOP:
-			case FOUND_STOP_DELAY:
-				time_to_next_event= ToStop(stops[start.stop])->GetPause();
-				next_event_time= start.last_time + time_to_next_event;
-				start.last_time= next_event_time;
-				INC_INDEX(start.stop);
-				break;
-			case FOUND_DELAY:
-				time_to_next_event= ToDelay(delays[start.delay])->GetPause();
-				next_event_time= start.last_time + time_to_next_event;
-				start.last_time= next_event_time;
-				INC_INDEX(start.delay);
-				break;
-			case FOUND_MARKER:
-				return start.last_time;
-			case FOUND_WARP:
-				{
-					start.is_warping= true;
-					WarpSegment* ws= ToWarp(warps[start.warp]);
-					float warp_sum= ws->GetLength() + ws->GetBeat();
-					if(warp_sum > start.warp_destination)
-					{
-						start.warp_destination= warp_sum;
-					}
-					INC_INDEX(start.warp);
-					break;
-				}
+			return start.last_time;
 		}
+		PassTimeEvent(start, bps, event_type, curr_segment, bpms, warps, stops,
+			delays);
 		start.last_row= event_row;
 	}
-#undef INC_INDEX
 	return start.last_time;
 }
 
+void TimingData::PrepareRowTimes(int iLastRow)
+{
+	const std::vector<TimingSegment*>& bpms= m_avpTimingSegments[SEGMENT_BPM];
+	const std::vector<TimingSegment*>& warps= m_avpTimingSegments[SEGMENT_WARP];
+	const std::vector<TimingSegment*>& stops= m_avpTimingSegments[SEGMENT_STOP];
+	const std::vector<TimingSegment*>& delays= m_avpTimingSegments[SEGMENT_DELAY];
+	m_vRowSeconds.resize(iLastRow + 1);
+	m_fRowSecondsOffset= m_fBeat0OffsetInSeconds;
+
+	// This is GetElapsedTimeInternal from the start for every row, but the
+	// walk through the segments carries on from one row to the next instead
+	// of starting over, since finding a row doesn't change anything.  The
+	// math is the same, so the times are exactly the same.
+	GetBeatStarts start;
+	start.last_time= -m_fBeat0OffsetInSeconds;
+	float bps= GetBPMAtRow(start.last_row) / 60.0f;
+	unsigned int curr_segment= 0;
+	for(int row= 0; row <= iLastRow; ++row)
+	{
+		const float beat= NoteRowToBeat(row);
+		for(;;)
+		{
+			int event_row= INT_MAX;
+			int event_type= NOT_FOUND;
+			FindEvent(event_row, event_type, start, beat, true, bpms, warps, stops,
+				delays);
+			float time_to_next_event= start.is_warping ? 0 :
+				NoteRowToBeat(event_row - start.last_row) / bps;
+			float next_event_time= start.last_time + time_to_next_event;
+			if(event_type == FOUND_MARKER)
+			{
+				m_vRowSeconds[row]= next_event_time;
+				break;
+			}
+			start.last_time= next_event_time;
+			PassTimeEvent(start, bps, event_type, curr_segment, bpms, warps, stops,
+				delays);
+			start.last_row= event_row;
+		}
+	}
+}
+
 float TimingData::GetElapsedTimeFromBeat( float fBeat ) const
 {
 	return TimingData::GetElapsedTimeFromBeatNoOffset( fBeat )
@@ -1001,6 +1069,17 @@ float TimingData::GetElapsedTimeFromBeat( float fBeat ) const
 
 float TimingData::GetElapsedTimeFromBeatNoOffset( float fBeat ) const
 {
+	// GetElapsedTimeInternal finds the time of the row nearest the beat, so
+	// if that row is in the table, it has the answer.
+	if(!m_vRowSeconds.empty() && m_fRowSecondsOffset == m_fBeat0OffsetInSeconds &&
+		fBeat >= 0 && fBeat <= NoteRowToBeat(m_vRowSeconds.size() - 1))
+	{
+		int row= BeatToNoteRow(fBeat);
+		if(row < static_cast<int>(m_vRowSeconds.size()))
+		{
+			return m_vRowSeconds[row];
+		}
+	}
 	GetBeatStarts start;
 	start.last_time= -m_fBeat0OffsetInSeconds;
 	beat_start_lookup_t::const_iterator looked_up_start=
@@ -1013,6 +1092,86 @@ float TimingData::GetElapsedTimeFromBeatNoOffset( float fBeat ) const
 	return start.last_time;
 }
 
+static unsigned int SegmentsPassed(const TimingData::GetBeatStarts& start)
+{
+	return start.bpm + start.warp + start.stop + start.delay;
+}
+
+TimingData::BeatCursor::BeatCursor() :m_pTiming(nullptr), m_iLookupVersion(0),
+	m_fBeat0OffsetInSeconds(0), m_bHasNext(false), m_iStartWarpBegin(-1),
+	m_fStartWarpDest(0), m_iNextWarpBegin(-1), m_fNextWarpDest(0)
+{
+}
+
+void TimingData::BeatCursor::GetBeatAndBPSFromElapsedTime(const TimingData& timing, GetBeatArgs& args)
+{
+	args.elapsed_time += GAMESTATE->m_SongOptions.GetCurrent().m_fMusicRate * PREFSMAN->m_fGlobalOffsetSeconds;
+	GetBeatAndBPSFromElapsedTimeNoOffset(timing, args);
+}
+
+void TimingData::BeatCursor::GetBeatAndBPSFromElapsedTimeNoOffset(const TimingData& timing, GetBeatArgs& args)
+{
+	if(timing.m_iLookupVersion == 0)
+	{
+		m_pTiming= nullptr;
+		timing.GetBeatAndBPSFromElapsedTimeNoOffset(args);
+		return;
+	}
+	// Starting from before the first segment is the same as starting over,
+	// so only go back when a segment has been passed.
+	if(m_pTiming != &timing || m_iLookupVersion != timing.m_iLookupVersion ||
+		m_fBeat0OffsetInSeconds != timing.m_fBeat0OffsetInSeconds ||
+		(args.elapsed_time < m_Start.last_time && SegmentsPassed(m_Start) != 0))
+	{
+		Restart(timing);
+	}
+	// Walking from m_Start to a time at or after m_Next does the same math
+	// that got to m_Next, so it can start from there instead.
+	while(m_bHasNext && m_Next.last_time <= args.elapsed_time)
+	{
+		m_Start= m_Next;
+		m_iStartWarpBegin= m_iNextWarpBegin;
+		m_fStartWarpDest= m_fNextWarpDest;
+		FindNext();
+	}
+	if(m_iStartWarpBegin != -1)
+	{
+		args.warp_begin_out= m_iStartWarpBegin;
+		args.warp_dest_out= m_fStartWarpDest;
+	}
+	GetBeatStarts start= m_Start;
+	timing.GetBeatInternal(start, args, INT_MAX);
+}
+
+void TimingData::BeatCursor::Restart(const TimingData& timing)
+{
+	// This starts from the beginning rather than a lookup entry, because an
+	// entry doesn't know about the warps passed before it.  Going back isn't
+	// something that happens every frame.
+	m_pTiming= &timing;
+	m_iLookupVersion= timing.m_iLookupVersion;
+	m_fBeat0OffsetInSeconds= timing.m_fBeat0OffsetInSeconds;
+	m_Start= GetBeatStarts();
+	m_Start.last_time= -timing.m_fBeat0OffsetInSeconds;
+	m_iStartWarpBegin= -1;
+	m_fStartWarpDest= 0;
+	FindNext();
+}
+
+void TimingData::BeatCursor::FindNext()
+{
+	GetBeatArgs args;
+	args.elapsed_time= FLT_MAX;
+	args.warp_begin_out= m_iStartWarpBegin;
+	args.warp_dest_out= m_fStartWarpDest;
+	m_Next= m_Start;
+	const unsigned int passed= SegmentsPassed(m_Start);
+	m_pTiming->GetBeatInternal(m_Next, args, passed + 1);
+	m_bHasNext= SegmentsPassed(m_Next) > passed;
+	m_iNextWarpBegin= args.warp_begin_out;
+	m_fNextWarpDest= args.warp_dest_out;
+}
+
 float TimingData::GetDisplayedBeat( float fBeat ) const
 {
 	float fOutBeat = 0;
@@ -88,6 +88,10 @@ public:
 	// tables are populated.  ReleaseLookup should be called after gameplay
 	// finishes so that memory isn't wasted.
 	// -Kyz
+	// PrepareLookup can also be given the last row of the chart, and then it
+	// works out the time of every row up to it once, so finding the time of a
+	// note is just looking it up.  BeatCursor goes the other way for times
+	// that only move forward, like the song position.
 	struct GetBeatArgs
 	{
 		float elapsed_time;
@@ -130,8 +134,58 @@ public:
 	beat_start_lookup_t m_beat_start_lookup;
 	beat_start_lookup_t m_time_start_lookup;
 
-	void PrepareLookup();
+	void PrepareLookup( int iLastRow = -1 );
 	void ReleaseLookup();
+	/**
+	 * @brief Finds the beat from a time that only moves forward, like the song
+	 * position.
+	 *
+	 * It remembers the last segment the time passed and the time of the one
+	 * after it, so each call only walks the segments passed since the last
+	 * call instead of starting over from a lookup entry.  Going back before
+	 * the last segment passed starts over from the beginning.  The results
+	 * are the same as the TimingData's own functions without a lookup.
+	 *
+	 * It's only used while the TimingData's lookup is prepared.  The rest of
+	 * the time, the segments might be changing, so it just calls the
+	 * TimingData's functions. */
+	class BeatCursor
+	{
+	public:
+		BeatCursor();
+		void GetBeatAndBPSFromElapsedTime( const TimingData &timing, GetBeatArgs &args );
+		void GetBeatAndBPSFromElapsedTimeNoOffset( const TimingData &timing, GetBeatArgs &args );
+		float GetBeatFromElapsedTime( const TimingData &timing, float elapsed_time )
+		{
+			GetBeatArgs args;
+			args.elapsed_time= elapsed_time;
+			GetBeatAndBPSFromElapsedTime(timing, args);
+			return args.beat;
+		}
+		float GetBeatFromElapsedTimeNoOffset( const TimingData &timing, float elapsed_time )
+		{
+			GetBeatArgs args;
+			args.elapsed_time= elapsed_time;
+			GetBeatAndBPSFromElapsedTimeNoOffset(timing, args);
+			return args.beat;
+		}
+	private:
+		void Restart( const TimingData &timing );
+		void FindNext();
+
+		const TimingData *m_pTiming;
+		unsigned int m_iLookupVersion;
+		float m_fBeat0OffsetInSeconds;
+		// The state after the last segment passed and after the one after it,
+		// and the last warp passed by each of them.
+		GetBeatStarts m_Start;
+		GetBeatStarts m_Next;
+		bool m_bHasNext;
+		int m_iStartWarpBegin;
+		float m_fStartWarpDest;
+		int m_iNextWarpBegin;
+		float m_fNextWarpDest;
+	};
 	void DumpOneTable(const beat_start_lookup_t& lookup, const RString& name);
 	void DumpLookupTables();
 
@@ -472,6 +526,17 @@ protected:
 
 	// All of the following vectors must be sorted before gameplay.
 	std::array<std::vector<TimingSegment *>, NUM_TimingSegmentType> m_avpTimingSegments;
+
+	void PrepareRowTimes( int iLastRow );
+
+	// Set by PrepareLookup and cleared by ReleaseLookup, so a BeatCursor can
+	// tell when the lookup it was used with is gone.  0 when not prepared.
+	unsigned int m_iLookupVersion = 0;
+	// The time of each row from 0, without the global offset, and the song
+	// offset they were worked out with.  Autosync can change the offset in
+	// the middle of a song.
+	std::vector<float> m_vRowSeconds;
+	float m_fRowSecondsOffset = 0;
 };
 
 #undef COMPARE
@@ -7,6 +7,7 @@
 #include "RageTimer.h"
 #include "RageUtil_CircularBuffer.h"
 
+#include <atomic>
 #include <cstdint>
 
 class RageSoundBase;
@@ -151,6 +152,15 @@ private:
 	 *
 	 * Do not allocate or deallocate memory in the mixing thread since allocating memory
 	 * involves taking a lock. Instead, push the deallocation to the main thread.
+	 *
+	 * With the SoundLockFreeMixing preference, the decoding thread takes no locks either,
+	 * so a decode that takes a while never holds up Update() or StopMixing().  Instead of
+	 * looking at the state of every sound, it decodes the sounds it has been sent a START
+	 * command for, through m_Commands, until it reaches EOF or is sent STOP.  StopMixing()
+	 * waits for STOP to be acknowledged, which happens between two blocks of decoding,
+	 * before it lets go of the sound.  The decoding thread sleeps until the mixing thread
+	 * has made room in a buffer or a command arrives.  In this mode, m_SoundListMutex
+	 * serializes the other threads with each other in place of m_Mutex.
 	 */
 	struct sound_block
 	{
@@ -174,6 +184,10 @@ private:
 
 		bool m_bPaused;
 
+		/* In lock-free mode, whether the decoding thread is decoding this sound.
+		 * Only the decoding thread touches this. */
+		bool m_bDecoding;
+
 		struct QueuedPosMap
 		{
 			int iFrames;
@@ -183,7 +197,7 @@ private:
 
 		CircBuf<QueuedPosMap> m_PosMapQueue;
 
-		enum
+		enum State
 		{
 			AVAILABLE,
 			BUFFERING,
@@ -196,7 +210,11 @@ private:
 
 			HALTING,	/* stop immediately */
 			PLAYING
-		} m_State;
+		};
+		/* Set and read by the main, mixing and decoding threads.  The decoding
+		 * thread stores STOPPING with release, and Update loads it with acquire,
+		 * so the last data decoded is visible before the sound is finished. */
+		std::atomic<State> m_State;
 	};
 
 	/* List of currently playing sounds: XXX no vector */
@@ -209,8 +227,29 @@ private:
 
 	bool m_bShutdownDecodeThread;
 
+	/* Lock-free mode; see above. */
+	bool m_bLockFreeMixing;
+	struct MixerCommand
+	{
+		enum Type { START, STOP } m_Type;
+		int m_iSound;
+	};
+	/* Written with m_SoundListMutex held, and read by the decoding thread. */
+	CircBuf<MixerCommand> m_Commands;
+	/* Posted when a command is sent, or when the decoding thread has asked
+	 * for it with m_bDemandWanted and the mixer has made room to decode into. */
+	RageSemaphore m_DecodeDemand;
+	std::atomic<bool> m_bDemandWanted;
+	/* Posted by the decoding thread once it has stopped decoding a sound. */
+	RageSemaphore m_StopDone;
+
+	RageMutex &GetStateMutex() { return m_bLockFreeMixing? m_SoundListMutex:m_Mutex; }
+	void SendMixerCommand( MixerCommand::Type type, int iSound );
+	void ProcessMixerCommands();
+
 	static int DecodeThread_start( void *p );
 	void DecodeThread();
+	void DecodeThreadLockFree();
 	RageSoundMixBuffer &MixIntoBuffer( int iFrames, std::int64_t iFrameNumber, std::int64_t iCurrentFrame );
 	RageThread m_DecodeThread;
 
@@ -1,6 +1,7 @@
 #include "global.h"
 #include "RageSoundDriver.h"
 #include "PrefsManager.h"
+#include "Preference.h"
 #include "RageLog.h"
 #include "RageSound.h"
 #include "RageUtil.h"
@@ -19,11 +20,14 @@ static int chunksize() { return 512; }
 
 static int underruns = 0, logged_underruns = 0;
 
+static Preference<bool> g_bLockFreeMixing( "SoundLockFreeMixing", false );
+
 RageSoundDriver::Sound::Sound()
 {
 	m_pSound = nullptr;
 	m_State = AVAILABLE;
 	m_bPaused = false;
+	m_bDecoding = false;
 }
 
 void RageSoundDriver::Sound::Allocate( int iFrames )
@@ -63,6 +67,11 @@ RageSoundMixBuffer &RageSoundDriver::MixIntoBuffer( int iFrames, std::int64_t iF
 
 	static RageSoundMixBuffer mix;
 
+	/* In lock-free mode, wake the decoding thread once a playing sound has a
+	 * quarter of its buffer free. */
+	const unsigned iDemandBlocks = std::max( 1, frames_to_buffer / (samples_per_block/channels) / 4 );
+	bool bWantDecode = false;
+
 	for( unsigned i = 0; i < ARRAYLEN(m_Sounds); ++i )
 	{
 		/* s.m_pSound can not safely be accessed from here. */
@@ -156,8 +165,14 @@ RageSoundMixBuffer &RageSoundDriver::MixIntoBuffer( int iFrames, std::int64_t iF
 		/* If we don't have enough to fill the buffer, we've underrun. */
 		if( iGotFrames < iFrames && s.m_State == Sound::PLAYING )
 			++underruns;
+
+		if( s.m_State == Sound::PLAYING && s.m_Buffer.num_writable() >= iDemandBlocks )
+			bWantDecode = true;
 	}
 
+	if( bWantDecode && m_bLockFreeMixing && m_bDemandWanted.exchange(false) )
+		m_DecodeDemand.Post();
+
 	return mix;
 }
 
@@ -184,6 +199,12 @@ void RageSoundDriver::DecodeThread()
 {
 	SetupDecodingThread();
 
+	if( m_bLockFreeMixing )
+	{
+		DecodeThreadLockFree();
+		return;
+	}
+
 	while( !m_bShutdownDecodeThread )
 	{
 		/* Fill each playing sound, round-robin. */
@@ -223,6 +244,113 @@ void RageSoundDriver::DecodeThread()
 	}
 }
 
+void RageSoundDriver::DecodeThreadLockFree()
+{
+	while( !m_bShutdownDecodeThread )
+	{
+		/* Ask to be woken before looking at the buffers, so room made while
+		 * we're decoding isn't missed. */
+		m_bDemandWanted.store( true );
+		bool bWouldBlock = false;
+
+		for( unsigned i = 0; i < ARRAYLEN(m_Sounds); ++i )
+		{
+			Sound &s = m_Sounds[i];
+
+			/* Don't look at the buffer of a sound we aren't decoding; Update()
+			 * may be freeing it. */
+			CHECKPOINT_M("Processing the sound while buffers are available.");
+			while( s.m_bDecoding && s.m_Buffer.num_writable() )
+			{
+				/* Check for commands between blocks, so StopMixing never waits
+				 * for more than one. */
+				ProcessMixerCommands();
+				if( !s.m_bDecoding )
+					break;
+
+				int iWrote = GetDataForSound( s );
+				if( iWrote == RageSoundReader::WOULD_BLOCK )
+				{
+					bWouldBlock = true;
+					break;
+				}
+				if( iWrote < 0 )
+				{
+					/* This sound is finishing.  Make sure the data we've written
+					 * is visible before Update() sees STOPPING. */
+					s.m_bDecoding = false;
+					s.m_State.store( Sound::STOPPING, std::memory_order_release );
+					break;
+				}
+			}
+		}
+		ProcessMixerCommands();
+
+		/* A reader that would block isn't going to make room, so try it again
+		 * after a chunk instead of waiting for the mixer. */
+		if( bWouldBlock )
+		{
+			int iSampleRate = GetSampleRate();
+			ASSERT_M( iSampleRate > 0, ssprintf("%i", iSampleRate) );
+			usleep( 1000000*chunksize() / iSampleRate );
+		}
+		else
+		{
+			m_DecodeDemand.Wait( false );
+		}
+	}
+}
+
+/* Send a command to the decoding thread.  STOP doesn't return until the
+ * decoding thread has stopped decoding the sound. */
+void RageSoundDriver::SendMixerCommand( MixerCommand::Type type, int iSound )
+{
+	LockMut( m_SoundListMutex );
+
+	MixerCommand cmd;
+	cmd.m_Type = type;
+	cmd.m_iSound = iSound;
+
+	/* Without a decoding thread, there's nobody else to read the commands. */
+	if( !m_DecodeThread.IsCreated() )
+	{
+		m_Commands.write( &cmd, 1 );
+		ProcessMixerCommands();
+		if( type == MixerCommand::STOP )
+			m_StopDone.Wait();
+		return;
+	}
+
+	while( !m_Commands.write(&cmd, 1) )
+	{
+		m_DecodeDemand.Post();
+		usleep( 1000 );
+	}
+	m_DecodeDemand.Post();
+
+	if( type == MixerCommand::STOP )
+		m_StopDone.Wait();
+}
+
+void RageSoundDriver::ProcessMixerCommands()
+{
+	MixerCommand cmd;
+	while( m_Commands.read(&cmd, 1) )
+	{
+		Sound &s = m_Sounds[cmd.m_iSound];
+		switch( cmd.m_Type )
+		{
+		case MixerCommand::START:
+			s.m_bDecoding = true;
+			break;
+		case MixerCommand::STOP:
+			s.m_bDecoding = false;
+			m_StopDone.Post();
+			break;
+		}
+	}
+}
+
 /* Buffer a block of sound data for the given sound.  Return the number of
  * frames buffered, or a RageSoundReader return code. */
 int RageSoundDriver::GetDataForSound( Sound &s )
@@ -252,7 +380,8 @@ int RageSoundDriver::GetDataForSound( Sound &s )
 
 void RageSoundDriver::Update()
 {
-	m_Mutex.Lock();
+	RageMutex &Mutex = GetStateMutex();
+	Mutex.Lock();
 	for( unsigned i = 0; i < ARRAYLEN(m_Sounds); ++i )
 	{
 		{
@@ -265,7 +394,7 @@ void RageSoundDriver::Update()
 			}
 		}
 
-		switch( m_Sounds[i].m_State )
+		switch( m_Sounds[i].m_State.load(std::memory_order_acquire) )
 		{
 		case Sound::STOPPED:
 			m_Sounds[i].Deallocate();
@@ -309,7 +438,7 @@ void RageSoundDriver::Update()
 		}
 	}
 
-	m_Mutex.Unlock();
+	Mutex.Unlock();
 }
 
 void RageSoundDriver::StartMixing( RageSoundBase *pSound )
@@ -355,14 +484,18 @@ void RageSoundDriver::StartMixing( RageSoundBase *pSound )
 	}
 
 	s.m_State = Sound::PLAYING;
+	if( m_bLockFreeMixing )
+		SendMixerCommand( MixerCommand::START, i );
 
 //	LOG->Trace("StartMixing: (#%i) finished prebuffering(%s) (%p)", i, s.m_pSound->GetLoadedFilePath().c_str(), s.m_pSound );
 }
 
 void RageSoundDriver::StopMixing( RageSoundBase *pSound )
 {
-	/* Lock, to make sure the decoder thread isn't running on this sound while we do this. */
-	m_Mutex.Lock();
+	/* Lock, to make sure the decoder thread isn't running on this sound while we do this.
+	 * In lock-free mode, the decoder doesn't take it; we tell it to stop below instead. */
+	RageMutex &Mutex = GetStateMutex();
+	Mutex.Lock();
 
 	/* Find the sound. */
 	unsigned i;
@@ -371,7 +504,7 @@ void RageSoundDriver::StopMixing( RageSoundBase *pSound )
 			break;
 	if( i == ARRAYLEN(m_Sounds) )
 	{
-		m_Mutex.Unlock();
+		Mutex.Unlock();
 		LOG->Trace( "not stopping a sound because it's not playing" );
 		return;
 	}
@@ -379,15 +512,18 @@ void RageSoundDriver::StopMixing( RageSoundBase *pSound )
 	/* If we're already in STOPPED, there's nothing to do. */
 	if( m_Sounds[i].m_State == Sound::STOPPED )
 	{
-		m_Mutex.Unlock();
+		Mutex.Unlock();
 		LOG->Trace( "not stopping a sound because it's already in STOPPED" );
 		return;
 	}
 
+	if( m_bLockFreeMixing )
+		SendMixerCommand( MixerCommand::STOP, i );
+
 //	LOG->Trace("StopMixing: set %p (%s) to HALTING", m_Sounds[i].m_pSound, m_Sounds[i].m_pSound->GetLoadedFilePath().c_str());
 
 	/* Tell the mixing thread to flush the buffer.  We don't have to worry about
-	 * the decoding thread, since we've locked m_Mutex. */
+	 * the decoding thread, since we've locked m_Mutex or it has acknowledged STOP. */
 	m_Sounds[i].m_State = Sound::HALTING;
 
 	/* Invalidate the m_pSound pointer to guarantee we don't make any further references to
@@ -395,7 +531,7 @@ void RageSoundDriver::StopMixing( RageSoundBase *pSound )
 	m_Sounds[i].m_pSound = nullptr;
 //	LOG->Trace("end StopMixing");
 
-	m_Mutex.Unlock();
+	Mutex.Unlock();
 
 	pSound->SoundIsFinishedPlaying();
 }
@@ -403,7 +539,7 @@ void RageSoundDriver::StopMixing( RageSoundBase *pSound )
 
 bool RageSoundDriver::PauseMixing( RageSoundBase *pSound, bool bStop )
 {
-	LockMut( m_Mutex );
+	LockMut( GetStateMutex() );
 
 	/* Find the sound. */
 	unsigned i;
@@ -447,9 +583,14 @@ void RageSoundDriver::low_sample_count_workaround()
 
 RageSoundDriver::RageSoundDriver():
 	m_Mutex("RageSoundDriver"),
-	m_SoundListMutex("SoundListMutex")
+	m_SoundListMutex("SoundListMutex"),
+	m_DecodeDemand("DecodeDemand"),
+	m_StopDone("DecodeStopDone")
 {
 	m_bShutdownDecodeThread = false;
+	m_bLockFreeMixing = g_bLockFreeMixing;
+	m_Commands.reserve( 64 );
+	m_bDemandWanted = false;
 	m_iMaxHardwareFrame = 0;
 	m_iVMaxHardwareFrame = 0;
 	SetDecodeBufferSize( 4096 );
@@ -463,6 +604,7 @@ RageSoundDriver::~RageSoundDriver()
 	if( m_DecodeThread.IsCreated() )
 	{
 		m_bShutdownDecodeThread = true;
+		m_DecodeDemand.Post();
 		LOG->Trace("Shutting down decode thread ...");
 		LOG->Flush();
 		m_DecodeThread.Wait();
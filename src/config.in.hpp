@@ -75,6 +75,9 @@ typedef int pid_t;
 /* Defined to 1 if logging timing segment additions and removals. */
 #cmakedefine WITH_LOGGING_TIMING_DATA 1
 
+/* Defined to 1 if each track of note data is a sorted array. */
+#cmakedefine WITH_FLAT_NOTE_DATA 1
+
 #if defined(__GNUC__)
 /** @brief Define a macro to tell the compiler that a function has printf()
  * semantics, to aid warning output. */
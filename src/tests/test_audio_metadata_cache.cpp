@@ -0,0 +1,207 @@
+/* Checks that AudioMetadataCache keeps MP3 frame indexes, and that a seek
+ * with one gives the same samples as decoding from the start of the file.
+ * The seek check needs one of test_audio_readers' input files; see
+ * "00 README". */
+#include "global.h"
+#include "test_misc.h"
+
+#include "AudioMetadataCache.h"
+#include "RageFile.h"
+#include "RageFileManager.h"
+#include "RageLog.h"
+#include "RageSoundReader_FileReader.h"
+#include "RageUtil.h"
+#include "SpecialFiles.h"
+
+#include <cmath>
+#include <vector>
+
+static const RString TABLE_FILE = "test_audio_metadata_cache.dat";
+static const RString MP3_FILE = "test MP3 44100 stereo VBR (XING, LAME).mp3";
+static const int NUM_SEEKS = 20;
+static const int SEEK_FRAMES = 4096;
+
+static bool WriteTestFile( const RString &sPath, const RString &sData )
+{
+	RageFile f;
+	return f.Open( sPath, RageFile::WRITE ) && f.Write( sData ) != -1 && f.Flush() != -1;
+}
+
+static bool CheckSeekTableRoundTrip()
+{
+	/* The index is only kept while the file it's for is unchanged, so it
+	 * needs a real file; what's in it doesn't matter. */
+	if( !WriteTestFile(TABLE_FILE, RString(1000, 'x')) )
+	{
+		LOG->Warn( "Couldn't write %s", TABLE_FILE.c_str() );
+		return false;
+	}
+
+	RandomGen rnd( 1 );
+	AudioMetadataCache::SeekTable table;
+	int iFrame = 0, iByte = 0;
+	for( int i = 0; i < 5000; ++i )
+	{
+		table.emplace_back( iFrame, iByte );
+		iFrame += 1152;
+		iByte += 200 + rnd() % 800;
+	}
+	AudioMetadataCache::SetSeekTable( TABLE_FILE, table );
+
+	bool bFailed = false;
+	AudioMetadataCache::SeekTable readBack;
+	if( !AudioMetadataCache::GetSeekTable(TABLE_FILE, readBack) )
+	{
+		LOG->Warn( "Fail: the seek table wasn't read back" );
+		bFailed = true;
+	}
+	else if( readBack != table )
+	{
+		LOG->Warn( "Fail: the seek table read back differently (%i entries, wrote %i)",
+			int(readBack.size()), int(table.size()) );
+		bFailed = true;
+	}
+
+	std::vector<RString> asTempFiles;
+	GetDirListing( SpecialFiles::CACHE_DIR + "FrameIndex/*.tmp", asTempFiles );
+	if( !asTempFiles.empty() )
+	{
+		LOG->Warn( "Fail: writing the seek table left %s behind", asTempFiles[0].c_str() );
+		bFailed = true;
+	}
+
+	/* Once the file changes, its index mustn't be used. */
+	WriteTestFile( TABLE_FILE, RString(2000, 'x') );
+	if( AudioMetadataCache::GetSeekTable(TABLE_FILE, readBack) )
+	{
+		LOG->Warn( "Fail: the seek table was read back after its file changed" );
+		bFailed = true;
+	}
+
+	FILEMAN->Remove( TABLE_FILE );
+	AudioMetadataCache::PruneFrameIndexes();
+	return !bFailed;
+}
+
+static bool ReadAll( RageSoundReader *pReader, std::vector<float> &vOut )
+{
+	vOut.clear();
+	for(;;)
+	{
+		float buf[4096];
+		const int iGot = pReader->Read( buf, ARRAYLEN(buf) / pReader->GetNumChannels() );
+		if( iGot == RageSoundReader::END_OF_FILE )
+			return true;
+		if( iGot < 0 )
+			return false;
+		vOut.insert( vOut.end(), buf, buf + iGot*pReader->GetNumChannels() );
+	}
+}
+
+static bool CheckIndexedSeek()
+{
+	RString sError;
+	RageSoundReader *pReader = RageSoundReader_FileReader::OpenFile( MP3_FILE, sError );
+	if( pReader == nullptr )
+	{
+		LOG->Warn( "Couldn't open %s: %s", MP3_FILE.c_str(), sError.c_str() );
+		return false;
+	}
+
+	/* Decoding the whole file from the start also leaves its index in the
+	 * cache. */
+	const int iChannels = pReader->GetNumChannels();
+	std::vector<float> vAll;
+	const bool bRead = ReadAll( pReader, vAll );
+	delete pReader;
+	if( !bRead || int(vAll.size()) < SEEK_FRAMES*iChannels*2 )
+	{
+		LOG->Warn( "Couldn't decode %s", MP3_FILE.c_str() );
+		return false;
+	}
+
+	AudioMetadataCache::SeekTable table;
+	if( !AudioMetadataCache::GetSeekTable(MP3_FILE, table) )
+	{
+		LOG->Warn( "Fail: decoding %s didn't leave a frame index", MP3_FILE.c_str() );
+		return false;
+	}
+
+	bool bFailed = false;
+	RandomGen rnd( 1 );
+	const int iFrames = vAll.size() / iChannels;
+	for( int i = 0; i < NUM_SEEKS; ++i )
+	{
+		/* A new reader, so it seeks with the index from the cache instead of
+		 * one it built itself. */
+		pReader = RageSoundReader_FileReader::OpenFile( MP3_FILE, sError );
+		ASSERT( pReader != nullptr );
+
+		const int iFrame = 1 + rnd() % (iFrames - SEEK_FRAMES - 1);
+		std::vector<float> vSeeked( SEEK_FRAMES*iChannels );
+		const int iRet = pReader->SetPosition( iFrame );
+		const int iGot = iRet == 1? pReader->Read( vSeeked.data(), SEEK_FRAMES ):0;
+		delete pReader;
+		if( iGot != SEEK_FRAMES )
+		{
+			LOG->Warn( "Fail: seeking to %i returned %i, and read %i frames", iFrame, iRet, iGot );
+			bFailed = true;
+			continue;
+		}
+
+		for( int s = 0; s < SEEK_FRAMES*iChannels; ++s )
+		{
+			if( std::abs(vSeeked[s] - vAll[iFrame*iChannels + s]) > 0.00001f )
+			{
+				LOG->Warn( "Fail: seeking to %i with the index gave different samples from frame %i",
+					iFrame, iFrame + s/iChannels );
+				bFailed = true;
+				break;
+			}
+		}
+	}
+
+	return !bFailed;
+}
+
+int main( int argc, char *argv[] )
+{
+	test_handle_args( argc, argv );
+	test_init();
+
+	bool bFailed = false;
+	if( !CheckSeekTableRoundTrip() )
+		bFailed = true;
+	if( !CheckIndexedSeek() )
+		bFailed = true;
+
+	LOG->Info( bFailed? "Failed":"Passed" );
+
+	test_deinit();
+	exit( bFailed? 1:0 );
+}
+
+/*
+ * (c) 2026 Stepmania team
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, and/or sell copies of the Software, and to permit persons to
+ * whom the Software is furnished to do so, provided that the above
+ * copyright notice(s) and this permission notice appear in all copies of
+ * the Software and that both the above copyright notice(s) and this
+ * permission notice appear in supporting documentation.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT OF
+ * THIRD PARTY RIGHTS. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR HOLDERS
+ * INCLUDED IN THIS NOTICE BE LIABLE FOR ANY CLAIM, OR ANY SPECIAL INDIRECT
+ * OR CONSEQUENTIAL DAMAGES, OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS
+ * OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
@@ -79,6 +79,11 @@ void dump( const std::int16_t *buf, int samples )
 	printf( "\n" );
 }
 
+void dump( const std::uint16_t *buf, int samples )
+{
+	dump( (const std::int16_t *) buf, samples );
+}
+
 void dump( const float *buf, int samples )
 {
 	for( int i = 0; i < samples; ++i )
@@ -86,12 +91,12 @@ void dump( const float *buf, int samples )
 	printf( "\n" );
 }
 
-bool compare( const float *m1, const std::int16_t *m2, int iSamples )
+bool compare( const float *m1, const std::uint16_t *m2, int iSamples )
 {
 	for( int i = 0; i < iSamples; ++i )
 	{
 		std::int16_t iSample1 = std::lrint(m1[i]*32768);
-		if( iSample1 != m2[i] )
+		if( std::uint16_t(iSample1) != m2[i] )
 			return false;
 	}
 
@@ -258,7 +263,7 @@ const int TestDataSize = 2;
 /* Find "haystack" in "needle".  Start looking at "expect" and move outward; find
  * the closest. */
 void *xmemsearch( const float *haystack, std::size_t iHaystackSamples,
-		const std::int16_t *needle, std::size_t iNeedleSamples,
+		const std::uint16_t *needle, std::size_t iNeedleSamples,
 		int expect )
 {
 	if( !iNeedleSamples )
@@ -300,11 +305,11 @@ struct TestFile
 	/* The number of silent frames we expect: */
 	int SilentFrames;
 
-	/* The first two frames (four samples): */
-	std::int16_t initial[TestDataSize*2];
+	/* The first two frames (four samples), as the bits dump() prints: */
+	std::uint16_t initial[TestDataSize*2];
 
 	/* Frames of data half a second in: */
-	std::int16_t later[TestDataSize*2];
+	std::uint16_t later[TestDataSize*2];
 };
 const int channels = 2;
 
@@ -576,13 +581,17 @@ int main( int argc, char *argv[] )
 		{ NULL,							0, {0,0,0,0}, {0,0,0,0} }
 	};
 
+	bool bFailed = false;
 	for( int i = 0; files[i].fn; ++i )
 	{
 		if( !test_file( files[i], 0 ) )
+		{
 			LOG->Trace(" ");
+			bFailed = true;
+		}
 	}
 
 	test_deinit();
-	exit(0);
+	exit( bFailed? 1:0 );
 }
 
@@ -0,0 +1,125 @@
+/* Checks Steps::GenerateChartKey against the original string-building
+ * implementation on large synthetic charts, and times both.  Like the other
+ * tests, it has to be linked against the game objects. */
+#include "global.h"
+#include "test_misc.h"
+
+#include "CryptManager.h"
+#include "NoteData.h"
+#include "RageLog.h"
+#include "RageTimer.h"
+#include "RageUtil.h"
+#include "Steps.h"
+#include "TimingData.h"
+
+#include <sstream>
+
+static const int NUM_CHARTS = 50;
+static const int NUM_MEASURES = 400;
+static const int NUM_TRACKS = 8;
+
+/* The implementation GenerateChartKey replaced, minus the OpenMP sections it
+ * never actually ran with.  Keys already stored with scores were made by
+ * this, so the new one has to match it byte for byte. */
+static RString ReferenceChartKey( NoteData &nd, TimingData *td )
+{
+	nd.LogNonEmptyRows();
+	std::vector<int>& nerv = nd.GetNonEmptyRowVector();
+	RString firstHalf, secondHalf;
+	for( std::size_t r = 0; r < nerv.size() / 2; r++ )
+	{
+		int row = nerv[r];
+		for( int t = 0; t < nd.GetNumTracks(); ++t )
+		{
+			std::ostringstream os;
+			os << nd.GetTapNote(t, row).type;
+			firstHalf.append( os.str() );
+		}
+		std::ostringstream os;
+		os << static_cast<int>(td->GetBPMAtRow(row) + 0.374643f);
+		firstHalf.append( os.str() );
+	}
+	for( std::size_t r = nerv.size() / 2; r < nerv.size(); r++ )
+	{
+		int row = nerv[r];
+		for( int t = 0; t < nd.GetNumTracks(); ++t )
+		{
+			std::ostringstream os;
+			os << nd.GetTapNote(t, row).type;
+			secondHalf.append( os.str() );
+		}
+		std::ostringstream os;
+		os << static_cast<int>(td->GetBPMAtRow(row) + 0.374643f);
+		firstHalf.append( os.str() );
+	}
+	return "X" + BinaryToHex( CryptManager::GetSHA1ForString(firstHalf + secondHalf) );
+}
+
+int main( int argc, char *argv[] )
+{
+	test_handle_args( argc, argv );
+	test_init();
+
+	std::vector<NoteData> vCharts( NUM_CHARTS );
+	std::vector<TimingData> vTiming( NUM_CHARTS );
+	for( int i = 0; i < NUM_CHARTS; ++i )
+	{
+		RandomGen rnd( i+1 );
+		test_make_chart( vCharts[i], NUM_TRACKS, NUM_MEASURES, rnd );
+		// Chart 0 has no timing segments at all; the rest change BPM often.
+		if( i != 0 )
+			test_make_timing( vTiming[i], NUM_MEASURES*4*ROWS_PER_BEAT, NUM_MEASURES, rnd );
+	}
+
+	Steps steps( nullptr );
+	std::vector<RString> vsReference( NUM_CHARTS ), vsKeys( NUM_CHARTS );
+
+	RageTimer timer;
+	for( int i = 0; i < NUM_CHARTS; ++i )
+		vsReference[i] = ReferenceChartKey( vCharts[i], &vTiming[i] );
+	const float fReferenceSeconds = timer.GetDeltaTime();
+
+	for( int i = 0; i < NUM_CHARTS; ++i )
+		vsKeys[i] = steps.GenerateChartKey( vCharts[i], &vTiming[i] );
+	const float fSeconds = timer.GetDeltaTime();
+
+	for( int i = 0; i < NUM_CHARTS; ++i )
+	{
+		if( vsKeys[i] != vsReference[i] )
+		{
+			LOG->Warn( "Chart %i: key %s, expected %s", i, vsKeys[i].c_str(), vsReference[i].c_str() );
+			exit(1);
+		}
+	}
+
+	LOG->Info( "%i charts: reference %.3fs, GenerateChartKey %.3fs (%.1fx)", NUM_CHARTS,
+		fReferenceSeconds, fSeconds, fSeconds > 0? fReferenceSeconds/fSeconds : 0.0f );
+
+	test_deinit();
+	exit(0);
+}
+
+/*
+ * (c) 2026 Stepmania team
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, and/or sell copies of the Software, and to permit persons to
+ * whom the Software is furnished to do so, provided that the above
+ * copyright notice(s) and this permission notice appear in all copies of
+ * the Software and that both the above copyright notice(s) and this
+ * permission notice appear in supporting documentation.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT OF
+ * THIRD PARTY RIGHTS. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR HOLDERS
+ * INCLUDED IN THIS NOTICE BE LIABLE FOR ANY CLAIM, OR ANY SPECIAL INDIRECT
+ * OR CONSEQUENTIAL DAMAGES, OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS
+ * OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
@@ -0,0 +1,175 @@
+/* Checks CompiledNoteData::RecompileRange after attacks transform part of a
+ * chart, the way Player::ApplyWaitingTransforms uses it, on random charts,
+ * ranges and transforms.  The result has to match compiling the transformed
+ * chart from scratch, and every compiled note has to point at the note on
+ * its track and row.  It exits nonzero if any don't.
+ *
+ * Build it both with and without WITH_FLAT_NOTE_DATA: flat storage moves
+ * notes that the transform didn't touch.  Like the other tests, it has to be
+ * linked against the game objects. */
+#include "global.h"
+#include "test_misc.h"
+
+#include "CompiledNoteData.h"
+#include "NoteData.h"
+#include "NoteDataUtil.h"
+#include "PlayerOptions.h"
+#include "PrefsManager.h"
+#include "RageLog.h"
+#include "RageUtil.h"
+#include "TimingData.h"
+
+static const int NUM_CHARTS = 1000;
+static const int NUM_MEASURES = 32;
+static const int NUM_TRACKS = 8;
+
+static bool CheckCompiled( const CompiledNoteData &compiled, NoteData &nd, const TimingData &timing )
+{
+	CompiledNoteData expected;
+	expected.Compile( nd, timing );
+	if( compiled.size() != expected.size() )
+	{
+		LOG->Warn( "%i notes compiled, expected %i", int(compiled.size()), int(expected.size()) );
+		return false;
+	}
+
+	for( std::size_t i = 0; i < compiled.size(); ++i )
+	{
+		const int iTrack = compiled.GetTrack( i );
+		const int iRow = compiled.GetRow( i );
+		bool bSame = iTrack == expected.GetTrack(i) && iRow == expected.GetRow(i) &&
+			compiled.GetSeconds(i, 0) == expected.GetSeconds(i, 0);
+		for( int iFlag : { CompiledNoteData::NOTE_JUDGABLE, CompiledNoteData::NOTE_STEPPABLE, CompiledNoteData::NOTE_TAP_OR_HOLD_HEAD } )
+			bSame &= compiled.HasFlag(i, iFlag) == expected.HasFlag(i, iFlag);
+		if( !bSame )
+		{
+			LOG->Warn( "Note %i (track %i, row %i) doesn't match", int(i), iTrack, iRow );
+			return false;
+		}
+
+		NoteData::iterator it = nd.FindTapNote( iTrack, iRow );
+		if( it == nd.end(iTrack) || &compiled.GetTapNote(i) != &it->second )
+		{
+			LOG->Warn( "Note %i (track %i, row %i) doesn't point at the note there", int(i), iTrack, iRow );
+			return false;
+		}
+	}
+	return true;
+}
+
+/* Transforms that remove, add and move notes, a few at a time. */
+static void MakeAttack( PlayerOptions &po, RandomGen &rnd )
+{
+	const PlayerOptions::Transform aTransforms[] =
+	{
+		PlayerOptions::TRANSFORM_LITTLE,
+		PlayerOptions::TRANSFORM_NOHOLDS,
+		PlayerOptions::TRANSFORM_NOMINES,
+		PlayerOptions::TRANSFORM_NOJUMPS,
+		PlayerOptions::TRANSFORM_MINES,
+		PlayerOptions::TRANSFORM_ECHO,
+		PlayerOptions::TRANSFORM_WIDE,
+		PlayerOptions::TRANSFORM_BIG,
+		PlayerOptions::TRANSFORM_QUICK,
+		PlayerOptions::TRANSFORM_STOMP,
+	};
+	for( PlayerOptions::Transform tr : aTransforms )
+		po.m_bTransforms[tr] = rnd() % 4 == 0;
+	const PlayerOptions::Turn aTurns[] =
+	{
+		PlayerOptions::TURN_MIRROR,
+		PlayerOptions::TURN_LEFT,
+		PlayerOptions::TURN_RIGHT,
+	};
+	po.m_bTurns[aTurns[rnd() % ARRAYLEN(aTurns)]] = rnd() % 2 == 0;
+}
+
+static bool CheckAttacks( NoteData &nd, const TimingData &timing, RandomGen &rnd )
+{
+	CompiledNoteData compiled;
+	compiled.Compile( nd, timing );
+
+	const int iLastRow = NUM_MEASURES*ROWS_PER_BEAT*4;
+	for( int iAttack = 0; iAttack < 4; ++iAttack )
+	{
+		PlayerOptions po;
+		MakeAttack( po, rnd );
+		const int iStartRow = rnd() % iLastRow;
+		const int iEndRow = iStartRow + rnd() % (iLastRow - iStartRow + 1);
+
+		// Player pads the range for Echo, which lays notes past it.  Leave
+		// that out sometimes, so that compiling everything when notes past
+		// the range changed is checked too.
+		const int iPad = rnd() % 2? ROWS_PER_BEAT:0;
+		int iPatchStart = std::max( iStartRow - iPad, 0 ), iPatchEnd = iEndRow + iPad;
+		CompiledNoteData::WidenRangeOverHolds( nd, iPatchStart, iPatchEnd );
+		NoteDataUtil::TransformNoteData( nd, timing, po, StepsType_dance_double, iStartRow, iEndRow );
+		CompiledNoteData::WidenRangeOverHolds( nd, iPatchStart, iPatchEnd );
+
+		std::size_t iCursor = compiled.size()? rnd() % compiled.size():0;
+		compiled.RecompileRange( nd, timing, iPatchStart, iPatchEnd+1, { &iCursor } );
+		if( iCursor > compiled.size() || !CheckCompiled(compiled, nd, timing) )
+		{
+			LOG->Warn( "Attack \"%s\" from %i to %i", po.GetString().c_str(), iStartRow, iEndRow );
+			return false;
+		}
+	}
+	return true;
+}
+
+int main( int argc, char *argv[] )
+{
+	test_handle_args( argc, argv );
+	test_init();
+	// PlayerOptions reads its defaults from the preferences.
+	PREFSMAN = new PrefsManager;
+
+	RandomGen rnd( 1 );
+	for( int i = 0; i < NUM_CHARTS; ++i )
+	{
+		NoteData nd;
+		TimingData timing;
+		test_make_chart( nd, NUM_TRACKS, NUM_MEASURES, rnd );
+		test_make_timing( timing, NUM_MEASURES*ROWS_PER_BEAT*4, 16, rnd );
+		if( !CheckAttacks(nd, timing, rnd) )
+		{
+			LOG->Warn( "Chart %i failed", i );
+			exit(1);
+		}
+	}
+
+#if defined(WITH_FLAT_NOTE_DATA)
+	LOG->Info( "%i charts match with FlatMap note storage", NUM_CHARTS );
+#else
+	LOG->Info( "%i charts match with std::map note storage", NUM_CHARTS );
+#endif
+
+	delete PREFSMAN;
+	test_deinit();
+	exit(0);
+}
+
+/*
+ * (c) 2026 Stepmania team
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, and/or sell copies of the Software, and to permit persons to
+ * whom the Software is furnished to do so, provided that the above
+ * copyright notice(s) and this permission notice appear in all copies of
+ * the Software and that both the above copyright notice(s) and this
+ * permission notice appear in supporting documentation.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT OF
+ * THIRD PARTY RIGHTS. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR HOLDERS
+ * INCLUDED IN THIS NOTICE BE LIABLE FOR ANY CLAIM, OR ANY SPECIAL INDIRECT
+ * OR CONSEQUENTIAL DAMAGES, OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS
+ * OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
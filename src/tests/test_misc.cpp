@@ -1,9 +1,11 @@
 #include "global.h"
 #include "test_misc.h"
 
+#include "NoteData.h"
 #include "RageFileManager.h"
 #include "RageLog.h"
 #include "RageUtil.h"
+#include "TimingData.h"
 #include "arch/ArchHooks/ArchHooks.h"
 
 RString g_Driver = "dir", g_Root = ".";
@@ -62,4 +64,70 @@ void test_deinit()
 	delete HOOKS;
 }
 
+void test_make_chart( NoteData &nd, int iTracks, int iMeasures, RandomGen &rnd )
+{
+	static const int SPACINGS[] = { 48, 24, 16, 12, 8, 6, 4, 3, 1 };
+	nd.SetNumTracks( iTracks );
+	std::vector<int> vNextFreeRow( iTracks, 0 );
+	for( int m = 0; m < iMeasures; ++m )
+	{
+		const int iSpacing = SPACINGS[rnd() % ARRAYLEN(SPACINGS)];
+		for( int row = m*ROWS_PER_BEAT*4; row < (m+1)*ROWS_PER_BEAT*4; row += iSpacing )
+		{
+			if( rnd() % 2 )
+				continue;
+
+			// One note, or now and then a jump.
+			const int iNotes = rnd() % 8 == 0? 2:1;
+			for( int n = 0; n < iNotes; ++n )
+			{
+				const int iTrack = rnd() % iTracks;
+				if( row < vNextFreeRow[iTrack] )
+					continue;
 
+				TapNote tn;
+				switch( rnd() % 10 )
+				{
+				case 0: tn = TAP_ORIGINAL_HOLD_HEAD; break;
+				case 1: tn = TAP_ORIGINAL_ROLL_HEAD; break;
+				case 2: tn = TAP_ORIGINAL_MINE; break;
+				case 3: tn = TAP_ORIGINAL_LIFT; break;
+				case 4: tn = TAP_ORIGINAL_FAKE; break;
+				case 5: tn = TAP_ORIGINAL_AUTO_KEYSOUND; tn.iKeysoundIndex = rnd() % 100; break;
+				case 6: tn = TAP_ORIGINAL_TAP; tn.iKeysoundIndex = rnd() % 100; break;
+				default: tn = TAP_ORIGINAL_TAP; break;
+				}
+
+				if( tn.type == TapNoteType_HoldHead )
+				{
+					const int iEndRow = row + 1 + rnd() % (ROWS_PER_BEAT*8);
+					nd.AddHoldNote( iTrack, row, iEndRow, tn );
+					vNextFreeRow[iTrack] = iEndRow + 1;
+				}
+				else
+				{
+					nd.SetTapNote( iTrack, row, tn );
+					vNextFreeRow[iTrack] = row + 1;
+				}
+			}
+		}
+	}
+}
+
+void test_make_timing( TimingData &td, int iLastRow, int iSegments, RandomGen &rnd )
+{
+	td.AddSegment( BPMSegment(0, 150) );
+	for( int i = 0; i < iSegments; ++i )
+	{
+		// Never on row 0, so the starting BPM stays.
+		const int iRow = rnd() % (iLastRow/12) * 12 + 12;
+		switch( rnd() % 8 )
+		{
+		case 0: td.AddSegment( StopSegment(iRow, rnd() % 1000 / 1000.0f) ); break;
+		case 1: td.AddSegment( DelaySegment(iRow, rnd() % 1000 / 1000.0f) ); break;
+		case 2: td.AddSegment( WarpSegment(iRow, int(rnd() % 200)) ); break;
+		case 3: td.AddSegment( FakeSegment(iRow, int(rnd() % (ROWS_PER_BEAT*4))) ); break;
+		default: td.AddSegment( BPMSegment(iRow, 60.0f + rnd() % 300) ); break;
+		}
+	}
+}
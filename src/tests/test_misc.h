@@ -1,8 +1,22 @@
 #ifndef TEST_HELPERS_H
 #define TEST_HELPERS_H
 
+#include "RageUtil.h"
+
+class NoteData;
+class TimingData;
+
 void test_handle_args( int argc, char *argv[] );
 void test_init();
 void test_deinit();
+
+/* Fill nd with iMeasures measures of random notes on iTracks tracks.  Each
+ * measure is spaced by one of the SM quantizations, and has every kind of
+ * note, jumps, and holds and rolls of up to two measures, which don't overlap
+ * anything else on their track. */
+void test_make_chart( NoteData &nd, int iTracks, int iMeasures, RandomGen &rnd );
+/* Start td at 150 BPM, then add iSegments BPM changes, stops, delays, warps
+ * and fakes on 16ths up to iLastRow. */
+void test_make_timing( TimingData &td, int iLastRow, int iSegments, RandomGen &rnd );
 	
 #endif
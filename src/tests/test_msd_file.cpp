@@ -0,0 +1,242 @@
+/* Checks that MsdFile, which points its parameters into the text it read,
+ * reads every value and parameter the same as the parser it replaced, which
+ * copied each parameter into a string of its own.  Like the other tests, it
+ * has to be linked against the game objects. */
+#include "global.h"
+#include "test_misc.h"
+
+#include "MsdFile.h"
+#include "RageLog.h"
+#include "RageUtil.h"
+
+#include <vector>
+
+static const int NUM_RANDOM_TEXTS = 200000;
+
+typedef std::vector<std::vector<RString>> Values;
+
+/* The original MsdFile::ReadBuf, with AddValue and AddParam filled in. */
+static void ReferenceReadBuf( const char *buf, int len, bool bUnescape, Values &values )
+{
+	bool ReadingValue=false;
+	int i = 0;
+	std::vector<char> vProcessed( len + 1 );
+	char *cProcessed = vProcessed.data();
+	int iProcessedLen = -1;
+	while( i < len )
+	{
+		if( i+1 < len && buf[i] == '/' && buf[i+1] == '/' )
+		{
+			/* Skip a comment entirely; don't copy the comment to the value/parameter */
+			do
+			{
+				i++;
+			} while( i < len && buf[i] != '\n' );
+
+			continue;
+		}
+
+		if( ReadingValue && buf[i] == '#' )
+		{
+			/* Make sure this # is the first non-whitespace character on the line. */
+			bool FirstChar = true;
+			int j = iProcessedLen;
+			while( j > 0 && cProcessed[j - 1] != '\r' && cProcessed[j - 1] != '\n' )
+			{
+				if( cProcessed[j - 1] == ' ' || cProcessed[j - 1] == '\t' )
+				{
+					--j;
+					continue;
+				}
+
+				FirstChar = false;
+				break;
+			}
+
+			if( !FirstChar )
+			{
+				/* We're not the first char on a line.  Treat it as if it were a normal character. */
+				cProcessed[iProcessedLen++] = buf[i++];
+				continue;
+			}
+
+			/* Skip newlines and whitespace before adding the value. */
+			iProcessedLen = j;
+			while( iProcessedLen > 0 &&
+			       ( cProcessed[iProcessedLen - 1] == '\r' || cProcessed[iProcessedLen - 1] == '\n' ||
+			         cProcessed[iProcessedLen - 1] == ' ' || cProcessed[iProcessedLen - 1] == '\t' ) )
+				--iProcessedLen;
+
+			values.back().push_back( RString(cProcessed, iProcessedLen) );
+			iProcessedLen = 0;
+			ReadingValue=false;
+		}
+
+		/* # starts a new value. */
+		if( !ReadingValue && buf[i] == '#' )
+		{
+			values.push_back( std::vector<RString>() );
+			ReadingValue=true;
+		}
+
+		if( !ReadingValue )
+		{
+			if( bUnescape && buf[i] == '\\' )
+				i += 2;
+			else
+				++i;
+			continue; /* nothing else is meaningful outside of a value */
+		}
+
+		/* : and ; end the current param, if any. */
+		if( iProcessedLen != -1 && (buf[i] == ':' || buf[i] == ';') )
+			values.back().push_back( RString(cProcessed, iProcessedLen) );
+
+		/* # and : begin new params. */
+		if( buf[i] == '#' || buf[i] == ':' )
+		{
+			++i;
+			iProcessedLen = 0;
+			continue;
+		}
+
+		/* ; ends the current value. */
+		if( buf[i] == ';' )
+		{
+			ReadingValue=false;
+			++i;
+			continue;
+		}
+
+		/* An escaped character, or a regular one. */
+		if( buf[i] == '\\' && i < len )
+		{
+			if( bUnescape )
+				++i;
+			else
+				cProcessed[iProcessedLen++] = buf[i++];
+		}
+
+		if( i < len )
+			cProcessed[iProcessedLen++] = buf[i++];
+	}
+
+	/* Add any unterminated value at the very end. */
+	if( ReadingValue )
+		values.back().push_back( RString(cProcessed, iProcessedLen) );
+}
+
+static RString Printable( const RString &s )
+{
+	RString sRet = s;
+	sRet.Replace( "\r", "\\r" );
+	sRet.Replace( "\n", "\\n" );
+	sRet.Replace( "\t", "\\t" );
+	return sRet;
+}
+
+static bool CheckText( const RString &sText, bool bUnescape )
+{
+	Values expected;
+	ReferenceReadBuf( sText.data(), sText.size(), bUnescape, expected );
+
+	MsdFile msd;
+	msd.ReadFromString( sText, bUnescape );
+
+	bool bSame = msd.GetNumValues() == expected.size();
+	for( unsigned v = 0; bSame && v < expected.size(); ++v )
+	{
+		bSame = msd.GetNumParams(v) == expected[v].size();
+		for( unsigned p = 0; bSame && p < expected[v].size(); ++p )
+			bSame = msd.GetParam(v, p) == expected[v][p];
+	}
+	if( !bSame )
+		LOG->Warn( "Fail: \"%s\" (unescape %i) read differently", Printable(sText).c_str(), bUnescape );
+	return bSame;
+}
+
+int main( int argc, char *argv[] )
+{
+	test_handle_args( argc, argv );
+	test_init();
+
+	static const char *TEXTS[] = {
+		/* Escapes. */
+		"#TITLE:Foo\\#Bar\\:Baz\\;Qux;\n",
+		"#TITLE:Back\\\\slash;\n#ARTIST:Trailing\\",
+		"\\#NOTATAG;\n#TITLE:Foo;",
+		/* Comments. */
+		"// header\n#TITLE:Foo; // after\n#ARTIST:Bar // inside\n;\n",
+		"#TITLE:a/b//c\n:d;",
+		"#TITLE:Foo;\n// comment at the end",
+		/* # in the middle of a line. */
+		"#NOTES:a#b:c#d;\n",
+		"#TITLE:Foo #1;\n#ARTIST:Bar;",
+		/* A missing ;. */
+		"#TITLE:Foo\n#ARTIST:Bar;\n",
+		"#TITLE:Foo  \r\n \t#ARTIST:Bar\r\n\r\n#BPMS:0=120;",
+		"#NOTES:\n     dance-single:\n     :\n     Beginner:\n     1:\n     0,0,0,0,0:\n0000\n1000\n,\n#TITLE:Next;",
+		/* A value at the end of the file, without a trailing newline. */
+		"#TITLE:Foo;\n#ARTIST:Bar",
+		"#TITLE:Foo;\n#ARTIST:",
+		"#TITLE",
+		"#",
+		"",
+	};
+
+	bool bFailed = false;
+	for( const char *szText : TEXTS )
+	{
+		for( int u = 0; u < 2; ++u )
+		{
+			if( !CheckText(szText, u == 1) )
+				bFailed = true;
+		}
+	}
+
+	/* Everything else, mixed at random. */
+	static const char ALPHABET[] = "#:;/\\\n\r \tab";
+	RandomGen rnd( 1 );
+	for( int i = 0; i < NUM_RANDOM_TEXTS && !bFailed; ++i )
+	{
+		RString sText;
+		const int iLength = rnd() % 40;
+		for( int c = 0; c < iLength; ++c )
+			sText += ALPHABET[rnd() % (ARRAYLEN(ALPHABET)-1)];
+		for( int u = 0; u < 2; ++u )
+		{
+			if( !CheckText(sText, u == 1) )
+				bFailed = true;
+		}
+	}
+
+	LOG->Info( bFailed? "Failed":"Passed" );
+
+	test_deinit();
+	exit( bFailed? 1:0 );
+}
+
+/*
+ * (c) 2026 Stepmania team
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, and/or sell copies of the Software, and to permit persons to
+ * whom the Software is furnished to do so, provided that the above
+ * copyright notice(s) and this permission notice appear in all copies of
+ * the Software and that both the above copyright notice(s) and this
+ * permission notice appear in supporting documentation.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT OF
+ * THIRD PARTY RIGHTS. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR HOLDERS
+ * INCLUDED IN THIS NOTICE BE LIABLE FOR ANY CLAIM, OR ANY SPECIAL INDIRECT
+ * OR CONSEQUENTIAL DAMAGES, OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS
+ * OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
@@ -0,0 +1,154 @@
+/* Times the std::map and FlatMap note storage against each other on a large
+ * synthetic chart, then times loading, radar values and gameplay-style
+ * iteration with whichever one NoteData was built with.  Like the other
+ * tests, it has to be linked against the game objects. */
+#include "global.h"
+#include "test_misc.h"
+
+#include "FlatMap.h"
+#include "NoteData.h"
+#include "NoteDataUtil.h"
+#include "RadarValues.h"
+#include "RageLog.h"
+#include "RageTimer.h"
+#include "RageUtil.h"
+
+#include <map>
+
+static const int NUM_MEASURES = 2000;
+static const int NUM_TRACKS = 4;
+static const int NUM_PASSES = 10;
+/* Gameplay looks at a few beats of notes each frame and moves on a little. */
+static const int VISIBLE_ROWS = ROWS_PER_BEAT * 8;
+static const int ROWS_PER_FRAME = ROWS_PER_BEAT / 8;
+
+template<typename Track>
+struct StorageTimes
+{
+	float m_fLoad = 0, m_fScan = 0, m_fWindow = 0;
+	int m_iChecksum = 0;
+
+	void Run( const NoteData &nd )
+	{
+		RageTimer timer;
+		std::vector<Track> vTracks;
+		for( int pass = 0; pass < NUM_PASSES; ++pass )
+		{
+			vTracks.assign( nd.GetNumTracks(), Track() );
+			for( int t = 0; t < nd.GetNumTracks(); ++t )
+				for( NoteData::const_iterator it = nd.begin(t); it != nd.end(t); ++it )
+					vTracks[t][it->first] = it->second;
+		}
+		m_fLoad = timer.GetDeltaTime();
+
+		int iChecksum = 0;
+		for( int pass = 0; pass < NUM_PASSES; ++pass )
+			for( Track const &track : vTracks )
+				for( auto const &note : track )
+					iChecksum += note.second.type + note.second.iDuration;
+		m_fScan = timer.GetDeltaTime();
+
+		const int iLastRow = nd.GetLastRow();
+		for( int row = 0; row < iLastRow; row += ROWS_PER_FRAME )
+		{
+			for( Track const &track : vTracks )
+			{
+				auto end = track.lower_bound( row + VISIBLE_ROWS );
+				for( auto it = track.lower_bound( row ); it != end; ++it )
+					iChecksum += it->first & 1;
+			}
+		}
+		m_fWindow = timer.GetDeltaTime();
+		m_iChecksum = iChecksum;
+	}
+};
+
+int main( int argc, char *argv[] )
+{
+	test_handle_args( argc, argv );
+	test_init();
+
+	NoteData nd;
+	RandomGen rnd( 1 );
+	test_make_chart( nd, NUM_TRACKS, NUM_MEASURES, rnd );
+	LOG->Info( "%i notes in %i measures", nd.GetNumTapNotes(), NUM_MEASURES );
+
+	StorageTimes<std::map<int,TapNote>> tree;
+	StorageTimes<FlatMap<int,TapNote>> flat;
+	tree.Run( nd );
+	flat.Run( nd );
+	if( tree.m_iChecksum != flat.m_iChecksum )
+	{
+		LOG->Warn( "Checksum mismatch: std::map %i, FlatMap %i", tree.m_iChecksum, flat.m_iChecksum );
+		exit(1);
+	}
+	LOG->Info( "std::map: load %.3fs, scan %.3fs, window %.3fs", tree.m_fLoad, tree.m_fScan, tree.m_fWindow );
+	LOG->Info( "FlatMap:  load %.3fs, scan %.3fs, window %.3fs", flat.m_fLoad, flat.m_fScan, flat.m_fWindow );
+
+#if defined(WITH_FLAT_NOTE_DATA)
+	LOG->Info( "NoteData is using FlatMap:" );
+#else
+	LOG->Info( "NoteData is using std::map:" );
+#endif
+	RString sNotes;
+	NoteDataUtil::GetSMNoteDataString( nd, sNotes );
+
+	RageTimer timer;
+	NoteData loaded;
+	for( int pass = 0; pass < NUM_PASSES; ++pass )
+	{
+		loaded.SetNumTracks( NUM_TRACKS );
+		NoteDataUtil::LoadFromSMNoteDataString( loaded, sNotes, false );
+	}
+	const float fLoadSeconds = timer.GetDeltaTime();
+	if( !(loaded == nd) )
+	{
+		LOG->Warn( "Loaded note data doesn't match the chart" );
+		exit(1);
+	}
+
+	RadarValues rv;
+	for( int pass = 0; pass < NUM_PASSES; ++pass )
+		NoteDataUtil::CalculateRadarValues( loaded, 600.0f, rv );
+	const float fRadarSeconds = timer.GetDeltaTime();
+
+	int iCount = 0;
+	const int iLastRow = loaded.GetLastRow();
+	for( int row = 0; row < iLastRow; row += ROWS_PER_FRAME )
+	{
+		NoteData::all_tracks_iterator iter = loaded.GetTapNoteRangeAllTracks( row, row + VISIBLE_ROWS );
+		for( ; !iter.IsAtEnd(); ++iter )
+			++iCount;
+	}
+	const float fIterateSeconds = timer.GetDeltaTime();
+	LOG->Info( "  load %.3fs, radar values %.3fs, all tracks iteration %.3fs (%i notes visited)",
+		fLoadSeconds, fRadarSeconds, fIterateSeconds, iCount );
+
+	test_deinit();
+	exit(0);
+}
+
+/*
+ * (c) 2026 Stepmania team
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, and/or sell copies of the Software, and to permit persons to
+ * whom the Software is furnished to do so, provided that the above
+ * copyright notice(s) and this permission notice appear in all copies of
+ * the Software and that both the above copyright notice(s) and this
+ * permission notice appear in supporting documentation.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT OF
+ * THIRD PARTY RIGHTS. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR HOLDERS
+ * INCLUDED IN THIS NOTICE BE LIABLE FOR ANY CLAIM, OR ANY SPECIAL INDIRECT
+ * OR CONSEQUENTIAL DAMAGES, OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS
+ * OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
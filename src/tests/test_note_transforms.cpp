@@ -0,0 +1,157 @@
+/* Checks the in-place note transforms against the copies they replaced, on
+ * random charts, ranges and options:
+ *
+ * NoteData::RemapTracks over a range has to give what LoadTransformed of the
+ * whole chart followed by CopyRange of the range back gave, and over the
+ * whole chart what LoadTransformed gave.
+ *
+ * TransformNoteData applies the one-note-at-a-time remove transforms in one
+ * walk, which has to give what calling each of them in turn gave.
+ *
+ * Like the other tests, it has to be linked against the game objects. */
+#include "global.h"
+#include "test_misc.h"
+
+#include "NoteData.h"
+#include "NoteDataUtil.h"
+#include "PlayerOptions.h"
+#include "PrefsManager.h"
+#include "RageLog.h"
+#include "RageUtil.h"
+#include "TimingData.h"
+
+static const int NUM_CHARTS = 3000;
+static const int NUM_MEASURES = 32;
+static const int NUM_TRACKS = 8;
+
+/* A range that's the whole chart a few times in ten, and otherwise starts
+ * and ends on any row. */
+static void MakeRange( RandomGen &rnd, int &iStartRow, int &iEndRow )
+{
+	if( rnd() % 10 < 2 )
+	{
+		iStartRow = 0;
+		iEndRow = MAX_NOTE_ROW;
+		return;
+	}
+	const int iLastRow = NUM_MEASURES*ROWS_PER_BEAT*4;
+	iStartRow = rnd() % iLastRow;
+	iEndRow = iStartRow + rnd() % (iLastRow - iStartRow + 1);
+}
+
+static bool CheckRemapTracks( const NoteData &original, RandomGen &rnd )
+{
+	// Any mapping, including tracks taken from twice and tracks left empty.
+	int iTakeFromTrack[NUM_TRACKS];
+	for( int t = 0; t < NUM_TRACKS; ++t )
+		iTakeFromTrack[t] = int(rnd() % (NUM_TRACKS+1)) - 1;
+	int iStartRow, iEndRow;
+	MakeRange( rnd, iStartRow, iEndRow );
+
+	NoteData expected;
+	expected.LoadTransformed( original, NUM_TRACKS, iTakeFromTrack );
+	if( iStartRow > 0 || iEndRow < MAX_NOTE_ROW )
+	{
+		NoteData transformed = expected;
+		expected = original;
+		expected.CopyRange( transformed, iStartRow, iEndRow, iStartRow );
+	}
+
+	NoteData actual = original;
+	actual.RemapTracks( iTakeFromTrack, iStartRow, iEndRow );
+	if( actual == expected )
+		return true;
+
+	LOG->Warn( "RemapTracks from %i to %i doesn't match", iStartRow, iEndRow );
+	return false;
+}
+
+static bool CheckPerNoteTransforms( const NoteData &original, const TimingData &timing, RandomGen &rnd )
+{
+	PlayerOptions po;
+	const PlayerOptions::Transform aTransforms[] =
+	{
+		PlayerOptions::TRANSFORM_LITTLE,
+		PlayerOptions::TRANSFORM_NOROLLS,
+		PlayerOptions::TRANSFORM_NOHOLDS,
+		PlayerOptions::TRANSFORM_NOMINES,
+		PlayerOptions::TRANSFORM_NOJUMPS,
+		PlayerOptions::TRANSFORM_NOLIFTS,
+		PlayerOptions::TRANSFORM_NOFAKES,
+	};
+	for( PlayerOptions::Transform tr : aTransforms )
+		po.m_bTransforms[tr] = rnd() % 2 == 0;
+	int iStartRow, iEndRow;
+	MakeRange( rnd, iStartRow, iEndRow );
+
+	// The order TransformNoteData applied them in, one at a time.
+	NoteData expected = original;
+	if( po.m_bTransforms[PlayerOptions::TRANSFORM_LITTLE] )	NoteDataUtil::Little( expected, iStartRow, iEndRow );
+	if( po.m_bTransforms[PlayerOptions::TRANSFORM_NOROLLS] )	NoteDataUtil::ChangeRollsToHolds( expected, iStartRow, iEndRow );
+	if( po.m_bTransforms[PlayerOptions::TRANSFORM_NOHOLDS] )	NoteDataUtil::RemoveHoldNotes( expected, iStartRow, iEndRow );
+	if( po.m_bTransforms[PlayerOptions::TRANSFORM_NOMINES] )	NoteDataUtil::RemoveMines( expected, iStartRow, iEndRow );
+	if( po.m_bTransforms[PlayerOptions::TRANSFORM_NOJUMPS] )	NoteDataUtil::RemoveJumps( expected, iStartRow, iEndRow );
+	if( po.m_bTransforms[PlayerOptions::TRANSFORM_NOLIFTS] )	NoteDataUtil::RemoveLifts( expected, iStartRow, iEndRow );
+	if( po.m_bTransforms[PlayerOptions::TRANSFORM_NOFAKES] )	NoteDataUtil::RemoveFakes( expected, timing, iStartRow, iEndRow );
+
+	NoteData actual = original;
+	NoteDataUtil::TransformNoteData( actual, timing, po, StepsType_dance_double, iStartRow, iEndRow );
+	if( actual == expected )
+		return true;
+
+	LOG->Warn( "TransformNoteData \"%s\" from %i to %i doesn't match", po.GetString().c_str(), iStartRow, iEndRow );
+	return false;
+}
+
+int main( int argc, char *argv[] )
+{
+	test_handle_args( argc, argv );
+	test_init();
+	// PlayerOptions reads its defaults from the preferences.
+	PREFSMAN = new PrefsManager;
+
+	RandomGen rnd( 1 );
+	for( int i = 0; i < NUM_CHARTS; ++i )
+	{
+		NoteData nd;
+		TimingData timing;
+		test_make_chart( nd, NUM_TRACKS, NUM_MEASURES, rnd );
+		test_make_timing( timing, NUM_MEASURES*ROWS_PER_BEAT*4, 16, rnd );
+		if( !CheckRemapTracks(nd, rnd) || !CheckPerNoteTransforms(nd, timing, rnd) )
+		{
+			LOG->Warn( "Chart %i failed", i );
+			exit(1);
+		}
+	}
+
+	LOG->Info( "%i charts match", NUM_CHARTS );
+
+	delete PREFSMAN;
+	test_deinit();
+	exit(0);
+}
+
+/*
+ * (c) 2026 Stepmania team
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, and/or sell copies of the Software, and to permit persons to
+ * whom the Software is furnished to do so, provided that the above
+ * copyright notice(s) and this permission notice appear in all copies of
+ * the Software and that both the above copyright notice(s) and this
+ * permission notice appear in supporting documentation.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT OF
+ * THIRD PARTY RIGHTS. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR HOLDERS
+ * INCLUDED IN THIS NOTICE BE LIABLE FOR ANY CLAIM, OR ANY SPECIAL INDIRECT
+ * OR CONSEQUENTIAL DAMAGES, OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS
+ * OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
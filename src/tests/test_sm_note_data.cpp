@@ -0,0 +1,120 @@
+/* Checks that NoteDataUtil::LoadFromSMNoteDataString reads back what
+ * GetSMNoteDataString writes, for every kind of note and quantization, and
+ * that line endings, comments and stray whitespace don't change what's read.
+ * Then times loading a large chart.  Like the other tests, it has to be
+ * linked against the game objects. */
+#include "global.h"
+#include "test_misc.h"
+
+#include "NoteData.h"
+#include "NoteDataUtil.h"
+#include "RageLog.h"
+#include "RageTimer.h"
+#include "RageUtil.h"
+
+#include <iterator>
+
+static const int NUM_MEASURES = 2000;
+static const int NUM_TRACKS = 4;
+static const int NUM_PASSES = 20;
+
+static bool CheckRoundTrip( const NoteData &nd, const RString &sName )
+{
+	RString sNotes;
+	NoteDataUtil::GetSMNoteDataString( nd, sNotes );
+
+	NoteData loaded;
+	loaded.SetNumTracks( nd.GetNumTracks() );
+	NoteDataUtil::LoadFromSMNoteDataString( loaded, sNotes, false );
+	if( loaded == nd )
+		return true;
+	LOG->Warn( "%s: loaded note data doesn't match what was written", sName.c_str() );
+	return false;
+}
+
+/* The same chart written differently has to load the same. */
+static bool CheckEquivalent( const RString &sExpected, const RString &sNotes, const char *szName )
+{
+	NoteData expected, loaded;
+	expected.SetNumTracks( NUM_TRACKS );
+	loaded.SetNumTracks( NUM_TRACKS );
+	NoteDataUtil::LoadFromSMNoteDataString( expected, sExpected, false );
+	NoteDataUtil::LoadFromSMNoteDataString( loaded, sNotes, false );
+	if( loaded == expected )
+		return true;
+	LOG->Warn( "%s: loaded note data doesn't match", szName );
+	return false;
+}
+
+int main( int argc, char *argv[] )
+{
+	test_handle_args( argc, argv );
+	test_init();
+
+	bool bPassed = true;
+	for( int iSeed = 1; iSeed <= 20; ++iSeed )
+	{
+		NoteData nd;
+		RandomGen rnd( iSeed );
+		test_make_chart( nd, NUM_TRACKS, 64, rnd );
+		bPassed &= CheckRoundTrip( nd, ssprintf("chart %i", iSeed) );
+	}
+
+	const RString sPlain = "1000\n0000\n0200\n0000\n,\n0300\n0M00\n0010\n000K[5]\n";
+	bPassed &= CheckEquivalent( sPlain, "1000\r\n0000\r\n0200\r\n0000\r\n,\r\n0300\r\n0M00\r\n0010\r\n000K[5]\r\n", "CRLF" );
+	bPassed &= CheckEquivalent( sPlain, "  // measure 0\n1000\n0000  \n\t0200\n\n0000\n,  // measure 1\n0300\n0M00\n0010\n000K[5]", "comments and whitespace" );
+	// ",," is read as one comma, not as an empty measure.
+	bPassed &= CheckEquivalent( "1000\n,\n0000\n,\n0100\n", "1000\n,,\n0000\n,\n0100\n", "doubled comma" );
+	if( !bPassed )
+		exit(1);
+	LOG->Info( "Round trips passed" );
+
+	NoteData nd;
+	RandomGen rnd( 1 );
+	test_make_chart( nd, NUM_TRACKS, NUM_MEASURES, rnd );
+	RString sNotes;
+	NoteDataUtil::GetSMNoteDataString( nd, sNotes );
+
+	// GetNumTapNotes asks the game state about the timing, so count them here.
+	int iNotes = 0;
+	for( int t = 0; t < nd.GetNumTracks(); ++t )
+		iNotes += std::distance( nd.begin(t), nd.end(t) );
+
+	RageTimer timer;
+	NoteData loaded;
+	loaded.SetNumTracks( NUM_TRACKS );
+	for( int pass = 0; pass < NUM_PASSES; ++pass )
+		NoteDataUtil::LoadFromSMNoteDataString( loaded, sNotes, false );
+	const float fSeconds = timer.GetDeltaTime();
+	LOG->Info( "Loaded %i notes in %i measures (%i bytes) %i times in %.3fs, %.0f notes per second",
+		iNotes, NUM_MEASURES, int(sNotes.size()), NUM_PASSES, fSeconds,
+		iNotes * NUM_PASSES / fSeconds );
+
+	test_deinit();
+	exit(0);
+}
+
+/*
+ * (c) 2026 Stepmania team
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, and/or sell copies of the Software, and to permit persons to
+ * whom the Software is furnished to do so, provided that the above
+ * copyright notice(s) and this permission notice appear in all copies of
+ * the Software and that both the above copyright notice(s) and this
+ * permission notice appear in supporting documentation.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT OF
+ * THIRD PARTY RIGHTS. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR HOLDERS
+ * INCLUDED IN THIS NOTICE BE LIABLE FOR ANY CLAIM, OR ANY SPECIAL INDIRECT
+ * OR CONSEQUENTIAL DAMAGES, OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS
+ * OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
@@ -0,0 +1,189 @@
+/* Round-trip check and load benchmark for the song caches.  This writes a
+ * synthetic library of songs as both SSC text cache files and binary cache
+ * records, then times loading each of them back.  Like the other tests, it
+ * has to be linked against the game objects. */
+#include "global.h"
+#include "test_misc.h"
+
+#include "GameManager.h"
+#include "NoteData.h"
+#include "NoteDataUtil.h"
+#include "NotesLoaderSSC.h"
+#include "NotesWriterSSC.h"
+#include "PrefsManager.h"
+#include "RageFileDriverDeflate.h"
+#include "RageFileManager.h"
+#include "RageLog.h"
+#include "RageTimer.h"
+#include "RageUtil.h"
+#include "Song.h"
+#include "SongCacheBinary.h"
+#include "Steps.h"
+
+static const int NUM_SONGS = 10000;
+static const int NUM_CHARTS = 5;
+static const int NUM_MEASURES = 120;
+
+static void MakeSong( Song &song, int iSong )
+{
+	song.SetSongDir( ssprintf("/Songs/Bench/Song %05d/", iSong) );
+	song.m_sSongFileName = song.GetSongDir() + "song.ssc";
+	song.m_sMainTitle = ssprintf( "Benchmark Song %05d", iSong );
+	song.m_sArtist = "Synthetic";
+	song.m_sMusicFile = "song.ogg";
+	song.m_sBannerFile = "bn.png";
+	song.m_fMusicLengthSeconds = 120;
+	song.m_bHasMusic = true;
+	song.m_SongTiming.m_fBeat0OffsetInSeconds = -0.01f * (iSong % 7);
+	song.m_SongTiming.AddSegment( BPMSegment(0, 120 + iSong % 60) );
+	song.m_SongTiming.AddSegment( BPMSegment(BeatToNoteRow(64), 180) );
+	song.m_SongTiming.AddSegment( StopSegment(BeatToNoteRow(128), 0.5f) );
+	song.m_SongTiming.AddSegment( TimeSignatureSegment(0, 4, 4) );
+	song.m_SongTiming.AddSegment( LabelSegment(0, "Song Start") );
+
+	RandomGen rnd( iSong+1 );
+	for( int c = 0; c < NUM_CHARTS; ++c )
+	{
+		Steps *pSteps = song.CreateSteps();
+		pSteps->m_StepsType = StepsType_dance_single;
+		pSteps->m_StepsTypeStr = "dance-single";
+		pSteps->SetDifficulty( Difficulty(c) );
+		pSteps->SetMeter( 2 + c*3 );
+		pSteps->SetFilename( song.m_sSongFileName );
+
+		NoteData nd;
+		test_make_chart( nd, 4, NUM_MEASURES, rnd );
+		pSteps->SetNoteData( nd );
+		pSteps->CalculateRadarValues( song.m_fMusicLengthSeconds );
+		song.AddSteps( pSteps );
+	}
+	song.SetFirstSecond( 0 );
+	song.SetLastSecond( song.m_SongTiming.GetElapsedTimeFromBeat(NUM_MEASURES*4) );
+}
+
+/* Binary cache records leave note data where it is; read it back from the
+ * record the song was loaded from, the way LoadNoteData reads it from the
+ * database. */
+static bool ReadCachedNoteData( const RString &sRecord, const Steps &steps, NoteData &out )
+{
+	const Steps::CachedNoteData &cached = steps.GetCachedNoteData();
+	if( cached.m_iSize == 0 || cached.m_iOffset + cached.m_iSize > sRecord.size() )
+		return false;
+	RString sNoteData, sError;
+	if( !GunzipString(sRecord.substr(cached.m_iOffset, cached.m_iSize), sNoteData, sError) ||
+		sNoteData.size() != cached.m_iRawSize )
+		return false;
+	NoteDataUtil::LoadFromSMNoteDataString( out, sNoteData, false );
+	return true;
+}
+
+static bool SameSong( const Song &a, const Song &b, const RString &sRecord )
+{
+#define CHECK(x) if( !(x) ) { LOG->Warn( "Line %i: %s failed for \"%s\"", __LINE__, #x, a.m_sMainTitle.c_str() ); return false; }
+	CHECK( a.m_sMainTitle == b.m_sMainTitle );
+	CHECK( a.m_sMusicFile == b.m_sMusicFile );
+	CHECK( a.GetLastSecond() == b.GetLastSecond() );
+	CHECK( a.m_SongTiming.m_fBeat0OffsetInSeconds == b.m_SongTiming.m_fBeat0OffsetInSeconds );
+	CHECK( a.m_SongTiming == b.m_SongTiming );
+	CHECK( a.m_SongTiming.GetBPMAtBeat(100) == b.m_SongTiming.GetBPMAtBeat(100) );
+	CHECK( a.GetAllSteps().size() == b.GetAllSteps().size() );
+	for( unsigned i = 0; i < a.GetAllSteps().size(); ++i )
+	{
+		const Steps *sa = a.GetAllSteps()[i], *sb = b.GetAllSteps()[i];
+		CHECK( sa->m_StepsType == sb->m_StepsType );
+		CHECK( sa->GetDifficulty() == sb->GetDifficulty() );
+		CHECK( sa->GetMeter() == sb->GetMeter() );
+		CHECK( sa->GetFilename() == sb->GetFilename() );
+		FOREACH_ENUM( RadarCategory, rc )
+			CHECK( sa->GetRadarValues(PLAYER_1)[rc] == sb->GetRadarValues(PLAYER_1)[rc] );
+		CHECK( sa->m_Timing == sb->m_Timing );
+
+		NoteData nda, ndb;
+		sa->GetNoteData( nda );
+		ndb.SetNumTracks( nda.GetNumTracks() );
+		CHECK( ReadCachedNoteData(sRecord, *sb, ndb) );
+		RString sNotesA, sNotesB;
+		NoteDataUtil::GetSMNoteDataString( nda, sNotesA );
+		NoteDataUtil::GetSMNoteDataString( ndb, sNotesB );
+		CHECK( sNotesA == sNotesB );
+	}
+#undef CHECK
+	return true;
+}
+
+int main( int argc, char *argv[] )
+{
+	test_handle_args( argc, argv );
+	test_init();
+	PREFSMAN = new PrefsManager;
+	GAMEMAN = new GameManager;
+
+	LOG->Trace( "Writing %i songs...", NUM_SONGS );
+	for( int i = 0; i < NUM_SONGS; ++i )
+	{
+		Song song;
+		MakeSong( song, i );
+		const RString sBase = ssprintf( "/Cache/Bench/%05d", i );
+		NotesWriterSSC::Write( sBase + ".ssc", song, song.GetAllSteps(), true );
+		SongCacheBinary::SaveToFile( sBase + ".bin", song, song.GetAllSteps() );
+
+		Song copy;
+		RString sRecord;
+		GetFileContents( sBase + ".bin", sRecord );
+		if( !SongCacheBinary::LoadFromFile(sBase + ".bin", copy) || !SameSong(song, copy, sRecord) )
+		{
+			LOG->Warn( "Binary cache round trip failed for song %i", i );
+			exit(1);
+		}
+	}
+	FILEMAN->FlushDirCache();
+
+	RageTimer timer;
+	for( int i = 0; i < NUM_SONGS; ++i )
+	{
+		Song song;
+		SSCLoader loader;
+		loader.LoadFromSimfile( ssprintf("/Cache/Bench/%05d.ssc", i), song, true );
+	}
+	const float fTextSeconds = timer.GetDeltaTime();
+
+	for( int i = 0; i < NUM_SONGS; ++i )
+	{
+		Song song;
+		SongCacheBinary::LoadFromFile( ssprintf("/Cache/Bench/%05d.bin", i), song );
+	}
+	const float fBinarySeconds = timer.GetDeltaTime();
+
+	LOG->Info( "%i songs: SSC cache %.3fs, binary cache %.3fs (%.1fx)", NUM_SONGS,
+		fTextSeconds, fBinarySeconds, fBinarySeconds > 0? fTextSeconds/fBinarySeconds : 0.0f );
+
+	delete GAMEMAN;
+	delete PREFSMAN;
+	test_deinit();
+	exit(0);
+}
+
+/*
+ * (c) 2026 Stepmania team
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, and/or sell copies of the Software, and to permit persons to
+ * whom the Software is furnished to do so, provided that the above
+ * copyright notice(s) and this permission notice appear in all copies of
+ * the Software and that both the above copyright notice(s) and this
+ * permission notice appear in supporting documentation.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT OF
+ * THIRD PARTY RIGHTS. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR HOLDERS
+ * INCLUDED IN THIS NOTICE BE LIABLE FOR ANY CLAIM, OR ANY SPECIAL INDIRECT
+ * OR CONSEQUENTIAL DAMAGES, OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS
+ * OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
@@ -0,0 +1,167 @@
+/* Checks each set of RageSoundKernels the CPU has (SSE2, AVX2) against the
+ * scalar ones.  Unlike the other tests, it only needs RageSoundKernels.cpp, so
+ * it can be built and run on its own; see "00 README". */
+#include "global.h"
+#include "RageSoundKernels.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+/* RageSoundKernels asserts on bad instruction sets; stand in for the crash
+ * handler, so it links without the rest of the game. */
+void Checkpoints::SetCheckpoint( const char * /* file */, int /* line */, const char * /* message */ )
+{
+}
+
+void sm_crash( const char *reason )
+{
+	fprintf( stderr, "%s\n", reason );
+	abort();
+}
+
+static float RandSample()
+{
+	/* Go past [-1,+1], so clipping is tested. */
+	return (float(rand()) / RAND_MAX) * 2.4f - 1.2f;
+}
+
+/* Check one set of RageSoundKernels against the scalar ones, on every size up
+ * to a few vectors, so the leftovers after the vector loops are covered too.
+ * The buffers end right after the last sample, so reading past it will show
+ * up in a memory checker. */
+static bool test_kernels( RageSoundKernels::InstructionSet is )
+{
+	using namespace RageSoundKernels;
+	const char *sName = GetInstructionSetName( is );
+	bool ret = true;
+
+	for( unsigned iSize = 0; iSize < 70; ++iSize )
+	{
+		for( int iStride = 1; iStride <= 3; ++iStride )
+		{
+			const unsigned iSamples = iSize? (iSize-1)*iStride + 1:0;
+			std::vector<float> src( iSamples ), expect( iSamples );
+			for( float &f: src )
+				f = RandSample();
+			for( float &f: expect )
+				f = RandSample();
+			std::vector<float> got( expect );
+
+			SetInstructionSet( InstructionSet_Scalar );
+			Mix( expect.data(), src.data(), iSize, iStride, iStride );
+			SetInstructionSet( is );
+			Mix( got.data(), src.data(), iSize, iStride, iStride );
+			if( memcmp(expect.data(), got.data(), iSamples*sizeof(float)) )
+			{
+				printf( "%s: Mix of %u with stride %i doesn't match\n", sName, iSize, iStride );
+				ret = false;
+			}
+
+			const unsigned iFrames = iSamples / iStride;
+			std::vector<float> expectChannels[3], gotChannels[3];
+			float *pExpect[3], *pGot[3];
+			for( int ch = 0; ch < iStride; ++ch )
+			{
+				expectChannels[ch].resize( iFrames );
+				gotChannels[ch].resize( iFrames );
+				pExpect[ch] = expectChannels[ch].data();
+				pGot[ch] = gotChannels[ch].data();
+			}
+			SetInstructionSet( InstructionSet_Scalar );
+			Deinterleave( src.data(), pExpect, iStride, iFrames );
+			SetInstructionSet( is );
+			Deinterleave( src.data(), pGot, iStride, iFrames );
+			for( int ch = 0; ch < iStride; ++ch )
+			{
+				if( expectChannels[ch] != gotChannels[ch] )
+				{
+					printf( "%s: Deinterleave of %u frames of %i channels doesn't match\n", sName, iFrames, iStride );
+					ret = false;
+				}
+			}
+		}
+
+		std::vector<float> src( iSize );
+		for( float &f: src )
+			f = RandSample();
+		std::vector<std::int16_t> expect( iSize ), got( iSize );
+		SetInstructionSet( InstructionSet_Scalar );
+		ConvertToInt16Clipped( src.data(), expect.data(), iSize );
+		SetInstructionSet( is );
+		ConvertToInt16Clipped( src.data(), got.data(), iSize );
+		if( expect != got )
+		{
+			printf( "%s: ConvertToInt16Clipped of %u doesn't match\n", sName, iSize );
+			ret = false;
+		}
+	}
+
+	/* This one adds in a different order, so it only has to be close. */
+	for( int i = 0; i < 1000; ++i )
+	{
+		float a[8], b[8];
+		for( int j = 0; j < 8; ++j )
+		{
+			a[j] = RandSample();
+			b[j] = RandSample();
+		}
+		SetInstructionSet( InstructionSet_Scalar );
+		const float fExpect = DotProduct8( a, b );
+		SetInstructionSet( is );
+		const float fGot = DotProduct8( a, b );
+		if( std::abs(fExpect - fGot) > 1e-5f )
+		{
+			printf( "%s: DotProduct8 got %f, expected %f\n", sName, fGot, fExpect );
+			ret = false;
+			break;
+		}
+	}
+
+	return ret;
+}
+
+int main()
+{
+	bool bFailed = false;
+	for( int is = 0; is < RageSoundKernels::NUM_InstructionSet; ++is )
+	{
+		const RageSoundKernels::InstructionSet set = RageSoundKernels::InstructionSet( is );
+		if( !RageSoundKernels::IsSupported(set) )
+			continue;
+		if( test_kernels(set) )
+			printf( "%s kernels passed\n", RageSoundKernels::GetInstructionSetName(set) );
+		else
+			bFailed = true;
+	}
+
+	exit( bFailed? 1:0 );
+}
+
+/*
+ * (c) 2026 Stepmania team
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, and/or sell copies of the Software, and to permit persons to
+ * whom the Software is furnished to do so, provided that the above
+ * copyright notice(s) and this permission notice appear in all copies of
+ * the Software and that both the above copyright notice(s) and this
+ * permission notice appear in supporting documentation.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT OF
+ * THIRD PARTY RIGHTS. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR HOLDERS
+ * INCLUDED IN THIS NOTICE BE LIABLE FOR ANY CLAIM, OR ANY SPECIAL INDIRECT
+ * OR CONSEQUENTIAL DAMAGES, OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS
+ * OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
@@ -0,0 +1,104 @@
+/* Checks the row times TimingData::PrepareLookup works out, and the beats a
+ * TimingData::BeatCursor finds, against the plain functions on a gimmick
+ * chart, and times both.  Like the other tests, it has to be linked against
+ * the game objects. */
+#include "global.h"
+#include "test_misc.h"
+
+#include "NoteTypes.h"
+#include "RageLog.h"
+#include "RageTimer.h"
+#include "RageUtil.h"
+#include "TimingData.h"
+
+#include <vector>
+
+static const int NUM_BEATS = 1500;
+
+int main( int argc, char *argv[] )
+{
+	test_handle_args( argc, argv );
+	test_init();
+
+	const int iLastRow = BeatToNoteRow( NUM_BEATS );
+	// Hundreds of BPM changes, stops, delays and warps.
+	TimingData gimmick( 0.1f );
+	RandomGen rnd( 1 );
+	test_make_timing( gimmick, iLastRow, 700, rnd );
+
+	std::vector<float> vTimes;
+	for( int row = 0; row <= iLastRow; ++row )
+		vTimes.push_back( gimmick.GetElapsedTimeFromBeatNoOffset(NoteRowToBeat(row)) );
+	std::vector<TimingData::GetBeatArgs> vBeats;
+	for( float t = -3; t < 1000; t += 0.01f )
+	{
+		TimingData::GetBeatArgs args;
+		args.elapsed_time = t;
+		gimmick.GetBeatAndBPSFromElapsedTimeNoOffset( args );
+		vBeats.push_back( args );
+	}
+
+	RageTimer timer;
+	gimmick.PrepareLookup( iLastRow );
+	const float fPrepareSeconds = timer.GetDeltaTime();
+	for( int row = 0; row <= iLastRow; ++row )
+	{
+		const float fTime = gimmick.GetElapsedTimeFromBeatNoOffset( NoteRowToBeat(row) );
+		if( fTime != vTimes[row] )
+		{
+			LOG->Warn( "Row %i: got %f, expected %f", row, fTime, vTimes[row] );
+			exit(1);
+		}
+	}
+
+	timer.Touch();
+	TimingData::BeatCursor cursor;
+	unsigned i = 0;
+	for( float t = -3; t < 1000; t += 0.01f, ++i )
+	{
+		TimingData::GetBeatArgs args;
+		args.elapsed_time = t;
+		cursor.GetBeatAndBPSFromElapsedTimeNoOffset( gimmick, args );
+		const TimingData::GetBeatArgs &exp = vBeats[i];
+		if( args.beat != exp.beat || args.bps_out != exp.bps_out ||
+			args.freeze_out != exp.freeze_out || args.delay_out != exp.delay_out ||
+			args.warp_begin_out != exp.warp_begin_out || args.warp_dest_out != exp.warp_dest_out )
+		{
+			LOG->Warn( "%f seconds: got beat %f, expected %f", t, args.beat, exp.beat );
+			exit(1);
+		}
+	}
+	const float fCursorSeconds = timer.GetDeltaTime();
+	gimmick.ReleaseLookup();
+
+	LOG->Info( "PrepareLookup with %i rows in %.3fs, %u cursor lookups in %.3fs",
+		iLastRow+1, fPrepareSeconds, i, fCursorSeconds );
+
+	test_deinit();
+	exit(0);
+}
+
+/*
+ * (c) 2026 Stepmania team
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, and/or sell copies of the Software, and to permit persons to
+ * whom the Software is furnished to do so, provided that the above
+ * copyright notice(s) and this permission notice appear in all copies of
+ * the Software and that both the above copyright notice(s) and this
+ * permission notice appear in supporting documentation.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT OF
+ * THIRD PARTY RIGHTS. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR HOLDERS
+ * INCLUDED IN THIS NOTICE BE LIABLE FOR ANY CLAIM, OR ANY SPECIAL INDIRECT
+ * OR CONSEQUENTIAL DAMAGES, OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS
+ * OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */